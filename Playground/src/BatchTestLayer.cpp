@@ -0,0 +1,178 @@
+#include "BatchTestLayer.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+//count every heap allocation in the program, not just the ones a pool makes, so the churn numbers show what spawning really costs.
+//Replacing these is program-wide, so this is the only place in the Playground that does it
+static std::atomic<uint64_t> s_HeapAllocations{ 0 };
+
+void* operator new(std::size_t size)
+{
+	s_HeapAllocations.fetch_add(1, std::memory_order_relaxed);
+	void* ptr = std::malloc(size > 0 ? size : 1);
+	if (!ptr) {
+		throw std::bad_alloc();
+	}
+	return ptr;
+}
+
+void* operator new[](std::size_t size)
+{
+	return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+	std::free(ptr);
+}
+
+BatchTestLayer::BatchTestLayer(uint32_t entityCount, uint32_t childrenPerEntity, bool moving, uint32_t queriesPerFrame, float spatialHashCellSize)
+	: m_EntityCount(entityCount), m_ChildrenPerEntity(childrenPerEntity), m_Moving(moving), 
+	m_QueriesPerFrame(queriesPerFrame), m_SpatialHashCellSize(spatialHashCellSize), m_Extent(0.0f), m_QueryRng(4321), m_QueryResultCount(0),
+	m_SpawnRng(1234), m_ChurnPerFrame(0), m_CameraZoom(1.0f), m_ExtraCameras(0),
+	m_Time(0.0f), m_FrameTimer(0.0f), m_FrameCount(0), m_HeapAllocationsAtLastLog(0)
+{}
+
+BatchTestLayer::~BatchTestLayer()
+{
+	Deactivate();
+}
+
+void BatchTestLayer::Activate()
+{
+	LOG_S(INFO) << "Batch Test Layer Activated! Spawning " << m_EntityCount << " entities with " << m_ChildrenPerEntity << " children each.";
+
+	//spread the entities out over a square area, so density stays about the same for any count
+	float extent = sqrtf((float)m_EntityCount) * 2.0f;
+	m_Extent = extent;
+
+	if (m_SpatialHashCellSize > 0.0f) {
+		EnableSpatialHash(m_SpatialHashCellSize);
+	}
+
+	auto camera = Tara::CreateEntity<Tara::CameraEntity>(Tara::EntityNoRef(), weak_from_this(), Tara::Camera::ProjectionType::Ortographic, TRANSFORM_DEFAULT, "camera");
+	camera->SetOrthographicExtent(extent / m_CameraZoom);
+	SetLayerCamera(camera);
+
+	//extra cameras, each looking at a different spot in the area
+	for (uint32_t i = 0; i < m_ExtraCameras; i++) {
+		float a = 6.2831853f * (float)i / (float)m_ExtraCameras;
+		auto extra = Tara::CreateEntity<Tara::CameraEntity>(Tara::EntityNoRef(), weak_from_this(), Tara::Camera::ProjectionType::Ortographic,
+			TRANSFORM_2D(cosf(a) * extent * 0.25f, sinf(a) * extent * 0.25f, 0, 1, 1), "extraCamera");
+		extra->SetOrthographicExtent(extent / m_CameraZoom);
+		extra->SetRenderEveryFrame(true);
+	}
+
+	for (uint32_t i = 0; i < m_EntityCount; i++) {
+		SpawnEntity();
+	}
+}
+
+void BatchTestLayer::Deactivate()
+{
+	LOG_S(INFO) << "Batch Test Layer Deactivated!";
+}
+
+void BatchTestLayer::Update(float deltaTime)
+{
+	Tara::Layer::Update(deltaTime);
+
+	if (m_Moving) {
+		//wobble every root around its spot, with a different phase each, so the overlap set changes a bit every frame
+		m_Time += deltaTime;
+		auto& entities = GetEntityList();
+		for (size_t i = 0; i < entities.size(); i++) {
+			float phase = m_Time + (float)i;
+			Tara::Vector pos = entities[i]->GetRelativePosition();
+			pos.x += cosf(phase) * deltaTime;
+			pos.y += sinf(phase) * deltaTime;
+			entities[i]->SetRelativePosition(pos);
+		}
+	}
+
+	if (m_ChurnPerFrame > 0) {
+		//destroy the oldest roots, and spawn as many new ones
+		SCOPE_PROFILE("BatchTestLayer churn");
+		auto& entities = GetEntityList();
+		uint32_t churn = std::min(m_ChurnPerFrame, (uint32_t)entities.size());
+		for (uint32_t i = 0; i < churn; i++) {
+			auto entity = entities.front(); //copy, as destroying removes it from the list
+			entity->Destroy();
+		}
+		for (uint32_t i = 0; i < churn; i++) {
+			SpawnEntity();
+		}
+	}
+
+	if (m_QueriesPerFrame > 0) {
+		//the sort of small, local queries AI sensing does: look around a random spot
+		SCOPE_PROFILE("BatchTestLayer queries");
+		std::uniform_real_distribution<float> pos(-m_Extent * 0.5f, m_Extent * 0.5f);
+		std::uniform_real_distribution<float> angle(0.0f, 6.2831853f);
+		for (uint32_t i = 0; i < m_QueriesPerFrame; i++) {
+			Tara::Vector origin = { pos(m_QueryRng), pos(m_QueryRng), 0.0f };
+			float a = angle(m_QueryRng);
+			m_QueryResults.clear();
+			QueryBox({ origin.x - 2.0f, origin.y - 2.0f, -1.0f, 4.0f, 4.0f, 2.0f }, m_QueryResults);
+			QueryRadius(origin, 4.0f, m_QueryResults);
+			QueryRay(origin, { cosf(a), sinf(a), 0.0f }, 16.0f, m_QueryResults);
+			m_QueryResultCount += m_QueryResults.size();
+		}
+	}
+
+	m_FrameTimer += deltaTime;
+	m_FrameCount++;
+	if (m_FrameTimer >= 1.0f) {
+		LOG_S(INFO) << "BatchTestLayer: " << m_EntityCount << " entities, " << (m_FrameCount / m_FrameTimer) << " fps";
+		auto& drawStats = GetDrawStats();
+		LOG_S(INFO) << "BatchTestLayer: last frame drew " << drawStats.DrawnEntities << " entities, culled " << drawStats.CulledEntities
+			<< ", " << Tara::Renderer::GetLastQuadBatchCount() << " quad batches in the last scene";
+		if (GetDrawListMode() && m_ExtraCameras > 0) {
+			LOG_S(INFO) << "BatchTestLayer: draw list recorded " << GetDrawList().GetItems().size() << " items, " << GetDrawList().GetQuadCount() << " quads";
+		}
+		if (m_QueriesPerFrame > 0) {
+			LOG_S(INFO) << "BatchTestLayer: " << ((m_QueriesPerFrame * 3 * m_FrameCount) / m_FrameTimer) << " queries/sec, "
+				<< ((float)m_QueryResultCount / (m_QueriesPerFrame * 3 * m_FrameCount)) << " results/query";
+		}
+		uint64_t heapAllocations = s_HeapAllocations.load(std::memory_order_relaxed);
+		if (m_ChurnPerFrame > 0) {
+			//everything, engine included. Compare runs with the pool enabled and disabled
+			LOG_S(INFO) << "BatchTestLayer: " << ((float)(heapAllocations - m_HeapAllocationsAtLastLog) / m_FrameCount) << " heap allocations/frame, churning "
+				<< m_ChurnPerFrame << " entities/frame";
+		}
+		m_HeapAllocationsAtLastLog = heapAllocations;
+		if (Tara::ObjectPool<Tara::SpriteEntity>::IsEnabled()) {
+			auto stats = Tara::ObjectPool<Tara::SpriteEntity>::GetStats();
+			LOG_S(INFO) << "BatchTestLayer: SpriteEntity pool: " << stats.Live << " live, " << stats.Capacity << " capacity, "
+				<< stats.HeapAllocations << " heap allocations, " << stats.Reuses << "/" << stats.Allocations << " allocations reused";
+		}
+		m_FrameTimer = 0.0f;
+		m_FrameCount = 0;
+		m_QueryResultCount = 0;
+	}
+}
+
+void BatchTestLayer::SpawnEntity()
+{
+	std::uniform_real_distribution<float> pos(-m_Extent * 0.5f, m_Extent * 0.5f);
+	std::uniform_real_distribution<float> color(0.0f, 1.0f);
+	auto entity = Tara::CreateEntity<Tara::SpriteEntity>(
+		Tara::EntityNoRef(), weak_from_this(),
+		TRANSFORM_2D(pos(m_SpawnRng), pos(m_SpawnRng), 0, 1, 1),
+		"batchEntity"
+	);
+	entity->SetTint({ color(m_SpawnRng), color(m_SpawnRng), color(m_SpawnRng), 1.0f });
+	for (uint32_t j = 0; j < m_ChildrenPerEntity; j++) {
+		Tara::CreateEntity<Tara::SpriteEntity>(
+			entity, weak_from_this(),
+			TRANSFORM_2D(0.5f, 0.5f, 0, 0.5f, 0.5f),
+			"batchChild"
+		);
+	}
+}
@@ -0,0 +1,90 @@
+#pragma once
+#include <Tara.h>
+#include <random>
+
+/// <summary>
+/// Stress testing layer. Spawns a large number of simple entities, so that the cost of
+/// the engine's update, draw and overlap passes can be measured with the profiler
+/// (build in Debug, the timings are dumped when the application closes).
+/// </summary>
+class BatchTestLayer : public Tara::Layer {
+public:
+	/// <summary>
+	/// Constructor
+	/// </summary>
+	/// <param name="entityCount">the number of root entities to spawn</param>
+	/// <param name="childrenPerEntity">the number of children to give each root entity</param>
+	/// <param name="moving">if the root entities should move around every frame</param>
+	/// <param name="queriesPerFrame">the number of box, radius and ray queries to run every frame (of each), for measuring query throughput</param>
+	/// <param name="spatialHashCellSize">the cell size of the layer's spatial hash. 0 leaves it disabled</param>
+	BatchTestLayer(uint32_t entityCount = 10000, uint32_t childrenPerEntity = 0, bool moving = false, uint32_t queriesPerFrame = 0, float spatialHashCellSize = 0.0f);
+
+	/// <summary>
+	/// Destructor
+	/// </summary>
+	virtual ~BatchTestLayer();
+
+	/// <summary>
+	/// Activation function, spawns all the entities
+	/// </summary>
+	virtual void Activate() override;
+
+	/// <summary>
+	/// Deactivation function
+	/// </summary>
+	virtual void Deactivate() override;
+
+	/// <summary>
+	/// Update function. Moves the entities and runs the queries (if enabled), and logs the frame rate every second
+	/// </summary>
+	/// <param name="deltaTime"></param>
+	virtual void Update(float deltaTime) override;
+
+	/// <summary>
+	/// Set how many root entities to destroy and respawn every frame, like bullets or particles.
+	/// Every heap allocation in the program is counted, and the allocations per frame are logged every second.
+	/// With pooling enabled (Tara::ObjectPool&lt;Tara::SpriteEntity&gt;::Enable()), the pool counters are logged too.
+	/// The pool only takes the entities' own storage off the heap. Anything an entity allocates itself still goes to the heap.
+	/// </summary>
+	/// <param name="perFrame">the number of entities to churn each frame</param>
+	inline void SetChurn(uint32_t perFrame) { m_ChurnPerFrame = perFrame; }
+
+	/// <summary>
+	/// Set how far the camera is zoomed in on the spawn area. At 1, it sees the whole area. Set before the layer is pushed.
+	/// Zoomed in, view culling skips most of the entities, and the logged draw counts show how many.
+	/// </summary>
+	/// <param name="zoom">the zoom</param>
+	inline void SetCameraZoom(float zoom) { m_CameraZoom = std::max(zoom, 0.001f); }
+
+	/// <summary>
+	/// Set how many cameras, besides the layer camera, draw the layer every frame, like a minimap or a second view.
+	/// Set before the layer is pushed. Compare frame rates with draw-list mode on and off (Layer::SetDrawListMode).
+	/// </summary>
+	/// <param name="count">the number of extra cameras</param>
+	inline void SetExtraCameras(uint32_t count) { m_ExtraCameras = count; }
+
+private:
+	/// <summary>
+	/// Spawn one root entity (and its children) at a random spot
+	/// </summary>
+	void SpawnEntity();
+
+private:
+	uint32_t m_EntityCount;
+	uint32_t m_ChildrenPerEntity;
+	bool m_Moving;
+	uint32_t m_QueriesPerFrame;
+	float m_SpatialHashCellSize;
+	float m_Extent;
+	std::mt19937 m_QueryRng;
+	std::vector<Tara::EntityRef> m_QueryResults;
+	uint64_t m_QueryResultCount;
+	std::mt19937 m_SpawnRng;
+	uint32_t m_ChurnPerFrame;
+	float m_CameraZoom;
+	uint32_t m_ExtraCameras;
+	float m_Time;
+	float m_FrameTimer;
+	uint32_t m_FrameCount;
+	uint64_t m_HeapAllocationsAtLastLog;
+};
@@ -3,6 +3,7 @@
 
 class EditorCameraControllerComponent : public Tara::Component {
 public:
+	TYPE_REGISTRY_BASE(EditorCameraControllerComponent, Tara::Component);
 	EditorCameraControllerComponent(Tara::EntityNoRef parent, float speed = 1.0f, const std::string& name = "EditorCameraControllerComponent");
 
 	virtual void OnBeginPlay() override;
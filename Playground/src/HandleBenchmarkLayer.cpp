@@ -0,0 +1,114 @@
+#include "HandleBenchmarkLayer.h"
+#include <chrono>
+#include <thread>
+#include <atomic>
+
+HandleBenchmarkLayer::HandleBenchmarkLayer(uint32_t entityCount, uint32_t passes, uint32_t maxThreads)
+	: m_EntityCount(entityCount), m_Passes(passes), m_MaxThreads(maxThreads)
+{}
+
+HandleBenchmarkLayer::~HandleBenchmarkLayer()
+{
+	Deactivate();
+}
+
+void HandleBenchmarkLayer::Activate()
+{
+	uint32_t maxThreads = m_MaxThreads;
+	if (maxThreads == 0) {
+		maxThreads = std::max(std::thread::hardware_concurrency(), 1u);
+	}
+	LOG_S(INFO) << "Handle Benchmark Layer Activated! " << m_EntityCount << " entities, " << m_Passes << " passes, 1 to " << maxThreads << " threads.";
+
+	m_Refs.clear();
+	m_Handles.clear();
+	m_Refs.reserve(m_EntityCount);
+	m_Handles.reserve(m_EntityCount);
+	for (uint32_t i = 0; i < m_EntityCount; i++) {
+		auto entity = Tara::CreateEntity<Tara::Entity>(Tara::EntityNoRef(), shared_from_this(), TRANSFORM_2D((float)i, 0, 0, 1, 1), "HandleBenchmarkEntity");
+		m_Refs.push_back(entity);
+		m_Handles.push_back(entity->GetHandle());
+	}
+
+	auto lockWalk = [this]() {
+		float sum = 0.0f;
+		for (uint32_t pass = 0; pass < m_Passes; pass++) {
+			for (auto& ref : m_Refs) {
+				auto entity = ref.lock();
+				if (entity) {
+					sum += entity->GetRelativeTransform().Position.x;
+				}
+			}
+		}
+		return sum;
+	};
+	auto handleWalk = [this]() {
+		float sum = 0.0f;
+		for (uint32_t pass = 0; pass < m_Passes; pass++) {
+			for (auto& handle : m_Handles) {
+				Tara::Entity* entity = Resolve(handle);
+				if (entity) {
+					sum += entity->GetRelativeTransform().Position.x;
+				}
+			}
+		}
+		return sum;
+	};
+
+	float lookups = (float)m_EntityCount * (float)m_Passes;
+	for (uint32_t threads = 1; threads <= maxThreads; threads++) {
+		float locked = TimeWalk(threads, lockWalk);
+		float resolved = TimeWalk(threads, handleWalk);
+		LOG_S(INFO) << "HandleBenchmark: " << threads << " threads | weak_ptr::lock: " << locked << "ms (" << (locked * 1000000.0f / lookups) << "ns/lookup)"
+			<< " | Resolve: " << resolved << "ms (" << (resolved * 1000000.0f / lookups) << "ns/lookup) | x" << (locked / resolved);
+	}
+
+	//and destroyed entities stop resolving
+	uint32_t destroyed = 0;
+	for (uint32_t i = 0; i < m_EntityCount; i += 2) {
+		m_Refs[i].lock()->Destroy();
+		destroyed++;
+	}
+	uint32_t live = 0;
+	for (auto& handle : m_Handles) {
+		live += Exists(handle) ? 1 : 0;
+	}
+	LOG_S(INFO) << "HandleBenchmark: destroyed " << destroyed << " entities, " << live << " handles still resolve (expected " << (m_EntityCount - destroyed) << ")";
+}
+
+void HandleBenchmarkLayer::Deactivate()
+{
+	LOG_S(INFO) << "Handle Benchmark Layer Deactivated!";
+}
+
+float HandleBenchmarkLayer::TimeWalk(uint32_t threads, const std::function<float()>& walk)
+{
+	//every thread waits for the go, so they all walk the same entities at the same time
+	std::atomic<uint32_t> ready = 0;
+	std::atomic<bool> go = false;
+	std::atomic<float> total = 0.0f;
+	std::vector<std::thread> workers;
+	workers.reserve(threads);
+	for (uint32_t i = 0; i < threads; i++) {
+		workers.emplace_back([&]() {
+			ready++;
+			while (!go.load(std::memory_order_acquire)) {
+				std::this_thread::yield();
+			}
+			float sum = walk();
+			float expected = total.load();
+			while (!total.compare_exchange_weak(expected, expected + sum));
+		});
+	}
+	while (ready.load() < threads) {
+		std::this_thread::yield();
+	}
+	auto start = std::chrono::high_resolution_clock::now();
+	go.store(true, std::memory_order_release);
+	for (auto& worker : workers) {
+		worker.join();
+	}
+	auto end = std::chrono::high_resolution_clock::now();
+	m_Checksum += total.load();
+	return std::chrono::duration<float, std::milli>(end - start).count();
+}
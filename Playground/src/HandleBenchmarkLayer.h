@@ -0,0 +1,50 @@
+#pragma once
+#include <Tara.h>
+
+/// <summary>
+/// Handle resolution benchmark. When activated, makes a batch of entities, and has 1 to N threads walk the same
+/// entities at once, reaching each one through an EntityNoRef (weak_ptr::lock) and through an EntityHandle (Layer::Resolve).
+/// Logs the time of each, and how it scales as threads are added and the reference counts are contended.
+/// </summary>
+class HandleBenchmarkLayer : public Tara::Layer {
+public:
+	/// <summary>
+	/// Constructor
+	/// </summary>
+	/// <param name="entityCount">the number of entities to walk</param>
+	/// <param name="passes">how many times each thread walks every entity</param>
+	/// <param name="maxThreads">the highest thread count to test. 0 tests up to one per hardware thread</param>
+	HandleBenchmarkLayer(uint32_t entityCount = 10000, uint32_t passes = 100, uint32_t maxThreads = 0);
+
+	/// <summary>
+	/// Destructor
+	/// </summary>
+	virtual ~HandleBenchmarkLayer();
+
+	/// <summary>
+	/// Activation function, runs the benchmark
+	/// </summary>
+	virtual void Activate() override;
+
+	/// <summary>
+	/// Deactivation function
+	/// </summary>
+	virtual void Deactivate() override;
+
+private:
+	/// <summary>
+	/// Time a walk run on several threads at once
+	/// </summary>
+	/// <param name="threads">the number of threads</param>
+	/// <param name="walk">walks every entity, once per pass, and returns a sum so the work is not optimized away</param>
+	/// <returns>the time until every thread finished, in milliseconds</returns>
+	float TimeWalk(uint32_t threads, const std::function<float()>& walk);
+
+private:
+	uint32_t m_EntityCount;
+	uint32_t m_Passes;
+	uint32_t m_MaxThreads;
+	std::vector<Tara::EntityNoRef> m_Refs;
+	std::vector<Tara::EntityHandle> m_Handles;
+	float m_Checksum = 0.0f; //the walks' sums end up here, so they are not optimized away
+};
@@ -0,0 +1,87 @@
+#include "JobBenchmarkLayer.h"
+#include <chrono>
+#include <thread>
+
+//a flat loop, like updating a big array of particles
+static void FlatWorkload(std::vector<float>& data)
+{
+	Tara::JobSystem::Get()->ParallelFor(data.size(), 4096, [&data](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			float x = (float)i;
+			for (int j = 0; j < 16; j++) {
+				x = sqrtf(x * x + 1.0f) * 0.999f;
+			}
+			data[i] = x;
+		}
+	});
+}
+
+//a recursive fork/join, like walking a tree, so jobs spawn and wait on jobs
+static uint64_t NestedWorkload(uint32_t depth)
+{
+	if (depth == 0) {
+		uint64_t sum = 0;
+		for (uint64_t i = 0; i < 20000; i++) {
+			sum += (i * i) ^ (sum >> 3);
+		}
+		return sum;
+	}
+	uint64_t left = 0;
+	Tara::JobCounter counter;
+	Tara::JobSystem::Get()->Run([&left, depth]() { left = NestedWorkload(depth - 1); }, &counter);
+	uint64_t right = NestedWorkload(depth - 1);
+	Tara::JobSystem::Get()->Wait(counter);
+	return left + right;
+}
+
+JobBenchmarkLayer::JobBenchmarkLayer(uint32_t maxThreads, uint32_t repeats)
+	: m_MaxThreads(maxThreads), m_Repeats(repeats)
+{}
+
+JobBenchmarkLayer::~JobBenchmarkLayer()
+{
+	Deactivate();
+}
+
+void JobBenchmarkLayer::Activate()
+{
+	uint32_t maxThreads = m_MaxThreads;
+	if (maxThreads == 0) {
+		maxThreads = std::max(std::thread::hardware_concurrency(), 1u);
+	}
+	LOG_S(INFO) << "Job Benchmark Layer Activated! Testing 1 to " << maxThreads << " threads.";
+
+	std::vector<float> data(1 << 20);
+	float flatBase = 0.0f;
+	float nestedBase = 0.0f;
+	for (uint32_t threads = 1; threads <= maxThreads; threads++) {
+		Tara::JobSystem::Get()->SetThreadCount(threads);
+		float flat = TimeWorkload([&data]() { FlatWorkload(data); });
+		float nested = TimeWorkload([]() { NestedWorkload(10); });
+		if (threads == 1) {
+			flatBase = flat;
+			nestedBase = nested;
+		}
+		LOG_S(INFO) << "JobBenchmark: " << threads << " threads | ParallelFor: " << flat << "ms (x" << (flatBase / flat) << ")"
+			<< " | Nested: " << nested << "ms (x" << (nestedBase / nested) << ")";
+	}
+	//back to the default
+	Tara::JobSystem::Get()->SetThreadCount(0);
+}
+
+void JobBenchmarkLayer::Deactivate()
+{
+	LOG_S(INFO) << "Job Benchmark Layer Deactivated!";
+}
+
+float JobBenchmarkLayer::TimeWorkload(const std::function<void()>& workload)
+{
+	float best = std::numeric_limits<float>::max();
+	for (uint32_t i = 0; i < m_Repeats; i++) {
+		auto start = std::chrono::high_resolution_clock::now();
+		workload();
+		auto end = std::chrono::high_resolution_clock::now();
+		best = std::min(best, std::chrono::duration<float, std::milli>(end - start).count());
+	}
+	return best;
+}
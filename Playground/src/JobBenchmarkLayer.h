@@ -0,0 +1,43 @@
+#pragma once
+#include <Tara.h>
+
+/// <summary>
+/// Job system scaling benchmark. When activated, runs a few fixed workloads on the JobSystem
+/// with 1 to N threads, and logs the time and speedup of each.
+/// </summary>
+class JobBenchmarkLayer : public Tara::Layer {
+public:
+	/// <summary>
+	/// Constructor
+	/// </summary>
+	/// <param name="maxThreads">the highest thread count to test. 0 tests up to one per hardware thread</param>
+	/// <param name="repeats">how many times each workload is run per thread count. The best time is kept.</param>
+	JobBenchmarkLayer(uint32_t maxThreads = 0, uint32_t repeats = 5);
+
+	/// <summary>
+	/// Destructor
+	/// </summary>
+	virtual ~JobBenchmarkLayer();
+
+	/// <summary>
+	/// Activation function, runs the benchmark
+	/// </summary>
+	virtual void Activate() override;
+
+	/// <summary>
+	/// Deactivation function
+	/// </summary>
+	virtual void Deactivate() override;
+
+private:
+	/// <summary>
+	/// Time a workload with the current thread count
+	/// </summary>
+	/// <param name="workload">the workload</param>
+	/// <returns>the best time over the repeats, in milliseconds</returns>
+	float TimeWorkload(const std::function<void()>& workload);
+
+private:
+	uint32_t m_MaxThreads;
+	uint32_t m_Repeats;
+};
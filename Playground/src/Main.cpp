@@ -16,7 +16,13 @@ OpenGL include - BAD - used for developing new features ONLY
 #include "TColorRectEntity.h"
 #include "PawnEntity.h"
 #include "TOrthoCameraControllerComponent.h"
-//#include "BatchTestLayer.h"
+#include "BatchTestLayer.h"
+#include "JobBenchmarkLayer.h"
+#include "SnapshotBenchmarkLayer.h"
+#include "StreamingTestLayer.h"
+#include "PrefabBenchmarkLayer.h"
+#include "HandleBenchmarkLayer.h"
+#include "QuadBenchmarkLayer.h"
 #include "EditorCameraControllerComponent.h"
 #define SPRITE_MAX 100
 
@@ -26,6 +32,7 @@ OpenGL include - BAD - used for developing new features ONLY
 
 
 void LayerSwitch(const std::string& newLayerName, Tara::LayerNoRef currentLayer);
+bool PushBenchmark(const std::string& name);
 
 
 struct TestStruct {
@@ -377,21 +384,134 @@ private:
 
 
 int main(int argc, char** argv) {
+	//Playground [--headless] [--fixed-timestep <ticks per second>] [--bench <name>]. See PushBenchmark for the benchmark names
+	bool headless = false;
+	float fixedTimestep = 0.0f;
+	std::string bench = "";
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		if (arg == "--headless") {
+			headless = true;
+		}
+		else if (arg == "--fixed-timestep" && i + 1 < argc) {
+			fixedTimestep = (float)atof(argv[++i]);
+		}
+		else if (arg == "--bench" && i + 1 < argc) {
+			bench = argv[++i];
+		}
+	}
+
 	Tara::Script::Get()->SetDefaultLibraryPath("../Tara/lua");
-	Tara::Application::Get()->Init(1200, 700, "Tara Playground Application!");
+	if (headless) {
+		//no window or GPU (a server, or a soak test): 60 synthetic ticks per second, as fast as possible
+		Tara::Application::Get()->InitHeadless(1200, 700, 60.0f, false);
+	}
+	else {
+		Tara::Application::Get()->Init(1200, 700, "Tara Playground Application!");
+	}
 	//init stuff we have to do
 	Tara::Script::RegisterType<PawnEntity>("PawnEntity"); //register PawnEntity
+	if (fixedTimestep > 0.0f) {
+		//sprites and cameras are interpolated between ticks when drawn
+		Tara::Application::Get()->SetFixedTimestep(fixedTimestep);
+	}
 
 	//add layers to scene...
-	//Tara::Application::Get()->GetScene()->PushLayer(std::make_shared<DemoLayer>());
-	Tara::Application::Get()->GetScene()->PushLayer(std::make_shared<TestingLayer>());
-	//Tara::Application::Get()->GetScene()->PushLayer(std::make_shared<FramebufferBuildLayer>());
-	//Tara::Application::Get()->GetScene()->PushLayer(std::make_shared<UIBuildLayer>());
+	if (bench != "") {
+		if (!PushBenchmark(bench)) {
+			return 1;
+		}
+	}
+	else {
+		//Tara::Application::Get()->GetScene()->PushLayer(std::make_shared<DemoLayer>());
+		Tara::Application::Get()->GetScene()->PushLayer(std::make_shared<TestingLayer>());
+		//Tara::Application::Get()->GetScene()->PushLayer(std::make_shared<FramebufferBuildLayer>());
+		//Tara::Application::Get()->GetScene()->PushLayer(std::make_shared<UIBuildLayer>());
+	}
 	//run
 	Tara::Application::Get()->Run();
 	return 0;
 }
 
+bool PushBenchmark(const std::string& name)
+{
+	auto scene = Tara::Application::Get()->GetScene();
+	if (name == "batch") {
+		//100k static sprites
+		scene->PushLayer(std::make_shared<BatchTestLayer>(100000));
+	}
+	else if (name == "overlap" || name == "overlap-brute") {
+		//overlap timings with moving entities, sweep and prune or brute force
+		auto batch = std::make_shared<BatchTestLayer>(10000, 0, true);
+		if (name == "overlap-brute") {
+			batch->SetOverlapBroadphase(Tara::Layer::OverlapBroadphase::BruteForce);
+		}
+		scene->PushLayer(batch);
+	}
+	else if (name == "query" || name == "query-nohash") {
+		//query throughput, with the spatial hash enabled and disabled
+		scene->PushLayer(std::make_shared<BatchTestLayer>(10000, 0, true, 1000, (name == "query") ? 8.0f : 0.0f));
+	}
+	else if (name == "jobs") {
+		//job system scaling, from 1 thread to one per hardware thread
+		scene->PushLayer(std::make_shared<JobBenchmarkLayer>());
+	}
+	else if (name == "churn" || name == "churn-pool") {
+		//entities destroyed and spawned every frame. Compare the logged heap allocations per frame with the pool enabled and disabled
+		if (name == "churn-pool") {
+			Tara::ObjectPool<Tara::SpriteEntity>::Enable(10000);
+		}
+		auto batch = std::make_shared<BatchTestLayer>(10000);
+		batch->SetChurn(100);
+		scene->PushLayer(batch);
+	}
+	else if (name == "snapshot") {
+		//snapshot save and load throughput, raw and compressed, at 100k entities
+		scene->PushLayer(std::make_shared<SnapshotBenchmarkLayer>(100000));
+	}
+	else if (name == "streaming") {
+		//stream in a 100k entity layer in the background, logging progress and the longest frame while it loads
+		scene->PushOverlay(std::make_shared<StreamingTestLayer>(100000));
+	}
+	else if (name == "prefab") {
+		//spawning 10k four-entity enemies: CreateEntity chains against prefab instantiation
+		scene->PushLayer(std::make_shared<PrefabBenchmarkLayer>(10000, 3));
+	}
+	else if (name == "handles") {
+		//reaching 10k entities from 1 to N threads at once: weak_ptr::lock against generational handles
+		scene->PushLayer(std::make_shared<HandleBenchmarkLayer>(10000, 100));
+	}
+	else if (name == "cull") {
+		//view culling, zoomed in 20x on 100k entities with 3 children each. The draw counts of the last frame are logged
+		auto batch = std::make_shared<BatchTestLayer>(100000, 3);
+		batch->SetCameraZoom(20.0f);
+		scene->PushLayer(batch);
+	}
+	else if (name == "drawlist" || name == "drawlist-off") {
+		//four cameras drawing the same 100k entities, recorded once into a draw list and submitted per camera, or drawn per camera
+		auto batch = std::make_shared<BatchTestLayer>(100000);
+		batch->SetCameraZoom(4.0f);
+		batch->SetExtraCameras(3);
+		batch->SetDrawListMode(name == "drawlist");
+		scene->PushLayer(batch);
+	}
+	else if (name == "quadsort") {
+		//quads sorted by key (sprites Y-sort). Compare fps against "batch", which uses the default submission order
+		Tara::Renderer::SetQuadSortMode(Tara::QuadSortMode::Key);
+		scene->PushLayer(std::make_shared<BatchTestLayer>(100000));
+	}
+	else if (name == "quads") {
+		//quads per second through Renderer::Quad batching. Meant for --headless
+		scene->PushLayer(std::make_shared<QuadBenchmarkLayer>(100000, 64));
+	}
+	else {
+		LOG_S(ERROR) << "Unknown benchmark: " << name << ". Known: batch, overlap, overlap-brute, query, query-nohash, jobs, churn, churn-pool, snapshot, "
+			<< "streaming, prefab, handles, cull, drawlist, drawlist-off, quadsort, quads";
+		return false;
+	}
+	return true;
+}
+
 void LayerSwitch(const std::string& newLayerName, Tara::LayerNoRef currentLayer)
 {
 	if (newLayerName == "basic") {
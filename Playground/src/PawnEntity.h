@@ -14,6 +14,7 @@ class PawnEntity : public Tara::SpriteEntity {
 	};
 
 public:
+	TYPE_REGISTRY_BASE(PawnEntity, Tara::SpriteEntity);
 	/// <summary>
 	/// Construct a new pawn entity
 	/// </summary>
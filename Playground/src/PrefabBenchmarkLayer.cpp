@@ -0,0 +1,78 @@
+#include "PrefabBenchmarkLayer.h"
+#include <chrono>
+#include <random>
+
+PrefabBenchmarkLayer::PrefabBenchmarkLayer(uint32_t copyCount, uint32_t childrenPerCopy, uint32_t repeats)
+	: m_CopyCount(copyCount), m_ChildrenPerCopy(childrenPerCopy), m_Repeats(repeats)
+{}
+
+PrefabBenchmarkLayer::~PrefabBenchmarkLayer()
+{
+	Deactivate();
+}
+
+void PrefabBenchmarkLayer::Activate()
+{
+	LOG_S(INFO) << "Prefab Benchmark Layer Activated! " << m_CopyCount << " copies of an entity with " << m_ChildrenPerCopy << " children.";
+
+	std::mt19937 rng(1234);
+	std::uniform_real_distribution<float> pos(-500.0f, 500.0f);
+	m_Transforms.clear();
+	m_Transforms.reserve(m_CopyCount);
+	for (uint32_t i = 0; i < m_CopyCount; i++) {
+		m_Transforms.push_back(TRANSFORM_2D(pos(rng), pos(rng), 0, 1, 1));
+	}
+
+	//the template is built in this layer, and captured once
+	auto prefab = Tara::Prefab::Create(BuildEnemy(shared_from_this(), TRANSFORM_DEFAULT), "PrefabBenchmarkEnemy");
+	if (!prefab) {
+		LOG_S(ERROR) << "PrefabBenchmark: failed to capture the prefab!";
+		return;
+	}
+	LOG_S(INFO) << "PrefabBenchmark: prefab has " << prefab->GetEntityCount() << " entities in " << prefab->GetDataSize() << " bytes";
+
+	RunBenchmark("CreateEntity", [this](const Tara::LayerRef& layer) {
+		for (auto& transform : m_Transforms) {
+			BuildEnemy(layer, transform);
+		}
+	});
+	RunBenchmark("Instantiate", [this, prefab](const Tara::LayerRef& layer) {
+		for (auto& transform : m_Transforms) {
+			prefab->Instantiate(Tara::EntityNoRef(), layer, transform);
+		}
+	});
+	RunBenchmark("Instantiate (bulk)", [this, prefab](const Tara::LayerRef& layer) {
+		prefab->Instantiate(Tara::EntityNoRef(), layer, m_Transforms);
+	});
+}
+
+void PrefabBenchmarkLayer::Deactivate()
+{
+	LOG_S(INFO) << "Prefab Benchmark Layer Deactivated!";
+}
+
+Tara::EntityRef PrefabBenchmarkLayer::BuildEnemy(const Tara::LayerRef& layer, const Tara::Transform& transform)
+{
+	auto root = Tara::CreateEntity<Tara::SpriteEntity>(Tara::EntityNoRef(), layer, transform, "Enemy");
+	root->SetTint({ 1.0f, 0.2f, 0.2f, 1.0f });
+	for (uint32_t i = 0; i < m_ChildrenPerCopy; i++) {
+		Tara::CreateEntity<Tara::SpriteEntity>(root, layer, TRANSFORM_2D(0.5f * (float)i, 0.5f, 0, 0.5f, 0.5f), "EnemyPart");
+	}
+	return root;
+}
+
+void PrefabBenchmarkLayer::RunBenchmark(const std::string& label, const std::function<void(const Tara::LayerRef&)>& spawn)
+{
+	using Clock = std::chrono::high_resolution_clock;
+	float best = std::numeric_limits<float>::max();
+	for (uint32_t i = 0; i < m_Repeats; i++) {
+		//a fresh layer each time, so every run starts empty. Destroying it is not timed
+		auto layer = std::make_shared<Tara::Layer>();
+		auto start = Clock::now();
+		spawn(layer);
+		auto end = Clock::now();
+		best = std::min(best, std::chrono::duration<float>(end - start).count());
+	}
+	float entities = (float)m_CopyCount * (float)(m_ChildrenPerCopy + 1);
+	LOG_S(INFO) << "PrefabBenchmark (" << label << "): " << (best * 1000.0f) << "ms for " << m_CopyCount << " copies (" << (entities / best) << " entities/s)";
+}
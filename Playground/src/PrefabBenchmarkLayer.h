@@ -0,0 +1,55 @@
+#pragma once
+#include <Tara.h>
+
+/// <summary>
+/// Prefab spawn benchmark. When activated, builds an "enemy" (a sprite entity with a few children) and captures it as a prefab,
+/// then spawns copies of it into fresh layers: one CreateEntity chain per copy, one Prefab::Instantiate call per copy,
+/// and a single bulk Prefab::Instantiate call, and logs the time each takes.
+/// </summary>
+class PrefabBenchmarkLayer : public Tara::Layer {
+public:
+	/// <summary>
+	/// Constructor
+	/// </summary>
+	/// <param name="copyCount">the number of copies to spawn</param>
+	/// <param name="childrenPerCopy">the number of children under each copy's root</param>
+	/// <param name="repeats">how many times each way of spawning is run. The best time is kept.</param>
+	PrefabBenchmarkLayer(uint32_t copyCount = 10000, uint32_t childrenPerCopy = 3, uint32_t repeats = 3);
+
+	/// <summary>
+	/// Destructor
+	/// </summary>
+	virtual ~PrefabBenchmarkLayer();
+
+	/// <summary>
+	/// Activation function, runs the benchmark
+	/// </summary>
+	virtual void Activate() override;
+
+	/// <summary>
+	/// Deactivation function
+	/// </summary>
+	virtual void Deactivate() override;
+
+private:
+	/// <summary>
+	/// Build one enemy by hand, the way it would be without prefabs
+	/// </summary>
+	/// <param name="layer">the layer to build it in</param>
+	/// <param name="transform">the transform of its root</param>
+	/// <returns>the enemy's root</returns>
+	Tara::EntityRef BuildEnemy(const Tara::LayerRef& layer, const Tara::Transform& transform);
+
+	/// <summary>
+	/// Time one way of spawning the copies, each run into a fresh layer
+	/// </summary>
+	/// <param name="label">the name to log it as</param>
+	/// <param name="spawn">spawns every copy into the layer</param>
+	void RunBenchmark(const std::string& label, const std::function<void(const Tara::LayerRef&)>& spawn);
+
+private:
+	uint32_t m_CopyCount;
+	uint32_t m_ChildrenPerCopy;
+	uint32_t m_Repeats;
+	std::vector<Tara::Transform> m_Transforms;
+};
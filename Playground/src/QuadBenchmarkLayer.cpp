@@ -0,0 +1,82 @@
+#include "QuadBenchmarkLayer.h"
+#include <chrono>
+#include <random>
+
+QuadBenchmarkLayer::QuadBenchmarkLayer(uint32_t quadsPerScene, uint32_t textureCount, uint32_t scenes)
+	: m_QuadsPerScene(quadsPerScene), m_TextureCount(std::max(textureCount, 1u)), m_Scenes(scenes)
+{}
+
+QuadBenchmarkLayer::~QuadBenchmarkLayer()
+{
+	Deactivate();
+}
+
+void QuadBenchmarkLayer::Activate()
+{
+	if (Tara::Renderer::GetRenderBackend() != Tara::RenderBackend::None) {
+		LOG_S(WARNING) << "Quad Benchmark Layer: run headless (Application::InitHeadless), skipping.";
+		return;
+	}
+	LOG_S(INFO) << "Quad Benchmark Layer Activated! " << m_QuadsPerScene << " quads per scene, " << m_TextureCount << " textures, " << m_Scenes << " scenes.";
+
+	//tiny textures, only their identity matters
+	uint8_t pixel[4] = { 255, 255, 255, 255 };
+	m_Textures.clear();
+	for (uint32_t i = 0; i < m_TextureCount; i++) {
+		m_Textures.push_back(Tara::Texture2D::Create(pixel, 1, 1, 4, "QuadBenchmarkTexture" + std::to_string(i)));
+	}
+
+	//runs of 1 to 8 quads with the same texture
+	std::mt19937 rng(1234);
+	std::uniform_int_distribution<uint32_t> texture(0, m_TextureCount - 1);
+	std::uniform_int_distribution<uint32_t> run(1, 8);
+	std::uniform_real_distribution<float> pos(-100.0f, 100.0f);
+	m_QuadTextures.clear();
+	m_QuadTransforms.clear();
+	m_QuadTextures.reserve(m_QuadsPerScene);
+	m_QuadTransforms.reserve(m_QuadsPerScene);
+	while (m_QuadTextures.size() < m_QuadsPerScene) {
+		uint32_t t = texture(rng);
+		for (uint32_t r = run(rng); r > 0 && m_QuadTextures.size() < m_QuadsPerScene; r--) {
+			m_QuadTextures.push_back(t);
+			m_QuadTransforms.push_back(TRANSFORM_2D(pos(rng), pos(rng), 0, 1, 1));
+		}
+	}
+
+	auto camera = std::make_shared<Tara::OrthographicCamera>(200.0f);
+	Tara::Renderer::SetHeadlessBatching(true);
+	float quads = (float)m_QuadsPerScene * (float)m_Scenes;
+	for (bool keyed : { false, true }) {
+		Tara::Renderer::SetQuadSortMode(keyed ? Tara::QuadSortMode::Key : Tara::QuadSortMode::Submission);
+		//a run first, so the batch storage has grown before the timed run
+		TimeScenes(camera, keyed);
+		float ms = TimeScenes(camera, keyed);
+		LOG_S(INFO) << "QuadBenchmark: " << (keyed ? "sorted by key" : "submission order") << " | " << ms << "ms | "
+			<< (quads * 1000.0f / ms / 1000000.0f) << "M quads/sec | " << Tara::Renderer::GetLastQuadBatchCount() << " batches per scene";
+	}
+	Tara::Renderer::SetQuadSortMode(Tara::QuadSortMode::Submission);
+	Tara::Renderer::SetHeadlessBatching(false);
+}
+
+void QuadBenchmarkLayer::Deactivate()
+{
+	LOG_S(INFO) << "Quad Benchmark Layer Deactivated!";
+}
+
+float QuadBenchmarkLayer::TimeScenes(const Tara::CameraRef& camera, bool keyed)
+{
+	glm::vec4 color = { 1.0f, 1.0f, 1.0f, 1.0f };
+	auto start = std::chrono::high_resolution_clock::now();
+	for (uint32_t scene = 0; scene < m_Scenes; scene++) {
+		Tara::Renderer::BeginScene(camera);
+		for (uint32_t i = 0; i < m_QuadsPerScene; i++) {
+			const Tara::Texture2DRef& texture = m_Textures[m_QuadTextures[i]];
+			const Tara::Transform& transform = m_QuadTransforms[i];
+			uint64_t key = keyed ? Tara::Renderer::MakeQuadSortKey(0, -transform.Position.y, texture) : 0;
+			Tara::Renderer::Quad(transform, color, texture, { 0, 0 }, { 1, 1 }, key);
+		}
+		Tara::Renderer::EndScene();
+	}
+	auto end = std::chrono::high_resolution_clock::now();
+	return std::chrono::duration<float, std::milli>(end - start).count();
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <Tara.h>
+
+/// <summary>
+/// Quad batching benchmark. Run headless (Application::InitHeadless). When activated, pushes quads through Renderer::Quad
+/// scene after scene, with the renderer batching them but drawing nothing (Renderer::SetHeadlessBatching), and logs quads per second
+/// and the batches per scene, in submission order and sorted by key. Quads cycle through many textures in short runs, like tiles from several atlases.
+/// </summary>
+class QuadBenchmarkLayer : public Tara::Layer {
+public:
+	/// <summary>
+	/// Constructor
+	/// </summary>
+	/// <param name="quadsPerScene">the number of quads in each scene</param>
+	/// <param name="textureCount">the number of textures the quads use</param>
+	/// <param name="scenes">the number of scenes to time</param>
+	QuadBenchmarkLayer(uint32_t quadsPerScene = 100000, uint32_t textureCount = 64, uint32_t scenes = 100);
+
+	/// <summary>
+	/// Destructor
+	/// </summary>
+	virtual ~QuadBenchmarkLayer();
+
+	/// <summary>
+	/// Activation function, runs the benchmark
+	/// </summary>
+	virtual void Activate() override;
+
+	/// <summary>
+	/// Deactivation function
+	/// </summary>
+	virtual void Deactivate() override;
+
+private:
+	/// <summary>
+	/// Time submitting every scene
+	/// </summary>
+	/// <param name="camera">the camera to begin the scenes with</param>
+	/// <param name="keyed">true to give each quad a sort key</param>
+	/// <returns>the time, in milliseconds</returns>
+	float TimeScenes(const Tara::CameraRef& camera, bool keyed);
+
+private:
+	uint32_t m_QuadsPerScene;
+	uint32_t m_TextureCount;
+	uint32_t m_Scenes;
+	std::vector<Tara::Texture2DRef> m_Textures;
+	std::vector<uint32_t> m_QuadTextures; //the texture of each quad, picked up front so the RNG is not timed
+	std::vector<Tara::Transform> m_QuadTransforms;
+};
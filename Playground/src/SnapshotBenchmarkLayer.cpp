@@ -0,0 +1,94 @@
+#include "SnapshotBenchmarkLayer.h"
+#include <chrono>
+#include <random>
+
+SnapshotBenchmarkLayer::SnapshotBenchmarkLayer(uint32_t entityCount, uint32_t tilemapSize, uint32_t repeats)
+	: m_EntityCount(entityCount), m_TilemapSize(tilemapSize), m_Repeats(repeats)
+{}
+
+SnapshotBenchmarkLayer::~SnapshotBenchmarkLayer()
+{
+	Deactivate();
+}
+
+void SnapshotBenchmarkLayer::Activate()
+{
+	LOG_S(INFO) << "Snapshot Benchmark Layer Activated! " << m_EntityCount << " entities, and a " << m_TilemapSize << "x" << m_TilemapSize << " tilemap.";
+
+	//one root in four has three children, so the hierarchy is walked as well
+	std::mt19937 rng(1234);
+	std::uniform_real_distribution<float> pos(-500.0f, 500.0f);
+	std::uniform_real_distribution<float> color(0.0f, 1.0f);
+	Tara::SpriteEntityRef root;
+	for (uint32_t i = 0; i < m_EntityCount; i++) {
+		bool child = root && (i % 4) != 0;
+		auto entity = Tara::CreateEntity<Tara::SpriteEntity>(
+			child ? Tara::EntityNoRef(root) : Tara::EntityNoRef(), weak_from_this(),
+			TRANSFORM_2D(pos(rng), pos(rng), 0, 1, 1),
+			child ? "Child" : "Root"
+		);
+		entity->SetTint(color(rng), color(rng), color(rng));
+		if (!child) {
+			root = entity;
+		}
+	}
+
+	//a full tilemap, with a little metadata
+	auto tilemap = Tara::CreateEntity<Tara::TilemapEntity>(
+		Tara::EntityNoRef(), weak_from_this(), std::initializer_list<Tara::TilesetRef>{}, TRANSFORM_DEFAULT, "Tilemap"
+	);
+	for (int32_t x = 0; x < (int32_t)m_TilemapSize; x++) {
+		for (int32_t y = 0; y < (int32_t)m_TilemapSize; y++) {
+			tilemap->SwapTile(x, y, 0, (uint32_t)(rng() % 16));
+		}
+	}
+	for (uint32_t i = 0; i < m_TilemapSize; i++) {
+		tilemap->SetCellMetadata((int32_t)i, (int32_t)i, 0, (int32_t)i);
+	}
+
+	RunBenchmark(false);
+	RunBenchmark(true);
+}
+
+void SnapshotBenchmarkLayer::Deactivate()
+{
+	LOG_S(INFO) << "Snapshot Benchmark Layer Deactivated!";
+}
+
+void SnapshotBenchmarkLayer::RunBenchmark(bool compress)
+{
+	using Clock = std::chrono::high_resolution_clock;
+	float bestSave = std::numeric_limits<float>::max();
+	float bestLoad = std::numeric_limits<float>::max();
+	std::string snapshot;
+	for (uint32_t i = 0; i < m_Repeats; i++) {
+		std::ostringstream out(std::ios::binary);
+		auto start = Clock::now();
+		bool saved = SaveSnapshot(out, compress);
+		auto end = Clock::now();
+		if (!saved) {
+			LOG_S(ERROR) << "SnapshotBenchmark: save failed!";
+			return;
+		}
+		bestSave = std::min(bestSave, std::chrono::duration<float>(end - start).count());
+		snapshot = out.str();
+	}
+	for (uint32_t i = 0; i < m_Repeats; i++) {
+		//a fresh layer each time, so every load starts empty. Destroying it is not timed
+		auto layer = std::make_shared<Tara::Layer>();
+		std::istringstream in(snapshot, std::ios::binary);
+		auto start = Clock::now();
+		bool loaded = layer->LoadSnapshot(in);
+		auto end = Clock::now();
+		if (!loaded) {
+			LOG_S(ERROR) << "SnapshotBenchmark: load failed!";
+			return;
+		}
+		bestLoad = std::min(bestLoad, std::chrono::duration<float>(end - start).count());
+	}
+	float entities = (float)m_EntityCount + 1; //and the tilemap
+	float megabytes = (float)snapshot.size() / (1024.0f * 1024.0f);
+	LOG_S(INFO) << "SnapshotBenchmark (" << (compress ? "compressed" : "raw") << ", " << megabytes << "MB):"
+		<< " Save: " << (bestSave * 1000.0f) << "ms (" << (entities / bestSave) << " entities/s, " << (megabytes / bestSave) << "MB/s)"
+		<< " | Load: " << (bestLoad * 1000.0f) << "ms (" << (entities / bestLoad) << " entities/s, " << (megabytes / bestLoad) << "MB/s)";
+}
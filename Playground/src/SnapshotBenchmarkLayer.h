@@ -0,0 +1,45 @@
+#pragma once
+#include <Tara.h>
+
+/// <summary>
+/// Snapshot throughput benchmark. When activated, fills itself with sprite entities (some with children) and a tilemap,
+/// then saves the layer to a binary snapshot in memory and loads it back into fresh layers, raw and compressed,
+/// and logs entities per second, MB per second, and the snapshot sizes.
+/// </summary>
+class SnapshotBenchmarkLayer : public Tara::Layer {
+public:
+	/// <summary>
+	/// Constructor
+	/// </summary>
+	/// <param name="entityCount">the number of sprite entities to save and load</param>
+	/// <param name="tilemapSize">the width and height, in tiles, of the tilemap</param>
+	/// <param name="repeats">how many times each save and load is run. The best time is kept.</param>
+	SnapshotBenchmarkLayer(uint32_t entityCount = 100000, uint32_t tilemapSize = 512, uint32_t repeats = 3);
+
+	/// <summary>
+	/// Destructor
+	/// </summary>
+	virtual ~SnapshotBenchmarkLayer();
+
+	/// <summary>
+	/// Activation function, runs the benchmark
+	/// </summary>
+	virtual void Activate() override;
+
+	/// <summary>
+	/// Deactivation function
+	/// </summary>
+	virtual void Deactivate() override;
+
+private:
+	/// <summary>
+	/// Time saving and loading the layer
+	/// </summary>
+	/// <param name="compress">true to compress the snapshot</param>
+	void RunBenchmark(bool compress);
+
+private:
+	uint32_t m_EntityCount;
+	uint32_t m_TilemapSize;
+	uint32_t m_Repeats;
+};
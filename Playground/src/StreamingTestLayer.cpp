@@ -0,0 +1,101 @@
+#include "StreamingTestLayer.h"
+#include <random>
+
+StreamingTestLayer::StreamingTestLayer(uint32_t entityCount, float budget)
+	: m_EntityCount(entityCount), m_Budget(budget), m_LoadTime(0.0f), m_LongestFrame(0.0f), m_LoggedTenths(0)
+{}
+
+StreamingTestLayer::~StreamingTestLayer()
+{
+	Deactivate();
+}
+
+void StreamingTestLayer::Activate()
+{
+	LOG_S(INFO) << "Streaming Test Layer Activated! Streaming in " << m_EntityCount << " entities.";
+	auto scene = Tara::Application::Get()->GetScene();
+	scene->SetLoadIntegrationBudget(m_Budget);
+
+	uint32_t entityCount = m_EntityCount;
+	m_Load = scene->PushLayerAsync([entityCount](Tara::LayerBuildContext& context) -> Tara::LayerRef {
+		//everything here runs on the streaming thread
+		auto layer = std::make_shared<Tara::Layer>();
+		float extent = sqrtf((float)entityCount) * 2.0f;
+		auto camera = Tara::CreateEntity<Tara::CameraEntity>(Tara::EntityNoRef(), layer, Tara::Camera::ProjectionType::Ortographic, TRANSFORM_DEFAULT, "camera");
+		camera->SetOrthographicExtent(extent);
+		layer->SetLayerCamera(camera);
+
+		std::vector<Tara::SpriteEntityRef> entities;
+		entities.reserve(entityCount);
+		std::mt19937 rng(1234);
+		std::uniform_real_distribution<float> pos(-extent * 0.5f, extent * 0.5f);
+		std::uniform_real_distribution<float> color(0.0f, 1.0f);
+		for (uint32_t i = 0; i < entityCount; i++) {
+			if ((i & 1023) == 0) {
+				if (context.IsCancelled()) {
+					return nullptr;
+				}
+				context.SetProgress((float)i / (float)entityCount);
+			}
+			auto entity = Tara::CreateEntity<Tara::SpriteEntity>(
+				Tara::EntityNoRef(), layer,
+				TRANSFORM_2D(pos(rng), pos(rng), 0, 1, 1),
+				"streamedEntity"
+			);
+			entity->SetTint({ color(rng), color(rng), color(rng), 1.0f });
+			entities.push_back(entity);
+		}
+
+		//the image decodes here, the texture and sprite are made on the main thread.
+		//the sprite is handed out in slices, so each step stays short
+		auto sprite = std::make_shared<Tara::SpriteRef>();
+		context.LoadTexture("assets/UV_Checker.png", "", [sprite](Tara::Texture2DRef texture) {
+			*sprite = Tara::Sprite::Create(texture, 1, 1, "streamedSprite");
+		});
+		auto shared = std::make_shared<std::vector<Tara::SpriteEntityRef>>(std::move(entities));
+		for (size_t start = 0; start < shared->size(); start += 4096) {
+			context.Defer([sprite, shared, start]() {
+				size_t end = std::min(start + 4096, shared->size());
+				for (size_t i = start; i < end; i++) {
+					(*shared)[i]->SetSprite(*sprite);
+				}
+			});
+		}
+		context.SetProgress(1.0f);
+		return layer;
+	});
+}
+
+void StreamingTestLayer::Deactivate()
+{
+	if (m_Load) {
+		m_Load->Cancel();
+	}
+	LOG_S(INFO) << "Streaming Test Layer Deactivated!";
+}
+
+void StreamingTestLayer::Update(float deltaTime)
+{
+	Tara::Layer::Update(deltaTime);
+	if (!m_Load) {
+		return;
+	}
+
+	m_LoadTime += deltaTime;
+	m_LongestFrame = std::max(m_LongestFrame, deltaTime);
+	uint32_t tenths = (uint32_t)(m_Load->GetProgress() * 10.0f);
+	if (tenths > m_LoggedTenths) {
+		m_LoggedTenths = tenths;
+		LOG_S(INFO) << "StreamingTest: " << tenths * 10 << "% (build " << (uint32_t)(m_Load->GetBuildProgress() * 100.0f)
+			<< "%, integration " << (uint32_t)(m_Load->GetIntegrationProgress() * 100.0f) << "%)";
+	}
+	if (m_Load->IsFinished()) {
+		if (m_Load->IsDone()) {
+			LOG_S(INFO) << "StreamingTest: loaded " << m_EntityCount << " entities in " << m_LoadTime << "s, longest frame while loading: " << m_LongestFrame * 1000.0f << "ms";
+		}
+		else {
+			LOG_S(ERROR) << "StreamingTest: load did not finish: " << m_Load->GetError();
+		}
+		m_Load.reset();
+	}
+}
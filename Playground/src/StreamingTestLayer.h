@@ -0,0 +1,46 @@
+#pragma once
+#include <Tara.h>
+
+/// <summary>
+/// Layer streaming test. Acts as a loading screen: when activated, it queues a layer of sprite entities to build on the
+/// streaming thread, then logs the load's progress as it goes, and once the layer is pushed, the load time and the longest frame
+/// seen while loading (which should stay near a normal frame, as nothing big runs on the main thread).
+/// </summary>
+class StreamingTestLayer : public Tara::Layer {
+public:
+	/// <summary>
+	/// Constructor
+	/// </summary>
+	/// <param name="entityCount">the number of sprite entities in the streamed layer</param>
+	/// <param name="budget">the main thread time, in milliseconds, the scene may spend integrating the layer each frame</param>
+	StreamingTestLayer(uint32_t entityCount = 100000, float budget = LAYER_LOAD_DEFAULT_BUDGET);
+
+	/// <summary>
+	/// Destructor
+	/// </summary>
+	virtual ~StreamingTestLayer();
+
+	/// <summary>
+	/// Activation function, starts the load
+	/// </summary>
+	virtual void Activate() override;
+
+	/// <summary>
+	/// Deactivation function, cancels the load if it is still running
+	/// </summary>
+	virtual void Deactivate() override;
+
+	/// <summary>
+	/// Update function. Logs the progress of the load
+	/// </summary>
+	/// <param name="deltaTime"></param>
+	virtual void Update(float deltaTime) override;
+
+private:
+	uint32_t m_EntityCount;
+	float m_Budget;
+	Tara::LayerLoadRef m_Load;
+	float m_LoadTime;
+	float m_LongestFrame;
+	uint32_t m_LoggedTenths;
+};
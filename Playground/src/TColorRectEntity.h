@@ -6,6 +6,7 @@
 class TColorRectEntity : public Tara::Entity {
 
 public:
+	TYPE_REGISTRY_BASE(TColorRectEntity, Tara::Entity);
 	TColorRectEntity(Tara::EntityNoRef parent, Tara::LayerNoRef owningLayer, Tara::Transform transform = TRANSFORM_DEFAULT, std::string name = "TColorRectEntity");
 
 public:
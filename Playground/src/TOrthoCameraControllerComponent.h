@@ -7,6 +7,7 @@ using TOrthoCameraControllerComponentRef = std::shared_ptr<TOrthoCameraControlle
 
 class TOrthoCameraControllerComponent : public Tara::Component {
 public:
+	TYPE_REGISTRY_BASE(TOrthoCameraControllerComponent, Tara::Component);
 	
 	TOrthoCameraControllerComponent(Tara::EntityNoRef parent, const std::string& name);
 
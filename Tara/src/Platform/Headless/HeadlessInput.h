@@ -0,0 +1,21 @@
+#pragma once
+#include "Tara/Input/Input.h"
+
+namespace Tara {
+
+	/// <summary>
+	/// Input for headless runs. There is no keyboard or mouse, so nothing is ever pressed and the mouse never moves.
+	/// </summary>
+	class HeadlessInput : public Input {
+	public:
+		HeadlessInput() : Input() {}
+
+		virtual bool IsKeyPressed(int32_t key) const override { return false; }
+		virtual bool IsMouseDown(int32_t button) const override { return false; }
+		virtual glm::vec2 GetMousePos() const override { return { 0.0f, 0.0f }; }
+
+	private:
+		void Initialize(WindowRef ref) override {}
+	};
+
+}
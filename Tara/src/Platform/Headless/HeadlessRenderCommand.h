@@ -0,0 +1,23 @@
+#pragma once
+#include "Tara/Renderer/RenderCommand.h"
+
+namespace Tara {
+
+	/// <summary>
+	/// RenderCommand for RenderBackend::None. There is nothing to draw to, so every command does nothing.
+	/// </summary>
+	class HeadlessRenderCommand : public RenderCommand {
+	public:
+		HeadlessRenderCommand() {}
+	protected:
+		virtual void ISetClearColor(float r, float g, float b) override {}
+		virtual void ISetDrawType(RenderDrawType drawType, bool wireframe) override {}
+
+		virtual void IClear() override {}
+		virtual void IDraw(VertexArrayRef vertexArray) override {}
+		virtual void IDrawCount(uint32_t count) override {}
+		virtual uint32_t IGetMaxTextureSlotsPerShader() override { return 16; }
+		virtual void IEnableDepthTesting(bool enable) override {}
+	};
+
+}
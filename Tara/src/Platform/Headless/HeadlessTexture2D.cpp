@@ -0,0 +1,33 @@
+#include "tarapch.h"
+#include "HeadlessTexture2D.h"
+
+#include "stb_image.h"
+
+namespace Tara {
+
+	HeadlessTexture2D::HeadlessTexture2D(const std::string& path, const std::string& name)
+		: Texture2D(name), m_Path(path), m_Width(0), m_Height(0), m_Channels(0)
+	{
+		int32_t width, height, channels;
+		//flipped the same way as the OpenGL texture, so pixel rows match
+		stbi_set_flip_vertically_on_load(1);
+		stbi_uc* imageData = stbi_load(m_Path.c_str(), &width, &height, &channels, 0);
+		DCHECK_NOTNULL_F(imageData, "Failed to load image! Path: %s", m_Path.c_str());
+		m_Width = width;
+		m_Height = height;
+		m_Channels = channels;
+		m_Pixels.assign(imageData, imageData + (size_t)width * height * channels);
+		stbi_image_free(imageData);
+		LOG_S(1) << "Image Loaded from File (headless): " << path;
+	}
+
+	HeadlessTexture2D::HeadlessTexture2D(const uint8_t* bytes, uint32_t width, uint32_t height, uint32_t bytesPerPixel, const std::string& name)
+		: Texture2D(name), m_Path(""), m_Width(width), m_Height(height), m_Channels(bytesPerPixel)
+	{
+		DCHECK_F(bytesPerPixel >= 1 && bytesPerPixel <= 4, "Unsupported number of channels in an image!");
+		if (bytes) {
+			m_Pixels.assign(bytes, bytes + (size_t)width * height * bytesPerPixel);
+		}
+	}
+
+}
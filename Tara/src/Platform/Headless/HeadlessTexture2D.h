@@ -0,0 +1,62 @@
+#pragma once
+#include "Tara/Renderer/Texture.h"
+
+namespace Tara {
+
+	/// <summary>
+	/// Texture2D for RenderBackend::None. The image is loaded into CPU memory only, so sizes (and pixels, for
+	/// anything that wants to read them) are available to sprites, tilesets, and fonts without a GPU.
+	/// </summary>
+	class HeadlessTexture2D : public Texture2D {
+	public:
+		HeadlessTexture2D(const std::string& path, const std::string& name);
+		HeadlessTexture2D(const uint8_t* bytes, uint32_t width, uint32_t height, uint32_t bytesPerPixel, const std::string& name);
+		virtual inline uint32_t GetWidth()const override { return m_Width; }
+		virtual inline uint32_t GetHeight()const override { return m_Height; }
+		virtual void Bind(int slot)const override {}
+		virtual void SetFiltering(Filtering filter) override {}
+		virtual void SetWrap(Wrapping wrap) override {}
+		virtual void SetBorderColor(const glm::vec4& color) override {}
+
+		/// <summary>
+		/// Get the pixels, row by row from the bottom, as loaded
+		/// </summary>
+		/// <returns>the pixel bytes</returns>
+		inline const std::vector<uint8_t>& GetPixels() const { return m_Pixels; }
+
+		/// <summary>
+		/// Get the number of channels (bytes per pixel)
+		/// </summary>
+		/// <returns>the channel count</returns>
+		inline uint32_t GetChannels() const { return m_Channels; }
+
+	private:
+		std::string m_Path;
+		uint32_t m_Width, m_Height;
+		uint32_t m_Channels;
+		std::vector<uint8_t> m_Pixels;
+	};
+
+
+	/// <summary>
+	/// RenderTarget for RenderBackend::None. Keeps its size, and nothing else.
+	/// </summary>
+	class HeadlessRenderTarget : public RenderTarget {
+	public:
+		HeadlessRenderTarget(uint32_t width, uint32_t height, const std::string& name)
+			: RenderTarget(name), m_Width(width), m_Height(height)
+		{}
+		virtual inline uint32_t GetWidth()const override { return m_Width; }
+		virtual inline uint32_t GetHeight()const override { return m_Height; }
+		virtual void Bind(int slot)const override {}
+		virtual void SetFiltering(Filtering filter) override {}
+		virtual void SetWrap(Wrapping wrap) override {}
+		virtual void SetBorderColor(const glm::vec4& color) override {}
+		virtual void RenderTo(bool render) const override {}
+		virtual void SetSize(uint32_t width, uint32_t height) override { m_Width = width; m_Height = height; }
+
+	private:
+		uint32_t m_Width, m_Height;
+	};
+
+}
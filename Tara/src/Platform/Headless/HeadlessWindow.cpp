@@ -0,0 +1,52 @@
+#include "tarapch.h"
+#include "HeadlessWindow.h"
+#include "Tara/Input/ApplicationEvents.h"
+#include <thread>
+
+namespace Tara {
+
+	HeadlessWindow::HeadlessWindow(uint32_t width, uint32_t height, float tickRate, bool throttle)
+		: m_Width(width), m_Height(height), m_VSync(false), m_EventCallback(),
+		m_TickLength(1.0 / (double)tickRate), m_Throttle(throttle), m_FrameCount(0), m_FrameLimit(0),
+		m_StartTime(std::chrono::steady_clock::now())
+	{
+		CHECK_F(tickRate > 0.0f, "HeadlessWindow: tick rate must be positive");
+		LOG_S(INFO) << "Headless window created, running at " << tickRate << " ticks per second" << (throttle ? "" : ", unthrottled");
+	}
+
+	HeadlessWindow::~HeadlessWindow()
+	{
+		LOG_S(INFO) << "Headless window closed after " << m_FrameCount << " frames";
+	}
+
+	void HeadlessWindow::OnUpdate()
+	{
+		if (m_FrameLimit > 0 && m_FrameCount >= m_FrameLimit) {
+			Close();
+		}
+	}
+
+	void HeadlessWindow::SwapBuffers()
+	{
+		m_FrameCount++;
+		if (m_Throttle) {
+			//wait for real time to catch up with synthetic time. If behind, don't wait at all
+			auto target = m_StartTime + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(m_FrameCount * m_TickLength));
+			std::this_thread::sleep_until(target);
+		}
+	}
+
+	float HeadlessWindow::GetLastFrameTime() const
+	{
+		return (float)(m_FrameCount * m_TickLength);
+	}
+
+	void HeadlessWindow::Close()
+	{
+		if (m_EventCallback) {
+			WindowCloseEvent e;
+			m_EventCallback(e);
+		}
+	}
+
+}
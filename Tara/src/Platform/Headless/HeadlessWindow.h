@@ -0,0 +1,63 @@
+#pragma once
+#include "Tara/Core/Window.h"
+#include <chrono>
+
+namespace Tara {
+
+	/// <summary>
+	/// A window that doesn't exist, for running without a display or GPU.
+	/// Time is synthetic: every frame (every SwapBuffers) advances the clock by exactly one tick,
+	/// so runs are reproducible regardless of how long frames really take.
+	/// </summary>
+	class HeadlessWindow : public Window {
+	public:
+		/// <summary>
+		/// Construct a headless window
+		/// </summary>
+		/// <param name="width">the width to report</param>
+		/// <param name="height">the height to report</param>
+		/// <param name="tickRate">frames per second of synthetic time</param>
+		/// <param name="throttle">if true, sleep so frames also pass at tickRate in real time. If false, run as fast as possible.</param>
+		HeadlessWindow(uint32_t width, uint32_t height, float tickRate, bool throttle);
+		virtual ~HeadlessWindow() override;
+
+		virtual uint32_t GetWidth() override { return m_Width; }
+		virtual uint32_t GetHeight() override { return m_Height; }
+		virtual void OnUpdate() override;
+		virtual void SetNativeEventCallback(const EventCallbackFn& callback) override { m_EventCallback = callback; }
+		virtual void SetVSync(bool enabled) override { m_VSync = enabled; }
+		virtual bool GetVSync() override { return m_VSync; }
+		virtual void* GetNativeWindow() const override { return nullptr; }
+		virtual void SwapBuffers() override;
+		virtual float GetLastFrameTime() const override;
+		virtual float GetFixedFrameDelta() const override { return (float)m_TickLength; }
+
+		/// <summary>
+		/// Close the window, as if the user had. The application stops at the end of the frame.
+		/// </summary>
+		void Close();
+
+		/// <summary>
+		/// Close the window automatically after a number of frames. Useful for soak tests.
+		/// </summary>
+		/// <param name="frames">the number of frames to run, 0 for no limit</param>
+		inline void SetFrameLimit(uint64_t frames) { m_FrameLimit = frames; }
+
+		/// <summary>
+		/// Get the number of frames run so far
+		/// </summary>
+		/// <returns>the frame count</returns>
+		inline uint64_t GetFrameCount() const { return m_FrameCount; }
+
+	private:
+		uint32_t m_Width, m_Height;
+		bool m_VSync;
+		EventCallbackFn m_EventCallback;
+		double m_TickLength;
+		bool m_Throttle;
+		uint64_t m_FrameCount;
+		uint64_t m_FrameLimit;
+		std::chrono::steady_clock::time_point m_StartTime;
+	};
+
+}
@@ -1,6 +1,8 @@
 #include "tarapch.h"
 #include "MultiPlatformInput.h"
 #include "GLFW/glfw3.h"
+#include "Tara/Core/Application.h"
+#include "Platform/Headless/HeadlessInput.h"
 
 namespace Tara {
     MultiPlatformInput::MultiPlatformInput()
@@ -36,6 +38,9 @@ namespace Tara {
 
     std::unique_ptr<Input> Tara::Input::Create()
     {
+        if (Application::Get()->IsHeadless()) {
+            return std::make_unique<HeadlessInput>();
+        }
         return std::make_unique<MultiPlatformInput>();
     }
 }
@@ -9,6 +9,7 @@
 #include "Tara/Input/Input.h"
 #include "Tara/Input/ApplicationEvents.h"
 #include "Tara/Input/EventListener.h"
+#include "Tara/Input/ListenerRegistry.h"
 
 //renderer
 #include "Tara/Renderer/Renderer.h"
@@ -18,14 +19,23 @@
 #include "Tara/Renderer/RenderCommand.h"
 #include "Tara/Renderer/Texture.h"
 #include "Tara/Renderer/Camera.h"
+#include "Tara/Renderer/DrawList.h"
 
 //Core
 #include "Tara/Core/Scene.h"
+#include "Tara/Core/LayerStreamer.h"
 #include "Tara/Core/Layer.h"
+#include "Tara/Core/SpatialHashGrid.h"
+#include "Tara/Core/JobSystem.h"
+#include "Tara/Core/ObjectPool.h"
+#include "Tara/Core/TypeRegistry.h"
+#include "Tara/Core/Name.h"
+#include "Tara/Core/Handle.h"
 #include "Tara/Core/Window.h"
 #include "Tara/Core/Application.h"
 #include "Tara/Core/Entity.h"
 #include "Tara/Core/Script.h"
+#include "Tara/Core/Snapshot.h"
 
 //Assets
 #include "Tara/Asset/AssetLibrary.h"
@@ -33,6 +43,7 @@
 #include "Tara/Asset/Font.h"
 #include "Tara/Asset/Tileset.h"
 #include "Tara/Asset/Patch.h"
+#include "Tara/Asset/Prefab.h"
 
 //math
 #include "Tara/Math/Types.h"
@@ -63,6 +74,7 @@
 
 //Utilities
 #include "Tara/Utility/After.h"
+#include "Tara/Utility/TimerScheduler.h"
 #include "Tara/Utility/Timer.h"
 #include "Tara/Utility/Profiler.h"
 
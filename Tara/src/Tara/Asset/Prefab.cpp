@@ -0,0 +1,113 @@
+#include "tarapch.h"
+#include "Prefab.h"
+#include "Tara/Asset/AssetLibrary.h"
+#include "Tara/Core/Layer.h"
+#include "Tara/Core/Snapshot.h"
+
+namespace Tara {
+
+	/// <summary>
+	/// Reads a prefab's data in place, so each copy doesn't duplicate it into a stringstream first
+	/// </summary>
+	class PrefabStreamBuffer : public std::streambuf {
+	public:
+		PrefabStreamBuffer(const std::string& data) {
+			char* begin = const_cast<char*>(data.data());
+			setg(begin, begin, begin + data.size());
+		}
+	};
+
+	Prefab::Prefab(std::string&& data, uint32_t entityCount, const std::string& name)
+		: Asset(name), m_Data(std::move(data)), m_EntityCount(entityCount)
+	{}
+
+	PrefabRef Prefab::Create(const EntityRef& root, const std::string& name)
+	{
+		auto ref = AssetLibrary::Get()->GetAssetIf<Prefab>(name);
+		if (ref == nullptr) {
+			if (!root || !root->m_Exists) {
+				LOG_S(ERROR) << "Prefab: can't capture an entity that doesn't exist, for prefab \"" << name << "\"";
+				return nullptr;
+			}
+			//a snapshot would quietly save these as a base type, or leave them out, so the copies would not match
+			std::string unregistered = SnapshotRegistry::Get()->FindUnregisteredType(*root);
+			if (!unregistered.empty()) {
+				LOG_S(ERROR) << "Prefab: can't capture prefab \"" << name << "\", " << unregistered << ". Register it with the SnapshotRegistry first.";
+				return nullptr;
+			}
+			//raw, not compressed, as it is read back once per copy
+			std::ostringstream out(std::ios::binary);
+			if (!SnapshotRegistry::Get()->SaveEntityTree(*root, out, false)) {
+				return nullptr;
+			}
+			//the entities that were captured: the root, and the children that still exist
+			std::function<uint32_t(const Entity&)> count = [&count](const Entity& entity) {
+				uint32_t total = 1;
+				for (auto& child : entity.m_Children) {
+					total += (child && child->m_Exists) ? count(*child) : 0;
+				}
+				return total;
+			};
+			ref = std::make_shared<Prefab>(out.str(), count(*root), name);
+			AssetLibrary::Get()->RegisterAsset(ref);
+		}
+		return ref;
+	}
+
+	EntityRef Prefab::Instantiate(EntityNoRef parent, LayerNoRef layer, const Transform& transform)
+	{
+		auto lLayer = layer.lock();
+		if (!lLayer) {
+			LOG_S(ERROR) << "Prefab: can't instantiate \"" << GetAssetName() << "\" without a layer";
+			return nullptr;
+		}
+		Entity::BeginCreationBatch();
+		EntityRef copy = InstantiateOne(parent, *lLayer, transform);
+		Entity::EndCreationBatch();
+		return copy;
+	}
+
+	std::vector<EntityRef> Prefab::Instantiate(EntityNoRef parent, LayerNoRef layer, const std::vector<Transform>& transforms)
+	{
+		std::vector<EntityRef> copies;
+		auto lLayer = layer.lock();
+		if (!lLayer) {
+			LOG_S(ERROR) << "Prefab: can't instantiate \"" << GetAssetName() << "\" without a layer";
+			return copies;
+		}
+		copies.reserve(transforms.size());
+
+		//size the storage the copies go into, once
+		auto lParent = parent.lock();
+		if (!lLayer->IsDeferringStructuralChanges()) {
+			if (lParent) {
+				lParent->m_Children.reserve(lParent->m_Children.size() + transforms.size());
+			}
+			else {
+				lLayer->m_Entities.reserve(lLayer->m_Entities.size() + transforms.size());
+			}
+		}
+
+		Entity::BeginCreationBatch();
+		for (auto& transform : transforms) {
+			EntityRef copy = InstantiateOne(parent, *lLayer, transform);
+			if (copy) {
+				copies.push_back(copy);
+			}
+		}
+		Entity::EndCreationBatch();
+		return copies;
+	}
+
+	EntityRef Prefab::InstantiateOne(const EntityNoRef& parent, Layer& layer, const Transform& transform)
+	{
+		PrefabStreamBuffer buffer(m_Data);
+		std::istream stream(&buffer);
+		EntityRef copy = SnapshotRegistry::Get()->LoadEntityTree(parent, layer, stream, &transform);
+		if (!copy) {
+			LOG_S(ERROR) << "Prefab: failed to instantiate \"" << GetAssetName() << "\"";
+		}
+		return copy;
+	}
+
+}
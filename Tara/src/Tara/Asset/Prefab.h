@@ -0,0 +1,77 @@
+#pragma once
+#include "Tara/Asset/Asset.h"
+#include "Tara/Core/Entity.h"
+
+namespace Tara {
+	REFTYPE(Prefab)
+
+	/// <summary>
+	/// An immutable template of an entity, with its components and children, for spawning copies of it quickly.
+	/// The entity is captured once through the SnapshotRegistry, so any type that can be saved in a snapshot can be in a prefab.
+	/// Copies are made in a creation batch: children are attached without AddChild's checks, and the hierarchy events
+	/// (ParentSwapedEvent and ChildAddedEvent) are sent once every copy exists, rather than while each is built.
+	/// Script components run their file from Script's compiled file cache, so it is only parsed once.
+	/// </summary>
+	class Prefab : public Asset {
+	public:
+		/// <summary>
+		/// Construct a new Prefab. Should not be called manually
+		/// </summary>
+		/// <param name="data">the captured entity, as a snapshot</param>
+		/// <param name="entityCount">the number of entities in the captured entity</param>
+		/// <param name="name">the asset name</param>
+		Prefab(std::string&& data, uint32_t entityCount, const std::string& name);
+
+		/// <summary>
+		/// Create a new Prefab from an entity. Later changes to the entity do not change the prefab.
+		/// Every entity and component type in the tree must be registered with the SnapshotRegistry, or the prefab is not created.
+		/// </summary>
+		/// <param name="root">the entity to capture, with its components and children</param>
+		/// <param name="name">the asset name</param>
+		/// <returns>the prefab, or null if the entity could not be captured</returns>
+		static PrefabRef Create(const EntityRef& root, const std::string& name);
+
+		virtual ~Prefab() {}
+
+		/// <summary>
+		/// Make a copy of the captured entity
+		/// </summary>
+		/// <param name="parent">the parent of the copy. May be null, to make it a root of the layer</param>
+		/// <param name="layer">the layer to make it in</param>
+		/// <param name="transform">the relative transform of the copy</param>
+		/// <returns>the copy, or null if failed</returns>
+		EntityRef Instantiate(EntityNoRef parent, LayerNoRef layer, const Transform& transform);
+
+		/// <summary>
+		/// Make many copies of the captured entity at once, one for each transform. The child or root storage they go into
+		/// is sized for all of them up front, and the hierarchy events are sent once all of them exist.
+		/// </summary>
+		/// <param name="parent">the parent of the copies. May be null, to make them roots of the layer</param>
+		/// <param name="layer">the layer to make them in</param>
+		/// <param name="transforms">the relative transform of each copy</param>
+		/// <returns>the copies, in the order of the transforms. Copies that failed are left out</returns>
+		std::vector<EntityRef> Instantiate(EntityNoRef parent, LayerNoRef layer, const std::vector<Transform>& transforms);
+
+		/// <summary>
+		/// Get the number of entities in one copy
+		/// </summary>
+		/// <returns>the entity count</returns>
+		inline uint32_t GetEntityCount() const { return m_EntityCount; }
+
+		/// <summary>
+		/// Get the size of the captured entity
+		/// </summary>
+		/// <returns>the size, in bytes</returns>
+		inline size_t GetDataSize() const { return m_Data.size(); }
+
+	private:
+		/// <summary>
+		/// Make one copy. The caller has checked the layer, and holds the creation batch
+		/// </summary>
+		EntityRef InstantiateOne(const EntityNoRef& parent, Layer& layer, const Transform& transform);
+
+	private:
+		const std::string m_Data;
+		const uint32_t m_EntityCount;
+	};
+}
@@ -9,6 +9,8 @@ namespace Tara{
 		: Component(parent, name), m_IsDownOverMe(false), m_IsHovering(false), m_IsDragging(false),
 		m_DragStartDist(5), m_DragOriginCache(0,0), m_Camera(CameraEntityNoRef())
 	{
+		//only button presses and releases are handled, so mouse moves and everything else skip this component
+		SetEventCategories(EventCategoryMouseButton);
 	}
 
 	CameraEntityNoRef ClickableComponent::GetCamera() const
@@ -18,9 +20,9 @@ namespace Tara{
 			return camEntity;
 		}
 		else {
-			auto parent = GetParent().lock();
-			if (parent) {
-				camEntity = parent->GetOwningLayer().lock()->GetLayerCamera().lock();
+			Entity* parent = GetParentPtr();
+			if (parent && parent->GetOwningLayerPtr()) {
+				camEntity = parent->GetOwningLayerPtr()->GetLayerCamera().lock();
 				if (camEntity) {
 					return camEntity;
 				}
@@ -43,12 +45,12 @@ namespace Tara{
 			if (IsInOwner(worldPos)) {
 				m_IsHovering = true;
 				HoverEvent e(screenPos.x, screenPos.y, true);
-				GetParent().lock()->ReceiveEvent(e);
+				GetParentPtr()->ReceiveEvent(e);
 			}
 			else {
 				if (m_IsHovering) {
 					HoverEvent e(screenPos.x, screenPos.y, false);
-					GetParent().lock()->ReceiveEvent(e);
+					GetParentPtr()->ReceiveEvent(e);
 					m_IsHovering = false;
 				}
 			}
@@ -63,16 +65,16 @@ namespace Tara{
 					//LOG_S(INFO) << "Dragging started!";
 					//send start event
 					DragEvent e(m_DragOriginCache.x, m_DragOriginCache.y, DragEvent::DragType::BEGIN);
-					GetParent().lock()->ReceiveEvent(e);
+					GetParentPtr()->ReceiveEvent(e);
 					//send update event
 					DragEvent c(screenPos.x, screenPos.y, DragEvent::DragType::CONTINUE);
-					GetParent().lock()->ReceiveEvent(c);
+					GetParentPtr()->ReceiveEvent(c);
 				}
 				
 				if (!IsInOwner(worldPos)) {
 					//unclick nicely
 					ClickEvent e(screenPos.x, screenPos.y, 0, false, true);
-					GetParent().lock()->ReceiveEvent(e);
+					GetParentPtr()->ReceiveEvent(e);
 					m_IsDownOverMe = false;
 				}
 			}
@@ -80,7 +82,7 @@ namespace Tara{
 				//send a drag contiue event
 				//LOG_S(INFO) << "Dragging Continued";
 				DragEvent e(screenPos.x, screenPos.y, DragEvent::DragType::CONTINUE);
-				GetParent().lock()->ReceiveEvent(e);
+				GetParentPtr()->ReceiveEvent(e);
 			}
 
 			
@@ -104,7 +106,7 @@ namespace Tara{
 			m_IsDownOverMe = true;
 			m_DragOriginCache = screenPos;
 			ClickEvent event(screenPos.x, screenPos.y, e.GetButton(), false, false);
-			GetParent().lock()->ReceiveEvent(event);
+			GetParentPtr()->ReceiveEvent(event);
 			return event.Handled();
 		}
 		return false;
@@ -117,7 +119,7 @@ namespace Tara{
 		bool rval = false;
 		if (m_IsDownOverMe) {
 			ClickEvent event(screenPos.x, screenPos.y, e.GetButton(), true, false);
-			GetParent().lock()->ReceiveEvent(event);
+			GetParentPtr()->ReceiveEvent(event);
 			m_IsDownOverMe = false;
 			rval = rval | event.Handled();
 		}
@@ -126,7 +128,7 @@ namespace Tara{
 			m_IsDragging = false;
 			//send drag end event
 			DragEvent event(screenPos.x, screenPos.y, DragEvent::DragType::END);
-			GetParent().lock()->ReceiveEvent(event);
+			GetParentPtr()->ReceiveEvent(event);
 			rval = rval | event.Handled();
 		}
 		return rval;
@@ -142,9 +144,9 @@ namespace Tara{
 			cam = camEntity->GetCamera();
 		}
 		else {
-			auto parent = GetParent().lock();
-			if (parent) {
-				camEntity = parent->GetOwningLayer().lock()->GetLayerCamera().lock();
+			Entity* parent = GetParentPtr();
+			if (parent && parent->GetOwningLayerPtr()) {
+				camEntity = parent->GetOwningLayerPtr()->GetLayerCamera().lock();
 				if (camEntity) {
 					cam = camEntity->GetCamera();
 				}
@@ -161,7 +163,7 @@ namespace Tara{
 
 	bool ClickableComponent::IsInOwner(Vector pos)
 	{
-		auto bb = GetParent().lock()->GetSpecificBoundingBox();
+		auto bb = GetParentPtr()->GetSpecificBoundingBox();
 		return (
 			pos.x >= bb.x && pos.x < bb.x + bb.Width&&
 			pos.y >= bb.y && pos.y < bb.y + bb.Height
@@ -13,6 +13,7 @@ namespace Tara {
 	/// </summary>
 	class ClickableComponent : public Component {
 	public:
+		TYPE_REGISTRY_BASE(ClickableComponent, Component);
 		ClickableComponent(EntityNoRef parent, const std::string& name = "ClickableComponent");
 
 		virtual ~ClickableComponent() {}
@@ -15,6 +15,7 @@ namespace Tara {
 
 	class LambdaComponent : public Component {
 	public:
+		TYPE_REGISTRY_BASE(LambdaComponent, Component);
 		LambdaComponent(EntityNoRef parent,
 			std::function<void(LambdaComponent*)> beginPlayCallback = LAMBDA_BEGIN_PLAY_DEFAULT,
 			std::function<void(LambdaComponent*, float)> onUpdateCallback = LAMBDA_UPDATE_DEFAULT,
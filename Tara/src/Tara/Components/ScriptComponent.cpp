@@ -31,12 +31,8 @@ namespace Tara{
 		//Script::Get()->GetState()["CurrentComponent"] = comp;
 		
 		
-		auto results = Script::Get()->GetState().safe_script_file(m_Path);
-		if (!results.valid()) {
-			sol::error err = results;
-			LOG_S(ERROR) << "Error in Lua Script: " << err.what();
-			LOG_S(ERROR) << loguru::stacktrace().c_str();
-		}
+		//compiled once per file, then reused by every component running it
+		Script::Get()->RunFile(m_Path);
 		//Script::Get()->GetState()["CurrentComponent"] = nullptr;
 	}
 
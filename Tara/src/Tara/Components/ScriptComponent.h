@@ -12,6 +12,7 @@ namespace Tara {
 	/// </summary>
 	class ScriptComponent : public Component {
 	public:
+		TYPE_REGISTRY_BASE(ScriptComponent, Component);
 		/// <summary>
 		/// Construct a new ScriptComponent. Do not use directly, use Tara::CreateComponenet<Tara::ScriptComponent>(...) instead
 		/// </summary>
@@ -53,6 +54,12 @@ namespace Tara {
 		/// </summary>
 		/// <param name="func">the function to call every event</param>
 		void SetOnEventCallbackFunction(sol::safe_function func);
+
+		/// <summary>
+		/// Get the path to the luafile that makes up this component
+		/// </summary>
+		/// <returns>the path</returns>
+		inline const std::string& GetPath() const { return m_Path; }
 	public:
 		/// <summary>
 		/// Register this lua type. Called by the State singleton
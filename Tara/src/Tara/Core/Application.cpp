@@ -7,6 +7,7 @@
 #include "Tara/Utility/After.h"
 #include "Tara/Utility/Profiler.h"
 #include "Tara/Core/Script.h"
+#include "Platform/Headless/HeadlessWindow.h"
 
 //TODO: Remove from this file
 //#include "glad/glad.h"
@@ -15,7 +16,8 @@
 namespace Tara {
 
 	Application::Application()
-		: m_Running(true)
+		: m_Running(true), m_Headless(false), m_LastFrameTime(0.0f), m_DeltaTime(0.0f),
+		m_FixedTimestep(false), m_FixedDeltaTime(1.0f / 60.0f), m_MaxCatchUpSteps(5), m_Accumulator(0.0f), m_InterpolationAlpha(1.0f)
 	{
 		//loguru::init();
 		//Initialize loguru. MUST happen relatively early, thus, first time application is initialized.
@@ -35,6 +37,7 @@ namespace Tara {
 
 	Application::~Application()
 	{	
+		m_Timers.CancelAll();	//first, as callbacks may hold on to the scene and scripts
 		m_Scene = SceneRef();	//manually cause these to be replaced
 		m_Window = WindowRef();	//early, so they exit first!
 		LOG_S(INFO) << "Application Shutting Down...";
@@ -59,6 +62,27 @@ namespace Tara {
 		m_Scene = std::make_shared<Scene>();
 	}
 
+	void Application::InitHeadless(uint32_t x, uint32_t y, float tickRate, bool throttle)
+	{
+		m_Headless = true;
+		//must be set before anything makes a renderer resource
+		Renderer::SetRenderBackend(RenderBackend::None);
+
+		//a window with a synthetic clock, and input that reads from nothing
+		m_Window = std::make_shared<HeadlessWindow>(x, y, tickRate, throttle);
+		m_Window->SetNativeEventCallback(TARA_BIND_FN(Application::EventCallback));
+		Input::Init(m_Window);
+
+		//RenderCommand still exists, it just does nothing
+		RenderCommand::Init();
+
+		//Init the LuaScript system
+		Script::Get()->Init();
+
+		//make a default scene
+		m_Scene = std::make_shared<Scene>();
+	}
+
 
 	void Application::Run()
 	{
@@ -67,7 +91,8 @@ namespace Tara {
 			try {
 				//get deltaTime 
 				float time = m_Window->GetLastFrameTime();
-				m_DeltaTime = time - m_LastFrameTime;
+				float fixedDelta = m_Window->GetFixedFrameDelta();
+				m_DeltaTime = (fixedDelta >= 0.0f) ? fixedDelta : time - m_LastFrameTime;
 				m_LastFrameTime = time;
 
 				PollEvents();
@@ -91,26 +116,39 @@ namespace Tara {
 		SCOPE_PROFILE("Update");
 		//update the window first, to cause all event states to update
 		m_Window->OnUpdate();
-		//then, update the scene
-		m_Scene->Update(deltaTime);
 
-		//deal with after functions
-		//AfterCallable* c = m_AfterCallableList;
-		auto c = m_AfterCallableList.begin();
-		while (c != m_AfterCallableList.end()) {
-			//LOG_S(INFO) << "Update of callback list item!";
-			(*c)->secondsRemaining -= deltaTime;
-			if ((*c)->secondsRemaining <= 0.0f) {
-				//call and remove
-				(*c)->callable.get(); //async wait for. since using deferred, this will be the first time it is called.
-				auto ptr = (*c);
-				m_AfterCallableList.erase(c++);
-				delete ptr;
-			}
-			else {
-				++c;
-			}
+		//hand over streamed layers at the frame boundary, so they update from this frame on
+		m_Scene->IntegrateLoads();
+
+		if (!m_FixedTimestep) {
+			Step(deltaTime);
+			m_InterpolationAlpha = 1.0f;
+			return;
+		}
+
+		//fixed timestep: run as many whole ticks as fit in the time that has passed, keeping the remainder for next frame
+		m_Accumulator += deltaTime;
+		uint32_t steps = 0;
+		while (m_Accumulator >= m_FixedDeltaTime && steps < m_MaxCatchUpSteps) {
+			Step(m_FixedDeltaTime);
+			m_Accumulator -= m_FixedDeltaTime;
+			steps++;
+		}
+		if (m_Accumulator >= m_FixedDeltaTime) {
+			//too far behind to catch up. Drop the whole ticks that are left over
+			LOG_S(1) << "Application: fixed timestep fell behind, dropping " << (uint32_t)(m_Accumulator / m_FixedDeltaTime) << " ticks";
+			m_Accumulator = std::fmod(m_Accumulator, m_FixedDeltaTime);
 		}
+		m_InterpolationAlpha = m_Accumulator / m_FixedDeltaTime;
+	}
+
+	void Application::Step(float deltaTime)
+	{
+		//update the scene
+		m_Scene->Update(deltaTime);
+
+		//then, run the timers that came due
+		m_Timers.Advance(deltaTime);
 	}
 
 	void Application::PollEvents()
@@ -127,9 +165,11 @@ namespace Tara {
 		//clear window
 		
 		RenderCommand::Clear();
-		//draw scene
-		m_Scene->Draw(deltaTime);
-		//swap buffers
+		//draw scene. Headless, there is nothing to draw to, so skip walking the scene at all
+		if (!m_Headless) {
+			m_Scene->Draw(deltaTime);
+		}
+		//swap buffers. Headless, this ends the frame on the synthetic clock
 		m_Window->SwapBuffers();
 	}
 
@@ -144,9 +184,20 @@ namespace Tara {
 		return false;
 	}
 
-	void Application::After(AfterCallable* c)
+	void Application::SetFixedTimestep(float tickRate, uint32_t maxCatchUpSteps)
+	{
+		CHECK_F(tickRate > 0.0f, "Application::SetFixedTimestep: tick rate must be positive");
+		m_FixedTimestep = true;
+		m_FixedDeltaTime = 1.0f / tickRate;
+		m_MaxCatchUpSteps = std::max(maxCatchUpSteps, 1u);
+		m_Accumulator = 0.0f;
+	}
+
+	void Application::DisableFixedTimestep()
 	{
-		m_AfterCallableList.push_back(c);
+		m_FixedTimestep = false;
+		m_Accumulator = 0.0f;
+		m_InterpolationAlpha = 1.0f;
 	}
 
 
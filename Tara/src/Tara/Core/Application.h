@@ -1,6 +1,7 @@
 #pragma once
 #include "Tara/Core/Window.h"
 #include "Tara/Core/Scene.h"
+#include "Tara/Utility/TimerScheduler.h"
 
 //TEMP
 #include "Tara/Renderer/Shader.h"
@@ -10,9 +11,6 @@
 namespace Tara {
 
 
-	struct AfterCallable;
-
-
 	/// <summary>
 	/// Application Class (Singleton)
 	/// </summary>
@@ -43,6 +41,24 @@ namespace Tara {
 		/// <param name="title">Window title</param>
 		void Init(uint32_t x, uint32_t y, const std::string& title);
 
+		/// <summary>
+		/// Initialize the application without a window or GPU, for servers and soak tests.
+		/// Uses a headless window with a synthetic clock, input that is never pressed, and RenderBackend::None, so
+		/// textures and fonts load CPU-side data only and nothing is drawn. Scenes, collision, scripting, and tilemaps work as normal.
+		/// Call instead of Init.
+		/// </summary>
+		/// <param name="x">width the window reports</param>
+		/// <param name="y">height the window reports</param>
+		/// <param name="tickRate">frames per second of synthetic time. Each frame advances the clock by exactly 1 / tickRate</param>
+		/// <param name="throttle">if true, frames are paced to tickRate in real time. If false, the loop runs as fast as it can</param>
+		void InitHeadless(uint32_t x = 1280, uint32_t y = 720, float tickRate = 60.0f, bool throttle = true);
+
+		/// <summary>
+		/// Check if the application was initialized headless
+		/// </summary>
+		/// <returns>true if headless</returns>
+		inline bool IsHeadless() const { return m_Headless; }
+
 		/// <summary>
 		/// Run the application main loop
 		/// </summary>
@@ -93,15 +109,65 @@ namespace Tara {
 		/// <returns>delta time, in seconds</returns>
 		inline float GetDeltaTime() const { return m_DeltaTime; }
 
-		void After(AfterCallable* c);
+		/// <summary>
+		/// Run the simulation at a fixed tick rate, decoupled from the frame rate. Each frame, the scene is updated
+		/// as many times as needed to catch up with real time, in steps of exactly 1 / tickRate seconds, and then drawn once.
+		/// Drawables blend between their transforms of the last two ticks, using the interpolation alpha.
+		/// </summary>
+		/// <param name="tickRate">the number of simulation ticks per second</param>
+		/// <param name="maxCatchUpSteps">the most ticks to run in one frame. If a frame takes longer than that, the remaining time is dropped (the simulation slows down) rather than spiraling.</param>
+		void SetFixedTimestep(float tickRate, uint32_t maxCatchUpSteps = 5);
+
+		/// <summary>
+		/// Go back to updating the scene once per frame, with the frame's delta time (the default)
+		/// </summary>
+		void DisableFixedTimestep();
+
+		/// <summary>
+		/// Check if the simulation runs at a fixed tick rate
+		/// </summary>
+		/// <returns>true if it does</returns>
+		inline bool GetFixedTimestepEnabled() const { return m_FixedTimestep; }
+
+		/// <summary>
+		/// Get the length of a simulation tick, when using a fixed timestep
+		/// </summary>
+		/// <returns>the tick length, in seconds</returns>
+		inline float GetFixedDeltaTime() const { return m_FixedDeltaTime; }
+
+		/// <summary>
+		/// Get how far between the last simulation tick and the next one the current frame is.
+		/// Always 1 when not using a fixed timestep.
+		/// </summary>
+		/// <returns>the alpha, in [0, 1)</returns>
+		inline float GetInterpolationAlpha() const { return m_InterpolationAlpha; }
+
+		/// <summary>
+		/// Get the timer scheduler, which Tara::After schedules on. It advances with the simulation, once per update step.
+		/// </summary>
+		/// <returns>the timer scheduler</returns>
+		inline TimerScheduler& GetTimers() { return m_Timers; }
+
+	private:
+		/// <summary>
+		/// Advance the simulation by one step: update the scene and the timers
+		/// </summary>
+		/// <param name="deltaTime">the length of the step, in seconds</param>
+		void Step(float deltaTime);
 
 	private:
 		bool m_Running;
+		bool m_Headless;
 		WindowRef m_Window;
 		SceneRef m_Scene;
 		float m_LastFrameTime;
 		float m_DeltaTime;
-		std::list<AfterCallable*> m_AfterCallableList;
+		TimerScheduler m_Timers;
+		bool m_FixedTimestep;
+		float m_FixedDeltaTime;
+		uint32_t m_MaxCatchUpSteps;
+		float m_Accumulator;
+		float m_InterpolationAlpha;
 	};
 
 }
\ No newline at end of file
@@ -6,15 +6,41 @@
 
 namespace Tara{
 	Component::Component(EntityNoRef parent, const std::string& name)
-		: m_Name(name), m_Parent(parent)
-	{}
+		: m_Name(name), m_TypeId(TypeRegistry<Component>::Get<Component>()) //replaced by the real type in Register
+	{
+		SetParent(parent);
+	}
+
+	Component::~Component()
+	{
+		if (m_Slots) {
+			m_Slots->Components.Remove(m_Handle);
+		}
+	}
 
-	void Component::Register(ComponentRef component){
+	void Component::Register(ComponentRef component, TypeId type){
+		component->m_TypeId = type;
 		component->GetParent().lock()->AddComponent(component);
 	}
 
 	void Component::ListenForEvents(bool enable){
-		m_Parent.lock()->GetOwningLayer().lock()->EnableListener(weak_from_this(), enable);
+		GetParentPtr()->GetOwningLayerPtr()->EnableListener(weak_from_this(), enable);
+	}
+
+	void Component::SetParent(std::weak_ptr<Entity> newParent)
+	{
+		m_Parent = newParent;
+		auto parent = newParent.lock();
+		LayerSlotsRef slots = parent ? parent->m_Slots : nullptr;
+		if (slots != m_Slots) {
+			//moving to another layer's tables, or out of them, so the slot moves too
+			if (m_Slots) {
+				m_Slots->Components.Remove(m_Handle);
+			}
+			m_Slots = slots;
+			m_Handle = m_Slots ? m_Slots->Components.Add(this) : ComponentHandle();
+		}
+		m_ParentHandle = parent ? parent->m_Handle : EntityHandle();
 	}
 
 	void Component::RegisterLuaType(sol::state& lua)
@@ -24,6 +50,18 @@ namespace Tara{
 		CONNECT_METHOD(Component, GetName);
 		CONNECT_METHOD(Component, GetListeningForEvents);
 		CONNECT_METHOD_OVERRIDE(Component, GetParent);
+		CONNECT_METHOD(Component, SetTickEnabled);
+		CONNECT_METHOD(Component, GetTickEnabled);
+		CONNECT_METHOD(Component, SetTickInterval);
+		CONNECT_METHOD(Component, GetTickInterval);
+		CONNECT_METHOD(Component, SetTickGroup);
+		CONNECT_METHOD(Component, GetTickGroup);
+	}
+
+	void Component::SetTickGroup(uint32_t group)
+	{
+		CHECK_F(group < TICK_GROUP_COUNT, "Component::SetTickGroup: group %u is out of range", group);
+		m_Tick.Group = group;
 	}
 
 }
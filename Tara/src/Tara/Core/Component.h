@@ -1,6 +1,11 @@
 #pragma once
 #include "tarapch.h"
 #include "Tara/Input/EventListener.h"
+#include "Tara/Core/ObjectPool.h"
+#include "Tara/Core/TypeRegistry.h"
+#include "Tara/Core/Name.h"
+#include "Tara/Core/TickControl.h"
+#include "Tara/Core/Handle.h"
 #include <sol/sol.hpp>
 
 namespace Tara {
@@ -25,6 +30,7 @@ namespace Tara {
 		friend class Entity;
 
 	public:
+		TYPE_REGISTRY_BASE(Component, Component);
 		/// <summary>
 		/// Create a new component. Should not be called directly. Use static Create(...) instead.
 		/// </summary>
@@ -34,15 +40,16 @@ namespace Tara {
 		Component(EntityNoRef parent, const std::string& name = "Component");
 
 		/// <summary>
-		/// Virtual destructor
+		/// Virtual destructor. Frees the component's slot
 		/// </summary>
-		virtual ~Component() {}
+		virtual ~Component();
 
 		/// <summary>
 		/// Register a new component (does the actual attaching)
 		/// </summary>
 		/// <param name="component"></param>
-		static void Register(ComponentRef component);
+		/// <param name="type">the exact type of the component, from TypeRegistry&lt;Component&gt;</param>
+		static void Register(ComponentRef component, TypeId type);
 
 		/// <summary>
 		/// Enable/Disable Listening for native window events
@@ -74,7 +81,13 @@ namespace Tara {
 		/// Get the name of the Entity
 		/// </summary>
 		/// <returns>the name</returns>
-		inline const std::string& GetName() const { return m_Name; }
+		inline const std::string& GetName() const { return m_Name.GetString(); }
+
+		/// <summary>
+		/// Get the interned name of the Component
+		/// </summary>
+		/// <returns>the name</returns>
+		inline const Name& GetInternedName() const { return m_Name; }
 
 		/// <summary>
 		/// Get the parent of the Componment
@@ -82,12 +95,74 @@ namespace Tara {
 		/// <returns>the parent</returns>
 		inline const EntityNoRef& GetParent() const { return m_Parent; }
 
+		/// <summary>
+		/// Get the parent of the Component through its handle, without locking a weak_ptr.
+		/// Only valid while the parent exists, so it should not be stored. Store GetParent() instead.
+		/// </summary>
+		/// <returns>the parent, or null if there is none or it was destroyed</returns>
+		inline Entity* GetParentPtr() const { return m_Slots ? m_Slots->Entities.Resolve(m_ParentHandle) : nullptr; }
+
+		/// <summary>
+		/// Get the handle of this component, for storing a reference to it that can be resolved with its parent's Layer::Resolve.
+		/// </summary>
+		/// <returns>the handle, null if the component has no parent. It stops resolving once the component is removed from its parent</returns>
+		inline ComponentHandle GetHandle() const { return m_Handle; }
+
 		/// <summary>
 		/// Script version of GetParent. DO NOT CALL FROM C++
 		/// </summary>
 		/// <returns></returns>
 		inline const EntityRef __SCRIPT__GetParent() const { return GetParent().lock(); }
 
+		/// <summary>
+		/// Get the exact type of this component, as assigned by TypeRegistry&lt;Component&gt; when it was created
+		/// </summary>
+		/// <returns>the type id</returns>
+		inline TypeId GetTypeId() const { return m_TypeId; }
+
+		/// <summary>
+		/// Check if this component is of a specific subclass of Component, without an RTTI cast
+		/// </summary>
+		/// <typeparam name="ComponentType">the subclass of component</typeparam>
+		/// <returns>true if it is</returns>
+		template<typename ComponentType> inline bool IsOfType() const { return TypeRegistry<Component>::IsA(m_TypeId, TypeRegistry<Component>::Get<ComponentType>()); }
+
+		/// <summary>
+		/// Enable or disable ticking. A disabled component's OnUpdate is not called, and it doesn't build up time.
+		/// </summary>
+		/// <param name="enabled">true to tick</param>
+		inline void SetTickEnabled(bool enabled) { m_Tick.Enabled = enabled; }
+
+		/// <summary>
+		/// Get if ticking is enabled
+		/// </summary>
+		/// <returns>true if enabled</returns>
+		inline bool GetTickEnabled() const { return m_Tick.Enabled; }
+
+		/// <summary>
+		/// Set the time between ticks. OnUpdate is called at most this often (and only when the parent ticks), with the time since the last tick.
+		/// </summary>
+		/// <param name="seconds">the interval, in seconds. 0 ticks every update</param>
+		inline void SetTickInterval(float seconds) { m_Tick.Interval = std::max(seconds, 0.0f); }
+
+		/// <summary>
+		/// Get the time between ticks
+		/// </summary>
+		/// <returns>the interval, in seconds</returns>
+		inline float GetTickInterval() const { return m_Tick.Interval; }
+
+		/// <summary>
+		/// Put the component in a tick group. The parent's layer can turn whole groups on and off with Layer::SetTickGroupEnabled.
+		/// </summary>
+		/// <param name="group">the group, less than TICK_GROUP_COUNT. 0 is the default group, which is always on</param>
+		void SetTickGroup(uint32_t group);
+
+		/// <summary>
+		/// Get the component's tick group
+		/// </summary>
+		/// <returns>the group</returns>
+		inline uint32_t GetTickGroup() const { return m_Tick.Group; }
+
 
 
 	public:
@@ -99,17 +174,32 @@ namespace Tara {
 
 	private:
 
-		inline void SetParent(std::weak_ptr<Entity> newParent) { m_Parent = newParent; }
+		void SetParent(std::weak_ptr<Entity> newParent);
+
+		/// <summary>
+		/// The position of a component in its parent's component vector, for the parent's TypeIndex
+		/// </summary>
+		struct IndexPosition {
+			static inline uint32_t Get(const Component& component) { return (uint32_t)component.m_ComponentIndex; }
+		};
 
 	private:
-		const std::string m_Name;
+		const Name m_Name;
 		EntityNoRef m_Parent;
+		//slot tables of the parent's layer, the slot of this component, and the slot of the parent. All null without a parent
+		LayerSlotsRef m_Slots;
+		ComponentHandle m_Handle;
+		EntityHandle m_ParentHandle;
+		//index of this component in its parent's component vector
+		size_t m_ComponentIndex = 0;
+		TypeId m_TypeId;
+		TickControl m_Tick;
 	};
 
 	/// <summary>
 	/// Create a new component
 	/// </summary>
-	/// <typeparam name="ComponentType">The subclass of component to create</typeparam>
+	/// <typeparam name="ComponentType">The subclass of component to create. Must declare its base with TYPE_REGISTRY_BASE</typeparam>
 	/// <typeparam name="...VA_ARGS">Varaible arguments</typeparam>
 	/// <param name="...args">the arguments to that class's constrcutor</param>
 	/// <returns>A reference to that Component</returns>
@@ -117,8 +207,8 @@ namespace Tara {
 	inline std::shared_ptr<ComponentType> CreateComponent(VA_ARGS&&... args) {
 		static_assert(std::is_base_of<Component, ComponentType>::value, "Error: Tara::CreateComponent:: Provided class is not a subclass of Tara::Component");
 		static_assert(std::is_constructible<ComponentType, VA_ARGS...>::value, "Error: Tara::CreateComponent:: cannot compile due to paramaters passed not matching constructor of that component type!");
-		std::shared_ptr<ComponentType> entity = std::make_shared<ComponentType>(std::forward<VA_ARGS>(args)...);
-		Component::Register(entity);
+		std::shared_ptr<ComponentType> entity = MakePooledShared<ComponentType>(std::forward<VA_ARGS>(args)...);
+		Component::Register(entity, TypeRegistry<Component>::Get<ComponentType>());
 		entity->OnBeginPlay();
 		return entity;
 	}
@@ -1,9 +1,12 @@
 #include "tarapch.h"
 #include "Entity.h"
 #include "Tara/Core/Layer.h"
+#include "Tara/Core/Application.h"
 #include "Tara/Input/ApplicationEvents.h"
 #include "Tara/Input/Manifold.h"
 #include "Tara/Core/Script.h"
+#include "Tara/Components/ScriptComponent.h"
+#include "Tara/Renderer/DrawList.h"
 
 #pragma warning( push )
 #pragma warning( disable : 4003 ) 
@@ -13,15 +16,41 @@ namespace Tara{
     Entity::Entity(EntityNoRef parent, LayerNoRef owningLayer, Transform transform, const std::string& name)
         :m_Parent(parent), 
         m_OwningLayer((parent.lock() && !owningLayer.lock()) ? parent.lock()->GetOwningLayer() : owningLayer), 
-        m_Name(name), m_Transform(transform), m_RenderFilterBits(~0)
+        m_Name(name), m_Transform(transform), m_RenderFilterBits(~0),
+        m_TypeId(TypeRegistry<Entity>::Get<Entity>()) //replaced by the real type in Register
     {
-        CHECK_NOTNULL_F(m_OwningLayer.lock(), "the owning layer of a newly created entity should never be null!");
+        auto layer = m_OwningLayer.lock();
+        CHECK_NOTNULL_F(layer, "the owning layer of a newly created entity should never be null!");
+        m_Slots = layer->m_Slots;
+        m_Handle = m_Slots->Entities.Add(this);
+        auto parentRef = parent.lock();
+        if (parentRef && parentRef->m_Slots == m_Slots) {
+            m_ParentHandle = parentRef->m_Handle;
+        }
+    }
+
+    Entity::~Entity()
+    {
+        m_Slots->Entities.Remove(m_Handle);
     }
 
-    void Entity::Register(EntityRef ref)
+    thread_local Entity::CreationBatch Entity::s_CreationBatch;
+
+    void Entity::Register(EntityRef ref, TypeId type)
     {
-        if (ref->m_Parent.lock()) {
-            ref->m_Parent.lock()->AddChild(ref); //auto cast to weak_ptr
+        ref->m_TypeId = type;
+        auto parent = ref->m_Parent.lock();
+        if (parent && s_CreationBatch.Depth > 0 && parent->m_Exists && !parent->IsDeferringStructuralChanges()) {
+            //a new entity: attach without AddChild's checks, events are sent when the batch ends
+            PushSibling(parent->m_Children, ref);
+            parent->m_ChildTypes.Add(type, ref);
+            if (parent->m_ChildNames) {
+                parent->m_ChildNames->Add(ref->m_Name, ref);
+            }
+            s_CreationBatch.Attached.emplace_back(parent, ref);
+        }
+        else if (parent) {
+            parent->AddChild(ref); //auto cast to weak_ptr
         }
         else {
             bool result = ref->m_OwningLayer.lock()->AddEntity(ref);//auto cast to weak_ptr
@@ -33,7 +62,14 @@ namespace Tara{
     {
         ENTITY_EXISTS();
         OnEvent(e);
-        for (auto comp : m_Components) {
+        const uint16_t flags = e.GetCategoryFlags();
+        //indexed, as handlers may add components
+        for (size_t i = 0; i < m_Components.size(); i++) {
+            if (!m_Components[i] || !(m_Components[i]->GetEventCategories() & flags)) {
+                //removed, or not wanted, so skip without copying the ref
+                continue;
+            }
+            auto comp = m_Components[i];
             if (!(comp->GetListeningForEvents() && (e.GetCategoryFlags() & EventCategoryNative))) { //if both the entity and the component are listening for native window events, don't forward
                 comp->ReceiveEvent(e);
             }
@@ -44,99 +80,134 @@ namespace Tara{
     Transform Entity::GetWorldTransform() const
     {
         ENTITY_EXISTS(TRANSFORM_DEFAULT);
-        if (GetParent().lock()) {
-            auto parentTransform = GetParent().lock()->GetWorldTransform();
-            return parentTransform + m_Transform;
+        if (m_WorldTransformDirty) {
+            Entity* parent = GetParentPtr();
+            Transform world = parent ? parent->GetWorldTransform() + m_Transform : m_Transform;
+            //during a parallel update any number of threads may be reading this, so only the main thread fills the cache.
+            //Until then, readers compute it themselves
+            Layer* layer = GetOwningLayerPtr();
+            if (layer && layer->IsInParallelUpdate()) {
+                return world;
+            }
+            m_WorldTransform = world;
+            m_WorldTransformDirty = false;
         }
-        else {
-            return m_Transform;
+        return m_WorldTransform;
+    }
+
+    Transform Entity::GetInterpolatedWorldTransform() const
+    {
+        ENTITY_EXISTS(TRANSFORM_DEFAULT);
+        auto app = Application::Get();
+        if (!app->GetFixedTimestepEnabled() || !m_HasPreviousWorldTransform) {
+            return GetWorldTransform();
         }
+        return Transform::Lerp(m_PreviousWorldTransform, GetWorldTransform(), app->GetInterpolationAlpha());
     }
 
     void Entity::SetWorldTransform(const Transform& transform)
     {
         ENTITY_EXISTS();
-        if (GetParent().lock()) {
-            auto parentTransform = GetParent().lock()->GetWorldTransform();
+        Entity* parent = GetParentPtr();
+        if (parent) {
+            auto parentTransform = parent->GetWorldTransform();
             m_Transform = transform - parentTransform;
         }
         else {
             m_Transform = transform;
         }
+        InvalidateWorldTransform();
     }
 
     void Entity::SetWorldPosition(const Vector& pos)
     {
         ENTITY_EXISTS();
-        if (GetParent().lock()) {
-            auto parentTransform = GetParent().lock()->GetWorldTransform();
+        Entity* parent = GetParentPtr();
+        if (parent) {
+            auto parentTransform = parent->GetWorldTransform();
             m_Transform.Position = pos - parentTransform.Position;
         }
         else {
             m_Transform.Position = pos;
         }
+        InvalidateWorldTransform();
     }
 
     void Entity::SetWorldRotation(const Rotator& rot)
     {
         ENTITY_EXISTS();
-        if (GetParent().lock()) {
-            auto parentTransform = GetParent().lock()->GetWorldTransform();
+        Entity* parent = GetParentPtr();
+        if (parent) {
+            auto parentTransform = parent->GetWorldTransform();
             m_Transform.Rotation = rot - parentTransform.Rotation;
         }
         else {
             m_Transform.Rotation = rot;
         }
+        InvalidateWorldTransform();
     }
 
     void Entity::SetWorldScale(const Vector& scale)
     {
         ENTITY_EXISTS();
-        if (GetParent().lock()) {
-            auto parentTransform = GetParent().lock()->GetWorldTransform();
+        Entity* parent = GetParentPtr();
+        if (parent) {
+            auto parentTransform = parent->GetWorldTransform();
             m_Transform.Scale = scale - parentTransform.Scale;
         }
         else {
             m_Transform.Scale = scale;
         }
+        InvalidateWorldTransform();
     }
 
     void Entity::Destroy()
     {
         ENTITY_EXISTS();
+        DEFER_STRUCTURAL_CHANGE(, Destroy());
         LOG_S(INFO) << "Entity destroyed. Should be cleaned soon.";
         m_Exists = false;
+        //free the slot now, so handles to this entity stop resolving right away
+        m_Slots->Entities.Remove(m_Handle);
         auto sthis = shared_from_this();
+        Layer* layer = GetOwningLayerPtr();
         //first, remove from hirarchy entirely (not root, not child)
-        if (m_Parent.lock()) {
-            m_Parent.lock()->RemoveChildByRef(sthis, false);
-        }
-        if (m_OwningLayer.lock()->IsEntityRoot(sthis)) {
-            m_OwningLayer.lock()->RemoveEntity(sthis);
-        }
-        //take care of childrend
-        while(m_Children.size() > 0){
-            auto child = m_Children.front();
-            RemoveChildByRef(child, true);
+        auto parent = m_Parent.lock();
+        if (parent) {
+            parent->RemoveChildByRef(sthis, false);
+        }
+        if (layer->IsEntityRoot(sthis)) {
+            layer->RemoveEntity(sthis);
+        }
+        //take care of childrend. From a copy, as handlers of the removal events may compact the child vector
+        auto children = m_Children;
+        for (auto& child : children) {
+            if (child && child->GetParentPtr() == this) {
+                RemoveChildByRef(child, true);
+            }
         }
         //mark destroyed for the layer's cleanup policies
-        m_OwningLayer.lock()->MarkDestroyed(weak_from_this());
+        layer->MarkDestroyed(weak_from_this());
     }
 
 
     bool Entity::IsChild(EntityRef ref, bool recursive) const
     {
         ENTITY_EXISTS(false);
-        if (std::find(m_Children.begin(), m_Children.end(), ref) != m_Children.end()) {
+        if (!ref) {
+            return false;
+        }
+        if (ref->m_SiblingIndex < m_Children.size() && m_Children[ref->m_SiblingIndex] == ref) {
             return true;
         }
-        else {
-            if (recursive) {
-                for (auto child : m_Children) {
-                    if (child->IsChild(ref, true)) {
-                        return true;
-                    }
+        if (recursive) {
+            //walk up from the candidate, rather than down through the whole subtree
+            Entity* parent = ref->GetParentPtr();
+            while (parent) {
+                if (parent == this) {
+                    return true;
                 }
+                parent = parent->GetParentPtr();
             }
         }
         return false;
@@ -146,37 +217,103 @@ namespace Tara{
     EntityRef Entity::GetFirstChildOfName(const std::string& name) const
     {
         ENTITY_EXISTS(nullptr);
-        for (auto child : m_Children) {
-            if (child->GetName() == name) {
+        Name interned;
+        if (!Name::Find(name, interned)) {
+            //never interned, so nothing has this name
+            return nullptr;
+        }
+        return FindFirstChildOfName(interned);
+    }
+
+    EntityRef Entity::RemoveChildByName(const std::string& name)
+    {
+        ENTITY_EXISTS(nullptr);
+        Name interned;
+        if (!Name::Find(name, interned)) {
+            return nullptr;
+        }
+        auto child = FindFirstChildOfName(interned);
+        if (child) {
+            DEFER_STRUCTURAL_CHANGE(child, RemoveChildByRef(child));
+            if (RemoveChildByRef(child)) {
                 return child;
             }
         }
         return nullptr;
     }
 
-    EntityRef Entity::RemoveChildByName(const std::string& name)
+    EntityRef Entity::FindFirstChildOfName(const Name& name) const
     {
-        ENTITY_EXISTS(nullptr);
-        for (auto child : m_Children) {
-            if (child->GetName() == name) {
-                if (RemoveChildByRef(child)) {
-                    return child;
-                }
-                else {
-                    return nullptr;
-                }
+        if (m_ChildNames) {
+            return m_ChildNames->First(name);
+        }
+        for (auto& child : m_Children) {
+            if (!child) { continue; }
+            if (child->m_Name == name) {
+                return child;
             }
         }
         return nullptr;
     }
 
+    void Entity::BeginCreationBatch()
+    {
+        s_CreationBatch.Depth++;
+    }
+
+    void Entity::EndCreationBatch()
+    {
+        if (s_CreationBatch.Depth == 0 || --s_CreationBatch.Depth > 0) {
+            return;
+        }
+        //taken out first, as handlers may create entities (outside the batch) while these are sent
+        auto attached = std::move(s_CreationBatch.Attached);
+        s_CreationBatch.Attached.clear();
+        for (auto& [parent, child] : attached) {
+            ParentSwapedEvent parentSwappedEvent(EntityNoRef(), parent);
+            child->ReceiveEvent(parentSwappedEvent);
+            ChildAddedEvent childAddedEvent(parent, child);
+            parent->ReceiveEvent(childAddedEvent);
+        }
+    }
+
+    void Entity::SetNameIndexEnabled(bool enable)
+    {
+        ENTITY_EXISTS();
+        if (!enable) {
+            m_ChildNames.reset();
+            m_ComponentNames.reset();
+            return;
+        }
+        if (m_ChildNames) {
+            return;
+        }
+        m_ChildNames = std::make_unique<NameIndex<Entity, SiblingPosition>>();
+        for (auto& child : m_Children) {
+            if (!child) { continue; }
+            m_ChildNames->Add(child->m_Name, child);
+        }
+        m_ComponentNames = std::make_unique<NameIndex<Component, Component::IndexPosition>>();
+        for (auto& comp : m_Components) {
+            if (!comp) { continue; }
+            m_ComponentNames->Add(comp->m_Name, comp);
+        }
+    }
+
     //TODO: add parenting child to level
     bool Entity::RemoveChildByRef(EntityRef ref, bool setToLayer)
     {
         ENTITY_EXISTS(false);
+        DEFER_STRUCTURAL_CHANGE(true, RemoveChildByRef(ref, setToLayer));
         if (&*(ref->GetParent().lock()) == this) {
             ref->SetParent(std::weak_ptr<Entity>());
-            m_Children.remove(ref);
+            if (EraseSibling(m_Children, ref, m_ChildHoles) && m_ComponentHoles == 0) {
+                QueueCompaction();
+            }
+            m_ChildTypes.Remove(ref->m_TypeId, ref);
+            if (m_ChildNames) {
+                m_ChildNames->Remove(ref->m_Name, ref);
+            }
             if (setToLayer) {
                 m_OwningLayer.lock()->AddEntity(ref);
                 //event to child, only if setToLayer is true. Otherwhise, whatever called this will handle it.
@@ -198,6 +335,7 @@ namespace Tara{
     bool Entity::AddChild(EntityRef ref)
     {
         ENTITY_EXISTS(false);
+        DEFER_STRUCTURAL_CHANGE(true, AddChild(ref));
         //early out if ref is already a immedate child
         if (IsChild(ref)) {
             return false;
@@ -209,11 +347,12 @@ namespace Tara{
         }
 
         //if part of layer, remove
-        if (m_OwningLayer.lock()->IsEntityRoot(ref)) {
-            m_OwningLayer.lock()->RemoveEntity(ref);
+        Layer* layer = GetOwningLayerPtr();
+        if (layer->IsEntityRoot(ref)) {
+            layer->RemoveEntity(ref);
         }
 
-        if (ref->GetParent().lock()) {
+        if (ref->GetParentPtr()) {
             //if has a parent, swap
             ref->SwapParent(weak_from_this());
             //parent swap event handled
@@ -221,7 +360,11 @@ namespace Tara{
         else {
             //else, just add to this
             ref->SetParent(weak_from_this(), true);
-            m_Children.push_back(ref);
+            PushSibling(m_Children, ref);
+            m_ChildTypes.Add(ref->m_TypeId, ref);
+            if (m_ChildNames) {
+                m_ChildNames->Add(ref->m_Name, ref);
+            }
             //Parent Swap event
             ParentSwapedEvent parentSwappedEvent(EntityNoRef(), weak_from_this());
             ref->ReceiveEvent(parentSwappedEvent);
@@ -235,6 +378,7 @@ namespace Tara{
     bool Entity::SwapParent(EntityNoRef newParent)
     {
         ENTITY_EXISTS(false);
+        DEFER_STRUCTURAL_CHANGE(false, SwapParent(newParent));
         //check if newParent can be parent
         if (IsChild(newParent.lock(), true)) {
             return false;
@@ -245,7 +389,11 @@ namespace Tara{
 
         //add to new parent
         SetParent(newParent, true);
-        newParent.lock()->m_Children.push_back(shared_from_this());
+        PushSibling(newParent.lock()->m_Children, shared_from_this());
+        newParent.lock()->m_ChildTypes.Add(m_TypeId, shared_from_this());
+        if (newParent.lock()->m_ChildNames) {
+            newParent.lock()->m_ChildNames->Add(m_Name, shared_from_this());
+        }
         
         //parent swappedEvent
         ParentSwapedEvent parentSwappedEvent(parentCopy, newParent);
@@ -258,48 +406,121 @@ namespace Tara{
     void Entity::Update(float deltaTime)
     {
         ENTITY_EXISTS();
+        if (!ShouldTick(deltaTime)) {
+            return;
+        }
+        //structural changes are deferred by the layer while updating, so the vectors can't change under these loops
         if (m_UpdateChildrenFirst) {
-            for (auto child : m_Children) {
+            for (auto& child : m_Children) {
+                if (!child) { continue; }
                 child->Update(deltaTime);
             }
         }
         if (m_UpdateComponentsFirst) {
-            for (auto component : m_Components) {
-                component->OnUpdate(deltaTime);
+            for (auto& component : m_Components) {
+                if (!component) { continue; }
+                UpdateComponent(*component, deltaTime);
             }
         }
         OnUpdate(deltaTime);
         if (!m_UpdateComponentsFirst) {
-            for (auto component : m_Components) {
-                component->OnUpdate(deltaTime);
+            for (auto& component : m_Components) {
+                if (!component) { continue; }
+                UpdateComponent(*component, deltaTime);
             }
         }
         if (!m_UpdateChildrenFirst) {
-            for (auto child : m_Children) {
+            for (auto& child : m_Children) {
+                if (!child) { continue; }
                 child->Update(deltaTime);
             }
         }
     }
 
-    void Entity::Draw(float deltaTime, const uint32_t& cameraBits)
+    bool Entity::ShouldTick(float& deltaTime)
+    {
+        //the common case, nothing set, doesn't need the layer
+        if (m_Tick.Enabled && m_Tick.Interval <= 0.0f && m_Tick.Group == 0 && !m_TickLOD && m_Tick.Accumulated <= 0.0f) {
+            return true;
+        }
+        Layer* layer = GetOwningLayerPtr();
+        if (!m_Tick.Enabled || (layer && !layer->GetTickGroupEnabled(m_Tick.Group))) {
+            //everything below is skipped along with this
+            if (layer) { layer->CountSkippedTicks(m_CachedSubtreeCount, m_CachedSubtreeComponentCount); }
+            return false;
+        }
+        float interval = m_Tick.Interval;
+        if (m_TickLOD && layer) {
+            interval = std::max(interval, layer->GetTickLODInterval(*this));
+        }
+        if (!m_Tick.Accumulate(deltaTime, interval)) {
+            if (layer) { layer->CountSkippedTicks(m_CachedSubtreeCount, m_CachedSubtreeComponentCount); }
+            return false;
+        }
+        return true;
+    }
+
+    void Entity::UpdateComponent(Component& component, float deltaTime)
+    {
+        TickControl& tick = component.m_Tick;
+        if (tick.Enabled && tick.Interval <= 0.0f && tick.Group == 0 && tick.Accumulated <= 0.0f) {
+            component.OnUpdate(deltaTime);
+            return;
+        }
+        Layer* layer = GetOwningLayerPtr();
+        if (!tick.Enabled || (layer && !layer->GetTickGroupEnabled(tick.Group)) || !tick.Accumulate(deltaTime, tick.Interval)) {
+            if (layer) { layer->CountSkippedTicks(0, 1); }
+            return;
+        }
+        component.OnUpdate(deltaTime);
+    }
+
+    void Entity::SetTickGroup(uint32_t group)
+    {
+        CHECK_F(group < TICK_GROUP_COUNT, "Entity::SetTickGroup: group %u is out of range", group);
+        m_Tick.Group = group;
+    }
+
+    void Entity::Draw(float deltaTime, const uint32_t& cameraBits, const BoundingBox* viewBounds, DrawStats& stats, DrawList* list)
     {
         ENTITY_EXISTS();
-        if (!m_DrawChildrenFirst && (cameraBits & m_RenderFilterBits)){
-            OnDraw(deltaTime);
+        bool drawSelf = list || (cameraBits & m_RenderFilterBits) != 0;
+        if (!m_DrawChildrenFirst && drawSelf){
+            DrawSelf(deltaTime, stats, list);
         }
-        for (auto child : m_Children) {
+        for (auto& child : m_Children) {
+            if (!child) { continue; }
             if (child->GetVisible()) {
-                child->Draw(deltaTime, cameraBits);
+                if (viewBounds && child->IsOutsideView(*viewBounds)) {
+                    stats.CulledEntities += child->m_CachedSubtreeCount;
+                    continue;
+                }
+                child->Draw(deltaTime, cameraBits, viewBounds, stats, list);
             }
         }
-        if (m_DrawChildrenFirst && (cameraBits & m_RenderFilterBits)) {
+        if (m_DrawChildrenFirst && drawSelf) {
+            DrawSelf(deltaTime, stats, list);
+        }
+    }
+
+    void Entity::DrawSelf(float deltaTime, DrawStats& stats, DrawList* list)
+    {
+        if (list) {
+            const BoundingBox& box = m_CachedSpecificBox;
+            list->BeginItem(box, m_RenderFilterBits, box.Width >= 0 && box.Height >= 0 && box.Depth >= 0);
+            OnDraw(deltaTime);
+            list->EndItem();
+        }
+        else {
             OnDraw(deltaTime);
         }
+        stats.DrawnEntities++;
     }
 
     void Entity::DebugLogAllChildren(bool recursive, int indentLevel) const
     {
         for (auto child : m_Children) {
+            if (!child) { continue; }
             LOG_S(INFO) << std::string(indentLevel, ' ') << child->GetName() << "{" << (child->GetParent().lock() == shared_from_this()) << "}";
             if (recursive) {
                 child->DebugLogAllChildren(true, indentLevel + 1);
@@ -312,6 +533,7 @@ namespace Tara{
     bool Entity::AddComponent(ComponentRef component)
     {
         ENTITY_EXISTS(false);
+        DEFER_STRUCTURAL_CHANGE(true, AddComponent(component));
         if (IsComponent(component)) {
             return false;
         }
@@ -324,7 +546,15 @@ namespace Tara{
                 component->SetParent(weak_from_this());
             }
             //now add to self
+            component->m_ComponentIndex = m_Components.size();
             m_Components.push_back(component);
+            m_ComponentTypes.Add(component->m_TypeId, component);
+            if (m_ComponentNames) {
+                m_ComponentNames->Add(component->m_Name, component);
+            }
+            if (component->IsOfType<ScriptComponent>()) {
+                CheckParallelUpdateScripts();
+            }
             //event
             ComponentAddedEvent e(weak_from_this(), component);
             ReceiveEvent(e);
@@ -335,15 +565,23 @@ namespace Tara{
     bool Entity::IsComponent(ComponentRef ref) const
     {
         ENTITY_EXISTS(false);
-        auto iter = std::find(m_Components.begin(), m_Components.end(), ref);
-        return iter != m_Components.end();
+        return ref && ref->m_ComponentIndex < m_Components.size() && m_Components[ref->m_ComponentIndex] == ref;
     }
 
     ComponentRef Entity::GetFirstComponentOfName(const std::string& name) const
     {
         ENTITY_EXISTS(nullptr);
-        for (auto comp : m_Components) {
-            if (comp->GetName() == name) {
+        Name interned;
+        if (!Name::Find(name, interned)) {
+            //never interned, so nothing has this name
+            return nullptr;
+        }
+        if (m_ComponentNames) {
+            return m_ComponentNames->First(interned);
+        }
+        for (auto& comp : m_Components) {
+            if (!comp) { continue; }
+            if (comp->m_Name == interned) {
                 return comp;
             }
         }
@@ -353,14 +591,27 @@ namespace Tara{
     ComponentRef Entity::RemoveComponentByName(const std::string& name)
     {
         ENTITY_EXISTS(nullptr);
+        Name interned;
+        if (!Name::Find(name, interned)) {
+            return nullptr;
+        }
+        //the last component with the name
         ComponentRef component = nullptr;
-        for (auto comp : m_Components) {
-            if (comp->GetName() == name) {
-                component = comp;
+        if (m_ComponentNames) {
+            component = m_ComponentNames->Last(interned);
+        }
+        else {
+            for (auto comp = m_Components.rbegin(); comp != m_Components.rend(); comp++) {
+                if (!*comp) { continue; }
+                if ((*comp)->m_Name == interned) {
+                    component = *comp;
+                    break;
+                }
             }
         }
         if (component) {
-            m_Components.remove(component);
+            DEFER_STRUCTURAL_CHANGE(component, RemoveComponentByRef(component));
+            EraseComponent(component);
             component->SetParent(EntityNoRef());
             ComponentRemovedEvent e(weak_from_this(), component);
             ReceiveEvent(e);
@@ -371,8 +622,9 @@ namespace Tara{
     bool Entity::RemoveComponentByRef(ComponentRef ref)
     {
         ENTITY_EXISTS(false);
+        DEFER_STRUCTURAL_CHANGE(true, RemoveComponentByRef(ref));
         if (IsComponent(ref)) {
-            m_Components.remove(ref);
+            EraseComponent(ref);
             ComponentRemovedEvent e(weak_from_this(), ref);
             ReceiveEvent(e);
             ref->SetParent(EntityNoRef());
@@ -385,90 +637,89 @@ namespace Tara{
 
     bool Entity::MoveToTop()
     {
-        EntityRef pp = m_Parent.lock(); 
+        Entity* pp = GetParentPtr();
         if (pp) { 
             return pp->MoveChildUp(shared_from_this(), true); 
         }
         else { 
-            return m_OwningLayer.lock()->MoveEntityUp(shared_from_this(), true); 
+            return GetOwningLayerPtr()->MoveEntityUp(shared_from_this(), true); 
         }
     }
 
     inline bool Entity::MoveToBottom()
     {
-        EntityRef pp = m_Parent.lock();
+        Entity* pp = GetParentPtr();
         if (pp) {
             return pp->MoveChildDown(shared_from_this(), true);
         }
         else {
-            return m_OwningLayer.lock()->MoveEntityDown(shared_from_this(), true);
+            return GetOwningLayerPtr()->MoveEntityDown(shared_from_this(), true);
         }
     }
 
     inline bool Entity::MoveUp()
     {
-        EntityRef pp = m_Parent.lock();
+        Entity* pp = GetParentPtr();
         if (pp) {
             return pp->MoveChildUp(shared_from_this(), false);
         }
         else {
-            return m_OwningLayer.lock()->MoveEntityUp(shared_from_this(), false);
+            return GetOwningLayerPtr()->MoveEntityUp(shared_from_this(), false);
         }
     }
 
     inline bool Entity::MoveDown()
     {
-        EntityRef pp = m_Parent.lock();
+        Entity* pp = GetParentPtr();
         if (pp) {
             return pp->MoveChildDown(shared_from_this(), false);
         }
         else {
-            return m_OwningLayer.lock()->MoveEntityDown(shared_from_this(), false);
+            return GetOwningLayerPtr()->MoveEntityDown(shared_from_this(), false);
         }
     }
 
     bool Entity::MoveChildUp(EntityRef child, bool toTop)
     {
-        auto f = std::find(m_Children.begin(), m_Children.end(), child);
-        if (f == m_Children.end()) {
+        DEFER_STRUCTURAL_CHANGE(true, MoveChildUp(child, toTop));
+        if (!IsChild(child)) {
             //not a child
             return false;
         }
-        if (f == std::prev(m_Children.end())) {
-            //it is already top
-            return true;
+        if (m_ChildHoles > 0) {
+            CompactChildLists();
         }
-        if (toTop) {
-            //remove and re-insert at top
-            //erase is used so not to search the list again
-            m_Children.erase(f);
-            m_Children.push_back(child);
+        //the type and name indices are ordered by sibling index, so take the child out while it moves
+        m_ChildTypes.Remove(child->m_TypeId, child);
+        if (m_ChildNames) {
+            m_ChildNames->Remove(child->m_Name, child);
         }
-        else {
-            std::iter_swap(f, std::next(f));
+        MoveSiblingUp(m_Children, child, toTop);
+        m_ChildTypes.Add(child->m_TypeId, child);
+        if (m_ChildNames) {
+            m_ChildNames->Add(child->m_Name, child);
         }
         return true;
     }
 
     bool Entity::MoveChildDown(EntityRef child, bool toBottom)
     {
-        auto f = std::find(m_Children.begin(), m_Children.end(), child);
-        if (f == m_Children.end()) {
+        DEFER_STRUCTURAL_CHANGE(true, MoveChildDown(child, toBottom));
+        if (!IsChild(child)) {
             //not a child
             return false;
         }
-        if (f == m_Children.begin()) {
-            //it is already bottom
-            return true;
+        if (m_ChildHoles > 0) {
+            CompactChildLists();
         }
-        if (toBottom) {
-            //remove and re-insert at top
-            //erase is used so not to search the list again
-            m_Children.erase(f);
-            m_Children.push_front(child);
+        m_ChildTypes.Remove(child->m_TypeId, child);
+        if (m_ChildNames) {
+            m_ChildNames->Remove(child->m_Name, child);
         }
-        else {
-            std::iter_swap(std::prev(f), f);
+        MoveSiblingDown(m_Children, child, toBottom);
+        m_ChildTypes.Add(child->m_TypeId, child);
+        if (m_ChildNames) {
+            m_ChildNames->Add(child->m_Name, child);
         }
         return true;
     }
@@ -479,11 +730,13 @@ namespace Tara{
             ListenForEvents(true);
         }
         for (auto& component : m_Components) {
+            if (!component) { continue; }
             if (component->GetListeningForEvents()) {
                 component->ListenForEvents(true);
             }
         }
         for (auto& child : m_Children) {
+            if (!child) { continue; }
             child->MoveListenersUp();
         }
     }
@@ -495,15 +748,57 @@ namespace Tara{
         ENTITY_EXISTS(BoundingBox());
         BoundingBox box = GetSpecificBoundingBox();
         for (auto child : m_Children) {
+            if (!child) { continue; }
             box = box + child->GetFullBoundingBox(); //not += because that is not overloaded.
         }
         return box;
     }
 
+    void Entity::RefreshBoundingBoxCache()
+    {
+        ENTITY_EXISTS();
+        m_CachedSpecificBox = GetSpecificBoundingBox();
+        BoundingBox box = m_CachedSpecificBox;
+        //with no specific box, only plain entities are known to draw nothing
+        bool hasBox = m_CachedSpecificBox.Width >= 0 && m_CachedSpecificBox.Height >= 0 && m_CachedSpecificBox.Depth >= 0;
+        bool cullable = hasBox || m_TypeId == TypeRegistry<Entity>::Get<Entity>();
+        uint32_t count = 1;
+        uint32_t componentCount = (uint32_t)m_Components.size() - m_ComponentHoles;
+        for (auto& child : m_Children) {
+            if (!child) { continue; }
+            child->RefreshBoundingBoxCache();
+            box = box + child->m_CachedFullBox;
+            cullable = cullable && child->m_CachedFullBoxCullable;
+            count += child->m_CachedSubtreeCount;
+            componentCount += child->m_CachedSubtreeComponentCount;
+        }
+        m_CachedFullBox = box;
+        m_CachedFullBoxCullable = cullable;
+        m_CachedSubtreeCount = count;
+        m_CachedSubtreeComponentCount = componentCount;
+    }
+
+    bool Entity::IsDeferringStructuralChanges() const
+    {
+        Layer* layer = GetOwningLayerPtr();
+        return layer && layer->IsDeferringStructuralChanges();
+    }
+
+    void Entity::DeferStructuralChange(std::function<void()> func)
+    {
+        Layer* layer = GetOwningLayerPtr();
+        if (layer) {
+            layer->DeferStructuralChange(std::move(func));
+        }
+        else {
+            func();
+        }
+    }
+
     void Entity::ListenForEvents(bool enable)
     {
         ENTITY_EXISTS();
-        m_OwningLayer.lock()->EnableListener(weak_from_this(), enable);
+        GetOwningLayerPtr()->EnableListener(weak_from_this(), enable);
         SetListeningForEvents(enable);
     }
 
@@ -517,6 +812,8 @@ namespace Tara{
         if (newParent.lock() == nullptr) {
             LOG_S(INFO) << "Entity::SetParent clearing the parent.";
             m_Parent = EntityNoRef();
+            m_ParentHandle = EntityHandle();
+            InvalidateWorldTransform();
             return;
         }
         //make sure the new parent is not a child
@@ -526,6 +823,208 @@ namespace Tara{
             return;
         }
         m_Parent = newParent;
+        auto parent = newParent.lock();
+        m_ParentHandle = (parent->m_Slots == m_Slots) ? parent->m_Handle : EntityHandle();
+        InvalidateWorldTransform();
+        CheckParallelUpdateScripts();
+    }
+
+    void Entity::SetParallelUpdateSafe(bool safe)
+    {
+        if (safe && SubtreeHasScripts()) {
+            LOG_S(ERROR) << "Entity::SetParallelUpdateSafe: Entity " << GetName() << " or one of its children has a ScriptComponent. Lua can only run on the main thread, so it can't be updated in parallel.";
+            return;
+        }
+        m_ParallelUpdateSafe = safe;
+    }
+
+    bool Entity::SubtreeHasScripts() const
+    {
+        if (HasComponentOfType<ScriptComponent>()) {
+            return true;
+        }
+        for (auto& child : m_Children) {
+            if (child && child->SubtreeHasScripts()) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void Entity::CheckParallelUpdateScripts()
+    {
+        //only walk the subtree if something above is actually marked
+        bool marked = false;
+        for (Entity* e = this; e && !marked; e = e->GetParentPtr()) {
+            marked = e->m_ParallelUpdateSafe;
+        }
+        if (!marked || !SubtreeHasScripts()) {
+            return;
+        }
+        for (Entity* e = this; e; e = e->GetParentPtr()) {
+            if (e->m_ParallelUpdateSafe) {
+                LOG_S(WARNING) << "Entity " << e->GetName() << " now has a ScriptComponent in its subtree, and is no longer updated in parallel.";
+                e->m_ParallelUpdateSafe = false;
+            }
+        }
+    }
+
+    void Entity::InvalidateWorldTransform()
+    {
+        //the root's full box moves with this one
+        InvalidateBoundingBox();
+        DirtyWorldTransform();
+    }
+
+    void Entity::InvalidateBoundingBox()
+    {
+        //so the root's spatial hash cells may be stale now
+        Layer* layer = GetOwningLayerPtr();
+        if (layer) {
+            layer->MarkSpatialHashDirty(this);
+            layer->MarkBoundingBoxCacheStale();
+        }
+    }
+
+    void Entity::DirtyWorldTransform()
+    {
+        //if already dirty, the whole subtree is already dirty too, as children can only
+        //recompute after their parent has.
+        if (m_WorldTransformDirty) {
+            return;
+        }
+        m_WorldTransformDirty = true;
+        for (auto& child : m_Children) {
+            if (!child) { continue; }
+            child->DirtyWorldTransform();
+        }
+    }
+
+    void Entity::SnapshotWorldTransform()
+    {
+        m_PreviousWorldTransform = GetWorldTransform();
+        m_PreviousCachedFullBox = m_CachedFullBox;
+        m_HasPreviousWorldTransform = true;
+        for (auto& child : m_Children) {
+            if (!child) { continue; }
+            child->SnapshotWorldTransform();
+        }
+    }
+
+    void Entity::ReindexSiblings(std::vector<EntityRef>& entities, size_t first, size_t last)
+    {
+        for (size_t i = first; i < last; i++) {
+            entities[i]->m_SiblingIndex = i;
+        }
+    }
+
+    void Entity::PushSibling(std::vector<EntityRef>& entities, const EntityRef& ref)
+    {
+        ref->m_SiblingIndex = entities.size();
+        entities.push_back(ref);
+    }
+
+    bool Entity::EraseSibling(std::vector<EntityRef>& entities, const EntityRef& ref, uint32_t& holes)
+    {
+        size_t index = ref->m_SiblingIndex;
+        DCHECK_F(index < entities.size() && entities[index] == ref, "Entity::EraseSibling: entity is not at its stored index!");
+        entities[index] = nullptr;
+        return holes++ == 0;
+    }
+
+    void Entity::CompactSiblings(std::vector<EntityRef>& entities, uint32_t& holes)
+    {
+        if (holes == 0) {
+            return;
+        }
+        size_t count = 0;
+        for (size_t i = 0; i < entities.size(); i++) {
+            if (entities[i]) {
+                if (i != count) {
+                    entities[count] = std::move(entities[i]);
+                }
+                entities[count]->m_SiblingIndex = count;
+                count++;
+            }
+        }
+        entities.resize(count);
+        holes = 0;
+    }
+
+    void Entity::CompactChildLists()
+    {
+        CompactSiblings(m_Children, m_ChildHoles);
+        if (m_ComponentHoles > 0) {
+            size_t count = 0;
+            for (size_t i = 0; i < m_Components.size(); i++) {
+                if (m_Components[i]) {
+                    if (i != count) {
+                        m_Components[count] = std::move(m_Components[i]);
+                    }
+                    m_Components[count]->m_ComponentIndex = count;
+                    count++;
+                }
+            }
+            m_Components.resize(count);
+            m_ComponentHoles = 0;
+        }
+    }
+
+    void Entity::QueueCompaction()
+    {
+        Layer* layer = GetOwningLayerPtr();
+        if (layer) {
+            layer->QueueCompaction(this);
+        }
+    }
+
+    void Entity::MoveSiblingUp(std::vector<EntityRef>& entities, const EntityRef& ref, bool toTop)
+    {
+        size_t index = ref->m_SiblingIndex;
+        if (index + 1 >= entities.size()) {
+            //it is already top
+            return;
+        }
+        if (toTop) {
+            //shift everything above down by one, and put this at the top
+            std::rotate(entities.begin() + index, entities.begin() + index + 1, entities.end());
+            ReindexSiblings(entities, index, entities.size());
+        }
+        else {
+            std::swap(entities[index], entities[index + 1]);
+            ReindexSiblings(entities, index, index + 2);
+        }
+    }
+
+    void Entity::MoveSiblingDown(std::vector<EntityRef>& entities, const EntityRef& ref, bool toBottom)
+    {
+        size_t index = ref->m_SiblingIndex;
+        if (index == 0) {
+            //it is already bottom
+            return;
+        }
+        if (toBottom) {
+            //shift everything below up by one, and put this at the bottom
+            std::rotate(entities.begin(), entities.begin() + index, entities.begin() + index + 1);
+            ReindexSiblings(entities, 0, index + 1);
+        }
+        else {
+            std::swap(entities[index - 1], entities[index]);
+            ReindexSiblings(entities, index - 1, index + 1);
+        }
+    }
+
+    void Entity::EraseComponent(const ComponentRef& ref)
+    {
+        //nulled rather than erased, like children, and compacted later
+        m_Components[ref->m_ComponentIndex] = nullptr;
+        m_ComponentTypes.Remove(ref->m_TypeId, ref);
+        if (m_ComponentNames) {
+            m_ComponentNames->Remove(ref->m_Name, ref);
+        }
+        if (m_ComponentHoles++ == 0 && m_ChildHoles == 0) {
+            QueueCompaction();
+        }
     }
 
     void Entity::SelfOverlapChecks()
@@ -534,12 +1033,13 @@ namespace Tara{
         std::list<std::pair<EntityRef, EntityRef>> overlapQueue;
 
         for (auto iter1 = m_Children.begin(); iter1 != m_Children.end(); iter1++) {
+            if (!*iter1) { continue; }
             //for all entities, check their own children
             EntityRef child1 = *iter1;
             child1->SelfOverlapChecks();
 
             //run all children x root, 
-            if (GetSpecificBoundingBox().Overlaping(child1->GetFullBoundingBox())) {
+            if (GetCachedSpecificBoundingBox().Overlaping(child1->GetCachedFullBoundingBox())) {
                 //for any that overlap (Full AABB for children only), queue up
                 overlapQueue.push_back(std::make_pair( shared_from_this(), child1 ));
             }
@@ -548,8 +1048,9 @@ namespace Tara{
             auto iter2 = iter1;
             iter2++;
             for (; iter2 != m_Children.end(); iter2++) {
+                if (!*iter2) { continue; }
                 EntityRef child2 = *iter2;
-                if (child1->GetFullBoundingBox().Overlaping(child2->GetFullBoundingBox())) {
+                if (child1->GetCachedFullBoundingBox().Overlaping(child2->GetCachedFullBoundingBox())) {
                     //for any that overlap (Full AABB for children only), queue up
                     overlapQueue.push_back(std::make_pair( child1, child2 ));
                 }
@@ -566,56 +1067,58 @@ namespace Tara{
     {
         ENTITY_EXISTS();
         //IF the core AABB of self and other overlap, THEN generate overlap event
-        if (GetSpecificBoundingBox().Overlaping(other->GetSpecificBoundingBox())) {
+        if (GetCachedSpecificBoundingBox().Overlaping(other->GetCachedSpecificBoundingBox())) {
             if (ConfirmOverlap(other) && other->ConfirmOverlap(shared_from_this())) {
                 Manifold m(shared_from_this(), other);
-                m_OwningLayer.lock()->AddManifoldToQueue(std::move(m));
+                GetOwningLayerPtr()->AddManifoldToQueue(std::move(m));
             }
             //INENTIONAL NO RETURN
         }
 
         //ALSO, filter it down more, by checking children against other full AABB, and get list of children that overlap
         std::list<EntityRef> selfPotentialChildrenQueue;
-        BoundingBox otherBox= other->GetFullBoundingBox(); //cache this
+        BoundingBox otherBox= other->GetCachedFullBoundingBox(); //cache this
         for (auto child : m_Children) {
+            if (!child) { continue; }
             if (child == other) { continue; } //otherwise, it starts colliding children and self.
 
-            if (child->GetFullBoundingBox().Overlaping(otherBox)) {
+            if (child->GetCachedFullBoundingBox().Overlaping(otherBox)) {
                 selfPotentialChildrenQueue.push_back(child);
             }
         }
         //other's children against our full aabb
         std::list<EntityRef> otherPotentialChildrenQueue;
-        otherBox = GetFullBoundingBox(); //cache this
+        otherBox = GetCachedFullBoundingBox(); //cache this
         for (auto otherChild : other->m_Children) {
-            if (otherBox.Overlaping(otherChild->GetFullBoundingBox())) {
+            if (!otherChild) { continue; }
+            if (otherBox.Overlaping(otherChild->GetCachedFullBoundingBox())) {
                 otherPotentialChildrenQueue.push_back(otherChild);
             }
         }
 
         //THEN, find the self+children in that list that overlap other's core or potential children.
         std::list<std::pair<EntityRef, EntityRef>> overlapQueue;
-        otherBox = other->GetSpecificBoundingBox();
+        otherBox = other->GetCachedSpecificBoundingBox();
         //first, do self's potential children against the other root
         for (auto child : selfPotentialChildrenQueue) {
             if (child == other) {
                 continue;// skip adding the child again
             } 
-            if (child->GetFullBoundingBox().Overlaping(otherBox)) {
+            if (child->GetCachedFullBoundingBox().Overlaping(otherBox)) {
                 //for each of those, queue up
                 overlapQueue.push_back(std::make_pair( child, other ));
             }
         }
         for (auto otherChild : otherPotentialChildrenQueue) {
-            otherBox = otherChild->GetFullBoundingBox(); //cache this
+            otherBox = otherChild->GetCachedFullBoundingBox(); //cache this
             //second, self root against other children
-            if (GetSpecificBoundingBox().Overlaping(otherBox)) {
+            if (GetCachedSpecificBoundingBox().Overlaping(otherBox)) {
                 //for each of those, queue up
                 overlapQueue.push_back(std::make_pair(shared_from_this(), otherChild ));
             }
             //third, self potential children against other's children
             for (auto child : selfPotentialChildrenQueue) {
-                if (child->GetFullBoundingBox().Overlaping(otherBox)) {
+                if (child->GetCachedFullBoundingBox().Overlaping(otherBox)) {
                    //for each of those, queue up
                     overlapQueue.push_back(std::make_pair(child, otherChild ));
                 }
@@ -640,10 +1143,11 @@ namespace Tara{
 
    
 
-    void Entity::GetAllChildrenInBox(const BoundingBox& box, std::list<EntityRef>& list)
+    void Entity::GetAllChildrenInBox(const BoundingBox& box, std::vector<EntityRef>& list)
     {
         ENTITY_EXISTS();
         for (auto child : m_Children) {
+            if (!child) { continue; }
             if (box.Overlaping(child->GetFullBoundingBox())) {
                 if (box.Overlaping(child->GetSpecificBoundingBox())) {
                     list.push_back(child);
@@ -654,10 +1158,11 @@ namespace Tara{
     }
 
     
-    void Entity::GetAllChildrenInRadius(Vector origin, float radius, std::list<EntityRef>& list)
+    void Entity::GetAllChildrenInRadius(Vector origin, float radius, std::vector<EntityRef>& list)
     {
         ENTITY_EXISTS();
         for (auto child : m_Children) {
+            if (!child) { continue; }
             if (child->GetFullBoundingBox().OverlappingSphere(origin, radius)) {
                 if (child->GetSpecificBoundingBox().OverlappingSphere(origin, radius)) {
                     list.push_back(child);
@@ -667,6 +1172,20 @@ namespace Tara{
         }
     }
 
+    void Entity::GetAllChildrenOnRay(Vector origin, Vector direction, float length, std::vector<EntityRef>& list)
+    {
+        ENTITY_EXISTS();
+        for (auto child : m_Children) {
+            if (!child) { continue; }
+            if (child->GetFullBoundingBox().OverlappingRay(origin, direction, length)) {
+                if (child->GetSpecificBoundingBox().OverlappingRay(origin, direction, length)) {
+                    list.push_back(child);
+                }
+                child->GetAllChildrenOnRay(origin, direction, length, list);
+            }
+        }
+    }
+
 
 
 
@@ -700,6 +1219,8 @@ namespace Tara{
         CONNECT_METHOD(Entity, GetVisible);
         CONNECT_METHOD(Entity, SetVisible);
         CONNECT_METHOD(Entity, IsChild);
+        CONNECT_METHOD(Entity, SetNameIndexEnabled);
+        CONNECT_METHOD(Entity, GetNameIndexEnabled);
         CONNECT_METHOD(Entity, GetFirstChildOfName);
         CONNECT_METHOD(Entity, RemoveChildByName);
         CONNECT_METHOD(Entity, RemoveChildByRef);
@@ -716,6 +1237,14 @@ namespace Tara{
         CONNECT_METHOD(Entity, GetUpdateComponentsFirst);
         CONNECT_METHOD(Entity, SetDrawChildrenFirst);
         CONNECT_METHOD(Entity, GetDrawChildrenFirst);
+        CONNECT_METHOD(Entity, SetTickEnabled);
+        CONNECT_METHOD(Entity, GetTickEnabled);
+        CONNECT_METHOD(Entity, SetTickInterval);
+        CONNECT_METHOD(Entity, GetTickInterval);
+        CONNECT_METHOD(Entity, SetTickGroup);
+        CONNECT_METHOD(Entity, GetTickGroup);
+        CONNECT_METHOD(Entity, SetTickLODEnabled);
+        CONNECT_METHOD(Entity, GetTickLODEnabled);
         CONNECT_METHOD(Entity, AddComponent);
         CONNECT_METHOD(Entity, IsComponent);
         CONNECT_METHOD(Entity, GetFirstComponentOfName);
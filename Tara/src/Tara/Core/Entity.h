@@ -7,10 +7,18 @@
 #include "Tara/Input/EventListener.h"
 #include "Tara/Input/Event.h"
 #include "Tara/Core/Component.h"
+#include "Tara/Core/ObjectPool.h"
+#include "Tara/Core/TypeRegistry.h"
+#include "Tara/Core/Name.h"
+#include "Tara/Core/TickControl.h"
+#include "Tara/Core/Handle.h"
 #include <sol/sol.hpp>
 
 #define ENTITY_EXISTS(x) if (!Exists()) {return x;}
 
+//if the owning layer is deferring structural changes, record the call in its command buffer to run at the next sync point, and return x
+#define DEFER_STRUCTURAL_CHANGE(x, call) if (IsDeferringStructuralChanges()) { auto self = shared_from_this(); DeferStructuralChange([=]() { self->call; }); return x; }
+
 #define PARENT_LAYER Tara::LayerNoRef()
 
 //#define LISTTYPE std::list
@@ -25,6 +33,7 @@ namespace Tara {
 	NOREFTYPE(Entity);
 
 	struct Manifold;
+	class DrawList;
 
 	/// <summary>
 	/// Base class for all entities in the game. 
@@ -35,9 +44,30 @@ namespace Tara {
 		/// So that Layer can access protected functions from Entity.
 		/// </summary>
 		friend class Layer;
+		/// <summary>
+		/// So that snapshots can walk the children and components
+		/// </summary>
+		friend class SnapshotRegistry;
+		/// <summary>
+		/// So that prefabs can create entities in a batch
+		/// </summary>
+		friend class Prefab;
+		/// <summary>
+		/// So that components can find their parent's slot tables
+		/// </summary>
+		friend class Component;
 		
 
 	public:
+		TYPE_REGISTRY_BASE(Entity, Entity);
+		/// <summary>
+		/// Counts of the entities drawn, and skipped by view culling, in a layer's draw
+		/// </summary>
+		struct DrawStats {
+			uint32_t DrawnEntities = 0;
+			uint32_t CulledEntities = 0;
+		};
+
 		/***********************************************************************************
 		*                          Construction Functions                                  *
 		************************************************************************************/
@@ -58,12 +88,13 @@ namespace Tara {
 		/// Register an externally created entity. This adds it to the parent, etc.
 		/// </summary>
 		/// <param name="ref">the entity to register</param>
-		static void Register(EntityRef ref);
+		/// <param name="type">the exact type of the entity, from TypeRegistry&lt;Entity&gt;</param>
+		static void Register(EntityRef ref, TypeId type);
 
 		/// <summary>
-		/// basic entity destructor
+		/// basic entity destructor. Frees the entity's slot, if Destroy has not already
 		/// </summary>
-		virtual ~Entity() = default;
+		virtual ~Entity();
 	
 
 		/***********************************************************************************
@@ -112,16 +143,25 @@ namespace Tara {
 		virtual inline const Transform& GetRelativeTransform() const { return m_Transform; }
 		
 		/// <summary>
-		/// Get the world transform of the Entity
+		/// Get the world transform of the Entity.
+		/// The result is cached, and only recomputed when this entity or one of its ancestors has changed.
 		/// </summary>
 		/// <returns>the current world transform</returns>
 		virtual Transform GetWorldTransform() const;
 
+		/// <summary>
+		/// Get the world transform to draw the Entity with. When the application runs a fixed timestep, this is blended
+		/// between the world transform of the previous tick and the current one by the interpolation alpha, so motion stays smooth
+		/// when frames and ticks don't line up. Otherwise, it is the same as GetWorldTransform().
+		/// </summary>
+		/// <returns>the interpolated world transform</returns>
+		Transform GetInterpolatedWorldTransform() const;
+
 		/// <summary>
 		/// Set the relative transform of the entity
 		/// </summary>
 		/// <param name="transform">the new transform</param>
-		virtual inline void SetRelativeTransform(const Transform& transform) { m_Transform = transform; }
+		virtual inline void SetRelativeTransform(const Transform& transform) { m_Transform = transform; InvalidateWorldTransform(); }
 
 		/// <summary>
 		/// set the world transform of an entity
@@ -138,7 +178,7 @@ namespace Tara {
 		/// Set the relative position of the Entity
 		/// </summary>
 		/// <param name="pos">the new position, as a vector</param>
-		virtual inline void SetRelativePosition(const Vector& pos) { m_Transform.Position = pos; }
+		virtual inline void SetRelativePosition(const Vector& pos) { m_Transform.Position = pos; InvalidateWorldTransform(); }
 
 		/// <summary>
 		/// Get the world position of the Entity
@@ -162,7 +202,7 @@ namespace Tara {
 		/// Set the relative rotation of the Entity
 		/// </summary>
 		/// <param name="rot">the new rotation, as Rotator</param>
-		virtual inline void SetRelativeRotation(const Rotator& rot) { m_Transform.Rotation = rot; }
+		virtual inline void SetRelativeRotation(const Rotator& rot) { m_Transform.Rotation = rot; InvalidateWorldTransform(); }
 
 		/// <summary>
 		/// Get the world rotation of the Entity
@@ -186,7 +226,7 @@ namespace Tara {
 		/// Set the relative scale of the Entity
 		/// </summary>
 		/// <param name="rot">the new scale, as Vector</param>
-		virtual inline void SetRelativeScale(const Vector& scale) { m_Transform.Scale = scale; }
+		virtual inline void SetRelativeScale(const Vector& scale) { m_Transform.Scale = scale; InvalidateWorldTransform(); }
 
 		/// <summary>
 		/// Get the world scale of the Entity
@@ -204,7 +244,27 @@ namespace Tara {
 		/// Get the name of the entity
 		/// </summary>
 		/// <returns>the name as string</returns>
-		const std::string& GetName() const { return m_Name; }
+		const std::string& GetName() const { return m_Name.GetString(); }
+
+		/// <summary>
+		/// Get the interned name of the entity
+		/// </summary>
+		/// <returns>the name</returns>
+		inline const Name& GetInternedName() const { return m_Name; }
+
+		/// <summary>
+		/// Enable or disable the name index of this entity. When enabled, the entity keeps its children and components
+		/// hashed by name, so the OfName and ByName functions don't have to check every one. Worth it for entities with many children
+		/// that are looked up by name often. Disabled by default.
+		/// </summary>
+		/// <param name="enable">true to enable</param>
+		void SetNameIndexEnabled(bool enable);
+
+		/// <summary>
+		/// Get if the name index of this entity is enabled
+		/// </summary>
+		/// <returns>true if enabled</returns>
+		inline bool GetNameIndexEnabled() const { return (bool)m_ChildNames; }
 
 		/// <summary>
 		/// Get if this entity is marked visible. Will be true even if parent is not visible
@@ -230,12 +290,103 @@ namespace Tara {
 		/// <param name="bits"></param>
 		inline virtual void SetRenderFilterBits(uint32_t bits) { m_RenderFilterBits = bits; }
 
+		/// <summary>
+		/// Declare if this entity (with its children and components) can be updated on a worker thread, when its layer has parallel update enabled.
+		/// Only mark root entities whose update only touches themselves. Hierarchy changes, Destroy and SendEvent are always deferred while the layer updates.
+		/// Only has an effect on root entities. Children are updated with their root.
+		/// Lua can only run on the main thread, so this is refused if the entity or any of its children has a ScriptComponent,
+		/// and cleared again if one is added to (or parented into) the subtree later.
+		/// </summary>
+		/// <param name="safe">true if safe for parallel update</param>
+		void SetParallelUpdateSafe(bool safe);
+
+		/// <summary>
+		/// Get if this entity can be updated on a worker thread
+		/// </summary>
+		/// <returns>true if safe for parallel update</returns>
+		inline bool GetParallelUpdateSafe() const { return m_ParallelUpdateSafe; }
+
+		/// <summary>
+		/// Enable or disable ticking. A disabled entity, its components, and all its children are not updated at all, and don't build up time.
+		/// </summary>
+		/// <param name="enabled">true to tick</param>
+		inline void SetTickEnabled(bool enabled) { m_Tick.Enabled = enabled; }
+
+		/// <summary>
+		/// Get if ticking is enabled
+		/// </summary>
+		/// <returns>true if enabled</returns>
+		inline bool GetTickEnabled() const { return m_Tick.Enabled; }
+
+		/// <summary>
+		/// Set the time between ticks. The entity, its components, and its children tick together, at most this often,
+		/// with the delta time being all the time since the last tick.
+		/// </summary>
+		/// <param name="seconds">the interval, in seconds. 0 ticks every update</param>
+		inline void SetTickInterval(float seconds) { m_Tick.Interval = std::max(seconds, 0.0f); }
+
+		/// <summary>
+		/// Get the time between ticks
+		/// </summary>
+		/// <returns>the interval, in seconds</returns>
+		inline float GetTickInterval() const { return m_Tick.Interval; }
+
+		/// <summary>
+		/// Put the entity in a tick group. The owning layer can turn whole groups on and off with Layer::SetTickGroupEnabled.
+		/// </summary>
+		/// <param name="group">the group, less than TICK_GROUP_COUNT. 0 is the default group, which is always on</param>
+		void SetTickGroup(uint32_t group);
+
+		/// <summary>
+		/// Get the entity's tick group
+		/// </summary>
+		/// <returns>the group</returns>
+		inline uint32_t GetTickGroup() const { return m_Tick.Group; }
+
+		/// <summary>
+		/// Opt in to the owning layer's tick LOD policy, which ticks the entity less often the further it is from the layer camera,
+		/// or when it is off screen. See Layer::SetTickLODPolicy.
+		/// </summary>
+		/// <param name="enabled">true to use tick LOD</param>
+		inline void SetTickLODEnabled(bool enabled) { m_TickLOD = enabled; }
+
+		/// <summary>
+		/// Get if the entity uses the owning layer's tick LOD policy
+		/// </summary>
+		/// <returns>true if it does</returns>
+		inline bool GetTickLODEnabled() const { return m_TickLOD; }
+
+		/// <summary>
+		/// Check if the owning layer is deferring structural changes (it is updating, checking overlaps, or drawing).
+		/// If it is, hierarchy changes are recorded and applied at the layer's next sync point.
+		/// </summary>
+		/// <returns>true if structural changes are deferred</returns>
+		bool IsDeferringStructuralChanges() const;
+
+		/// <summary>
+		/// Run a structural change. If the owning layer is deferring structural changes, the function is recorded in its
+		/// command buffer and run at the next sync point, on the main thread, otherwise it is run right away.
+		/// </summary>
+		/// <param name="func">the function</param>
+		void DeferStructuralChange(std::function<void()> func);
+
+		/// <summary>
+		/// Construct and send an event to this entity. Unlike ReceiveEvent, this is safe during a parallel update.
+		/// While the owning layer is deferring structural changes, the event is built and sent at its next sync point,
+		/// in order with the changes around it.
+		/// </summary>
+		/// <typeparam name="EventType">the event subclass</typeparam>
+		/// <typeparam name="...VA_ARGS">the constructor argument types</typeparam>
+		/// <param name="...args">the arguments to the event's constructor. These are copied.</param>
+		template<class EventType, typename... VA_ARGS> void SendEvent(VA_ARGS... args);
+
 
 
 		/// <summary>
 		/// Destroy this entity. 
 		/// This by default will make all chilren root entities. If something else is desired, do it manually first.
 		/// Will not remove the ref you currently have, so you have to do that too.
+		/// While the owning layer updates, checks overlaps or draws, this is deferred to its next sync point.
 		/// </summary>
 		void Destroy();
 
@@ -266,8 +417,17 @@ namespace Tara {
 		/// <returns>the first child of that subclass if any, or nullptr if none found</returns>
 		template<typename EntityType> std::shared_ptr<EntityType> GetFirstChildOfType() const;
 
+		/// <summary>
+		/// Check if this entity has a child of a specific subclass of Entity. A single mask test.
+		/// </summary>
+		/// <typeparam name="EntityType">the subclass of entity</typeparam>
+		/// <returns>true if there is one</returns>
+		template<typename EntityType> bool HasChildOfType() const;
+
 		/// <summary>
 		/// Remove a child by its name. Only removes the first child with this name
+		/// While the owning layer updates, checks overlaps or draws, hierarchy changes are deferred to its next sync point.
+		/// Then, the return is the child that will be removed.
 		/// </summary>
 		/// <param name="name">The child name</param>
 		/// <returns>the child, if removed. nullptr otherwise</returns>
@@ -275,6 +435,8 @@ namespace Tara {
 		
 		/// <summary>
 		/// Remove a specific reference from the children list
+		/// While the owning layer updates, checks overlaps or draws, hierarchy changes are deferred to its next sync point.
+		/// Then, the return is true, even if the deferred removal later finds nothing to remove.
 		/// </summary>
 		/// <param name="ref">the child to remove</param>
 		/// /// <param name="setToLayer">if false, then the entity is not given to the layer</param>
@@ -283,6 +445,8 @@ namespace Tara {
 		
 		/// <summary>
 		/// Add a new child to an entity
+		/// While the owning layer updates, checks overlaps or draws, hierarchy changes are deferred to its next sync point.
+		/// Then, the return is true, even if the deferred add later finds it is already a child.
 		/// </summary>
 		/// <param name="ref">the child to add</param>
 		/// <returns>true if added, false if already a child</returns>
@@ -290,6 +454,8 @@ namespace Tara {
 
 		/// <summary>
 		/// Swap the current parent for a new one. Does not work if the current entity is root. You cannot parent to your own child.
+		/// While the owning layer updates, checks overlaps or draws, hierarchy changes are deferred to its next sync point.
+		/// Then, the return is false, as the swap has not happened yet.
 		/// </summary>
 		/// <param name="newParent">the new parent enetity</param>
 		/// <returns>true if operation was successful</returns>
@@ -300,6 +466,13 @@ namespace Tara {
 		/// </summary>
 		/// <returns>The parent</returns>
 		EntityNoRef GetParent() const { return m_Parent; }
+
+		/// <summary>
+		/// Get the parent of an entity through its handle, without locking a weak_ptr.
+		/// Only valid while the parent exists, so it should not be stored. Store GetHandle() or GetParent() instead.
+		/// </summary>
+		/// <returns>the parent, or null if root or the parent was destroyed</returns>
+		inline Entity* GetParentPtr() const { return m_ParentHandle.IsNull() ? m_Parent.lock().get() : m_Slots->Entities.Resolve(m_ParentHandle); }
 		
 		
 		
@@ -309,6 +482,19 @@ namespace Tara {
 		/// <returns>a weak ref to the owning layer</returns>
 		inline std::weak_ptr<Layer> GetOwningLayer() const { return m_OwningLayer; }
 
+		/// <summary>
+		/// Get the owning layer without locking a weak_ptr. Only valid while the layer exists, so it should not be stored.
+		/// </summary>
+		/// <returns>the owning layer, or null if it was destroyed</returns>
+		inline Layer* GetOwningLayerPtr() const { return m_Slots->Owner; }
+
+		/// <summary>
+		/// Get the handle of this entity, for storing a reference to it that can be resolved with Layer::Resolve.
+		/// Handles are small, and checking them costs no atomic operations, unlike locking an EntityNoRef.
+		/// </summary>
+		/// <returns>the handle. It stops resolving once the entity is destroyed</returns>
+		inline EntityHandle GetHandle() const { return m_Handle; }
+
 		/// <summary>
 		/// Debug function, logs the name of every child to the output
 		/// </summary>
@@ -347,6 +533,7 @@ namespace Tara {
 
 		/// <summary>
 		/// Add a component
+		/// While the owning layer updates, checks overlaps or draws, this is deferred to its next sync point. Then, the return is true.
 		/// </summary>
 		/// <param name="component"></param>
 		/// <returns></returns>
@@ -373,8 +560,25 @@ namespace Tara {
 		/// <returns>the first component of that subclass if any, or nullptr if none found</returns>
 		template<typename ComponentType> std::shared_ptr<ComponentType> GetFirstCompontentOfType() const;
 
+		/// <summary>
+		/// Check if this entity has a component of a specific subclass of component. A single mask test.
+		/// </summary>
+		/// <typeparam name="ComponentType">the subclass of component</typeparam>
+		/// <returns>true if there is one</returns>
+		template<typename ComponentType> bool HasComponentOfType() const;
+
+		/// <summary>
+		/// Call a function with every component of a specific subclass of component, in component order.
+		/// </summary>
+		/// <typeparam name="ComponentType">the subclass of component</typeparam>
+		/// <typeparam name="Func">[void](ComponentType&amp; component){...}</typeparam>
+		/// <param name="func">the function. Must not add or remove components of this entity.</param>
+		template<typename ComponentType, typename Func> void ForEachComponentOfType(Func func) const;
+
 		/// <summary>
 		/// Remove a component that has a specific name
+		/// While the owning layer updates, checks overlaps or draws, this is deferred to its next sync point.
+		/// Then, the return is the component that will be removed.
 		/// </summary>
 		/// <param name="name">the name to remove</param>
 		/// <returns>A reference to the removed component if one was removed, nullptr otherwise</returns>
@@ -382,6 +586,7 @@ namespace Tara {
 
 		/// <summary>
 		/// Remove a component by reference
+		/// While the owning layer updates, checks overlaps or draws, this is deferred to its next sync point. Then, the return is true.
 		/// </summary>
 		/// <param name="ref">the reference to that component</param>
 		/// <returns>True if the component was remove, false otherwise</returns>
@@ -430,6 +635,7 @@ namespace Tara {
 
 		/// <summary>
 		/// Move a child up by one or to top in the child list. Check if the entity is a child.
+		/// While the owning layer updates, checks overlaps or draws, this is deferred to its next sync point. Then, the return is true.
 		/// </summary>
 		/// <param name="child">the child to move</param>
 		/// <param name="toTop">if the move should be to the top or normal. defaults to false (normal)</param>
@@ -438,6 +644,7 @@ namespace Tara {
 
 		/// <summary>
 		/// Move a child down by one or to bottom in the child list. Check if the entity is a child.
+		/// While the owning layer updates, checks overlaps or draws, this is deferred to its next sync point. Then, the return is true.
 		/// </summary>
 		/// <param name="child">the child to move</param>
 		/// <param name="toBottom">if the move should be to the bottom or normal. defaults to false (normal)</param>
@@ -460,6 +667,26 @@ namespace Tara {
 		/// <returns></returns>
 		BoundingBox GetFullBoundingBox() const;
 
+		/// <summary>
+		/// Get the specific bounding box as of the last bounding box refresh.
+		/// The owning layer refreshes these once per frame, before running overlap checks.
+		/// </summary>
+		/// <returns>the cached specific bounding box</returns>
+		inline const BoundingBox& GetCachedSpecificBoundingBox() const { return m_CachedSpecificBox; }
+
+		/// <summary>
+		/// Get the full bounding box (this and all children) as of the last bounding box refresh.
+		/// The owning layer refreshes these once per frame, before running overlap checks.
+		/// </summary>
+		/// <returns>the cached full bounding box</returns>
+		inline const BoundingBox& GetCachedFullBoundingBox() const { return m_CachedFullBox; }
+
+		/// <summary>
+		/// Recompute the cached bounding boxes of this entity and all of its children, bottom-up.
+		/// Should not normally be called manually, the owning layer does it once per frame.
+		/// </summary>
+		void RefreshBoundingBoxCache();
+
 		/// <summary>
 		/// Enable/Disable Listening for application window native events
 		/// </summary>
@@ -473,19 +700,54 @@ protected:
 		/// </summary>
 		/// <param name="deltaTime"></param>
 		void Update(float deltaTime);
+
+		/// <summary>
+		/// Check the tick settings, to see if the entity ticks this update
+		/// </summary>
+		/// <param name="deltaTime">the update's delta time. Set to the time since the last tick, when returning true</param>
+		/// <returns>true if the entity should tick</returns>
+		bool ShouldTick(float& deltaTime);
+
+		/// <summary>
+		/// Update a component, if its tick settings say so
+		/// </summary>
+		void UpdateComponent(Component& component, float deltaTime);
 		
 		/// <summary>
 		/// Draw the entity. Should not be manually called.
 		/// </summary>
 		/// <param name="deltaTime"></param>
-		void Draw(float deltaTime, const uint32_t& cameraBits);
+		/// <param name="cameraBits">the render filter bits of the camera</param>
+		/// <param name="viewBounds">the world space bounds of the camera's view, to skip children outside of. Null draws every child</param>
+		/// <param name="stats">the counts to add to</param>
+		/// <param name="list">if not null, the draw list being recorded, with one item per entity drawn. Recording ignores cameraBits, as the list is filtered per camera</param>
+		void Draw(float deltaTime, const uint32_t& cameraBits, const BoundingBox* viewBounds, DrawStats& stats, DrawList* list = nullptr);
+
+		/// <summary>
+		/// Run OnDraw, as an item of a draw list if one is being recorded
+		/// </summary>
+		void DrawSelf(float deltaTime, DrawStats& stats, DrawList* list);
+
+		/// <summary>
+		/// Check if this entity and all its children are outside of a view, as of the last bounding box refresh, so drawing them can be skipped.
+		/// Entities that draw with no specific bounding box (other than plain Entities, which draw nothing) are never outside,
+		/// nor is anything above them. Entities that draw outside of their specific bounding box should override it to cover what they draw.
+		/// With a fixed timestep, entities draw somewhere between the last two ticks, so the box as of the tick before is checked too.
+		/// </summary>
+		/// <param name="viewBounds">the world space bounds of the view</param>
+		/// <returns>true if outside</returns>
+		inline bool IsOutsideView(const BoundingBox& viewBounds) const {
+			return m_CachedFullBoxCullable && !m_CachedFullBox.Overlaping(viewBounds) && !(m_HasPreviousWorldTransform && m_PreviousCachedFullBox.Overlaping(viewBounds));
+		}
 
 
 		/// <summary>
-		/// Get a const ref to the list of children
+		/// Get a const ref to the list of children.
+		/// Removed children leave holes that are compacted out later, so this compacts first if there are any. The layer compacts
+		/// before each update, so this never has to during one.
 		/// </summary>
 		/// <returns>the list of children</returns>
-		const std::list<EntityRef>& GetChildren() const { return m_Children; }
+		const std::vector<EntityRef>& GetChildren() const { if (m_ChildHoles > 0) { const_cast<Entity*>(this)->CompactChildLists(); } return m_Children; }
 
 		/// <summary>
 		/// used for checking if this entity is a real entity, or if its a ghost, zombie entity.
@@ -493,6 +755,25 @@ protected:
 		/// <returns></returns>
 		inline bool Exists() const { if (!m_Exists) { LOG_S(ERROR) << "Attempting to access a deleted Entity!"; } return m_Exists; }
 
+		/// <summary>
+		/// Mark the cached world transform of this entity and all its children as stale,
+		/// and the root's cells in the layer's spatial hash, if enabled.
+		/// Subclasses that write to m_Transform directly must call this afterwards.
+		/// </summary>
+		void InvalidateWorldTransform();
+
+		/// <summary>
+		/// Mark the root's cells in the layer's spatial hash, and the layer's bounding box cache, as stale.
+		/// Subclasses whose specific bounding box changes without a transform change (tiles, layout) must call this afterwards.
+		/// </summary>
+		void InvalidateBoundingBox();
+
+		/// <summary>
+		/// Remember the current world transform of this entity and its children as the previous tick's, for interpolation.
+		/// Called by the layer before each fixed timestep tick.
+		/// </summary>
+		void SnapshotWorldTransform();
+
 
 	public: //must be public to properly inherit
 
@@ -518,7 +799,7 @@ protected:
 		/// </summary>
 		/// <param name="box">the box to check with</param>
 		/// <param name="list">the list to append to</param>
-		virtual void GetAllChildrenInBox(const BoundingBox& box, std::list<EntityRef>& list);
+		virtual void GetAllChildrenInBox(const BoundingBox& box, std::vector<EntityRef>& list);
 		
 		
 		/// <summary>
@@ -527,7 +808,16 @@ protected:
 		/// <param name="origin">the position</param>
 		/// <param name="radius">the radius</param>
 		/// <param name="list">the list to append to</param>
-		virtual void GetAllChildrenInRadius(Vector origin, float radius, std::list<EntityRef>& list);
+		virtual void GetAllChildrenInRadius(Vector origin, float radius, std::vector<EntityRef>& list);
+
+		/// <summary>
+		/// Append to a list of all the children that a ray segment hits
+		/// </summary>
+		/// <param name="origin">the start of the ray</param>
+		/// <param name="direction">the direction of the ray</param>
+		/// <param name="length">how far along the direction the ray goes</param>
+		/// <param name="list">the list to append to</param>
+		virtual void GetAllChildrenOnRay(Vector origin, Vector direction, float length, std::vector<EntityRef>& list);
 
 		/// <summary>
 		/// In case any entity has special collision, override this. Their spicific overlap volumes overlap
@@ -564,23 +854,189 @@ protected:
 		static void RegisterLuaType(sol::state& lua);
 
 	private:
+		/// <summary>
+		/// The position of an entity in its parent's child vector, for the parent's TypeIndex
+		/// </summary>
+		struct SiblingPosition {
+			static inline uint32_t Get(const Entity& entity) { return (uint32_t)entity.m_SiblingIndex; }
+		};
+
 		/// <summary>
 		/// Set the parent of an entity. Should not be manually called
 		/// </summary>
 		/// <param name="newParent"> the new parent</param>
 		void SetParent(EntityNoRef newParent, bool ignoreChecks = false);
 
+		/// <summary>
+		/// Rewrite the stored sibling indices of a range of entities in a child or root vector.
+		/// Must be called after anything that shifts elements around.
+		/// </summary>
+		/// <param name="entities">the vector</param>
+		/// <param name="first">the first index to fix</param>
+		/// <param name="last">one past the last index to fix</param>
+		static void ReindexSiblings(std::vector<EntityRef>& entities, size_t first, size_t last);
+
+		/// <summary>
+		/// Append an entity to a child or root vector, storing its index
+		/// </summary>
+		/// <param name="entities">the vector</param>
+		/// <param name="ref">the entity to append</param>
+		static void PushSibling(std::vector<EntityRef>& entities, const EntityRef& ref);
+
+		/// <summary>
+		/// Remove an entity from a child or root vector by its stored index, in O(1). The entry is nulled rather than erased,
+		/// so the order and indices of the rest are kept, and the hole is removed by the next CompactSiblings.
+		/// </summary>
+		/// <param name="entities">the vector</param>
+		/// <param name="ref">the entity to remove. Must be in the vector.</param>
+		/// <param name="holes">the hole count of the vector</param>
+		/// <returns>true if this is the first hole, so the vector needs to be queued for compacting</returns>
+		static bool EraseSibling(std::vector<EntityRef>& entities, const EntityRef& ref, uint32_t& holes);
+
+		/// <summary>
+		/// Remove the holes left by EraseSibling from a child or root vector, keeping the order, and fix the stored indices. O(n)
+		/// </summary>
+		/// <param name="entities">the vector</param>
+		/// <param name="holes">the hole count of the vector. Zero afterwards</param>
+		static void CompactSiblings(std::vector<EntityRef>& entities, uint32_t& holes);
+
+		/// <summary>
+		/// Compact the holes out of the child and component vectors
+		/// </summary>
+		void CompactChildLists();
+
+		/// <summary>
+		/// Queue this entity with its layer, to have its child and component vectors compacted at the next sync point
+		/// </summary>
+		void QueueCompaction();
+
+		/// <summary>
+		/// Mark the cached world transform of this entity and all its children as stale
+		/// </summary>
+		void DirtyWorldTransform();
+
+		/// <summary>
+		/// Check if this entity or any of its children has a ScriptComponent
+		/// </summary>
+		bool SubtreeHasScripts() const;
+
+		/// <summary>
+		/// Clear the parallel update flag of this entity and its parents, if the subtree now holds a ScriptComponent
+		/// </summary>
+		void CheckParallelUpdateScripts();
+
+		/// <summary>
+		/// Move an entity up by one (or to the top) in a child or root vector
+		/// </summary>
+		/// <param name="entities">the vector</param>
+		/// <param name="ref">the entity to move. Must be in the vector.</param>
+		/// <param name="toTop">if it should go all the way to the top</param>
+		static void MoveSiblingUp(std::vector<EntityRef>& entities, const EntityRef& ref, bool toTop);
+
+		/// <summary>
+		/// Move an entity down by one (or to the bottom) in a child or root vector
+		/// </summary>
+		/// <param name="entities">the vector</param>
+		/// <param name="ref">the entity to move. Must be in the vector.</param>
+		/// <param name="toBottom">if it should go all the way to the bottom</param>
+		static void MoveSiblingDown(std::vector<EntityRef>& entities, const EntityRef& ref, bool toBottom);
+
+		/// <summary>
+		/// Remove a component from the component vector by its stored index, keeping the order of the rest.
+		/// </summary>
+		/// <param name="ref">the component to remove. Must be a component of this entity.</param>
+		void EraseComponent(const ComponentRef& ref);
+
+		/// <summary>
+		/// Find the first child with a name, in child order
+		/// </summary>
+		/// <param name="name">the name</param>
+		/// <returns>the child, or nullptr if none</returns>
+		EntityRef FindFirstChildOfName(const Name& name) const;
+
+		/// <summary>
+		/// Start a creation batch on this thread. Until it ends, new entities with a parent are attached to it directly,
+		/// skipping AddChild's checks (a new entity can't already be a child or an ancestor of anything), and the hierarchy events are held back.
+		/// Batches nest; only the outermost one sends the events.
+		/// </summary>
+		static void BeginCreationBatch();
+
+		/// <summary>
+		/// End a creation batch. The outermost one sends the held back hierarchy events, in creation order.
+		/// </summary>
+		static void EndCreationBatch();
+
+		/// <summary>
+		/// New children attached during a creation batch, whose hierarchy events have not been sent yet
+		/// </summary>
+		struct CreationBatch {
+			uint32_t Depth = 0;
+			std::vector<std::pair<EntityRef, EntityRef>> Attached; //parent, child
+		};
+		static thread_local CreationBatch s_CreationBatch;
+
+	public:
+		/// <summary>
+		/// Get the exact type of this entity, as assigned by TypeRegistry&lt;Entity&gt; when it was created
+		/// </summary>
+		/// <returns>the type id</returns>
+		inline TypeId GetTypeId() const { return m_TypeId; }
+
+		/// <summary>
+		/// Check if this entity is of a specific subclass of Entity, without an RTTI cast
+		/// </summary>
+		/// <typeparam name="EntityType">the subclass of entity</typeparam>
+		/// <returns>true if it is</returns>
+		template<typename EntityType> inline bool IsOfType() const { return TypeRegistry<Entity>::IsA(m_TypeId, TypeRegistry<Entity>::Get<EntityType>()); }
+
 	protected:
 		Transform m_Transform;
 		uint32_t m_RenderFilterBits;
 		
 	private:
-		const std::string m_Name;
+		const Name m_Name;
 		const LayerNoRef m_OwningLayer;
 		EntityNoRef m_Parent;
-		std::list<EntityRef> m_Children;
-		std::list<ComponentRef> m_Components;
+		//slot tables of the owning layer, the slot of this entity, and the slot of the parent (null if root, or the parent has no slot in them)
+		LayerSlotsRef m_Slots;
+		EntityHandle m_Handle;
+		EntityHandle m_ParentHandle;
+		std::vector<EntityRef> m_Children;
+		std::vector<ComponentRef> m_Components;
+		//null entries left by removals in m_Children and m_Components, until compacted
+		uint32_t m_ChildHoles = 0;
+		uint32_t m_ComponentHoles = 0;
+		//index of this entity in its parent's child vector, or in the owning layer's root vector if root
+		size_t m_SiblingIndex = 0;
 		bool m_Exists = true;
+		TypeId m_TypeId;
+		//children and components by type, for typed lookups
+		TypeIndex<Entity, SiblingPosition> m_ChildTypes;
+		TypeIndex<Component, Component::IndexPosition> m_ComponentTypes;
+		//children and components by name, null unless enabled
+		std::unique_ptr<NameIndex<Entity, SiblingPosition>> m_ChildNames;
+		std::unique_ptr<NameIndex<Component, Component::IndexPosition>> m_ComponentNames;
+		//cached world transform, recomputed lazily in GetWorldTransform
+		mutable Transform m_WorldTransform;
+		mutable bool m_WorldTransformDirty = true;
+		//world transform as of the previous fixed timestep tick, for interpolation
+		Transform m_PreviousWorldTransform;
+		bool m_HasPreviousWorldTransform = false;
+		//bounding boxes cached by RefreshBoundingBoxCache, for overlap checks
+		BoundingBox m_CachedSpecificBox = { 0,0,0,-1,-1,-1 };
+		BoundingBox m_CachedFullBox = { 0,0,0,-1,-1,-1 };
+		//the cached full box as of the previous fixed timestep tick, for culling interpolated drawing
+		BoundingBox m_PreviousCachedFullBox = { 0,0,0,-1,-1,-1 };
+		//if the cached full box covers everything the subtree draws, and the number of entities in it, for view culling
+		bool m_CachedFullBoxCullable = false;
+		uint32_t m_CachedSubtreeCount = 1;
+		//the number of components in the subtree, for counting the ticks a skipped subtree skips
+		uint32_t m_CachedSubtreeComponentCount = 0;
+		//set while queued with the layer to have its spatial hash cells refreshed. Guarded by the layer's spatial hash mutex
+		bool m_SpatialHashDirty = false;
+		bool m_ParallelUpdateSafe = false;
+		TickControl m_Tick;
+		bool m_TickLOD = false;
 
 	protected:
 		bool m_UpdateChildrenFirst = true;
@@ -592,7 +1048,7 @@ protected:
 	/// <summary>
 	/// Create a new entity
 	/// </summary>
-	/// <typeparam name="EntityType">The subclass of Entity to make</typeparam>
+	/// <typeparam name="EntityType">The subclass of Entity to make. Must declare its base with TYPE_REGISTRY_BASE</typeparam>
 	/// <typeparam name="...VA_ARGS">The variable args for its constructor</typeparam>
 	/// <param name="...args">the arguments to the subclass's constructor</param>
 	/// <returns>A reference to the created Entity</returns>
@@ -600,24 +1056,45 @@ protected:
 	inline std::shared_ptr<EntityType> CreateEntity(VA_ARGS&&... args) {
 		static_assert(std::is_base_of<Entity, EntityType>::value, "Error: Tara::CreateEntity: Provided class is not a subclass of Tara::Entity");
 		static_assert(std::is_constructible<EntityType, VA_ARGS...>::value, "Error: Tara::CreateEntity: cannot compile due to paramaters passed not matching constructor of that entity type!");
-		std::shared_ptr<EntityType> entity = std::make_shared<EntityType>(std::forward<VA_ARGS>(args)...);
-		Entity::Register(entity);
+		std::shared_ptr<EntityType> entity = MakePooledShared<EntityType>(std::forward<VA_ARGS>(args)...);
+		Entity::Register(entity, TypeRegistry<Entity>::Get<EntityType>());
 		entity->OnBeginPlay();
 		return entity;
 	}
 
+	template<class EventType, typename... VA_ARGS>
+	inline void Entity::SendEvent(VA_ARGS... args)
+	{
+		static_assert(std::is_base_of<Event, EventType>::value, "Error: Tara::Entity::SendEvent : Provided class is not a subclass of Tara::Event");
+		ENTITY_EXISTS();
+		auto self = shared_from_this();
+		DeferStructuralChange([self, args...]() {
+			EventType e(args...);
+			self->ReceiveEvent(e);
+		});
+	}
+
 	template<typename EntityType>
 	inline std::shared_ptr<EntityType> Entity::GetFirstChildOfType() const
 	{
 		static_assert(std::is_base_of<Entity, EntityType>::value, "Error: Tara::Entity::GetFirstChildOfType : Provided class is not a subclass of Tara::Entity");
 		ENTITY_EXISTS(nullptr);
-		for (auto comp : m_Children) {
-			auto subtype = std::dynamic_pointer_cast<EntityType>(comp);
-			if (subtype) {
-				return subtype;
+		//each bucket is in child order, so only the fronts need comparing
+		const EntityRef* first = nullptr;
+		m_ChildTypes.ForEachBucket(TypeRegistry<Entity>::Get<EntityType>(), [&first](const std::vector<EntityRef>& refs) {
+			if (!first || refs.front()->m_SiblingIndex < (*first)->m_SiblingIndex) {
+				first = &refs.front();
 			}
-		}
-		return nullptr;
+		});
+		return first ? std::static_pointer_cast<EntityType>(*first) : nullptr;
+	}
+
+	template<typename EntityType>
+	inline bool Entity::HasChildOfType() const
+	{
+		static_assert(std::is_base_of<Entity, EntityType>::value, "Error: Tara::Entity::HasChildOfType : Provided class is not a subclass of Tara::Entity");
+		ENTITY_EXISTS(false);
+		return m_ChildTypes.Contains(TypeRegistry<Entity>::Get<EntityType>());
 	}
 
 	template<typename ComponentType>
@@ -625,13 +1102,38 @@ protected:
 	{
 		static_assert(std::is_base_of<Component, ComponentType>::value, "Error: Tara::Entity::GetFirstCompontentOfType : Provided class is not a subclass of Tara::Component");
 		ENTITY_EXISTS(nullptr);
-		for (auto comp : m_Components) {
-			auto subtype = std::dynamic_pointer_cast<ComponentType>(comp);
-			if (subtype) {
-				return subtype;
+		//each bucket is in component order, so only the fronts need comparing
+		const ComponentRef* first = nullptr;
+		m_ComponentTypes.ForEachBucket(TypeRegistry<Component>::Get<ComponentType>(), [&first](const std::vector<ComponentRef>& refs) {
+			if (!first || refs.front()->m_ComponentIndex < (*first)->m_ComponentIndex) {
+				first = &refs.front();
+			}
+		});
+		return first ? std::static_pointer_cast<ComponentType>(*first) : nullptr;
+	}
+
+	template<typename ComponentType>
+	inline bool Entity::HasComponentOfType() const
+	{
+		static_assert(std::is_base_of<Component, ComponentType>::value, "Error: Tara::Entity::HasComponentOfType : Provided class is not a subclass of Tara::Component");
+		ENTITY_EXISTS(false);
+		return m_ComponentTypes.Contains(TypeRegistry<Component>::Get<ComponentType>());
+	}
+
+	template<typename ComponentType, typename Func>
+	inline void Entity::ForEachComponentOfType(Func func) const
+	{
+		static_assert(std::is_base_of<Component, ComponentType>::value, "Error: Tara::Entity::ForEachComponentOfType : Provided class is not a subclass of Tara::Component");
+		ENTITY_EXISTS();
+		const TypeId type = TypeRegistry<Component>::Get<ComponentType>();
+		if (!m_ComponentTypes.Contains(type)) {
+			return;
+		}
+		for (auto& comp : m_Components) {
+			if (comp && TypeRegistry<Component>::IsA(comp->m_TypeId, type)) {
+				func(static_cast<ComponentType&>(*comp));
 			}
 		}
-		return nullptr;
 	}
 
 
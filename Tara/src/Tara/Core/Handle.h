@@ -0,0 +1,192 @@
+#pragma once
+#include "tarapch.h"
+#include <mutex>
+#include <atomic>
+
+//slot tables are split into pages of 2^SLOT_TABLE_PAGE_BITS slots, which never move once made
+#define SLOT_TABLE_PAGE_BITS 12
+#define SLOT_TABLE_PAGE_SIZE (1u << SLOT_TABLE_PAGE_BITS)
+//the most pages a slot table can have, so it holds up to SLOT_TABLE_MAX_PAGES * SLOT_TABLE_PAGE_SIZE live objects (4M)
+#define SLOT_TABLE_MAX_PAGES 1024
+
+namespace Tara {
+
+	class Layer;
+	class Entity;
+	class Component;
+
+	/// <summary>
+	/// A generational handle: the index of a slot in a SlotTable, and the generation the slot had when the handle was made.
+	/// Once the object is gone, the slot's generation moves on, and the handle resolves to null. Small and safe to copy.
+	/// </summary>
+	/// <typeparam name="T">the type of object the handle refers to</typeparam>
+	template<typename T>
+	struct Handle {
+		uint32_t Index = 0;
+		uint32_t Generation = 0; //0 is never a live slot
+
+		/// <summary>
+		/// Check if this is the null handle (rather than a handle to something that may be gone)
+		/// </summary>
+		/// <returns>true if null</returns>
+		inline bool IsNull() const { return Generation == 0; }
+
+		inline bool operator==(const Handle& other) const { return Index == other.Index && Generation == other.Generation; }
+		inline bool operator!=(const Handle& other) const { return !(*this == other); }
+	};
+
+	/// <summary>
+	/// Maps generational handles to raw pointers.
+	/// Resolving a handle is a bounds check, and a compare against the slot's generation, with plain loads: no locks, and
+	/// no atomic read-modify-write, unlike locking a weak_ptr. Slots live in pages that never move, so resolving is safe on any
+	/// number of threads, even while other threads add and remove (which take a lock). As with any raw pointer, the object must not
+	/// be destroyed on another thread while a resolved pointer is in use.
+	/// </summary>
+	/// <typeparam name="T">the type of object</typeparam>
+	template<typename T>
+	class SlotTable {
+	public:
+		SlotTable()
+			: m_PageCount(0), m_LiveCount(0)
+		{
+			for (uint32_t i = 0; i < SLOT_TABLE_MAX_PAGES; i++) {
+				m_Pages[i].store(nullptr, std::memory_order_relaxed);
+			}
+		}
+
+		~SlotTable() {
+			for (uint32_t i = 0; i < m_PageCount; i++) {
+				delete[] m_Pages[i].load(std::memory_order_relaxed);
+			}
+		}
+
+		SlotTable(SlotTable const&) = delete;
+		void operator=(SlotTable const&) = delete;
+
+		/// <summary>
+		/// Give an object a slot
+		/// </summary>
+		/// <param name="object">the object</param>
+		/// <returns>the handle to it</returns>
+		Handle<T> Add(T* object) {
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			uint32_t index;
+			if (m_Free.size() > 0) {
+				index = m_Free.back();
+				m_Free.pop_back();
+			}
+			else {
+				uint32_t page = m_PageCount;
+				CHECK_F(page < SLOT_TABLE_MAX_PAGES, "SlotTable: out of slots!");
+				Slot* slots = new Slot[SLOT_TABLE_PAGE_SIZE];
+				for (uint32_t i = 0; i < SLOT_TABLE_PAGE_SIZE; i++) {
+					slots[i].Object.store(nullptr, std::memory_order_relaxed);
+					slots[i].Generation.store(1, std::memory_order_relaxed);
+				}
+				m_Pages[page].store(slots, std::memory_order_release);
+				m_PageCount++;
+				//handed out lowest first, so pages fill in order
+				for (uint32_t i = SLOT_TABLE_PAGE_SIZE; i > 1; i--) {
+					m_Free.push_back((page << SLOT_TABLE_PAGE_BITS) | (i - 1));
+				}
+				index = page << SLOT_TABLE_PAGE_BITS;
+			}
+			Slot& slot = SlotOf(index);
+			slot.Object.store(object, std::memory_order_relaxed);
+			m_LiveCount++;
+			return { index, slot.Generation.load(std::memory_order_relaxed) };
+		}
+
+		/// <summary>
+		/// Free an object's slot. Every handle to it resolves to null from now on. Does nothing for stale handles.
+		/// </summary>
+		/// <param name="handle">the handle</param>
+		void Remove(Handle<T> handle) {
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			if (Resolve(handle) == nullptr) {
+				return;
+			}
+			Slot& slot = SlotOf(handle.Index);
+			uint32_t generation = slot.Generation.load(std::memory_order_relaxed) + 1;
+			//0 is reserved for null handles
+			slot.Generation.store(generation == 0 ? 1 : generation, std::memory_order_relaxed);
+			slot.Object.store(nullptr, std::memory_order_relaxed);
+			m_Free.push_back(handle.Index);
+			m_LiveCount--;
+		}
+
+		/// <summary>
+		/// Get the object a handle refers to
+		/// </summary>
+		/// <param name="handle">the handle</param>
+		/// <returns>the object, or null if it is gone (or the handle is null)</returns>
+		inline T* Resolve(Handle<T> handle) const {
+			uint32_t page = handle.Index >> SLOT_TABLE_PAGE_BITS;
+			if (page >= SLOT_TABLE_MAX_PAGES) {
+				return nullptr;
+			}
+			const Slot* slots = m_Pages[page].load(std::memory_order_acquire);
+			if (!slots) {
+				return nullptr;
+			}
+			const Slot& slot = slots[handle.Index & (SLOT_TABLE_PAGE_SIZE - 1)];
+			return (slot.Generation.load(std::memory_order_relaxed) == handle.Generation) ? slot.Object.load(std::memory_order_relaxed) : nullptr;
+		}
+
+		/// <summary>
+		/// Check if the object a handle refers to still has its slot. O(1)
+		/// </summary>
+		/// <param name="handle">the handle</param>
+		/// <returns>true if live</returns>
+		inline bool IsLive(Handle<T> handle) const { return Resolve(handle) != nullptr; }
+
+		/// <summary>
+		/// Get the number of live slots
+		/// </summary>
+		/// <returns>the count</returns>
+		inline uint32_t GetLiveCount() const { return m_LiveCount; }
+
+	private:
+		/// <summary>
+		/// A slot. Atomic only so resolving on other threads is well defined; every access is a plain load or store.
+		/// </summary>
+		struct Slot {
+			std::atomic<T*> Object;
+			std::atomic<uint32_t> Generation;
+		};
+
+		inline Slot& SlotOf(uint32_t index) {
+			return m_Pages[index >> SLOT_TABLE_PAGE_BITS].load(std::memory_order_relaxed)[index & (SLOT_TABLE_PAGE_SIZE - 1)];
+		}
+
+	private:
+		std::atomic<Slot*> m_Pages[SLOT_TABLE_MAX_PAGES];
+		std::vector<uint32_t> m_Free;
+		std::mutex m_Mutex; //guards adding and removing
+		uint32_t m_PageCount;
+		uint32_t m_LiveCount;
+	};
+
+
+	/// <summary>
+	/// A handle to an Entity, resolved through its layer's slot table. See Layer::Resolve and Entity::GetHandle.
+	/// </summary>
+	using EntityHandle = Handle<Entity>;
+	/// <summary>
+	/// A handle to a Component, resolved through its entity's layer's slot table. See Layer::Resolve and Component::GetHandle.
+	/// </summary>
+	using ComponentHandle = Handle<Component>;
+
+	/// <summary>
+	/// The slot tables of a layer, shared by the layer and everything in it, so entities and components that outlive their layer
+	/// can still free their slots. Owner is cleared when the layer is destroyed.
+	/// </summary>
+	struct LayerSlots {
+		Layer* Owner = nullptr;
+		SlotTable<Entity> Entities;
+		SlotTable<Component> Components;
+	};
+
+	using LayerSlotsRef = std::shared_ptr<LayerSlots>;
+
+}
@@ -0,0 +1,186 @@
+#include "tarapch.h"
+#include "JobSystem.h"
+
+namespace Tara {
+
+	//the queue of the current thread. 0 for threads that are not workers
+	static thread_local uint32_t s_QueueIndex = 0;
+
+	void JobCounter::Increment()
+	{
+		//first job of the group, so the group becomes pending in the parent
+		if (m_Pending.fetch_add(1, std::memory_order_acq_rel) == 0 && m_Parent) {
+			m_Parent->Increment();
+		}
+	}
+
+	void JobCounter::Decrement()
+	{
+		//read before the decrement, as a waiter may destroy this counter as soon as it reaches 0
+		JobCounter* parent = m_Parent;
+		if (m_Pending.fetch_sub(1, std::memory_order_acq_rel) == 1 && parent) {
+			parent->Decrement();
+		}
+	}
+
+
+	JobSystem::JobSystem()
+		: m_QueuedJobs(0), m_Stopping(false)
+	{
+		Start(0);
+	}
+
+	JobSystem* JobSystem::Get()
+	{
+		static JobSystem system;
+		return &system;
+	}
+
+	JobSystem::~JobSystem()
+	{
+		Stop();
+	}
+
+	void JobSystem::Run(std::function<void()> job, JobCounter* counter)
+	{
+		if (counter) {
+			counter->Increment();
+		}
+		//an index past the end means the queues were rebuilt since this thread last looked, so use the shared one
+		uint32_t index = s_QueueIndex < m_Queues.size() ? s_QueueIndex : 0;
+		{
+			std::lock_guard<std::mutex> lock(m_Queues[index]->Mutex);
+			m_Queues[index]->Jobs.push_back({ std::move(job), counter });
+		}
+		m_QueuedJobs.fetch_add(1, std::memory_order_release);
+		//take the sleep lock, so a worker can't miss this between checking for jobs and going to sleep
+		{ std::lock_guard<std::mutex> lock(m_SleepMutex); }
+		m_WakeUp.notify_one();
+	}
+
+	void JobSystem::Wait(const JobCounter& counter)
+	{
+		while (!counter.IsDone()) {
+			if (!TryRunJob(s_QueueIndex)) {
+				//nothing to help with, the remaining jobs are running elsewhere
+				std::this_thread::yield();
+			}
+		}
+	}
+
+	void JobSystem::ParallelFor(size_t count, size_t batchSize, const std::function<void(size_t, size_t)>& func)
+	{
+		if (count == 0) {
+			return;
+		}
+		if (batchSize == 0) {
+			batchSize = 1;
+		}
+		//too small to split, or nobody to split with: just run it here
+		if (count <= batchSize || m_Workers.size() == 0) {
+			func(0, count);
+			return;
+		}
+		JobCounter counter;
+		//queue all but the first batch, which this thread runs right away
+		for (size_t begin = batchSize; begin < count; begin += batchSize) {
+			size_t end = std::min(begin + batchSize, count);
+			Run([&func, begin, end]() { func(begin, end); }, &counter);
+		}
+		func(0, batchSize);
+		Wait(counter);
+	}
+
+	void JobSystem::SetThreadCount(uint32_t count)
+	{
+		Stop();
+		Start(count);
+	}
+
+	void JobSystem::Start(uint32_t count)
+	{
+		if (count == 0) {
+			count = std::max(std::thread::hardware_concurrency(), 1u);
+		}
+		m_Stopping = false;
+		//the queues are all made before any worker starts, so they never change while in use
+		m_Queues.clear();
+		for (uint32_t i = 0; i < count; i++) {
+			m_Queues.push_back(std::make_unique<WorkQueue>());
+		}
+		//the calling thread counts as one
+		for (uint32_t i = 1; i < count; i++) {
+			m_Workers.emplace_back(&JobSystem::WorkerLoop, this, i);
+		}
+		LOG_S(INFO) << "JobSystem started with " << count << " threads";
+	}
+
+	void JobSystem::Stop()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_SleepMutex);
+			m_Stopping = true;
+		}
+		m_WakeUp.notify_all();
+		for (auto& worker : m_Workers) {
+			worker.join();
+		}
+		m_Workers.clear();
+		//anything still queued runs here, so no counter is left waiting forever
+		while (TryRunJob(0)) {}
+	}
+
+	void JobSystem::WorkerLoop(uint32_t queueIndex)
+	{
+		s_QueueIndex = queueIndex;
+		while (!m_Stopping) {
+			if (!TryRunJob(queueIndex)) {
+				std::unique_lock<std::mutex> lock(m_SleepMutex);
+				m_WakeUp.wait(lock, [this]() { return m_Stopping || m_QueuedJobs.load(std::memory_order_acquire) > 0; });
+			}
+		}
+	}
+
+	bool JobSystem::TryRunJob(uint32_t queueIndex)
+	{
+		if (m_QueuedJobs.load(std::memory_order_acquire) <= 0) {
+			return false;
+		}
+		Job job;
+		bool found = false;
+		uint32_t queueCount = (uint32_t)m_Queues.size();
+		if (queueIndex >= queueCount) {
+			queueIndex = 0;
+		}
+		//own queue first, newest job (most likely still in cache)
+		{
+			WorkQueue& own = *m_Queues[queueIndex];
+			std::lock_guard<std::mutex> lock(own.Mutex);
+			if (own.Jobs.size() > 0) {
+				job = std::move(own.Jobs.back());
+				own.Jobs.pop_back();
+				found = true;
+			}
+		}
+		//then steal the oldest job from the others (most likely the biggest piece of work left)
+		for (uint32_t i = 1; i < queueCount && !found; i++) {
+			WorkQueue& other = *m_Queues[(queueIndex + i) % queueCount];
+			std::lock_guard<std::mutex> lock(other.Mutex);
+			if (other.Jobs.size() > 0) {
+				job = std::move(other.Jobs.front());
+				other.Jobs.pop_front();
+				found = true;
+			}
+		}
+		if (!found) {
+			return false;
+		}
+		m_QueuedJobs.fetch_sub(1, std::memory_order_acq_rel);
+		job.Func();
+		if (job.Counter) {
+			job.Counter->Decrement();
+		}
+		return true;
+	}
+
+}
@@ -0,0 +1,162 @@
+#pragma once
+#include "tarapch.h"
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+namespace Tara {
+
+	/// <summary>
+	/// Counts the unfinished jobs in a group, so they can be waited on.
+	/// Counters can have a parent counter. While a counter has unfinished jobs, it counts as one unfinished job
+	/// of its parent, so waiting on the parent also waits on every child group.
+	/// A counter must outlive the jobs it counts.
+	/// </summary>
+	class JobCounter {
+		friend class JobSystem;
+	public:
+		/// <summary>
+		/// Construct a new job counter
+		/// </summary>
+		/// <param name="parent">the parent counter, may be null</param>
+		JobCounter(JobCounter* parent = nullptr)
+			: m_Pending(0), m_Parent(parent)
+		{}
+
+		JobCounter(JobCounter const&) = delete;
+		void operator=(JobCounter const&) = delete;
+
+		/// <summary>
+		/// Check if every job in the group (and child groups) has finished
+		/// </summary>
+		/// <returns>true if finished</returns>
+		inline bool IsDone() const { return m_Pending.load(std::memory_order_acquire) == 0; }
+
+		/// <summary>
+		/// Get the number of unfinished jobs in the group, with each unfinished child group counting as one
+		/// </summary>
+		/// <returns>the unfinished count</returns>
+		inline int32_t GetPending() const { return m_Pending.load(std::memory_order_acquire); }
+
+	private:
+		void Increment();
+		void Decrement();
+
+	private:
+		std::atomic<int32_t> m_Pending;
+		JobCounter* const m_Parent;
+	};
+
+
+	/// <summary>
+	/// JobSystem (Singleton)
+	/// A work-stealing job scheduler. Every worker thread has its own queue of jobs. It takes jobs from the back of its own queue,
+	/// and when that is empty, steals from the front of the others'.
+	/// Threads that are not workers (like the main thread) share one extra queue.
+	/// Waiting on a counter runs other jobs while waiting, so jobs can safely wait on jobs they spawn.
+	/// </summary>
+	class JobSystem {
+	private:
+		/// <summary>
+		/// Private Constructor.
+		/// </summary>
+		JobSystem();
+
+	public:
+		/// <summary>
+		/// Get the singleton JobSystem
+		/// </summary>
+		/// <returns>JobSystem pointer</returns>
+		static JobSystem* Get();
+		//singleton stuff
+		JobSystem(JobSystem const&) = delete;
+		void operator=(JobSystem const&) = delete;
+
+		~JobSystem();
+
+		/// <summary>
+		/// Queue a job to run on any thread
+		/// </summary>
+		/// <param name="job">the job</param>
+		/// <param name="counter">the counter to add the job to, may be null</param>
+		void Run(std::function<void()> job, JobCounter* counter = nullptr);
+
+		/// <summary>
+		/// Wait until every job in a counter's group has finished. Runs other jobs while waiting.
+		/// </summary>
+		/// <param name="counter">the counter</param>
+		void Wait(const JobCounter& counter);
+
+		/// <summary>
+		/// Run a function over the range [0, count), split into batches run as jobs. Blocks (helping) until every batch is done.
+		/// Batches may run in any order, on any thread. Safe to call from inside a job.
+		/// </summary>
+		/// <param name="count">the size of the range</param>
+		/// <param name="batchSize">how many indices each job handles. Larger batches mean less overhead but worse balancing</param>
+		/// <param name="func">the function, [void](size_t begin, size_t end){...}, called on [begin, end) sub-ranges</param>
+		void ParallelFor(size_t count, size_t batchSize, const std::function<void(size_t, size_t)>& func);
+
+		/// <summary>
+		/// Set the number of threads that run jobs, including the calling thread.
+		/// Restarts the workers. Must not be called while jobs are running.
+		/// </summary>
+		/// <param name="count">the thread count. 0 uses one per hardware thread</param>
+		void SetThreadCount(uint32_t count);
+
+		/// <summary>
+		/// Get the number of threads that run jobs, including the calling thread
+		/// </summary>
+		/// <returns>the thread count</returns>
+		inline uint32_t GetThreadCount() const { return (uint32_t)m_Workers.size() + 1; }
+
+	private:
+		/// <summary>
+		/// A queued job
+		/// </summary>
+		struct Job {
+			std::function<void()> Func;
+			JobCounter* Counter;
+		};
+
+		/// <summary>
+		/// A thread's queue. The owner uses the back, thieves use the front.
+		/// </summary>
+		struct WorkQueue {
+			std::mutex Mutex;
+			std::deque<Job> Jobs;
+		};
+
+		/// <summary>
+		/// Start the worker threads
+		/// </summary>
+		void Start(uint32_t count);
+
+		/// <summary>
+		/// Stop and join the worker threads
+		/// </summary>
+		void Stop();
+
+		/// <summary>
+		/// The worker thread main loop
+		/// </summary>
+		void WorkerLoop(uint32_t queueIndex);
+
+		/// <summary>
+		/// Run one job: from the back of a thread's own queue, or stolen from the front of another's
+		/// </summary>
+		/// <param name="queueIndex">the thread's own queue</param>
+		/// <returns>true if a job was run, false if there were none</returns>
+		bool TryRunJob(uint32_t queueIndex);
+
+	private:
+		std::vector<std::thread> m_Workers;
+		std::vector<std::unique_ptr<WorkQueue>> m_Queues; //0 is shared by non-worker threads, then one per worker
+		std::atomic<int32_t> m_QueuedJobs;
+		std::mutex m_SleepMutex;
+		std::condition_variable m_WakeUp;
+		std::atomic<bool> m_Stopping;
+	};
+
+}
@@ -1,14 +1,22 @@
 #include "tarapch.h"
 #include "Layer.h"
 #include "Tara/Renderer/Renderer.h"
+#include "Tara/Utility/Profiler.h"
+#include "Tara/Core/JobSystem.h"
+#include "Tara/Core/Application.h"
+#include "Tara/Core/Snapshot.h"
+#include <fstream>
 
 namespace Tara{
 	Layer::Layer()
+		: m_Slots(std::make_shared<LayerSlots>())
 	{
+		m_Slots->Owner = this;
 	}
 
 	Layer::~Layer()
 	{
+		m_Slots->Owner = nullptr;
 	}
 
 	void Layer::Activate()
@@ -21,83 +29,218 @@ namespace Tara{
 
 	void Layer::Update(float deltaTime)
 	{
-		for (auto entity : m_Entities) {
-			if (entity) {
-				entity->Update(deltaTime);
+		SCOPE_PROFILE("Layer::Update");
+		bool fixedTimestep = Application::Get()->GetFixedTimestepEnabled();
+		if (fixedTimestep) {
+			//the transforms as of the last tick, for drawables to interpolate from
+			for (auto& entity : m_Entities) {
+				if (entity) {
+					entity->SnapshotWorldTransform();
+				}
+			}
+			//frames can pass with no tick to enqueue the cameras again, so the queue is kept until the first tick after a draw
+			if (!m_UpdatedSinceDraw) {
+				m_CameraQueue.clear();
 			}
 		}
-		uint32_t cleanCount = 0;
-		for (auto it = m_DestroyedEntities.begin(); it != m_DestroyedEntities.end();) {
-			if (!it->lock()){
-				cleanCount++;
-				m_DestroyedEntities.erase(it++);
+		m_UpdatedSinceDraw = true;
+
+		//where the layer camera is, for tick LOD. Taken once, so every entity sees the same camera this update
+		m_TickLODHasCamera = false;
+		m_TickLODHasView = false;
+		if (m_LayerCamera && m_LayerCamera->Exists()) {
+			Transform t = m_LayerCamera->GetWorldTransform();
+			m_TickLODHasCamera = true;
+			m_TickLODCameraPosition = t.Position;
+			if (m_LayerCamera->GetProjectionType() == Camera::ProjectionType::Ortographic) {
+				auto extent = std::static_pointer_cast<OrthographicCamera>(m_LayerCamera->GetCamera())->GetExtent();
+				float left = t.Position.x + extent.Left * t.Scale.x, right = t.Position.x + extent.Right * t.Scale.x;
+				float bottom = t.Position.y + extent.Bottom * t.Scale.y, top = t.Position.y + extent.Top * t.Scale.y;
+				m_TickLODView = { std::min(left, right), std::min(bottom, top), 0.0f, std::abs(right - left), std::abs(top - bottom), 0.0f };
+				m_TickLODHasView = true;
 			}
-			else {
-				it++;
+		}
+		m_SkippedEntityTicks.store(0, std::memory_order_relaxed);
+		m_SkippedComponentTicks.store(0, std::memory_order_relaxed);
+
+		//queries from worker threads can't refresh the grid themselves, so bring it up to date before they can run
+		RefreshSpatialHash();
+		BeginStructuralPhase();
+		if (m_ParallelUpdate) {
+			UpdateParallel(deltaTime);
+		}
+		else {
+			for (auto& entity : m_Entities) {
+				if (entity) {
+					entity->Update(deltaTime);
+				}
 			}
 		}
+		EndStructuralPhase();
+		m_TickStats.SkippedEntityTicks = m_SkippedEntityTicks.load(std::memory_order_relaxed);
+		m_TickStats.SkippedComponentTicks = m_SkippedComponentTicks.load(std::memory_order_relaxed);
+		//compact in place. The vector keeps its capacity, so steady spawning and destroying does not allocate here
+		auto cleaned = std::remove_if(m_DestroyedEntities.begin(), m_DestroyedEntities.end(), [](const EntityNoRef& ref) { return ref.expired(); });
+		uint32_t cleanCount = (uint32_t)std::distance(cleaned, m_DestroyedEntities.end());
+		m_DestroyedEntities.erase(cleaned, m_DestroyedEntities.end());
 		if (cleanCount > 0) {
 			LOG_S(INFO) << "Entities Cleaned since last frame: " << cleanCount;
 		}
 	}
 
+	void Layer::SetTickGroupEnabled(uint32_t group, bool enabled)
+	{
+		CHECK_F(group < TICK_GROUP_COUNT, "Layer::SetTickGroupEnabled: group %u is out of range", group);
+		if (group == 0) {
+			LOG_S(WARNING) << "Layer::SetTickGroupEnabled: the default tick group (0) can't be turned off";
+			return;
+		}
+		if (enabled) {
+			m_DisabledTickGroups &= ~((uint32_t)1 << group);
+		}
+		else {
+			m_DisabledTickGroups |= ((uint32_t)1 << group);
+		}
+	}
+
+	float Layer::GetTickLODInterval(const Entity& entity) const
+	{
+		if (!m_TickLODHasCamera) {
+			return 0.0f;
+		}
+		const auto& policy = m_TickLODPolicy;
+		float interval = 0.0f;
+		Vector position = entity.GetWorldPosition();
+
+		if (policy.FarDistance > policy.NearDistance) {
+			Vector offset = position - m_TickLODCameraPosition;
+			float distance = std::sqrt(offset.x * offset.x + offset.y * offset.y + offset.z * offset.z);
+			float t = std::clamp((distance - policy.NearDistance) / (policy.FarDistance - policy.NearDistance), 0.0f, 1.0f);
+			interval = t * policy.FarInterval;
+		}
+
+		if (m_TickLODHasView && policy.OffscreenInterval > interval) {
+			BoundingBox box = entity.GetSpecificBoundingBox();
+			if (box.Width < 0) {
+				//no box, so just the position
+				box = { position.x, position.y, 0.0f, 0.0f, 0.0f, 0.0f };
+			}
+			bool onScreen = !(box.x + box.Width < m_TickLODView.x || m_TickLODView.x + m_TickLODView.Width < box.x ||
+				box.y + box.Height < m_TickLODView.y || m_TickLODView.y + m_TickLODView.Height < box.y);
+			if (!onScreen) {
+				interval = policy.OffscreenInterval;
+			}
+		}
+		return interval;
+	}
+
 	void Layer::Draw(float deltaTime)
 	{
+		SCOPE_PROFILE("Layer::Draw");
+		BeginStructuralPhase();
+		//culling uses the cached boxes, so bring them up to date if overlap handlers (or anything after them) moved entities
+		if (m_ViewCulling && m_BoundingBoxCacheStale.exchange(false, std::memory_order_relaxed)) {
+			SCOPE_PROFILE("Layer::Draw refresh bounds");
+			for (auto& entity : m_Entities) {
+				if (entity) {
+					entity->RefreshBoundingBoxCache();
+				}
+			}
+		}
+		bool fixedTimestep = Application::Get()->GetFixedTimestepEnabled();
+		m_DrawStats = Entity::DrawStats();
 		for (auto& cameranoref : m_CameraQueue) {
 			auto camera = cameranoref.lock();
 			if (camera) {
-				Tara::Renderer::BeginScene(camera->GetCamera());
-				uint32_t cameraBits = camera->GetCamera()->GetRenderFilterBits();
-				for (auto entity : m_Entities) {
-					if (entity) {
-						entity->Draw(deltaTime, cameraBits);
-					}
+				if (fixedTimestep) {
+					camera->SyncCameraTransform(true);
 				}
+				m_DrawCameras.push_back(camera->GetCamera());
+			}
+		}
 
-				Tara::Renderer::EndScene();
+		//with one camera, recording would only add work
+		bool useList = m_DrawListMode && m_DrawCameras.size() > 1;
+		bool listIsScreen = false;
+		if (useList) {
+			SCOPE_PROFILE("Layer::Draw record");
+			//recorded for the first camera. Cameras of the other kind (screen or not) lay out text differently, so they draw directly
+			listIsScreen = m_DrawCameras.front()->GetProjectionType() == Camera::ProjectionType::Screen;
+			//only what some camera that uses the list might see is recorded
+			BoundingBox recordView;
+			bool hasRecordView = m_ViewCulling;
+			bool firstView = true;
+			for (auto& camera : m_DrawCameras) {
+				if (hasRecordView && (camera->GetProjectionType() == Camera::ProjectionType::Screen) == listIsScreen) {
+					BoundingBox view;
+					hasRecordView = camera->GetViewBounds(view);
+					recordView = firstView ? view : recordView + view;
+					firstView = false;
+				}
 			}
+			m_DrawList.Clear();
+			Renderer::BeginRecording(m_DrawList, m_DrawCameras.front());
+			DrawRoots(deltaTime, ~0u, hasRecordView ? &recordView : nullptr, &m_DrawList);
+			Renderer::EndRecording();
 		}
-		
-		m_CameraQueue.clear();
-	}
 
-	void Layer::OnEvent(Event& e)
-	{
-		//LOG_S(INFO) << "Layer OnEvent called!";
-		m_InEventHandler = true;
-		std::list<EventListenerNoRef> removable;
-		for (auto& listener : m_Listeners) {
-			//LOG_S(INFO) << "Event listener OnEvent called!";
-			auto lockedListener = listener.lock();
-			if (lockedListener) {
-				//valid non-null listener
-				lockedListener->ReceiveEvent(e);
+		for (auto& camera : m_DrawCameras) {
+			Tara::Renderer::BeginScene(camera);
+			uint32_t cameraBits = camera->GetRenderFilterBits();
+			BoundingBox view;
+			const BoundingBox* viewBounds = (m_ViewCulling && camera->GetViewBounds(view)) ? &view : nullptr;
+			if (useList && (camera->GetProjectionType() == Camera::ProjectionType::Screen) == listIsScreen) {
+				for (auto& item : m_DrawList.GetItems()) {
+					if (DrawList::IsVisible(item, cameraBits, viewBounds)) {
+						m_DrawList.Submit(item);
+					}
+				}
 			}
 			else {
-				//add to removable list (don't want to remove now b/c of possible issues)
-				removable.push_back(listener);
-			}
-			if (e.Handled()) {
-				break;
+				DrawRoots(deltaTime, cameraBits, viewBounds, nullptr);
 			}
+			Tara::Renderer::EndScene();
 		}
-		//remove any that are no longer valid
-		for (auto listener : removable) {
-			m_Listeners.remove(listener);
+		m_DrawCameras.clear();
+		
+		if (!fixedTimestep) {
+			m_CameraQueue.clear();
 		}
-		m_InEventHandler = false;
+		m_UpdatedSinceDraw = false;
+		EndStructuralPhase();
+	}
 
-		//handle any enqued listener changes
-		for (auto ls : m_ListenerQueue) {
-			EnableListener(ls.first, ls.second);
+	void Layer::DrawRoots(float deltaTime, uint32_t cameraBits, const BoundingBox* viewBounds, DrawList* list)
+	{
+		for (auto& entity : m_Entities) {
+			if (entity) {
+				if (viewBounds && entity->IsOutsideView(*viewBounds)) {
+					m_DrawStats.CulledEntities += entity->m_CachedSubtreeCount;
+					continue;
+				}
+				entity->Draw(deltaTime, cameraBits, viewBounds, m_DrawStats, list);
+			}
 		}
-		m_ListenerQueue.clear();
+	}
+
+	void Layer::OnEvent(Event& e)
+	{
+		//LOG_S(INFO) << "Layer OnEvent called!";
+		m_Listeners.Dispatch(e);
 	}
 
 	bool Layer::AddEntity(EntityRef ref)
 	{
+		if (IsDeferringStructuralChanges()) {
+			DeferStructuralChange([this, ref]() { AddEntity(ref); });
+			return true;
+		}
 		if (!IsEntityRoot(ref)) {
-			m_Entities.push_back(ref);
+			Entity::PushSibling(m_Entities, ref);
+			m_SweepListDirty = true;
+			if (m_SpatialHash) {
+				m_SpatialHash->Update(ref, ref->GetFullBoundingBox());
+			}
 			return true;
 		}
 		return false;
@@ -105,85 +248,69 @@ namespace Tara{
 
 	bool Layer::RemoveEntity(EntityRef ref)
 	{
+		if (IsDeferringStructuralChanges()) {
+			DeferStructuralChange([this, ref]() { RemoveEntity(ref); });
+			return true;
+		}
 		if (!IsEntityRoot(ref)) {
 			return false;
 		}
-		m_Entities.remove(ref);
+		Entity::EraseSibling(m_Entities, ref, m_EntityHoles);
+		m_SweepListDirty = true;
+		if (m_SpatialHash) {
+			m_SpatialHash->Remove(ref);
+		}
 		return true;
 	}
 
-	bool Layer::IsEntityRoot(EntityRef ref)
+	bool Layer::IsEntityRoot(const EntityRef& ref)
 	{
-		return std::find(m_Entities.begin(), m_Entities.end(), ref) != m_Entities.end();
+		//an entity is either root or a child, so its stored index is only valid here if it is root
+		return ref && ref->m_SiblingIndex < m_Entities.size() && m_Entities[ref->m_SiblingIndex] == ref;
 	}
 
 	bool Layer::MoveEntityDown(EntityRef ref, bool toBottom)
 	{
-		auto f = std::find(m_Entities.begin(), m_Entities.end(), ref);
-		if (f == m_Entities.end()) {
-			//not a child
-			return false;
-		}
-		if (f == m_Entities.begin()) {
-			//it is already top
+		if (IsDeferringStructuralChanges()) {
+			DeferStructuralChange([this, ref, toBottom]() { MoveEntityDown(ref, toBottom); });
 			return true;
 		}
-		if (toBottom) {
-			//remove and re-insert at top
-			//erase is used so not to search the list again
-			m_Entities.erase(f);
-			m_Entities.push_front(ref);
-		}
-		else {
-			std::iter_swap(std::prev(f), f);
+		if (!IsEntityRoot(ref)) {
+			//not a child
+			return false;
 		}
+		Entity::CompactSiblings(m_Entities, m_EntityHoles);
+		Entity::MoveSiblingDown(m_Entities, ref, toBottom);
 		return true;
 	}
 	
 	bool Layer::MoveEntityUp(EntityRef ref, bool toTop)
 	{
-		auto f = std::find(m_Entities.begin(), m_Entities.end(), ref);
-		if (f == m_Entities.end()) {
-			//not a child
-			return false;
-		}
-		if (f == std::prev(m_Entities.end())) {
-			//it is already bottom
+		if (IsDeferringStructuralChanges()) {
+			DeferStructuralChange([this, ref, toTop]() { MoveEntityUp(ref, toTop); });
 			return true;
 		}
-		if (toTop) {
-			//remove and re-insert at top
-			//erase is used so not to search the list again
-			m_Entities.erase(f);
-			m_Entities.push_back(ref);
-		}
-		else {
-			std::iter_swap(f, std::next(f));
+		if (!IsEntityRoot(ref)) {
+			//not a child
+			return false;
 		}
+		Entity::CompactSiblings(m_Entities, m_EntityHoles);
+		Entity::MoveSiblingUp(m_Entities, ref, toTop);
 		return true;
 	}
 
 	bool Layer::EnableListener(EventListenerNoRef ref, bool enable)
 	{
-		if (m_InEventHandler) {
-			//enqueue, as running now will break Listener list
-			m_ListenerQueue.push_back(std::make_pair(ref, enable));
+		if (IsDeferringStructuralChanges()) {
+			DeferStructuralChange([this, ref, enable]() { EnableListener(ref, enable); });
 			return true;
 		}
 		if (enable){
-			//if the element is already in the list, move to front
-			auto f = std::find(m_Listeners.begin(), m_Listeners.end(), ref);
-			if (f != m_Listeners.end()) {
-				if (f == m_Listeners.begin()) {
-					return true;
-				}
-				m_Listeners.remove(ref);
-			}
-			m_Listeners.push_front(ref); //listeners are updated in REVERSE order
-			return true;
+			//adding again moves it to the front, as the most recently enabled listener gets events first
+			m_Listeners.Add(ref);
 		}
 		else {
-			m_Listeners.remove(ref);
+			m_Listeners.Remove(ref);
 		}
 		return true;
 	}
@@ -194,33 +321,124 @@ namespace Tara{
 		m_DestroyedEntities.push_back(ref);
 	}
 
+	void Layer::DeferStructuralChange(std::function<void()> func)
+	{
+		if (IsDeferringStructuralChanges()) {
+			//only contended during a parallel update
+			std::lock_guard<std::mutex> lock(m_CommandMutex);
+			m_CommandBuffer.push_back(std::move(func));
+		}
+		else {
+			func();
+		}
+	}
+
+	void Layer::FlushStructuralChanges()
+	{
+		if (IsDeferringStructuralChanges() || m_FlushingStructuralChanges) {
+			return;
+		}
+		m_FlushingStructuralChanges = true;
+		{
+			std::lock_guard<std::mutex> lock(m_CommandMutex);
+			m_FlushBuffer.swap(m_CommandBuffer);
+		}
+		//no longer deferring, so anything these change runs right away, in order
+		for (auto& func : m_FlushBuffer) {
+			func();
+		}
+		m_FlushBuffer.clear();
+		m_FlushingStructuralChanges = false;
+	}
+
+	void Layer::CompactHierarchy()
+	{
+		Entity::CompactSiblings(m_Entities, m_EntityHoles);
+		for (auto& handle : m_CompactQueue) {
+			Entity* entity = Resolve(handle);
+			if (entity) {
+				entity->CompactChildLists();
+			}
+		}
+		m_CompactQueue.clear();
+	}
+
+	void Layer::EndStructuralPhase()
+	{
+		if (--m_StructuralPhaseDepth == 0) {
+			FlushStructuralChanges();
+		}
+	}
+
+	void Layer::UpdateParallel(float deltaTime)
+	{
+		//split the roots. Done up front, and roots can't be added or removed until the update is done anyway
+		m_ParallelRoots.clear();
+		m_SerialRoots.clear();
+		for (auto& entity : m_Entities) {
+			if (entity) {
+				if (entity->GetParallelUpdateSafe()) {
+					m_ParallelRoots.push_back(entity);
+				}
+				else {
+					m_SerialRoots.push_back(entity);
+				}
+			}
+		}
+
+		{
+			SCOPE_PROFILE("Layer::UpdateParallel parallel phase");
+			m_InParallelUpdate.store(true, std::memory_order_release);
+			JobSystem::Get()->ParallelFor(m_ParallelRoots.size(), 16, [this, deltaTime](size_t begin, size_t end) {
+				for (size_t i = begin; i < end; i++) {
+					m_ParallelRoots[i]->Update(deltaTime);
+				}
+			});
+			m_InParallelUpdate.store(false, std::memory_order_release);
+		}
+
+		for (auto& entity : m_SerialRoots) {
+			entity->Update(deltaTime);
+		}
+		m_ParallelRoots.clear();
+		m_SerialRoots.clear();
+	}
+
 	void Layer::RunOverlapChecks()
 	{
+		SCOPE_PROFILE("Layer::RunOverlapChecks");
+		BeginStructuralPhase();
 		//clear manifolds
 		m_FrameManifoldQueue.clear();
 
-		// Set up queue
-		std::list<std::pair<EntityRef, EntityRef>> overlapQueue;
+		//refresh the cached bounding boxes once, so the checks below don't recompute them per pair
+		m_BoundingBoxCacheStale.store(false, std::memory_order_relaxed);
+		for (auto& entity : m_Entities) {
+			if (entity) {
+				entity->RefreshBoundingBoxCache();
+			}
+		}
+		//and move only the roots that moved since the last refresh in the spatial hash
+		RefreshSpatialHash();
 
 		//for all entities, check their own children
-		for (auto iter1 = m_Entities.begin(); iter1 != m_Entities.end(); iter1++) {
-			EntityRef entity1 = *iter1;
-			entity1->SelfOverlapChecks();
-			
-			//run all root x root, full AABB overlap check
-			auto iter2 = iter1;
-			iter2++;
-			for (; iter2 != m_Entities.end(); iter2++) {
-				EntityRef entity2 = *iter2;
-				if (entity1->GetFullBoundingBox().Overlaping(entity2->GetFullBoundingBox())) {
-					//for all that have overlaps, queue up
-					overlapQueue.push_back(std::make_pair(entity1, entity2 ));
-				}
+		for (auto& entity : m_Entities) {
+			if (entity) {
+				entity->SelfOverlapChecks();
 			}
 		}
 
+		// Set up queue of root x root full AABB overlaps
+		std::vector<std::pair<EntityRef, EntityRef>> overlapQueue;
+		if (m_OverlapBroadphase == OverlapBroadphase::SweepAndPrune) {
+			SweepAndPruneBroadphase(overlapQueue);
+		}
+		else {
+			BruteForceBroadphase(overlapQueue);
+		}
+
 		//when done, run OtherOverlapChecks on them
-		for (auto pair : overlapQueue) {
+		for (auto& pair : overlapQueue) {
 			pair.first->OtherOverlapChecks(pair.second);
 		}
 
@@ -228,31 +446,263 @@ namespace Tara{
 		for (Manifold m : m_FrameManifoldQueue) {
 			m.Resolve();
 		}
+		EndStructuralPhase();
 	}
 
+	void Layer::BruteForceBroadphase(std::vector<std::pair<EntityRef, EntityRef>>& overlapQueue)
+	{
+		for (auto iter1 = m_Entities.begin(); iter1 != m_Entities.end(); iter1++) {
+			const EntityRef& entity1 = *iter1;
+			if (!entity1) {
+				continue;
+			}
+			//run all root x root, full AABB overlap check
+			for (auto iter2 = std::next(iter1); iter2 != m_Entities.end(); iter2++) {
+				const EntityRef& entity2 = *iter2;
+				if (entity2 && entity1->GetCachedFullBoundingBox().Overlaping(entity2->GetCachedFullBoundingBox())) {
+					//for all that have overlaps, queue up
+					overlapQueue.push_back(std::make_pair(entity1, entity2));
+				}
+			}
+		}
+	}
 
-	std::list<EntityRef> Layer::GetAllEntitiesInBox(const BoundingBox& box)
+	void Layer::SweepAndPruneBroadphase(std::vector<std::pair<EntityRef, EntityRef>>& overlapQueue)
+	{
+		if (m_SweepListDirty) {
+			//roots were added or removed, rebuild from scratch
+			m_SweepList.clear();
+			m_SweepList.reserve(m_Entities.size());
+			for (auto& entity : m_Entities) {
+				if (!entity) {
+					continue;
+				}
+				const BoundingBox& box = entity->GetCachedFullBoundingBox();
+				m_SweepList.push_back({ entity, box.x, box.x + box.Width });
+			}
+			std::sort(m_SweepList.begin(), m_SweepList.end(), [](const SweepEntry& a, const SweepEntry& b) { return a.Min < b.Min; });
+			m_SweepListDirty = false;
+		}
+		else {
+			for (auto& entry : m_SweepList) {
+				const BoundingBox& box = entry.Entity->GetCachedFullBoundingBox();
+				entry.Min = box.x;
+				entry.Max = box.x + box.Width;
+			}
+			//insertion sort. Things move very little between frames, so the list is nearly sorted already and this is close to linear.
+			for (size_t i = 1; i < m_SweepList.size(); i++) {
+				if (!(m_SweepList[i].Min < m_SweepList[i - 1].Min)) {
+					continue;
+				}
+				SweepEntry entry = std::move(m_SweepList[i]);
+				size_t j = i;
+				while (j > 0 && entry.Min < m_SweepList[j - 1].Min) {
+					m_SweepList[j] = std::move(m_SweepList[j - 1]);
+					j--;
+				}
+				m_SweepList[j] = std::move(entry);
+			}
+		}
+
+		//sweep. Anything that starts after an entry ends on X cannot overlap it, or anything after.
+		for (size_t i = 0; i < m_SweepList.size(); i++) {
+			const SweepEntry& entry1 = m_SweepList[i];
+			for (size_t j = i + 1; j < m_SweepList.size() && m_SweepList[j].Min <= entry1.Max; j++) {
+				const SweepEntry& entry2 = m_SweepList[j];
+				if (entry1.Entity->GetCachedFullBoundingBox().Overlaping(entry2.Entity->GetCachedFullBoundingBox())) {
+					//order the pair the same way the brute force would (by root order)
+					if (entry1.Entity->m_SiblingIndex < entry2.Entity->m_SiblingIndex) {
+						overlapQueue.push_back(std::make_pair(entry1.Entity, entry2.Entity));
+					}
+					else {
+						overlapQueue.push_back(std::make_pair(entry2.Entity, entry1.Entity));
+					}
+				}
+			}
+		}
+
+		//and sort the pairs by root order, so overlap events happen in the same order as the brute force
+		std::sort(overlapQueue.begin(), overlapQueue.end(), [](const std::pair<EntityRef, EntityRef>& a, const std::pair<EntityRef, EntityRef>& b) {
+			if (a.first->m_SiblingIndex != b.first->m_SiblingIndex) {
+				return a.first->m_SiblingIndex < b.first->m_SiblingIndex;
+			}
+			return a.second->m_SiblingIndex < b.second->m_SiblingIndex;
+		});
+	}
+
+
+	bool Layer::SaveSnapshot(const std::string& path, bool compress) const
+	{
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		if (!file) {
+			LOG_S(ERROR) << "Layer: unable to open snapshot file for writing: " << path;
+			return false;
+		}
+		return SaveSnapshot(file, compress);
+	}
+
+	bool Layer::SaveSnapshot(std::ostream& stream, bool compress) const
+	{
+		SCOPE_PROFILE("Layer::SaveSnapshot");
+		return SnapshotRegistry::Get()->SaveLayer(*this, stream, compress);
+	}
+
+	bool Layer::LoadSnapshot(const std::string& path)
+	{
+		std::ifstream file(path, std::ios::binary);
+		if (!file) {
+			LOG_S(ERROR) << "Layer: unable to open snapshot file: " << path;
+			return false;
+		}
+		return LoadSnapshot(file);
+	}
+
+	bool Layer::LoadSnapshot(std::istream& stream)
+	{
+		SCOPE_PROFILE("Layer::LoadSnapshot");
+		return SnapshotRegistry::Get()->LoadLayer(*this, stream);
+	}
+
+	void Layer::EnableSpatialHash(float cellSize)
+	{
+		//drop anything queued while it was disabled. The whole grid is built below anyway
+		m_SpatialHash.reset();
+		RefreshSpatialHash();
+		m_SpatialHash = std::make_unique<SpatialHashGrid>(cellSize);
+		for (auto& entity : m_Entities) {
+			if (entity) {
+				m_SpatialHash->Update(entity, entity->GetFullBoundingBox());
+			}
+		}
+	}
+
+	void Layer::MarkSpatialHashDirty(Entity* entity)
+	{
+		if (!m_SpatialHash) {
+			return;
+		}
+		//the grid only holds roots, with their full box
+		Entity* root = entity;
+		for (Entity* parent = root->GetParentPtr(); parent; parent = parent->GetParentPtr()) {
+			root = parent;
+		}
+		std::lock_guard<std::mutex> lock(m_SpatialHashDirtyMutex);
+		if (!root->m_SpatialHashDirty) {
+			root->m_SpatialHashDirty = true;
+			m_SpatialHashDirty.push_back(root->GetHandle());
+		}
+	}
+
+	void Layer::RefreshSpatialHash()
+	{
+		for (auto& handle : m_SpatialHashDirty) {
+			Entity* entity = Resolve(handle);
+			if (!entity) {
+				continue;
+			}
+			entity->m_SpatialHashDirty = false;
+			//may have been parented, or not added to the layer yet
+			if (m_SpatialHash && entity->m_SiblingIndex < m_Entities.size() && m_Entities[entity->m_SiblingIndex].get() == entity) {
+				m_SpatialHash->Update(m_Entities[entity->m_SiblingIndex], entity->GetFullBoundingBox());
+			}
+		}
+		m_SpatialHashDirty.clear();
+	}
+
+	const std::vector<EntityRef>& Layer::GetQueryRoots(const std::function<void(std::vector<EntityRef>&)>& query, std::vector<EntityRef>& candidates)
 	{
-		std::list<EntityRef> Overlaps;
-		for (auto entity : m_Entities) {
+		if (!m_SpatialHash) {
+			return m_Entities;
+		}
+		//roots moved since the last refresh. Worker threads use the grid as of the start of the update instead
+		if (!IsInParallelUpdate()) {
+			RefreshSpatialHash();
+		}
+		query(candidates);
+		//keep results in root order, the same as without the hash
+		std::sort(candidates.begin(), candidates.end(), [](const EntityRef& a, const EntityRef& b) {
+			return a->m_SiblingIndex < b->m_SiblingIndex;
+		});
+		return candidates;
+	}
+
+	void Layer::QueryBox(const BoundingBox& box, std::vector<EntityRef>& results)
+	{
+		SCOPE_PROFILE("Layer::QueryBox");
+		CollectInBox(box, results, true);
+	}
+
+	void Layer::CollectInBox(const BoundingBox& box, std::vector<EntityRef>& results, bool includeRoots)
+	{
+		std::vector<EntityRef> candidates;
+		auto& roots = GetQueryRoots([&](std::vector<EntityRef>& c) { m_SpatialHash->QueryBox(box, c); }, candidates);
+		for (auto& entity : roots) {
+			if (!entity) {
+				continue;
+			}
 			if (box.Overlaping(entity->GetFullBoundingBox())) {
-				entity->GetAllChildrenInBox(box, Overlaps);
+				if (includeRoots && box.Overlaping(entity->GetSpecificBoundingBox())) {
+					results.push_back(entity);
+				}
+				entity->GetAllChildrenInBox(box, results);
 			}
 		}
-		return Overlaps;
 	}
 
-	std::list<EntityRef> Layer::GetAllEntitiesInRadius(Vector origin, float radius)
+	void Layer::QueryRadius(Vector origin, float radius, std::vector<EntityRef>& results)
 	{
-		std::list<EntityRef> Overlaps;
-		for (auto entity : m_Entities) {
+		SCOPE_PROFILE("Layer::QueryRadius");
+		CollectInRadius(origin, radius, results, true);
+	}
+
+	void Layer::CollectInRadius(Vector origin, float radius, std::vector<EntityRef>& results, bool includeRoots)
+	{
+		std::vector<EntityRef> candidates;
+		auto& roots = GetQueryRoots([&](std::vector<EntityRef>& c) { m_SpatialHash->QuerySphere(origin, radius, c); }, candidates);
+		for (auto& entity : roots) {
+			if (!entity) {
+				continue;
+			}
 			if (entity->GetFullBoundingBox().OverlappingSphere(origin, radius)) {
-				entity->GetAllChildrenInRadius(origin, radius, Overlaps);
+				if (includeRoots && entity->GetSpecificBoundingBox().OverlappingSphere(origin, radius)) {
+					results.push_back(entity);
+				}
+				entity->GetAllChildrenInRadius(origin, radius, results);
 			}
 		}
-		return Overlaps;
 	}
 
-	
+	void Layer::QueryRay(Vector origin, Vector direction, float length, std::vector<EntityRef>& results)
+	{
+		SCOPE_PROFILE("Layer::QueryRay");
+		std::vector<EntityRef> candidates;
+		auto& roots = GetQueryRoots([&](std::vector<EntityRef>& c) { m_SpatialHash->QueryRay(origin, direction, length, c); }, candidates);
+		for (auto& entity : roots) {
+			if (!entity) {
+				continue;
+			}
+			if (entity->GetFullBoundingBox().OverlappingRay(origin, direction, length)) {
+				if (entity->GetSpecificBoundingBox().OverlappingRay(origin, direction, length)) {
+					results.push_back(entity);
+				}
+				entity->GetAllChildrenOnRay(origin, direction, length, results);
+			}
+		}
+	}
+
+	std::list<EntityRef> Layer::GetAllEntitiesInBox(const BoundingBox& box)
+	{
+		//children only, as it has always been. QueryBox includes the roots
+		std::vector<EntityRef> overlaps;
+		CollectInBox(box, overlaps, false);
+		return std::list<EntityRef>(overlaps.begin(), overlaps.end());
+	}
+
+	std::list<EntityRef> Layer::GetAllEntitiesInRadius(Vector origin, float radius)
+	{
+		std::vector<EntityRef> overlaps;
+		CollectInRadius(origin, radius, overlaps, false);
+		return std::list<EntityRef>(overlaps.begin(), overlaps.end());
+	}
 
 }
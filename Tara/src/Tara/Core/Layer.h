@@ -3,8 +3,14 @@
 #include "Tara/Input/Event.h"
 #include "Tara/Core/Entity.h"
 #include "Tara/Input/EventListener.h"
+#include "Tara/Input/ListenerRegistry.h"
 #include "Tara/Input/Manifold.h"
 #include "Tara/Entities/CameraEntity.h"
+#include "Tara/Core/SpatialHashGrid.h"
+#include "Tara/Core/Handle.h"
+#include "Tara/Renderer/DrawList.h"
+#include <atomic>
+#include <mutex>
 
 namespace Tara {
 
@@ -21,6 +27,17 @@ namespace Tara {
 
 		friend class Entity;
 		friend class Scene;
+		friend class SnapshotRegistry;
+		friend class Prefab;
+	public:
+		/// <summary>
+		/// The method used to find which root entities might overlap each other
+		/// </summary>
+		enum class OverlapBroadphase : uint8_t {
+			BruteForce,		//test every pair of root entities
+			SweepAndPrune	//keep roots sorted along X between frames, and only test neighbors
+		};
+
 	public:
 		/// <summary>
 		/// Layer Constructor
@@ -74,7 +91,36 @@ namespace Tara {
 		/// </summary>
 		/// <param name="ref">the entity to check for</param>
 		/// <returns>true if present, false otherwise</returns>
-		bool IsEntityRoot(EntityRef ref);
+		bool IsEntityRoot(const EntityRef& ref);
+
+		/// <summary>
+		/// Get the entity a handle refers to. O(1), and nothing is locked or reference counted.
+		/// The handle must come from an entity of this layer (see Entity::GetHandle)
+		/// </summary>
+		/// <param name="handle">the handle</param>
+		/// <returns>the entity, or null if it was destroyed</returns>
+		inline Entity* Resolve(EntityHandle handle) const { return m_Slots->Entities.Resolve(handle); }
+
+		/// <summary>
+		/// Get the component a handle refers to. O(1), and nothing is locked or reference counted.
+		/// The handle must come from a component on an entity of this layer (see Component::GetHandle)
+		/// </summary>
+		/// <param name="handle">the handle</param>
+		/// <returns>the component, or null if it was removed from its entity</returns>
+		inline Component* Resolve(ComponentHandle handle) const { return m_Slots->Components.Resolve(handle); }
+
+		/// <summary>
+		/// Check if a handle refers to an entity that still exists. O(1)
+		/// </summary>
+		/// <param name="handle">the handle</param>
+		/// <returns>true if it exists</returns>
+		inline bool Exists(EntityHandle handle) const { return m_Slots->Entities.IsLive(handle); }
+
+		/// <summary>
+		/// Get the slot tables of this layer, which handles are resolved through
+		/// </summary>
+		/// <returns>the slot tables</returns>
+		inline const LayerSlotsRef& GetSlots() const { return m_Slots; }
 
 		/// <summary>
 		/// Move an entity up by one or to top in the entity list. Check if the entity is root.
@@ -93,7 +139,9 @@ namespace Tara {
 		bool MoveEntityDown(EntityRef ref, bool toBottom = false);
 
 		/// <summary>
-		/// Enable/Disable a specific reference as a listener
+		/// Enable/Disable a specific reference as a listener.
+		/// Native window events are only dispatched to listeners subscribed to one of their categories (see EventListener::SetEventCategories).
+		/// Enabling a listener again moves it to the front.
 		/// </summary>
 		/// <param name="ref">the reference</param>
 		/// <param name="enable">if it should be enabled</param>
@@ -114,14 +162,119 @@ namespace Tara {
 		void RunOverlapChecks();
 
 		/// <summary>
-		/// Get a list of all the entities that overlap a bounding box
+		/// Set the broadphase used for root entity overlap checks. Defaults to SweepAndPrune.
+		/// Both produce the same overlaps, in the same order.
+		/// </summary>
+		/// <param name="broadphase">the new broadphase</param>
+		inline void SetOverlapBroadphase(OverlapBroadphase broadphase) { m_OverlapBroadphase = broadphase; m_SweepListDirty = true; }
+
+		/// <summary>
+		/// Get the broadphase used for root entity overlap checks.
+		/// </summary>
+		/// <returns>the current broadphase</returns>
+		inline OverlapBroadphase GetOverlapBroadphase() const { return m_OverlapBroadphase; }
+
+		/// <summary>
+		/// Enable or disable parallel update. When enabled, root entities marked safe for parallel update
+		/// (Entity::SetParallelUpdateSafe) are updated as jobs on the JobSystem first, then the rest are updated on the main thread.
+		/// Hierarchy changes, Destroy and SendEvent are deferred during updates anyway (see DeferStructuralChange), so workers never touch the hierarchy.
+		/// Cached world transforms are not filled in during the parallel phase, so workers can read any entity's transform (and tick LOD) safely.
+		/// </summary>
+		/// <param name="enable">true to enable</param>
+		inline void SetParallelUpdate(bool enable) { m_ParallelUpdate = enable; }
+
+		/// <summary>
+		/// Get if parallel update is enabled
+		/// </summary>
+		/// <returns>true if enabled</returns>
+		inline bool GetParallelUpdate() const { return m_ParallelUpdate; }
+
+		/// <summary>
+		/// Check if the layer is in its parallel update phase
+		/// </summary>
+		/// <returns>true if root entities are being updated on worker threads right now</returns>
+		inline bool IsInParallelUpdate() const { return m_InParallelUpdate.load(std::memory_order_acquire); }
+
+		/// <summary>
+		/// Check if structural changes are being deferred. They are while the layer updates, checks overlaps, or draws its entities,
+		/// as those iterate the entity and component vectors.
+		/// </summary>
+		/// <returns>true if structural changes are deferred</returns>
+		inline bool IsDeferringStructuralChanges() const { return m_StructuralPhaseDepth > 0; }
+
+		/// <summary>
+		/// Run a structural change (adding, removing, moving, or destroying entities and components). While structural changes are deferred,
+		/// the function is recorded in the layer's command buffer instead, and run at the end of the phase, on the main thread,
+		/// in the order the changes were made (per thread, during a parallel update). Otherwise it is run right away.
+		/// Safe to call from worker threads.
+		/// </summary>
+		/// <param name="func">the function</param>
+		void DeferStructuralChange(std::function<void()> func);
+
+		/// <summary>
+		/// Apply every recorded structural change. This is the layer's sync point, and is called automatically at the end of
+		/// Update, RunOverlapChecks and Draw. Changes made by the recorded changes are applied right away.
+		/// Does nothing while structural changes are being deferred, or from inside a flush.
+		/// </summary>
+		void FlushStructuralChanges();
+
+		/// <summary>
+		/// Enable the spatial hash grid for this layer. When enabled, spatial queries only look at root entities
+		/// in the grid cells they touch, instead of every root entity.
+		/// Roots whose subtree moved or changed bounds are refreshed before each query, before each update and during
+		/// overlap checks. Untouched roots cost nothing per frame. During a parallel update, queries see the grid
+		/// as of the start of the update.
+		/// </summary>
+		/// <param name="cellSize">the width of a grid cell in world units. Should be around the size of the common entity.</param>
+		void EnableSpatialHash(float cellSize = 8.0f);
+
+		/// <summary>
+		/// Disable the spatial hash grid for this layer. Spatial queries will look at every root entity.
+		/// </summary>
+		inline void DisableSpatialHash() { m_SpatialHash.reset(); }
+
+		/// <summary>
+		/// Get if the spatial hash grid is enabled for this layer
+		/// </summary>
+		/// <returns>true if enabled</returns>
+		inline bool GetSpatialHashEnabled() const { return (bool)m_SpatialHash; }
+
+		/// <summary>
+		/// Append every entity (root or child) whose bounding box overlaps a box.
+		/// Results are in hierarchy order.
+		/// </summary>
+		/// <param name="box">The box to check with</param>
+		/// <param name="results">the vector to append to</param>
+		void QueryBox(const BoundingBox& box, std::vector<EntityRef>& results);
+
+		/// <summary>
+		/// Append every entity (root or child) whose bounding box overlaps a circle/sphere.
+		/// Results are in hierarchy order.
+		/// </summary>
+		/// <param name="origin">the position</param>
+		/// <param name="radius">the radius</param>
+		/// <param name="results">the vector to append to</param>
+		void QueryRadius(Vector origin, float radius, std::vector<EntityRef>& results);
+
+		/// <summary>
+		/// Append every entity (root or child) whose bounding box is hit by a ray segment.
+		/// The segment runs from origin to origin + (direction * length). Results are in hierarchy order, not hit order.
+		/// </summary>
+		/// <param name="origin">the start of the ray</param>
+		/// <param name="direction">the direction of the ray</param>
+		/// <param name="length">how far along the direction the ray goes</param>
+		/// <param name="results">the vector to append to</param>
+		void QueryRay(Vector origin, Vector direction, float length, std::vector<EntityRef>& results);
+
+		/// <summary>
+		/// Get a list of all the child entities that overlap a bounding box. Root entities are not included.
 		/// </summary>
 		/// <param name="box">The box to check with</param>
 		/// <returns>a list of all entities</returns>
 		std::list<EntityRef> GetAllEntitiesInBox(const BoundingBox& box);
 
 		/// <summary>
-		/// Get a list of all the entities that overlap a circle/sphere
+		/// Get a list of all the child entities that overlap a circle/sphere. Root entities are not included.
 		/// </summary>
 		/// <param name="origin">the position</param>
 		/// <param name="radius"></param>
@@ -171,17 +324,260 @@ namespace Tara {
 			m_CameraQueue.insert(camera);
 		}
 
+		/// <summary>
+		/// How entities that opt in with Entity::SetTickLODEnabled tick, by their distance from the layer camera.
+		/// Within NearDistance, they tick every update. From there to FarDistance, their interval grows linearly up to FarInterval.
+		/// With an orthographic layer camera, entities entirely off screen tick at OffscreenInterval instead, if that is longer.
+		/// An entity's own tick interval is a minimum, and is never shortened.
+		/// </summary>
+		struct TickLODPolicy {
+			float NearDistance = 0.0f;
+			float FarDistance = 0.0f;
+			float FarInterval = 0.2f; //5 Hz
+			float OffscreenInterval = 0.0f;
+		};
+
+		/// <summary>
+		/// Counts of ticks that were skipped in the last update, by disabled entities, disabled tick groups, tick intervals, and LOD.
+		/// When an entity skips its tick, its whole subtree is skipped with it, and every entity and component in it is counted.
+		/// Subtree sizes are taken from the last overlap checks, so they lag a frame behind hierarchy changes.
+		/// </summary>
+		struct TickStats {
+			uint32_t SkippedEntityTicks = 0;
+			uint32_t SkippedComponentTicks = 0;
+		};
+
+		/// <summary>
+		/// Turn a tick group on or off. Entities and components in a group that is off are not updated, and don't build up time.
+		/// </summary>
+		/// <param name="group">the group, less than TICK_GROUP_COUNT. Group 0 can't be turned off</param>
+		/// <param name="enabled">true to tick the group</param>
+		void SetTickGroupEnabled(uint32_t group, bool enabled);
+
+		/// <summary>
+		/// Check if a tick group is on
+		/// </summary>
+		/// <param name="group">the group</param>
+		/// <returns>true if on</returns>
+		inline bool GetTickGroupEnabled(uint32_t group) const { return !(m_DisabledTickGroups & ((uint32_t)1 << group)); }
+
+		/// <summary>
+		/// Set the tick LOD policy
+		/// </summary>
+		/// <param name="policy">the policy</param>
+		inline void SetTickLODPolicy(const TickLODPolicy& policy) { m_TickLODPolicy = policy; }
+
+		/// <summary>
+		/// Get the tick LOD policy
+		/// </summary>
+		/// <returns>the policy</returns>
+		inline const TickLODPolicy& GetTickLODPolicy() const { return m_TickLODPolicy; }
+
+		/// <summary>
+		/// Get the tick interval the LOD policy gives an entity, this update
+		/// </summary>
+		/// <param name="entity">the entity</param>
+		/// <returns>the interval, in seconds</returns>
+		float GetTickLODInterval(const Entity& entity) const;
+
+		/// <summary>
+		/// Get the tick statistics of the last update
+		/// </summary>
+		/// <returns>the statistics</returns>
+		inline const TickStats& GetTickStats() const { return m_TickStats; }
+
+		/// <summary>
+		/// Count skipped ticks, for the statistics. Called by entities while updating. Safe from any thread.
+		/// </summary>
+		/// <param name="entities">the number of entity ticks skipped</param>
+		/// <param name="components">the number of component ticks skipped</param>
+		inline void CountSkippedTicks(uint32_t entities, uint32_t components) {
+			if (entities > 0) { m_SkippedEntityTicks.fetch_add(entities, std::memory_order_relaxed); }
+			if (components > 0) { m_SkippedComponentTicks.fetch_add(components, std::memory_order_relaxed); }
+		}
+
+		/// <summary>
+		/// Turn culling of entities outside of the camera's view on or off. On by default.
+		/// When on, entities whose cached full bounding box (see Entity::IsOutsideView) misses the view bounds of the camera being drawn are skipped,
+		/// along with their children. Boxes are refreshed during overlap checks, and again before drawing if anything moved since.
+		/// With a fixed timestep, the boxes as of the previous tick are checked too, so interpolated entities aren't culled while still in view.
+		/// </summary>
+		/// <param name="enabled">true to cull</param>
+		inline void SetViewCulling(bool enabled) { m_ViewCulling = enabled; }
+
+		/// <summary>
+		/// Check if view culling is on
+		/// </summary>
+		/// <returns>true if on</returns>
+		inline bool GetViewCulling() const { return m_ViewCulling; }
+
+		/// <summary>
+		/// Get the counts of entities drawn and culled in the last draw, summed over every camera
+		/// </summary>
+		/// <returns>the statistics</returns>
+		inline const Entity::DrawStats& GetDrawStats() const { return m_DrawStats; }
+
+		/// <summary>
+		/// Turn draw list mode on or off. Off by default.
+		/// When on, and more than one camera is queued, the entities are drawn once per frame into a DrawList (one item per entity, with its
+		/// bounds and render filter bits), which is then filtered and submitted to each camera, rather than drawing every entity again per camera.
+		/// Screen cameras and other cameras lay out text differently, so only cameras of the same kind as the first share the list.
+		/// Entities should not draw differently based on which camera is drawing them.
+		/// </summary>
+		/// <param name="enabled">true to use a draw list</param>
+		inline void SetDrawListMode(bool enabled) { m_DrawListMode = enabled; }
+
+		/// <summary>
+		/// Check if draw list mode is on
+		/// </summary>
+		/// <returns>true if on</returns>
+		inline bool GetDrawListMode() const { return m_DrawListMode; }
+
+		/// <summary>
+		/// Get the draw list recorded in the last draw. Empty unless draw list mode is on and several cameras were drawn.
+		/// </summary>
+		/// <returns>the draw list</returns>
+		inline const DrawList& GetDrawList() const { return m_DrawList; }
+
+		/// <summary>
+		/// Save every entity in the layer (with their children, components, and tilemap data) to a binary snapshot file.
+		/// Entity and component types are saved with the functions registered in SnapshotRegistry.
+		/// </summary>
+		/// <param name="path">the file path</param>
+		/// <param name="compress">true to compress the snapshot</param>
+		/// <returns>true if successful</returns>
+		bool SaveSnapshot(const std::string& path, bool compress = true) const;
+
+		/// <summary>
+		/// Save every entity in the layer to a binary snapshot, written to a stream
+		/// </summary>
+		/// <param name="stream">the stream, opened in binary mode</param>
+		/// <param name="compress">true to compress the snapshot</param>
+		/// <returns>true if successful</returns>
+		bool SaveSnapshot(std::ostream& stream, bool compress = true) const;
+
+		/// <summary>
+		/// Load the entities in a binary snapshot file into the layer, after the entities already in it.
+		/// The assets the entities use (sprites, fonts, tilesets) must already be loaded, under the same names.
+		/// Can't be called while the layer is updating or drawing.
+		/// </summary>
+		/// <param name="path">the file path</param>
+		/// <returns>true if successful. If loading fails partway, the entities loaded before the failure stay in the layer</returns>
+		bool LoadSnapshot(const std::string& path);
+
+		/// <summary>
+		/// Load the entities in a binary snapshot, read from a stream, into the layer
+		/// </summary>
+		/// <param name="stream">the stream, opened in binary mode</param>
+		/// <returns>true if successful</returns>
+		bool LoadSnapshot(std::istream& stream);
+
 	protected:
 		/// <summary>
-		/// Get a const ref to the list of entities that are root in this layer
+		/// Get a const ref to the list of entities that are root in this layer.
+		/// Removed roots leave holes that are compacted out later, so this compacts first if there are any.
 		/// </summary>
 		/// <returns>const ref to list of entities that are root in this layer</returns>
-		const std::list<EntityRef>& GetEntityList() const { return m_Entities; }
+		const std::vector<EntityRef>& GetEntityList() const { if (m_EntityHoles > 0) { const_cast<Layer*>(this)->CompactHierarchy(); } return m_Entities; }
 
 
 	private:
 		inline void AddManifoldToQueue(Manifold&& m) {m_FrameManifoldQueue.push_back(m);}
 
+		/// <summary>
+		/// Find overlapping root entities by testing every pair
+		/// </summary>
+		/// <param name="overlapQueue">the vector to add overlapping pairs to</param>
+		void BruteForceBroadphase(std::vector<std::pair<EntityRef, EntityRef>>& overlapQueue);
+
+		/// <summary>
+		/// Find overlapping root entities with the persistent sweep list
+		/// </summary>
+		/// <param name="overlapQueue">the vector to add overlapping pairs to</param>
+		void SweepAndPruneBroadphase(std::vector<std::pair<EntityRef, EntityRef>>& overlapQueue);
+
+		/// <summary>
+		/// Get the root entities a spatial query needs to look at. All of them, or only the nearby ones if the spatial hash is enabled.
+		/// </summary>
+		/// <param name="query">a function that fills a vector with candidates from the spatial hash</param>
+		/// <param name="candidates">storage for the candidates, if the spatial hash is used</param>
+		/// <returns>the roots to check, in root order</returns>
+		const std::vector<EntityRef>& GetQueryRoots(const std::function<void(std::vector<EntityRef>&)>& query, std::vector<EntityRef>& candidates);
+
+		/// <summary>
+		/// Append every entity whose bounding box overlaps a box, optionally leaving out the roots
+		/// </summary>
+		/// <param name="box">The box to check with</param>
+		/// <param name="results">the vector to append to</param>
+		/// <param name="includeRoots">if the root entities are included</param>
+		void CollectInBox(const BoundingBox& box, std::vector<EntityRef>& results, bool includeRoots);
+
+		/// <summary>
+		/// Append every entity whose bounding box overlaps a circle/sphere, optionally leaving out the roots
+		/// </summary>
+		/// <param name="origin">the position</param>
+		/// <param name="radius">the radius</param>
+		/// <param name="results">the vector to append to</param>
+		/// <param name="includeRoots">if the root entities are included</param>
+		void CollectInRadius(Vector origin, float radius, std::vector<EntityRef>& results, bool includeRoots);
+
+		/// <summary>
+		/// Update the root entities, with the parallel-safe ones split across the JobSystem
+		/// </summary>
+		/// <param name="deltaTime">the delta time</param>
+		void UpdateParallel(float deltaTime);
+
+		/// <summary>
+		/// Draw the root entities, skipping those outside the view
+		/// </summary>
+		/// <param name="deltaTime">the delta time</param>
+		/// <param name="cameraBits">the render filter bits of the camera</param>
+		/// <param name="viewBounds">the view bounds to cull against, or null</param>
+		/// <param name="list">the draw list being recorded, or null to draw directly</param>
+		void DrawRoots(float deltaTime, uint32_t cameraBits, const BoundingBox* viewBounds, DrawList* list);
+
+		/// <summary>
+		/// Start a phase that iterates the entities, deferring structural changes until the matching EndStructuralPhase.
+		/// The outermost phase compacts the hierarchy first, so phases never see holes, and never compact during one.
+		/// </summary>
+		inline void BeginStructuralPhase() { if (m_StructuralPhaseDepth++ == 0) { CompactHierarchy(); } }
+
+		/// <summary>
+		/// Queue an entity to have the holes compacted out of its child and component vectors
+		/// </summary>
+		/// <param name="entity">the entity</param>
+		inline void QueueCompaction(Entity* entity) { m_CompactQueue.push_back(entity->GetHandle()); }
+
+		/// <summary>
+		/// Compact the holes left by removals out of the root vector, and the child and component vectors of queued entities.
+		/// Removals only null their entry, so this is where their cost is paid: once per vector per sync point, not once per removal.
+		/// </summary>
+		void CompactHierarchy();
+
+		/// <summary>
+		/// End a phase started with BeginStructuralPhase. Flushes the recorded changes when the outermost phase ends.
+		/// </summary>
+		void EndStructuralPhase();
+
+		/// <summary>
+		/// Queue the root of an entity to have its spatial hash cells refreshed. Called when the entity's transform changes.
+		/// Safe to call from worker threads.
+		/// </summary>
+		/// <param name="entity">the entity that moved</param>
+		void MarkSpatialHashDirty(Entity* entity);
+
+		/// <summary>
+		/// Note that an entity moved since the bounding box cache was refreshed, so Draw refreshes it before culling.
+		/// Safe to call from worker threads.
+		/// </summary>
+		inline void MarkBoundingBoxCacheStale() { m_BoundingBoxCacheStale.store(true, std::memory_order_relaxed); }
+
+		/// <summary>
+		/// Move the queued roots to the cells their full bounding box now covers.
+		/// Main thread only, and not during a parallel update.
+		/// </summary>
+		void RefreshSpatialHash();
+
 	private:
 
 		struct CameraHasher {
@@ -190,15 +586,56 @@ namespace Tara {
 			}
 		};
 
-		std::list<EntityRef> m_Entities;
-		std::list<EntityNoRef> m_DestroyedEntities;
-		std::list<EventListenerNoRef> m_Listeners;
-		std::list<std::pair<EventListenerNoRef, bool>> m_ListenerQueue;
+		/// <summary>
+		/// An entry in the sweep and prune list. Holds the X span of the root's full bounding box
+		/// </summary>
+		struct SweepEntry {
+			EntityRef Entity;
+			float Min;
+			float Max;
+		};
+
+		std::vector<EntityRef> m_Entities;
+		uint32_t m_EntityHoles = 0; //null entries left by removals in m_Entities, until compacted
+		std::vector<EntityHandle> m_CompactQueue; //entities with holes in their child or component vectors
+		std::vector<EntityNoRef> m_DestroyedEntities;
+		LayerSlotsRef m_Slots; //shared with the entities and components, so they can free their slots after the layer is gone
+		ListenerRegistry m_Listeners;
 		std::list<Manifold> m_FrameManifoldQueue;
 		std::unordered_set<CameraEntityNoRef, CameraHasher> m_CameraQueue;
 		CameraEntityRef m_LayerCamera; //intentonally an owning pointer
+		std::vector<SweepEntry> m_SweepList; //kept sorted by Min between frames
+		std::unique_ptr<SpatialHashGrid> m_SpatialHash; //null unless enabled
+		std::vector<EntityHandle> m_SpatialHashDirty; //roots that moved since their cells were last refreshed
+		std::mutex m_SpatialHashDirtyMutex;
+		OverlapBroadphase m_OverlapBroadphase = OverlapBroadphase::SweepAndPrune;
+		bool m_SweepListDirty = true; //set when roots are added or removed
 		bool m_Dead = false; //used by Scene to destroy layers
-		bool m_InEventHandler = false;
+		bool m_ParallelUpdate = false;
+		bool m_UpdatedSinceDraw = false; //set by Update, cleared by Draw
+		std::atomic<bool> m_InParallelUpdate = false;
+		uint32_t m_StructuralPhaseDepth = 0; //only changed on the main thread, outside the parallel phase
+		bool m_FlushingStructuralChanges = false;
+		std::mutex m_CommandMutex;
+		std::vector<std::function<void()>> m_CommandBuffer; //guarded by m_CommandMutex
+		std::vector<std::function<void()>> m_FlushBuffer; //swapped with the command buffer while flushing, so neither reallocates in steady state
+		std::vector<EntityRef> m_ParallelRoots; //reused every frame
+		std::vector<EntityRef> m_SerialRoots; //reused every frame
+		uint32_t m_DisabledTickGroups = 0; //one bit per tick group
+		TickLODPolicy m_TickLODPolicy;
+		bool m_TickLODHasCamera = false; //the camera state below is only valid if set. Refreshed at the start of every update
+		Vector m_TickLODCameraPosition;
+		bool m_TickLODHasView = false;
+		BoundingBox m_TickLODView; //world space area the camera sees, for orthographic cameras
+		std::atomic<uint32_t> m_SkippedEntityTicks = 0;
+		std::atomic<uint32_t> m_SkippedComponentTicks = 0;
+		TickStats m_TickStats;
+		bool m_ViewCulling = true;
+		std::atomic<bool> m_BoundingBoxCacheStale = true; //set when anything moves after the overlap checks refreshed the cache
+		Entity::DrawStats m_DrawStats;
+		bool m_DrawListMode = false;
+		DrawList m_DrawList; //kept between frames, so it doesn't reallocate
+		std::vector<CameraRef> m_DrawCameras; //reused every frame
 	};
 
 
@@ -212,9 +649,10 @@ namespace Tara {
 	{
 		static_assert(std::is_base_of<Entity, T>::value, "Provided class is not a subclass of Tara::Entity");
 
-		std::list<EntityRef> PotentialOverlaps = GetAllEntitiesInBox(box);
+		std::vector<EntityRef> PotentialOverlaps;
+		CollectInBox(box, PotentialOverlaps, false);
 		std::list<std::shared_ptr<T>> Overlaps;
-		for (auto entity : PotentialOverlaps) {
+		for (auto& entity : PotentialOverlaps) {
 			std::shared_ptr<T> target = std::dynamic_pointer_cast<T>(entity);
 			if (target) {
 				Overlaps.push_back(target);
@@ -228,9 +666,10 @@ namespace Tara {
 	{
 		static_assert(std::is_base_of<Entity, T>::value, "Provided class is not a subclass of Tara::Entity");
 
-		std::list<EntityRef> PotentialOverlaps = GetAllEntitiesInRadius(origin, radius);
+		std::vector<EntityRef> PotentialOverlaps;
+		CollectInRadius(origin, radius, PotentialOverlaps, false);
 		std::list<std::shared_ptr<T>> Overlaps;
-		for (auto entity : PotentialOverlaps) {
+		for (auto& entity : PotentialOverlaps) {
 			std::shared_ptr<T> target = std::dynamic_pointer_cast<T>(entity);
 			if (target) {
 				Overlaps.push_back(target);
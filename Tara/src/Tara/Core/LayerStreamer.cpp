@@ -0,0 +1,358 @@
+#include "tarapch.h"
+#include "LayerStreamer.h"
+#include "Tara/Core/Scene.h"
+#include "Tara/Asset/AssetLibrary.h"
+#include "Tara/Utility/Profiler.h"
+#include "stb_image.h"
+#include <chrono>
+
+namespace Tara {
+
+	/*****************************************************************
+	 *                           LayerLoad                           *
+	 *****************************************************************/
+
+	LayerLoad::LayerLoad(LayerBuildFunction&& build, bool overlay)
+		: m_Build(std::move(build)), m_Overlay(overlay), m_State(State::Queued), m_BuildProgress(0.0f),
+		m_CancelRequested(false), m_StepsRun(0), m_StepCount(0)
+	{}
+
+	float LayerLoad::GetProgress() const
+	{
+		switch (GetState()) {
+		case State::Queued: return 0.0f;
+		case State::Integrating: return LAYER_LOAD_BUILD_SHARE + (1.0f - LAYER_LOAD_BUILD_SHARE) * GetIntegrationProgress();
+		case State::Done: return 1.0f;
+		default: return LAYER_LOAD_BUILD_SHARE * GetBuildProgress();
+		}
+	}
+
+	float LayerLoad::GetIntegrationProgress() const
+	{
+		if (GetState() == State::Done) {
+			return 1.0f;
+		}
+		uint32_t count = m_StepCount.load(std::memory_order_relaxed);
+		if (count == 0) {
+			return 0.0f;
+		}
+		return std::min((float)m_StepsRun.load(std::memory_order_relaxed) / (float)count, 1.0f);
+	}
+
+	LayerRef LayerLoad::GetLayer() const
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		return (m_State.load(std::memory_order_relaxed) == State::Done) ? m_Layer : nullptr;
+	}
+
+	std::string LayerLoad::GetError() const
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		return m_Error;
+	}
+
+	void LayerLoad::Cancel()
+	{
+		m_CancelRequested.store(true, std::memory_order_relaxed);
+		//a running build is left to notice the request. Anything else can be dropped now.
+		//the layer and steps are released outside the lock, as destroying them may run arbitrary code
+		LayerRef layer;
+		std::deque<std::function<void()>> steps;
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			State state = m_State.load(std::memory_order_relaxed);
+			if (state != State::Queued && state != State::Integrating) {
+				return;
+			}
+			layer = std::move(m_Layer);
+			steps = std::move(m_Steps);
+			m_Steps.clear();
+			m_State.store(State::Cancelled, std::memory_order_release);
+		}
+	}
+
+	bool LayerLoad::Finish(State state)
+	{
+		LayerRef layer;
+		std::deque<std::function<void()>> steps;
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			if (m_State.load(std::memory_order_relaxed) >= State::Done) {
+				return false;
+			}
+			if (state != State::Done) {
+				layer = std::move(m_Layer);
+			}
+			steps = std::move(m_Steps);
+			m_Steps.clear();
+			m_State.store(state, std::memory_order_release);
+		}
+		return true;
+	}
+
+
+	/*****************************************************************
+	 *                       LayerBuildContext                       *
+	 *****************************************************************/
+
+	void LayerBuildContext::SetProgress(float fraction)
+	{
+		//only the build thread writes it, so a plain max is enough
+		fraction = std::min(std::max(fraction, 0.0f), 1.0f);
+		if (fraction > m_Load.m_BuildProgress.load(std::memory_order_relaxed)) {
+			m_Load.m_BuildProgress.store(fraction, std::memory_order_relaxed);
+		}
+	}
+
+	void LayerBuildContext::Defer(std::function<void()>&& step)
+	{
+		if (!step) {
+			return;
+		}
+		std::lock_guard<std::mutex> lock(m_Load.m_Mutex);
+		if (m_Load.m_State.load(std::memory_order_relaxed) >= LayerLoad::State::Done) {
+			return;
+		}
+		m_Load.m_Steps.push_back(std::move(step));
+		m_Load.m_StepCount.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	bool LayerBuildContext::LoadTexture(const std::string& path, const std::string& name, std::function<void(Texture2DRef)>&& onLoaded)
+	{
+		std::string lName = name;
+		if (name == "") { lName = GetAssetNameFromPath(path); }
+		int width, height, channels;
+		//same settings as the texture backends use when loading from a path. This runs on the streaming thread,
+		//so the flag is set for this thread only, rather than racing the main thread's loads on stb's global one
+		stbi_set_flip_vertically_on_load_thread(1);
+		stbi_uc* imageData = stbi_load(path.c_str(), &width, &height, &channels, 0);
+		if (!imageData) {
+			LOG_S(ERROR) << "LayerBuildContext: failed to load image: " << path;
+			return false;
+		}
+		std::shared_ptr<stbi_uc> pixels(imageData, stbi_image_free);
+		Defer([pixels, width, height, channels, lName, onLoaded]() {
+			Texture2DRef texture = Texture2D::Create(pixels.get(), (uint32_t)width, (uint32_t)height, (uint32_t)channels, lName);
+			if (onLoaded) {
+				onLoaded(texture);
+			}
+		});
+		return true;
+	}
+
+	void LayerBuildContext::Fail(const std::string& reason)
+	{
+		std::lock_guard<std::mutex> lock(m_Load.m_Mutex);
+		if (!m_Failed) {
+			m_Load.m_Error = reason;
+			m_Failed = true;
+		}
+	}
+
+
+	/*****************************************************************
+	 *                         LayerStreamer                         *
+	 *****************************************************************/
+
+	LayerStreamer::LayerStreamer()
+		: m_Stop(false), m_Budget(LAYER_LOAD_DEFAULT_BUDGET)
+	{}
+
+	LayerStreamer::~LayerStreamer()
+	{
+		CancelAll();
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Stop = true;
+		}
+		m_Wake.notify_all();
+		if (m_Thread.joinable()) {
+			m_Thread.join();
+		}
+	}
+
+	LayerLoadRef LayerStreamer::Enqueue(LayerBuildFunction&& build, bool overlay)
+	{
+		LayerLoadRef load = std::make_shared<LayerLoad>(std::move(build), overlay);
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Queued.push_back(load);
+			if (!m_Thread.joinable()) {
+				m_Thread = std::thread(&LayerStreamer::Run, this);
+			}
+		}
+		m_Wake.notify_one();
+		return load;
+	}
+
+	void LayerStreamer::Integrate(Scene& scene)
+	{
+		SCOPE_PROFILE("LayerStreamer Integrate");
+		auto start = std::chrono::steady_clock::now();
+		auto budget = std::chrono::duration<float, std::milli>(m_Budget);
+		bool ranAny = false;
+		auto overBudget = [&]() { return ranAny && std::chrono::steady_clock::now() - start >= budget; };
+
+		while (true) {
+			//only this thread pops, so the front stays put while it is worked on
+			LayerLoadRef load;
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				if (m_Built.empty()) {
+					return;
+				}
+				load = m_Built.front();
+			}
+
+			//run its steps. One at a time, taken out first, so a step can defer more or cancel the load
+			while (true) {
+				if (overBudget()) {
+					return;
+				}
+				std::function<void()> step;
+				{
+					std::lock_guard<std::mutex> lock(load->m_Mutex);
+					if (load->m_State.load(std::memory_order_relaxed) != LayerLoad::State::Integrating || load->m_Steps.empty()) {
+						break;
+					}
+					step = std::move(load->m_Steps.front());
+					load->m_Steps.pop_front();
+				}
+				step();
+				load->m_StepsRun.fetch_add(1, std::memory_order_relaxed);
+				ranAny = true;
+			}
+
+			//then push it, if it is still wanted. Activating can be costly too, so it waits for a frame with budget left
+			LayerRef layer;
+			{
+				std::lock_guard<std::mutex> lock(load->m_Mutex);
+				if (load->m_State.load(std::memory_order_relaxed) == LayerLoad::State::Integrating) {
+					layer = load->m_Layer;
+				}
+			}
+			if (layer) {
+				if (overBudget()) {
+					return;
+				}
+				if (load->IsOverlay()) {
+					scene.PushOverlay(layer);
+				}
+				else {
+					scene.PushLayer(layer);
+				}
+				load->Finish(LayerLoad::State::Done);
+				ranAny = true;
+			}
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				m_Built.pop_front();
+			}
+		}
+	}
+
+	void LayerStreamer::CancelAll()
+	{
+		std::vector<LayerLoadRef> loads;
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			loads.insert(loads.end(), m_Queued.begin(), m_Queued.end());
+			if (m_Building) {
+				loads.push_back(m_Building);
+			}
+			loads.insert(loads.end(), m_Built.begin(), m_Built.end());
+		}
+		//finished loads are skipped and dropped from the queues as they come up
+		for (auto& load : loads) {
+			load->Cancel();
+		}
+	}
+
+	uint32_t LayerStreamer::GetPendingCount() const
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		uint32_t count = 0;
+		for (auto& load : m_Queued) {
+			count += load->IsFinished() ? 0 : 1;
+		}
+		count += (m_Building && !m_Building->IsFinished()) ? 1 : 0;
+		for (auto& load : m_Built) {
+			count += load->IsFinished() ? 0 : 1;
+		}
+		return count;
+	}
+
+	void LayerStreamer::Run()
+	{
+		while (true) {
+			LayerLoadRef load;
+			{
+				std::unique_lock<std::mutex> lock(m_Mutex);
+				m_Wake.wait(lock, [this]() { return m_Stop || !m_Queued.empty(); });
+				if (m_Stop) {
+					return;
+				}
+				load = m_Queued.front();
+				m_Queued.pop_front();
+				m_Building = load;
+			}
+			Build(load);
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				m_Building = nullptr;
+			}
+		}
+	}
+
+	void LayerStreamer::Build(const LayerLoadRef& load)
+	{
+		{
+			std::lock_guard<std::mutex> lock(load->m_Mutex);
+			if (load->m_State.load(std::memory_order_relaxed) != LayerLoad::State::Queued) {
+				//cancelled while queued
+				return;
+			}
+			load->m_State.store(LayerLoad::State::Building, std::memory_order_release);
+		}
+
+		LayerBuildContext context(*load);
+		LayerRef layer;
+		try {
+			layer = load->m_Build(context);
+		}
+		catch (std::exception& e) {
+			context.Fail(e.what());
+		}
+		load->m_Build = nullptr;
+
+		if (load->m_CancelRequested.load(std::memory_order_relaxed)) {
+			load->Finish(LayerLoad::State::Cancelled);
+			return;
+		}
+		if (!layer && !context.m_Failed) {
+			context.Fail("the build function returned no layer");
+		}
+		if (context.m_Failed) {
+			LOG_S(ERROR) << "LayerStreamer: layer load failed: " << load->GetError();
+			load->Finish(LayerLoad::State::Failed);
+			return;
+		}
+
+		{
+			//checked again under the lock, as Cancel leaves a building load alone
+			std::lock_guard<std::mutex> lock(load->m_Mutex);
+			if (!load->m_CancelRequested.load(std::memory_order_relaxed)) {
+				load->m_Layer = layer;
+				load->m_BuildProgress.store(1.0f, std::memory_order_relaxed);
+				load->m_State.store(LayerLoad::State::Integrating, std::memory_order_release);
+			}
+		}
+		if (load->GetState() != LayerLoad::State::Integrating) {
+			load->Finish(LayerLoad::State::Cancelled);
+			return;
+		}
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Built.push_back(load);
+	}
+
+}
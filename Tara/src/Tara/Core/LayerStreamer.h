@@ -0,0 +1,266 @@
+#pragma once
+#include "tarapch.h"
+#include "Tara/Core/Layer.h"
+#include "Tara/Renderer/Texture.h"
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+//the share of a layer load's progress that is the build on the streaming thread. The rest is integration on the main thread
+#define LAYER_LOAD_BUILD_SHARE 0.8f
+//default main thread time spent integrating streamed layers each frame, in milliseconds
+#define LAYER_LOAD_DEFAULT_BUDGET 2.0f
+
+namespace Tara {
+	class Scene;
+	class LayerBuildContext;
+	class LayerStreamer;
+
+	/// <summary>
+	/// A function that builds a layer off the main thread. It returns the finished layer, or null on failure.
+	/// </summary>
+	using LayerBuildFunction = std::function<LayerRef(LayerBuildContext&)>;
+
+
+	REFTYPE(LayerLoad);
+
+	/// <summary>
+	/// The state of one asynchronous layer load, for checking on it while it runs (like from a loading screen).
+	/// A load is queued, built on the streaming thread, integrated on the main thread over as many frames as its budget needs,
+	/// and then pushed into the Scene.
+	/// </summary>
+	class LayerLoad {
+		friend class LayerBuildContext;
+		friend class LayerStreamer;
+	public:
+		enum class State : uint8_t {
+			Queued,			//waiting for the streaming thread
+			Building,		//the build function is running on the streaming thread
+			Integrating,	//built, running deferred main thread steps
+			Done,			//pushed into the scene
+			Failed,			//the build function failed or returned no layer
+			Cancelled,		//cancelled before being pushed
+		};
+
+		LayerLoad(LayerBuildFunction&& build, bool overlay);
+
+		LayerLoad(LayerLoad const&) = delete;
+		void operator=(LayerLoad const&) = delete;
+
+		/// <summary>
+		/// Get the state of the load
+		/// </summary>
+		/// <returns>the state</returns>
+		inline State GetState() const { return m_State.load(std::memory_order_acquire); }
+
+		/// <summary>
+		/// Check if the load is over, whether it worked or not
+		/// </summary>
+		/// <returns>true if done, failed, or cancelled</returns>
+		inline bool IsFinished() const { return GetState() >= State::Done; }
+
+		/// <summary>
+		/// Check if the layer has been pushed into the scene
+		/// </summary>
+		/// <returns>true if done</returns>
+		inline bool IsDone() const { return GetState() == State::Done; }
+
+		/// <summary>
+		/// Get the overall progress of the load, from 0 to 1. The build is the first LAYER_LOAD_BUILD_SHARE of it, and integration the rest.
+		/// </summary>
+		/// <returns>the progress</returns>
+		float GetProgress() const;
+
+		/// <summary>
+		/// Get the progress the build function reported, from 0 to 1
+		/// </summary>
+		/// <returns>the build progress</returns>
+		inline float GetBuildProgress() const { return m_BuildProgress.load(std::memory_order_relaxed); }
+
+		/// <summary>
+		/// Get the share of the deferred main thread steps that have run, from 0 to 1
+		/// </summary>
+		/// <returns>the integration progress</returns>
+		float GetIntegrationProgress() const;
+
+		/// <summary>
+		/// Get the loaded layer
+		/// </summary>
+		/// <returns>the layer, or null if the load is not done</returns>
+		LayerRef GetLayer() const;
+
+		/// <summary>
+		/// Get the reason the load failed
+		/// </summary>
+		/// <returns>the reason, or an empty string if it has not failed</returns>
+		std::string GetError() const;
+
+		/// <summary>
+		/// Check if the load is a layer or an overlay
+		/// </summary>
+		/// <returns>true if overlay</returns>
+		inline bool IsOverlay() const { return m_Overlay; }
+
+		/// <summary>
+		/// Cancel the load. A build that is running is asked to stop (see LayerBuildContext::IsCancelled), and the layer is never pushed.
+		/// Does nothing once the load is finished.
+		/// </summary>
+		void Cancel();
+
+	private:
+		/// <summary>
+		/// Move to a finished state, dropping the layer and any steps left. Returns false if it was already finished.
+		/// </summary>
+		bool Finish(State state);
+
+	private:
+		LayerBuildFunction m_Build;
+		const bool m_Overlay;
+		std::atomic<State> m_State;
+		std::atomic<float> m_BuildProgress;
+		std::atomic<bool> m_CancelRequested;
+		std::atomic<uint32_t> m_StepsRun;
+		std::atomic<uint32_t> m_StepCount;
+		mutable std::mutex m_Mutex;	//guards the members below while the load is shared between threads
+		LayerRef m_Layer;
+		std::string m_Error;
+		std::deque<std::function<void()>> m_Steps;
+	};
+
+
+	/// <summary>
+	/// Passed to a LayerBuildFunction, for reporting progress and handing work back to the main thread.
+	/// The build runs on the streaming thread. It can create the layer, and entities and components in it, as the name table, object pools,
+	/// and type registry are thread safe. The layer must not be pushed into a scene; that is done for it when the load finishes.
+	/// Anything that touches the renderer, Lua, or the AssetLibrary (like creating textures, sprites, or script components) must go through Defer.
+	/// Entities run OnBeginPlay when created, so on the streaming thread; entity types that need the main thread there should be created in a deferred step.
+	/// </summary>
+	class LayerBuildContext {
+		friend class LayerStreamer;
+	private:
+		LayerBuildContext(LayerLoad& load)
+			: m_Load(load)
+		{}
+
+	public:
+		LayerBuildContext(LayerBuildContext const&) = delete;
+		void operator=(LayerBuildContext const&) = delete;
+
+		/// <summary>
+		/// Report how far along the build is. Progress never goes backwards.
+		/// </summary>
+		/// <param name="fraction">the progress, from 0 to 1</param>
+		void SetProgress(float fraction);
+
+		/// <summary>
+		/// Run a step on the main thread, after the build and before the layer is pushed.
+		/// Steps run in the order they were deferred, a few each frame, within the scene's load integration budget.
+		/// </summary>
+		/// <param name="step">the step</param>
+		void Defer(std::function<void()>&& step);
+
+		/// <summary>
+		/// Decode an image on the streaming thread, and defer creating the texture from it.
+		/// If a texture with the name already exists, it is used and the decoded image is dropped.
+		/// </summary>
+		/// <param name="path">the image path</param>
+		/// <param name="name">the texture name. If empty, the name comes from the path, as with Texture2D::Create</param>
+		/// <param name="onLoaded">called on the main thread with the texture. May be null</param>
+		/// <returns>true if the image decoded</returns>
+		bool LoadTexture(const std::string& path, const std::string& name = "", std::function<void(Texture2DRef)>&& onLoaded = nullptr);
+
+		/// <summary>
+		/// Check if the load was cancelled. Long builds should check this now and then, and return null if so.
+		/// </summary>
+		/// <returns>true if cancelled</returns>
+		inline bool IsCancelled() const { return m_Load.m_CancelRequested.load(std::memory_order_relaxed); }
+
+		/// <summary>
+		/// Mark the load as failed. The layer is not pushed, even if the build returns one.
+		/// </summary>
+		/// <param name="reason">why it failed</param>
+		void Fail(const std::string& reason);
+
+	private:
+		LayerLoad& m_Load;
+		bool m_Failed = false;
+	};
+
+
+	/// <summary>
+	/// Builds layers on a streaming thread, and integrates them into a Scene from the main thread.
+	/// It uses its own thread rather than the JobSystem, as waiting on jobs can run any queued job, and a long build
+	/// picked up by the main thread would be the very hitch streaming is meant to avoid. Builds may still use the JobSystem.
+	/// Loads build one at a time, in the order they were queued, and are pushed in that order.
+	/// </summary>
+	class LayerStreamer {
+	public:
+		LayerStreamer();
+		~LayerStreamer();
+
+		LayerStreamer(LayerStreamer const&) = delete;
+		void operator=(LayerStreamer const&) = delete;
+
+		/// <summary>
+		/// Queue a layer to build. The streaming thread is started on first use.
+		/// </summary>
+		/// <param name="build">the build function</param>
+		/// <param name="overlay">true to push the layer as an overlay</param>
+		/// <returns>the load</returns>
+		LayerLoadRef Enqueue(LayerBuildFunction&& build, bool overlay);
+
+		/// <summary>
+		/// Run deferred steps of built loads, and push the loads that finish into the scene. Main thread only, once a frame.
+		/// At least one step runs each call, so loads always move forward, and then steps run until the budget is spent.
+		/// </summary>
+		/// <param name="scene">the scene to push into</param>
+		void Integrate(Scene& scene);
+
+		/// <summary>
+		/// Cancel every load that is not finished
+		/// </summary>
+		void CancelAll();
+
+		/// <summary>
+		/// Set the main thread time Integrate may spend each frame
+		/// </summary>
+		/// <param name="milliseconds">the budget</param>
+		inline void SetBudget(float milliseconds) { m_Budget = std::max(milliseconds, 0.0f); }
+
+		/// <summary>
+		/// Get the main thread time Integrate may spend each frame
+		/// </summary>
+		/// <returns>the budget, in milliseconds</returns>
+		inline float GetBudget() const { return m_Budget; }
+
+		/// <summary>
+		/// Get the number of loads that are not finished
+		/// </summary>
+		/// <returns>the count</returns>
+		uint32_t GetPendingCount() const;
+
+	private:
+		/// <summary>
+		/// The streaming thread: build loads until stopped
+		/// </summary>
+		void Run();
+
+		/// <summary>
+		/// Build one load on the streaming thread
+		/// </summary>
+		void Build(const LayerLoadRef& load);
+
+	private:
+		std::thread m_Thread;
+		mutable std::mutex m_Mutex;			//guards the queues below and m_Stop
+		std::condition_variable m_Wake;
+		std::deque<LayerLoadRef> m_Queued;	//waiting to build
+		LayerLoadRef m_Building;			//being built
+		std::deque<LayerLoadRef> m_Built;	//built, waiting to integrate
+		bool m_Stop;
+		float m_Budget;
+	};
+
+}
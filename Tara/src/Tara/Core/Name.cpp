@@ -0,0 +1,66 @@
+#include "tarapch.h"
+#include "Name.h"
+#include <mutex>
+#include <deque>
+
+namespace Tara {
+
+	struct Name::Table {
+		std::mutex Mutex;
+		std::unordered_map<std::string, const Entry*> Entries;
+		std::deque<Entry> Storage; //a deque, so entries never move as it grows
+	};
+
+	Name::Table& Name::GetTable()
+	{
+		//intentionally leaked, so names stay valid during static destruction
+		static Table* table = new Table();
+		return *table;
+	}
+
+	Name::Name()
+		: m_Entry(Intern(""))
+	{}
+
+	Name::Name(const std::string& string)
+		: m_Entry(Intern(string))
+	{}
+
+	Name::Name(const char* string)
+		: m_Entry(Intern(string))
+	{}
+
+	bool Name::Find(const std::string& string, Name& name)
+	{
+		auto& table = GetTable();
+		std::lock_guard<std::mutex> lock(table.Mutex);
+		auto found = table.Entries.find(string);
+		if (found == table.Entries.end()) {
+			return false;
+		}
+		name.m_Entry = found->second;
+		return true;
+	}
+
+	uint32_t Name::GetInternedCount()
+	{
+		auto& table = GetTable();
+		std::lock_guard<std::mutex> lock(table.Mutex);
+		return (uint32_t)table.Storage.size();
+	}
+
+	const Name::Entry* Name::Intern(const std::string& string)
+	{
+		auto& table = GetTable();
+		std::lock_guard<std::mutex> lock(table.Mutex);
+		auto found = table.Entries.find(string);
+		if (found != table.Entries.end()) {
+			return found->second;
+		}
+		table.Storage.push_back({ string, (NameId)table.Storage.size() });
+		const Entry* entry = &table.Storage.back();
+		table.Entries.emplace(string, entry);
+		return entry;
+	}
+
+}
@@ -0,0 +1,178 @@
+#pragma once
+#include "tarapch.h"
+
+namespace Tara {
+
+	/// <summary>
+	/// The small integer id of an interned name
+	/// </summary>
+	using NameId = uint32_t;
+
+	/// <summary>
+	/// An interned string. Every distinct string is stored once in a global table, and a Name is just a pointer to its entry,
+	/// so copying and comparing names costs the same as copying and comparing a pointer, and thousands of entities
+	/// named "SpriteEntity" share one string.
+	/// Interned strings are never freed.
+	/// </summary>
+	class Name {
+	public:
+		/// <summary>
+		/// Construct the empty name
+		/// </summary>
+		Name();
+
+		/// <summary>
+		/// Construct a name, interning the string if it is new. Implicit, so a name can be given anywhere a Name is expected.
+		/// </summary>
+		/// <param name="string">the string</param>
+		Name(const std::string& string);
+
+		/// <summary>
+		/// Construct a name, interning the string if it is new.
+		/// </summary>
+		/// <param name="string">the string</param>
+		Name(const char* string);
+
+		/// <summary>
+		/// Find the name of a string without interning it
+		/// </summary>
+		/// <param name="string">the string</param>
+		/// <param name="name">set to the name, if found</param>
+		/// <returns>true if the string has been interned before. If not, no Name has that string.</returns>
+		static bool Find(const std::string& string, Name& name);
+
+		/// <summary>
+		/// Get the number of interned strings
+		/// </summary>
+		/// <returns>the count</returns>
+		static uint32_t GetInternedCount();
+
+		/// <summary>
+		/// Get the string
+		/// </summary>
+		/// <returns>the string</returns>
+		inline const std::string& GetString() const { return m_Entry->String; }
+
+		/// <summary>
+		/// Get the id. Ids count up from 0 (the empty name) in the order strings were interned.
+		/// </summary>
+		/// <returns>the id</returns>
+		inline NameId GetId() const { return m_Entry->Id; }
+
+		inline bool operator==(const Name& other) const { return m_Entry == other.m_Entry; }
+		inline bool operator!=(const Name& other) const { return m_Entry != other.m_Entry; }
+
+	private:
+		/// <summary>
+		/// An entry in the intern table. Never moves once made.
+		/// </summary>
+		struct Entry {
+			std::string String;
+			NameId Id;
+		};
+
+		/// <summary>
+		/// The global intern table
+		/// </summary>
+		struct Table;
+		static Table& GetTable();
+
+		/// <summary>
+		/// Get the entry of a string, making it if it is new
+		/// </summary>
+		static const Entry* Intern(const std::string& string);
+
+	private:
+		const Entry* m_Entry;
+	};
+
+
+	/// <summary>
+	/// An index of a set of objects by name. The objects with each name are linked in order of their position in their owner's list,
+	/// so the first and last of a name are found directly, and removing one unlinks it in constant time.
+	/// Positions may shift, as long as the relative order of the indexed objects does not change while they are indexed.
+	/// To reorder an object, remove it, move it, and add it again.
+	/// </summary>
+	/// <typeparam name="T">the object type</typeparam>
+	/// <typeparam name="Position">a type with a static uint32_t Get(const T&amp;) that gives an object's position</typeparam>
+	template<typename T, typename Position>
+	class NameIndex {
+	public:
+		/// <summary>
+		/// Add an object. Constant time when it is after every other object with its name, as new children and components are.
+		/// Otherwise the name's list is walked back from the end to find its place.
+		/// </summary>
+		/// <param name="name">the object's name</param>
+		/// <param name="ref">the object</param>
+		void Add(const Name& name, const std::shared_ptr<T>& ref) {
+			Node& node = m_Nodes[ref.get()];
+			node.Ref = ref;
+			Bucket& bucket = m_Buckets[name.GetId()];
+			//the last object with the name that is before this one, if any
+			const T* prev = bucket.Last;
+			while (prev && Position::Get(*ref) < Position::Get(*prev)) {
+				prev = m_Nodes[prev].Prev;
+			}
+			const T* next = prev ? m_Nodes[prev].Next : bucket.First;
+			node.Prev = prev;
+			node.Next = next;
+			(prev ? m_Nodes[prev].Next : bucket.First) = ref.get();
+			(next ? m_Nodes[next].Prev : bucket.Last) = ref.get();
+		}
+
+		/// <summary>
+		/// Remove an object, in constant time
+		/// </summary>
+		/// <param name="name">the object's name</param>
+		/// <param name="ref">the object</param>
+		void Remove(const Name& name, const std::shared_ptr<T>& ref) {
+			auto node = m_Nodes.find(ref.get());
+			auto bucket = m_Buckets.find(name.GetId());
+			if (node == m_Nodes.end() || bucket == m_Buckets.end()) {
+				return;
+			}
+			const T* prev = node->second.Prev;
+			const T* next = node->second.Next;
+			(prev ? m_Nodes[prev].Next : bucket->second.First) = next;
+			(next ? m_Nodes[next].Prev : bucket->second.Last) = prev;
+			m_Nodes.erase(node);
+			if (!bucket->second.First) {
+				m_Buckets.erase(bucket);
+			}
+		}
+
+		/// <summary>
+		/// Get the first object with a name, by position
+		/// </summary>
+		/// <param name="name">the name</param>
+		/// <returns>the object, or nullptr if there are none</returns>
+		std::shared_ptr<T> First(const Name& name) const {
+			auto bucket = m_Buckets.find(name.GetId());
+			return bucket != m_Buckets.end() ? m_Nodes.at(bucket->second.First).Ref : nullptr;
+		}
+
+		/// <summary>
+		/// Get the last object with a name, by position
+		/// </summary>
+		/// <param name="name">the name</param>
+		/// <returns>the object, or nullptr if there are none</returns>
+		std::shared_ptr<T> Last(const Name& name) const {
+			auto bucket = m_Buckets.find(name.GetId());
+			return bucket != m_Buckets.end() ? m_Nodes.at(bucket->second.Last).Ref : nullptr;
+		}
+
+	private:
+		struct Node {
+			std::shared_ptr<T> Ref;
+			const T* Prev = nullptr;
+			const T* Next = nullptr;
+		};
+		struct Bucket {
+			const T* First = nullptr;
+			const T* Last = nullptr;
+		};
+		std::unordered_map<const T*, Node> m_Nodes;
+		std::unordered_map<NameId, Bucket> m_Buckets;
+	};
+
+}
@@ -0,0 +1,225 @@
+#pragma once
+#include "tarapch.h"
+#include <mutex>
+#include <atomic>
+#include <new>
+
+//how many blocks a pool gets from the heap at a time
+#define OBJECT_POOL_CHUNK_SIZE 64
+
+namespace Tara {
+
+	/// <summary>
+	/// Allocation counters for an ObjectPool
+	/// </summary>
+	struct ObjectPoolStats {
+		/// <summary>
+		/// Number of times the pool went to the heap (one per chunk of blocks)
+		/// </summary>
+		uint64_t HeapAllocations = 0;
+		/// <summary>
+		/// Number of blocks handed out in total
+		/// </summary>
+		uint64_t Allocations = 0;
+		/// <summary>
+		/// Number of blocks handed out that were already free in the pool (recycled or reserved), without growing it
+		/// </summary>
+		uint64_t Reuses = 0;
+		/// <summary>
+		/// Number of blocks currently in use
+		/// </summary>
+		uint64_t Live = 0;
+		/// <summary>
+		/// Number of blocks the pool owns, in use or free
+		/// </summary>
+		uint64_t Capacity = 0;
+	};
+
+	/// <summary>
+	/// A per-type pool of storage for shared_ptr-owned objects. Each block holds one object along with its shared_ptr control block.
+	/// When the last shared_ptr and weak_ptr to an object are gone, its block goes back on the pool's free list for the next object,
+	/// so once the pool has grown to the peak live count, the objects' own storage no longer touches the heap.
+	/// Anything an object allocates itself (vectors, strings and so on) still does.
+	/// Pooling is opt-in, per type: call Enable(), and CreateEntity/CreateComponent will use the pool for that exact type.
+	/// Pools never give memory back to the heap.
+	/// </summary>
+	/// <typeparam name="T">the pooled type</typeparam>
+	template<typename T>
+	class ObjectPool {
+	public:
+		/// <summary>
+		/// Start pooling this type
+		/// </summary>
+		/// <param name="reserve">the number of blocks to have ready, so even the first objects don't go to the heap</param>
+		static void Enable(size_t reserve = 0) {
+			auto& pool = Get();
+			std::lock_guard<std::mutex> lock(pool.Mutex);
+			pool.Enabled = true;
+			pool.Reserve = std::max(pool.Reserve, reserve);
+		}
+
+		/// <summary>
+		/// Stop pooling this type. Objects that were pooled still return their storage to the pool.
+		/// </summary>
+		static void Disable() {
+			auto& pool = Get();
+			std::lock_guard<std::mutex> lock(pool.Mutex);
+			pool.Enabled = false;
+		}
+
+		/// <summary>
+		/// Get if this type is pooled
+		/// </summary>
+		/// <returns>true if enabled</returns>
+		static bool IsEnabled() {
+			return Get().Enabled.load(std::memory_order_relaxed);
+		}
+
+		/// <summary>
+		/// Get the allocation counters of this type's pool
+		/// </summary>
+		/// <returns>a copy of the counters</returns>
+		static ObjectPoolStats GetStats() {
+			auto& pool = Get();
+			std::lock_guard<std::mutex> lock(pool.Mutex);
+			return pool.Stats;
+		}
+
+		/// <summary>
+		/// Get a block. Used by PoolAllocator.
+		/// </summary>
+		/// <param name="size">the size of the block. Must be the same every call</param>
+		/// <param name="align">the alignment of the block</param>
+		/// <returns>the block</returns>
+		static void* Allocate(size_t size, size_t align) {
+			auto& pool = Get();
+			std::lock_guard<std::mutex> lock(pool.Mutex);
+			if (pool.BlockSize == 0) {
+				//the first allocation decides the block size, rounded up so every block in a chunk stays aligned
+				pool.BlockAlign = std::max(align, alignof(FreeBlock));
+				pool.BlockSize = ((std::max(size, sizeof(FreeBlock)) + pool.BlockAlign - 1) / pool.BlockAlign) * pool.BlockAlign;
+				if (pool.Reserve > 0) {
+					pool.Grow(pool.Reserve);
+				}
+			}
+			CHECK_F(size <= pool.BlockSize && align <= pool.BlockAlign, "ObjectPool: allocation does not fit the pool's blocks!");
+			if (pool.FreeList == nullptr) {
+				pool.Grow(OBJECT_POOL_CHUNK_SIZE);
+			}
+			else {
+				pool.Stats.Reuses++;
+			}
+			FreeBlock* block = pool.FreeList;
+			pool.FreeList = block->Next;
+			pool.Stats.Allocations++;
+			pool.Stats.Live++;
+			return block;
+		}
+
+		/// <summary>
+		/// Return a block. Used by PoolAllocator.
+		/// </summary>
+		/// <param name="ptr">the block</param>
+		static void Free(void* ptr) {
+			auto& pool = Get();
+			std::lock_guard<std::mutex> lock(pool.Mutex);
+			FreeBlock* block = static_cast<FreeBlock*>(ptr);
+			block->Next = pool.FreeList;
+			pool.FreeList = block;
+			pool.Stats.Live--;
+		}
+
+	private:
+		/// <summary>
+		/// A free block, linked to the next free block
+		/// </summary>
+		struct FreeBlock {
+			FreeBlock* Next;
+		};
+
+		/// <summary>
+		/// The actual pool state. One per type.
+		/// </summary>
+		struct Instance {
+			std::mutex Mutex;
+			FreeBlock* FreeList = nullptr;
+			size_t BlockSize = 0;
+			size_t BlockAlign = 0;
+			size_t Reserve = 0;
+			std::atomic<bool> Enabled = false;
+			ObjectPoolStats Stats;
+
+			/// <summary>
+			/// Get a chunk of blocks from the heap, and put them all on the free list
+			/// </summary>
+			void Grow(size_t count) {
+				char* chunk = static_cast<char*>(::operator new(BlockSize * count, std::align_val_t(BlockAlign)));
+				for (size_t i = count; i > 0; i--) {
+					FreeBlock* block = reinterpret_cast<FreeBlock*>(chunk + ((i - 1) * BlockSize));
+					block->Next = FreeList;
+					FreeList = block;
+				}
+				Stats.HeapAllocations++;
+				Stats.Capacity += count;
+			}
+		};
+
+		static Instance& Get() {
+			//intentionally leaked, so objects that outlive static destruction can still be freed
+			static Instance* instance = new Instance();
+			return *instance;
+		}
+	};
+
+
+	/// <summary>
+	/// A standard allocator that gets its storage from ObjectPool&lt;Owner&gt;.
+	/// Used with std::allocate_shared, which rebinds it to the combined object + control block type.
+	/// </summary>
+	/// <typeparam name="Owner">the type whose pool is used</typeparam>
+	/// <typeparam name="T">the allocated type</typeparam>
+	template<typename Owner, typename T = Owner>
+	class PoolAllocator {
+	public:
+		using value_type = T;
+		template<typename U> struct rebind { using other = PoolAllocator<Owner, U>; };
+
+		PoolAllocator() = default;
+		template<typename U> PoolAllocator(const PoolAllocator<Owner, U>&) {}
+
+		T* allocate(size_t n) {
+			if (n != 1) {
+				//only single objects are pooled
+				return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(alignof(T))));
+			}
+			return static_cast<T*>(ObjectPool<Owner>::Allocate(sizeof(T), alignof(T)));
+		}
+
+		void deallocate(T* ptr, size_t n) {
+			if (n != 1) {
+				::operator delete(ptr, std::align_val_t(alignof(T)));
+				return;
+			}
+			ObjectPool<Owner>::Free(ptr);
+		}
+
+		template<typename U> inline bool operator==(const PoolAllocator<Owner, U>&) const { return true; }
+		template<typename U> inline bool operator!=(const PoolAllocator<Owner, U>&) const { return false; }
+	};
+
+	/// <summary>
+	/// Make a shared object, from its type's pool if pooling is enabled for it, or the heap otherwise
+	/// </summary>
+	/// <typeparam name="T">the type to make</typeparam>
+	/// <typeparam name="...VA_ARGS">the constructor argument types</typeparam>
+	/// <param name="...args">the constructor arguments</param>
+	/// <returns>the new object</returns>
+	template<typename T, typename... VA_ARGS>
+	inline std::shared_ptr<T> MakePooledShared(VA_ARGS&&... args) {
+		if (ObjectPool<T>::IsEnabled()) {
+			return std::allocate_shared<T>(PoolAllocator<T>(), std::forward<VA_ARGS>(args)...);
+		}
+		return std::make_shared<T>(std::forward<VA_ARGS>(args)...);
+	}
+
+}
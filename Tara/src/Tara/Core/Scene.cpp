@@ -103,5 +103,20 @@ namespace Tara {
 		return false;
 	}
 
+	LayerLoadRef Scene::PushLayerAsync(LayerBuildFunction build)
+	{
+		return m_Streamer.Enqueue(std::move(build), false);
+	}
+
+	LayerLoadRef Scene::PushOverlayAsync(LayerBuildFunction build)
+	{
+		return m_Streamer.Enqueue(std::move(build), true);
+	}
+
+	void Scene::IntegrateLoads()
+	{
+		m_Streamer.Integrate(*this);
+	}
+
 
 }
@@ -2,6 +2,7 @@
 #include "tarapch.h"
 #include "Tara/Input/Event.h"
 #include "Tara/Core/Layer.h"
+#include "Tara/Core/LayerStreamer.h"
 //TODO: build scene graph stuff
 
 namespace Tara {
@@ -68,11 +69,49 @@ namespace Tara {
 		/// <returns>true if removed</returns>
 		bool RemoveLayer(LayerRef layer);
 
+		/// <summary>
+		/// Build a Layer on the streaming thread, and push it into the Scene once it is built and integrated.
+		/// The Scene keeps updating and drawing meanwhile, so a loading screen can watch the returned load's progress.
+		/// See LayerBuildContext for what a build may and may not do off the main thread.
+		/// </summary>
+		/// <param name="build">the function that builds the layer</param>
+		/// <returns>the load</returns>
+		LayerLoadRef PushLayerAsync(LayerBuildFunction build);
+		/// <summary>
+		/// Build an Overlay Layer on the streaming thread, and push it into the Scene once it is built and integrated.
+		/// </summary>
+		/// <param name="build">the function that builds the layer</param>
+		/// <returns>the load</returns>
+		LayerLoadRef PushOverlayAsync(LayerBuildFunction build);
+
+		/// <summary>
+		/// Run the main thread part of streamed layer loads, within the load integration budget, pushing the ones that finish.
+		/// Called by the Application once a frame, before updating.
+		/// </summary>
+		void IntegrateLoads();
+
+		/// <summary>
+		/// Set the main thread time spent integrating streamed layers each frame
+		/// </summary>
+		/// <param name="milliseconds">the budget</param>
+		inline void SetLoadIntegrationBudget(float milliseconds) { m_Streamer.SetBudget(milliseconds); }
+		/// <summary>
+		/// Get the main thread time spent integrating streamed layers each frame
+		/// </summary>
+		/// <returns>the budget, in milliseconds</returns>
+		inline float GetLoadIntegrationBudget() const { return m_Streamer.GetBudget(); }
+		/// <summary>
+		/// Get the number of streamed layer loads that have not finished
+		/// </summary>
+		/// <returns>the count</returns>
+		inline uint32_t GetPendingLoadCount() const { return m_Streamer.GetPendingCount(); }
+
 
 	private:
 
 		std::vector<LayerRef> m_Layers;
 		std::vector<LayerRef> m_Overlays;
+		LayerStreamer m_Streamer; //after the layers, so the streaming thread stops first
 
 	};
 
@@ -38,12 +38,14 @@ namespace Tara{
 		RegisterType<CameraEntity>("Tara::CameraEntity");
 		RegisterType<SpriteEntity>("Tara::SpriteEntity");
 		RegisterType<TilemapEntity>("Tara::TilemapEntity");
+		RegisterType<TimerHandle>("Tara::Timer");
 
 		CONNECT_FUNCTION_OVERRIDE(After);
 	}
 
 	void Script::ReloadDefaultLibrary()
 	{
+		ClearFileCache();
 		m_LuaState["LibraryPath"] = m_DefaultLibPath;
 		auto results = m_LuaState.safe_script_file(m_DefaultLibPath + "/init.lua");
 		if (!results.valid()) {
@@ -66,5 +68,28 @@ namespace Tara{
 		}
 	}
 
+	bool Script::RunFile(const std::string& path)
+	{
+		auto compiled = m_CompiledFiles.find(path);
+		if (compiled == m_CompiledFiles.end()) {
+			sol::load_result loaded = m_LuaState.load_file(path);
+			if (!loaded.valid()) {
+				//not cached, so a fixed file is picked up on the next run
+				sol::error err = loaded;
+				LOG_S(ERROR) << "Error in Lua Script: " << err.what();
+				return false;
+			}
+			compiled = m_CompiledFiles.emplace(path, (sol::protected_function)loaded).first;
+		}
+		auto results = compiled->second();
+		if (!results.valid()) {
+			sol::error err = results;
+			LOG_S(ERROR) << "Error in Lua Script: " << err.what();
+			LOG_S(ERROR) << loguru::stacktrace().c_str();
+			return false;
+		}
+		return true;
+	}
+
 
 }
@@ -69,6 +69,19 @@ namespace Tara {
 		/// <param name="script"></param>
 		void DEBUG_RunScript(const std::string& script);
 
+		/// <summary>
+		/// Run a script file. The file is compiled the first time it runs, and the compiled chunk is kept, so running
+		/// the same file many times (like a ScriptComponent on every copy of a prefab) only reads and parses it once.
+		/// </summary>
+		/// <param name="path">the file path</param>
+		/// <returns>true if the file compiled and ran without errors</returns>
+		bool RunFile(const std::string& path);
+
+		/// <summary>
+		/// Forget every compiled file, so each is read again the next time it runs. For picking up edited scripts.
+		/// </summary>
+		inline void ClearFileCache() { m_CompiledFiles.clear(); }
+
 		/// <summary>
 		/// Register a class, if you can. Otherwise, compile error!
 		/// </summary>
@@ -86,6 +99,7 @@ namespace Tara {
 	private:
 		sol::state m_LuaState;
 		std::string m_DefaultLibPath;
+		std::unordered_map<std::string, sol::protected_function> m_CompiledFiles;
 	};
 
 
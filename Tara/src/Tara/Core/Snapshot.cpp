@@ -0,0 +1,1145 @@
+#include "tarapch.h"
+#include "Snapshot.h"
+#include "Tara/Core/Layer.h"
+#include "Tara/Asset/AssetLibrary.h"
+#include "Tara/Entities/SpriteEntity.h"
+#include "Tara/Entities/CameraEntity.h"
+#include "Tara/Entities/TextEntity.h"
+#include "Tara/Entities/TilemapEntity.h"
+#include "Tara/Components/ScriptComponent.h"
+
+//entity record flag bits
+#define SNAPSHOT_ENTITY_VISIBLE 0x01
+#define SNAPSHOT_ENTITY_TICK_ENABLED 0x02
+#define SNAPSHOT_ENTITY_TICK_LOD 0x04
+#define SNAPSHOT_ENTITY_PARALLEL_SAFE 0x08
+#define SNAPSHOT_ENTITY_UPDATE_CHILDREN_FIRST 0x10
+#define SNAPSHOT_ENTITY_UPDATE_COMPONENTS_FIRST 0x20
+#define SNAPSHOT_ENTITY_DRAW_CHILDREN_FIRST 0x40
+#define SNAPSHOT_ENTITY_LAYER_CAMERA 0x80
+
+//block compression. LZ77, with a sequence format like LZ4's: a token byte holding the literal count (high nibble) and match length - 4 (low nibble),
+//each extended with 255-valued bytes when 15, then the literals, then a 2 byte offset back to the match. The last sequence is literals only.
+#define SNAPSHOT_HASH_BITS 12
+#define SNAPSHOT_MIN_MATCH 4
+#define SNAPSHOT_MAX_OFFSET 0xFFFF
+
+//the most elements a count read from a snapshot may reserve up front
+#define SNAPSHOT_MAX_RESERVE 4096u
+
+namespace Tara {
+
+	static inline bool IsLittleEndian()
+	{
+		const uint16_t probe = 1;
+		return *(const uint8_t*)&probe == 1;
+	}
+
+	static inline uint32_t Load32(const uint8_t* p)
+	{
+		uint32_t value;
+		memcpy(&value, p, 4);
+		return value;
+	}
+
+	static void PutLength(std::vector<uint8_t>& out, size_t length)
+	{
+		while (length >= 255) {
+			out.push_back(255);
+			length -= 255;
+		}
+		out.push_back((uint8_t)length);
+	}
+
+	static void PutSequence(std::vector<uint8_t>& out, const uint8_t* literals, size_t literalCount, size_t offset, size_t matchLength)
+	{
+		uint8_t token = (uint8_t)(std::min(literalCount, (size_t)15) << 4);
+		if (matchLength > 0) {
+			token |= (uint8_t)std::min(matchLength - SNAPSHOT_MIN_MATCH, (size_t)15);
+		}
+		out.push_back(token);
+		if (literalCount >= 15) {
+			PutLength(out, literalCount - 15);
+		}
+		out.insert(out.end(), literals, literals + literalCount);
+		if (matchLength > 0) {
+			out.push_back((uint8_t)offset);
+			out.push_back((uint8_t)(offset >> 8));
+			if (matchLength - SNAPSHOT_MIN_MATCH >= 15) {
+				PutLength(out, matchLength - SNAPSHOT_MIN_MATCH - 15);
+			}
+		}
+	}
+
+	/// <summary>
+	/// Compress a block. Fast, rather than small: a single hash probe per position.
+	/// </summary>
+	static void CompressBlock(const uint8_t* src, size_t size, std::vector<uint8_t>& out)
+	{
+		out.clear();
+		uint32_t table[1 << SNAPSHOT_HASH_BITS] = {}; //position + 1 of the last place each hash was seen
+		size_t anchor = 0;
+		size_t i = 0;
+		while (i + SNAPSHOT_MIN_MATCH <= size) {
+			uint32_t sequence = Load32(src + i);
+			uint32_t hash = (sequence * 2654435761u) >> (32 - SNAPSHOT_HASH_BITS);
+			size_t candidate = table[hash];
+			table[hash] = (uint32_t)(i + 1);
+			if (candidate == 0 || i - (candidate - 1) > SNAPSHOT_MAX_OFFSET || Load32(src + candidate - 1) != sequence) {
+				i++;
+				continue;
+			}
+			size_t match = candidate - 1;
+			size_t length = SNAPSHOT_MIN_MATCH;
+			while (i + length < size && src[match + length] == src[i + length]) {
+				length++;
+			}
+			PutSequence(out, src + anchor, i - anchor, i - match, length);
+			i += length;
+			anchor = i;
+		}
+		if (anchor < size) {
+			PutSequence(out, src + anchor, size - anchor, 0, 0);
+		}
+	}
+
+	static bool GetLength(const uint8_t*& in, const uint8_t* end, size_t& length)
+	{
+		uint8_t byte;
+		do {
+			if (in >= end) {
+				return false;
+			}
+			byte = *in++;
+			length += byte;
+		} while (byte == 255);
+		return true;
+	}
+
+	/// <summary>
+	/// Decompress a block, checking every length and offset against the buffers
+	/// </summary>
+	/// <returns>false if the data is corrupt, or doesn't decompress to exactly size bytes</returns>
+	static bool DecompressBlock(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t size)
+	{
+		const uint8_t* in = src;
+		const uint8_t* inEnd = src + srcSize;
+		size_t out = 0;
+		while (in < inEnd) {
+			uint8_t token = *in++;
+			size_t literalCount = token >> 4;
+			if (literalCount == 15 && !GetLength(in, inEnd, literalCount)) {
+				return false;
+			}
+			if (literalCount > (size_t)(inEnd - in) || literalCount > size - out) {
+				return false;
+			}
+			memcpy(dst + out, in, literalCount);
+			in += literalCount;
+			out += literalCount;
+			if (in == inEnd) {
+				break; //the last sequence
+			}
+
+			if (inEnd - in < 2) {
+				return false;
+			}
+			size_t offset = (size_t)in[0] | ((size_t)in[1] << 8);
+			in += 2;
+			size_t matchLength = token & 0xF;
+			if (matchLength == 15 && !GetLength(in, inEnd, matchLength)) {
+				return false;
+			}
+			matchLength += SNAPSHOT_MIN_MATCH;
+			if (offset == 0 || offset > out || matchLength > size - out) {
+				return false;
+			}
+			//byte by byte, as the match may overlap what it is writing
+			const uint8_t* from = dst + out - offset;
+			for (size_t i = 0; i < matchLength; i++) {
+				dst[out + i] = from[i];
+			}
+			out += matchLength;
+		}
+		return out == size;
+	}
+
+
+	/*****************************************************************
+	 *                        SnapshotWriter                         *
+	 *****************************************************************/
+
+	SnapshotWriter::SnapshotWriter(std::ostream& stream, bool compress)
+		: m_Stream(stream), m_Compress(compress)
+	{
+		m_Block.reserve(SNAPSHOT_BLOCK_SIZE);
+		//header, never compressed
+		uint8_t header[16];
+		memcpy(header, SNAPSHOT_MAGIC, 8);
+		uint32_t fields[2] = { SNAPSHOT_VERSION, compress ? SNAPSHOT_FLAG_COMPRESSED : 0u };
+		for (int i = 0; i < 2; i++) {
+			for (int b = 0; b < 4; b++) {
+				header[8 + i * 4 + b] = (uint8_t)(fields[i] >> (8 * b));
+			}
+		}
+		m_Stream.write((const char*)header, sizeof(header));
+		m_StoredSize += sizeof(header);
+	}
+
+	SnapshotWriter::~SnapshotWriter()
+	{
+		Finish();
+	}
+
+	void SnapshotWriter::WriteU8(uint8_t value)
+	{
+		Put(&value, 1);
+	}
+
+	void SnapshotWriter::WriteU16(uint16_t value)
+	{
+		uint8_t bytes[2] = { (uint8_t)value, (uint8_t)(value >> 8) };
+		Put(bytes, 2);
+	}
+
+	void SnapshotWriter::WriteU32(uint32_t value)
+	{
+		uint8_t bytes[4] = { (uint8_t)value, (uint8_t)(value >> 8), (uint8_t)(value >> 16), (uint8_t)(value >> 24) };
+		Put(bytes, 4);
+	}
+
+	void SnapshotWriter::WriteU64(uint64_t value)
+	{
+		WriteU32((uint32_t)value);
+		WriteU32((uint32_t)(value >> 32));
+	}
+
+	void SnapshotWriter::WriteF32(float value)
+	{
+		uint32_t bits;
+		memcpy(&bits, &value, 4);
+		WriteU32(bits);
+	}
+
+	void SnapshotWriter::WriteString(const std::string& value)
+	{
+		WriteU32((uint32_t)value.size());
+		Put(value.data(), value.size());
+	}
+
+	void SnapshotWriter::WriteVector(const Vector& value)
+	{
+		WriteF32(value.x);
+		WriteF32(value.y);
+		WriteF32(value.z);
+	}
+
+	void SnapshotWriter::WriteRotator(const Rotator& value)
+	{
+		WriteF32(value.Roll);
+		WriteF32(value.Pitch);
+		WriteF32(value.Yaw);
+	}
+
+	void SnapshotWriter::WriteTransform(const Transform& value)
+	{
+		WriteVector(value.Position);
+		WriteRotator(value.Rotation);
+		WriteVector(value.Scale);
+	}
+
+	void SnapshotWriter::WriteVec4(const glm::vec4& value)
+	{
+		WriteF32(value.x);
+		WriteF32(value.y);
+		WriteF32(value.z);
+		WriteF32(value.w);
+	}
+
+	void SnapshotWriter::WriteU32Array(const uint32_t* values, size_t count)
+	{
+		if (IsLittleEndian()) {
+			Put(values, count * 4);
+		}
+		else {
+			for (size_t i = 0; i < count; i++) {
+				WriteU32(values[i]);
+			}
+		}
+	}
+
+	void SnapshotWriter::WriteKey(const std::string& key)
+	{
+		auto found = m_Keys.find(key);
+		if (found != m_Keys.end()) {
+			WriteU16(found->second);
+			return;
+		}
+		CHECK_F(m_Keys.size() < 0xFFFF, "SnapshotWriter: too many type keys in one snapshot!");
+		uint16_t index = (uint16_t)m_Keys.size();
+		m_Keys[key] = index;
+		//a new index is followed by the key itself
+		WriteU16(index);
+		WriteString(key);
+	}
+
+	bool SnapshotWriter::Finish()
+	{
+		if (!m_Finished) {
+			FlushBlock();
+			uint8_t end[8] = {};
+			m_Stream.write((const char*)end, sizeof(end));
+			m_StoredSize += sizeof(end);
+			m_Stream.flush();
+			m_Finished = true;
+		}
+		return m_Stream.good();
+	}
+
+	void SnapshotWriter::Put(const void* data, size_t size)
+	{
+		CHECK_F(!m_Finished, "SnapshotWriter: attempted to write to a finished snapshot!");
+		const uint8_t* bytes = (const uint8_t*)data;
+		while (size > 0) {
+			size_t count = std::min(size, (size_t)SNAPSHOT_BLOCK_SIZE - m_Block.size());
+			m_Block.insert(m_Block.end(), bytes, bytes + count);
+			bytes += count;
+			size -= count;
+			if (m_Block.size() == SNAPSHOT_BLOCK_SIZE) {
+				FlushBlock();
+			}
+		}
+	}
+
+	void SnapshotWriter::FlushBlock()
+	{
+		if (m_Block.size() == 0) {
+			return;
+		}
+		const uint8_t* stored = m_Block.data();
+		uint32_t storedSize = (uint32_t)m_Block.size();
+		if (m_Compress) {
+			CompressBlock(m_Block.data(), m_Block.size(), m_Compressed);
+			//a block that doesn't shrink is stored raw. The reader tells them apart by size
+			if (m_Compressed.size() < m_Block.size()) {
+				stored = m_Compressed.data();
+				storedSize = (uint32_t)m_Compressed.size();
+			}
+		}
+		uint32_t rawSize = (uint32_t)m_Block.size();
+		uint8_t header[8];
+		for (int b = 0; b < 4; b++) {
+			header[b] = (uint8_t)(rawSize >> (8 * b));
+			header[4 + b] = (uint8_t)(storedSize >> (8 * b));
+		}
+		m_Stream.write((const char*)header, sizeof(header));
+		m_Stream.write((const char*)stored, storedSize);
+		m_StoredSize += sizeof(header) + storedSize;
+		m_RawSize += rawSize;
+		m_Block.clear();
+	}
+
+
+	/*****************************************************************
+	 *                        SnapshotReader                         *
+	 *****************************************************************/
+
+	SnapshotReader::SnapshotReader(std::istream& stream)
+		: m_Stream(stream)
+	{
+		uint8_t header[16];
+		if (!m_Stream.read((char*)header, sizeof(header))) {
+			Fail("snapshot is too short to have a header");
+			return;
+		}
+		if (memcmp(header, SNAPSHOT_MAGIC, 8) != 0) {
+			Fail("not a snapshot (bad magic)");
+			return;
+		}
+		uint32_t fields[2] = {};
+		for (int i = 0; i < 2; i++) {
+			for (int b = 0; b < 4; b++) {
+				fields[i] |= (uint32_t)header[8 + i * 4 + b] << (8 * b);
+			}
+		}
+		m_Version = fields[0];
+		m_Flags = fields[1];
+		if (m_Version == 0 || m_Version > SNAPSHOT_VERSION) {
+			Fail("snapshot version " + std::to_string(m_Version) + " is not supported (newest supported is " + std::to_string(SNAPSHOT_VERSION) + ")");
+		}
+	}
+
+	uint8_t SnapshotReader::ReadU8()
+	{
+		uint8_t value = 0;
+		Get(&value, 1);
+		return value;
+	}
+
+	uint16_t SnapshotReader::ReadU16()
+	{
+		uint8_t bytes[2] = {};
+		Get(bytes, 2);
+		return (uint16_t)(bytes[0] | (bytes[1] << 8));
+	}
+
+	uint32_t SnapshotReader::ReadU32()
+	{
+		uint8_t bytes[4] = {};
+		Get(bytes, 4);
+		return (uint32_t)bytes[0] | ((uint32_t)bytes[1] << 8) | ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+	}
+
+	uint64_t SnapshotReader::ReadU64()
+	{
+		uint64_t low = ReadU32();
+		uint64_t high = ReadU32();
+		return low | (high << 32);
+	}
+
+	float SnapshotReader::ReadF32()
+	{
+		uint32_t bits = ReadU32();
+		float value;
+		memcpy(&value, &bits, 4);
+		return value;
+	}
+
+	std::string SnapshotReader::ReadString()
+	{
+		uint32_t size = ReadU32();
+		std::string value;
+		//a block at a time, so a corrupt size fails at the end of the data instead of allocating it all up front
+		while (size > 0 && Good()) {
+			size_t count = std::min((size_t)size, (size_t)SNAPSHOT_BLOCK_SIZE);
+			size_t start = value.size();
+			value.resize(start + count);
+			Get(&value[start], count);
+			size -= (uint32_t)count;
+		}
+		if (!Good()) {
+			value.clear();
+		}
+		return value;
+	}
+
+	Vector SnapshotReader::ReadVector()
+	{
+		float x = ReadF32();
+		float y = ReadF32();
+		float z = ReadF32();
+		return Vector(x, y, z);
+	}
+
+	Rotator SnapshotReader::ReadRotator()
+	{
+		float roll = ReadF32();
+		float pitch = ReadF32();
+		float yaw = ReadF32();
+		return Rotator(roll, pitch, yaw);
+	}
+
+	Transform SnapshotReader::ReadTransform()
+	{
+		Vector position = ReadVector();
+		Rotator rotation = ReadRotator();
+		Vector scale = ReadVector();
+		return Transform(position, rotation, scale);
+	}
+
+	glm::vec4 SnapshotReader::ReadVec4()
+	{
+		float x = ReadF32();
+		float y = ReadF32();
+		float z = ReadF32();
+		float w = ReadF32();
+		return { x, y, z, w };
+	}
+
+	void SnapshotReader::ReadU32Array(uint32_t* values, size_t count)
+	{
+		if (IsLittleEndian()) {
+			Get(values, count * 4);
+			if (!Good()) {
+				memset(values, 0, count * 4);
+			}
+		}
+		else {
+			for (size_t i = 0; i < count; i++) {
+				values[i] = ReadU32();
+			}
+		}
+	}
+
+	const std::string& SnapshotReader::ReadKey()
+	{
+		static const std::string empty;
+		uint16_t index = ReadU16();
+		if (!Good()) {
+			return empty;
+		}
+		if (index == m_Keys.size()) {
+			//first use, the key follows
+			m_Keys.push_back(ReadString());
+		}
+		else if (index > m_Keys.size()) {
+			Fail("type key index out of range");
+			return empty;
+		}
+		return m_Keys[index];
+	}
+
+	void SnapshotReader::Fail(const std::string& reason)
+	{
+		if (!m_Failed) {
+			LOG_S(ERROR) << "SnapshotReader: " << reason;
+			m_Failed = true;
+		}
+	}
+
+	bool SnapshotReader::AtEnd()
+	{
+		while (Good() && m_Cursor == m_Block.size()) {
+			if (!LoadBlock()) {
+				return m_Ended;
+			}
+		}
+		return false;
+	}
+
+	void SnapshotReader::Get(void* data, size_t size)
+	{
+		uint8_t* bytes = (uint8_t*)data;
+		while (size > 0 && Good()) {
+			if (m_Cursor == m_Block.size() && !LoadBlock()) {
+				Fail("unexpected end of snapshot");
+				break;
+			}
+			size_t count = std::min(size, m_Block.size() - m_Cursor);
+			memcpy(bytes, m_Block.data() + m_Cursor, count);
+			m_Cursor += count;
+			bytes += count;
+			size -= count;
+		}
+		if (size > 0) {
+			memset(bytes, 0, size);
+		}
+	}
+
+	bool SnapshotReader::LoadBlock()
+	{
+		if (m_Ended || !Good()) {
+			return false;
+		}
+		uint8_t header[8];
+		if (!m_Stream.read((char*)header, sizeof(header))) {
+			Fail("snapshot is truncated (missing block header)");
+			return false;
+		}
+		uint32_t rawSize = 0;
+		uint32_t storedSize = 0;
+		for (int b = 0; b < 4; b++) {
+			rawSize |= (uint32_t)header[b] << (8 * b);
+			storedSize |= (uint32_t)header[4 + b] << (8 * b);
+		}
+		if (rawSize == 0) {
+			//the end marker
+			m_Ended = true;
+			m_Block.clear();
+			m_Cursor = 0;
+			return false;
+		}
+		if (rawSize > SNAPSHOT_BLOCK_SIZE || storedSize > rawSize || storedSize == 0) {
+			Fail("snapshot is corrupt (bad block header)");
+			return false;
+		}
+		m_Block.resize(rawSize);
+		m_Cursor = 0;
+		if (storedSize == rawSize) {
+			if (!m_Stream.read((char*)m_Block.data(), rawSize)) {
+				Fail("snapshot is truncated (incomplete block)");
+				return false;
+			}
+		}
+		else {
+			m_Compressed.resize(storedSize);
+			if (!m_Stream.read((char*)m_Compressed.data(), storedSize)) {
+				Fail("snapshot is truncated (incomplete block)");
+				return false;
+			}
+			if (!DecompressBlock(m_Compressed.data(), storedSize, m_Block.data(), rawSize)) {
+				Fail("snapshot is corrupt (block does not decompress)");
+				return false;
+			}
+		}
+		return true;
+	}
+
+
+	/*****************************************************************
+	 *                       SnapshotRegistry                        *
+	 *****************************************************************/
+
+	SnapshotRegistry::SnapshotRegistry()
+	{
+		RegisterBuiltinTypes();
+	}
+
+	SnapshotRegistry* SnapshotRegistry::Get()
+	{
+		static SnapshotRegistry registry;
+		return &registry;
+	}
+
+	void SnapshotRegistry::RegisterEntity(TypeId type, const std::string& key, EntitySaver saver, EntityLoader loader)
+	{
+		auto existing = m_EntityKeys.find(key);
+		CHECK_F(existing == m_EntityKeys.end() || existing->second == type, "SnapshotRegistry: entity key \"%s\" is already used by another type!", key.c_str());
+		auto old = m_Entities.find(type);
+		if (old != m_Entities.end()) {
+			m_EntityKeys.erase(old->second.Key);
+		}
+		m_Entities[type] = { key, saver, loader };
+		m_EntityKeys[key] = type;
+		//the nearest registered base of other types may have changed
+		m_EntityFallbacks.clear();
+	}
+
+	void SnapshotRegistry::RegisterComponent(TypeId type, const std::string& key, ComponentSaver saver, ComponentLoader loader)
+	{
+		auto existing = m_ComponentKeys.find(key);
+		CHECK_F(existing == m_ComponentKeys.end() || existing->second == type, "SnapshotRegistry: component key \"%s\" is already used by another type!", key.c_str());
+		auto old = m_Components.find(type);
+		if (old != m_Components.end()) {
+			m_ComponentKeys.erase(old->second.Key);
+		}
+		m_Components[type] = { key, saver, loader };
+		m_ComponentKeys[key] = type;
+		m_SkippedComponents.erase(type);
+	}
+
+	bool SnapshotRegistry::SaveLayer(const Layer& layer, std::ostream& stream, bool compress)
+	{
+		SnapshotWriter writer(stream, compress);
+		uint32_t count = 0;
+		for (auto& root : layer.m_Entities) {
+			if (root && root->m_Exists) {
+				count++;
+			}
+		}
+		writer.WriteU32(count);
+		for (auto& root : layer.m_Entities) {
+			if (root && root->m_Exists) {
+				SaveEntity(*root, layer.m_LayerCamera.get(), writer);
+			}
+		}
+		if (!writer.Finish()) {
+			LOG_S(ERROR) << "SnapshotRegistry: failed to write the snapshot of a layer!";
+			return false;
+		}
+		return true;
+	}
+
+	bool SnapshotRegistry::LoadLayer(Layer& layer, std::istream& stream)
+	{
+		if (layer.IsDeferringStructuralChanges()) {
+			LOG_S(ERROR) << "SnapshotRegistry: can't load a snapshot into a layer while it is updating or drawing!";
+			return false;
+		}
+		SnapshotReader reader(stream);
+		CameraEntityRef camera = layer.m_LayerCamera;
+		//everything loaded so far, to take back out if a later entity fails
+		std::vector<EntityRef> loaded;
+		uint32_t count = reader.ReadU32();
+		loaded.reserve(std::min(count, SNAPSHOT_MAX_RESERVE));
+		for (uint32_t i = 0; i < count && reader.Good(); i++) {
+			EntityRef entity = LoadEntity(EntityNoRef(), layer, reader);
+			if (entity) {
+				loaded.push_back(entity);
+			}
+		}
+		if (reader.Good() && !reader.AtEnd()) {
+			reader.Fail("snapshot has data after the last entity");
+		}
+		if (!reader.Good()) {
+			for (auto& entity : loaded) {
+				DiscardEntity(entity);
+			}
+			layer.m_LayerCamera = camera;
+			return false;
+		}
+		return true;
+	}
+
+	bool SnapshotRegistry::SaveEntityTree(const Entity& root, std::ostream& stream, bool compress)
+	{
+		SnapshotWriter writer(stream, compress);
+		SaveEntity(root, nullptr, writer);
+		if (!writer.Finish()) {
+			LOG_S(ERROR) << "SnapshotRegistry: failed to write the snapshot of entity \"" << root.GetName() << "\"!";
+			return false;
+		}
+		return true;
+	}
+
+	EntityRef SnapshotRegistry::LoadEntityTree(EntityNoRef parent, Layer& layer, std::istream& stream, const Transform* transform)
+	{
+		SnapshotReader reader(stream);
+		CameraEntityRef camera = layer.m_LayerCamera;
+		EntityRef root = LoadEntity(parent, layer, reader, transform);
+		if (reader.Good() && !reader.AtEnd()) {
+			reader.Fail("snapshot has data after the entity");
+		}
+		if (!reader.Good()) {
+			if (root) {
+				DiscardEntity(root);
+			}
+			layer.m_LayerCamera = camera;
+			return nullptr;
+		}
+		return root;
+	}
+
+	bool SnapshotRegistry::CanSaveValue(const std::any& value) const
+	{
+		return m_ValueSavers.find(std::type_index(value.type())) != m_ValueSavers.end();
+	}
+
+	void SnapshotRegistry::SaveValue(const std::any& value, SnapshotWriter& writer) const
+	{
+		auto found = m_ValueSavers.find(std::type_index(value.type()));
+		CHECK_F(found != m_ValueSavers.end(), "SnapshotRegistry: attempted to save a value of an unregistered type!");
+		writer.WriteKey(found->second.Key);
+		found->second.Saver(value, writer);
+	}
+
+	std::any SnapshotRegistry::LoadValue(SnapshotReader& reader) const
+	{
+		const std::string& key = reader.ReadKey();
+		if (!reader.Good()) {
+			return {};
+		}
+		auto found = m_ValueLoaders.find(key);
+		if (found == m_ValueLoaders.end()) {
+			reader.Fail("unknown value type \"" + key + "\"");
+			return {};
+		}
+		return found->second(reader);
+	}
+
+	const SnapshotRegistry::EntityEntry* SnapshotRegistry::FindEntityEntry(TypeId type)
+	{
+		auto found = m_Entities.find(type);
+		if (found != m_Entities.end()) {
+			return &found->second;
+		}
+		auto cached = m_EntityFallbacks.find(type);
+		if (cached != m_EntityFallbacks.end()) {
+			return cached->second;
+		}
+		//the most derived registered type this one is a subclass of. Entity itself is always registered, so there is one
+		TypeId best = TypeRegistry<Entity>::Get<Entity>();
+		for (auto& kv : m_Entities) {
+			if (TypeRegistry<Entity>::IsA(type, kv.first) && TypeRegistry<Entity>::IsA(kv.first, best)) {
+				best = kv.first;
+			}
+		}
+		const EntityEntry* entry = &m_Entities.at(best);
+		LOG_S(WARNING) << "SnapshotRegistry: entity type " << type << " is not registered, saving it as \"" << entry->Key << "\"";
+		m_EntityFallbacks[type] = entry;
+		return entry;
+	}
+
+	void SnapshotRegistry::SaveEntity(const Entity& entity, const Entity* layerCamera, SnapshotWriter& writer)
+	{
+		const EntityEntry* entry = FindEntityEntry(entity.GetTypeId());
+		writer.WriteKey(entry->Key);
+		writer.WriteString(entity.GetName());
+		writer.WriteTransform(entity.GetRelativeTransform());
+		writer.WriteU32(entity.GetRenderFilterBits());
+		uint8_t flags = 0;
+		flags |= entity.GetVisible() ? SNAPSHOT_ENTITY_VISIBLE : 0;
+		flags |= entity.GetTickEnabled() ? SNAPSHOT_ENTITY_TICK_ENABLED : 0;
+		flags |= entity.GetTickLODEnabled() ? SNAPSHOT_ENTITY_TICK_LOD : 0;
+		flags |= entity.GetParallelUpdateSafe() ? SNAPSHOT_ENTITY_PARALLEL_SAFE : 0;
+		flags |= entity.GetUpdateChildrenFirst() ? SNAPSHOT_ENTITY_UPDATE_CHILDREN_FIRST : 0;
+		flags |= entity.GetUpdateComponentsFirst() ? SNAPSHOT_ENTITY_UPDATE_COMPONENTS_FIRST : 0;
+		flags |= entity.GetDrawChildrenFirst() ? SNAPSHOT_ENTITY_DRAW_CHILDREN_FIRST : 0;
+		flags |= (&entity == layerCamera) ? SNAPSHOT_ENTITY_LAYER_CAMERA : 0;
+		writer.WriteU8(flags);
+		writer.WriteF32(entity.GetTickInterval());
+		writer.WriteU8((uint8_t)entity.GetTickGroup());
+		entry->Saver(entity, writer);
+
+		//components. Ones of unregistered types can't be recreated, so are left out
+		uint32_t componentCount = 0;
+		for (auto& component : entity.m_Components) {
+			if (!component) {
+				continue;
+			}
+			if (m_Components.find(component->GetTypeId()) != m_Components.end()) {
+				componentCount++;
+			}
+			else if (m_SkippedComponents.insert(component->GetTypeId()).second) {
+				LOG_S(WARNING) << "SnapshotRegistry: component type " << component->GetTypeId() << " is not registered, components of it are not saved";
+			}
+		}
+		writer.WriteU32(componentCount);
+		for (auto& component : entity.m_Components) {
+			if (!component) {
+				continue;
+			}
+			auto found = m_Components.find(component->GetTypeId());
+			if (found == m_Components.end()) {
+				continue;
+			}
+			writer.WriteKey(found->second.Key);
+			writer.WriteString(component->GetName());
+			writer.WriteBool(component->GetTickEnabled());
+			writer.WriteF32(component->GetTickInterval());
+			writer.WriteU8((uint8_t)component->GetTickGroup());
+			found->second.Saver(*component, writer);
+		}
+
+		//children, depth first
+		uint32_t childCount = 0;
+		for (auto& child : entity.m_Children) {
+			if (child && child->m_Exists) {
+				childCount++;
+			}
+		}
+		writer.WriteU32(childCount);
+		for (auto& child : entity.m_Children) {
+			if (child && child->m_Exists) {
+				SaveEntity(*child, layerCamera, writer);
+			}
+		}
+	}
+
+	std::string SnapshotRegistry::FindUnregisteredType(const Entity& root) const
+	{
+		if (m_Entities.find(root.GetTypeId()) == m_Entities.end()) {
+			return "entity \"" + root.GetName() + "\" is of unregistered type " + typeid(root).name();
+		}
+		for (auto& component : root.m_Components) {
+			if (component && m_Components.find(component->GetTypeId()) == m_Components.end()) {
+				return "component \"" + component->GetName() + "\" of entity \"" + root.GetName() + "\" is of unregistered type " + typeid(*component).name();
+			}
+		}
+		for (auto& child : root.m_Children) {
+			if (child && child->m_Exists) {
+				std::string found = FindUnregisteredType(*child);
+				if (!found.empty()) {
+					return found;
+				}
+			}
+		}
+		return "";
+	}
+
+	EntityRef SnapshotRegistry::LoadEntity(EntityNoRef parent, Layer& layer, SnapshotReader& reader, const Transform* transformOverride)
+	{
+		std::string key = reader.ReadKey();
+		std::string name = reader.ReadString();
+		Transform transform = reader.ReadTransform();
+		if (transformOverride) {
+			transform = *transformOverride;
+		}
+		uint32_t filterBits = reader.ReadU32();
+		uint8_t flags = reader.ReadU8();
+		float tickInterval = reader.ReadF32();
+		uint32_t tickGroup = reader.ReadU8();
+		if (!reader.Good()) {
+			return nullptr;
+		}
+		auto type = m_EntityKeys.find(key);
+		if (type == m_EntityKeys.end()) {
+			reader.Fail("unknown entity type \"" + key + "\"");
+			return nullptr;
+		}
+		if (tickGroup >= TICK_GROUP_COUNT) {
+			reader.Fail("entity tick group out of range");
+			return nullptr;
+		}
+		EntityRef entity = m_Entities[type->second].Loader(parent, layer.weak_from_this(), transform, name, reader);
+		//from here on, a failure takes out the entity, with whatever of its components and children were loaded
+		auto fail = [this, &entity]() -> EntityRef {
+			if (entity) {
+				DiscardEntity(entity);
+			}
+			return nullptr;
+		};
+		if (!entity || !reader.Good()) {
+			reader.Fail("failed to load entity \"" + name + "\" of type \"" + key + "\"");
+			return fail();
+		}
+		entity->SetRenderFilterBits(filterBits);
+		entity->SetVisible(flags & SNAPSHOT_ENTITY_VISIBLE);
+		entity->SetTickEnabled(flags & SNAPSHOT_ENTITY_TICK_ENABLED);
+		entity->SetTickLODEnabled(flags & SNAPSHOT_ENTITY_TICK_LOD);
+		entity->SetParallelUpdateSafe(flags & SNAPSHOT_ENTITY_PARALLEL_SAFE);
+		entity->SetUpdateChildrenFirst(flags & SNAPSHOT_ENTITY_UPDATE_CHILDREN_FIRST);
+		entity->SetUpdateComponentsFirst(flags & SNAPSHOT_ENTITY_UPDATE_COMPONENTS_FIRST);
+		entity->SetDrawChildrenFirst(flags & SNAPSHOT_ENTITY_DRAW_CHILDREN_FIRST);
+		entity->SetTickInterval(tickInterval);
+		entity->SetTickGroup(tickGroup);
+		if ((flags & SNAPSHOT_ENTITY_LAYER_CAMERA) && entity->IsOfType<CameraEntity>()) {
+			layer.SetLayerCamera(std::static_pointer_cast<CameraEntity>(entity));
+		}
+
+		//counts come from the stream, so are capped before reserving
+		uint32_t componentCount = reader.ReadU32();
+		entity->m_Components.reserve(entity->m_Components.size() + std::min(componentCount, SNAPSHOT_MAX_RESERVE));
+		for (uint32_t i = 0; i < componentCount && reader.Good(); i++) {
+			std::string componentKey = reader.ReadKey();
+			std::string componentName = reader.ReadString();
+			bool componentTickEnabled = reader.ReadBool();
+			float componentTickInterval = reader.ReadF32();
+			uint32_t componentTickGroup = reader.ReadU8();
+			if (!reader.Good()) {
+				return fail();
+			}
+			auto componentType = m_ComponentKeys.find(componentKey);
+			if (componentType == m_ComponentKeys.end()) {
+				reader.Fail("unknown component type \"" + componentKey + "\"");
+				return fail();
+			}
+			if (componentTickGroup >= TICK_GROUP_COUNT) {
+				reader.Fail("component tick group out of range");
+				return fail();
+			}
+			ComponentRef component = m_Components[componentType->second].Loader(entity, componentName, reader);
+			if (!component || !reader.Good()) {
+				reader.Fail("failed to load component \"" + componentName + "\" of type \"" + componentKey + "\"");
+				return fail();
+			}
+			component->SetTickEnabled(componentTickEnabled);
+			component->SetTickInterval(componentTickInterval);
+			component->SetTickGroup(componentTickGroup);
+		}
+
+		uint32_t childCount = reader.ReadU32();
+		entity->m_Children.reserve(entity->m_Children.size() + std::min(childCount, SNAPSHOT_MAX_RESERVE));
+		for (uint32_t i = 0; i < childCount && reader.Good(); i++) {
+			if (!LoadEntity(entity, layer, reader)) {
+				return fail();
+			}
+		}
+		return reader.Good() ? entity : fail();
+	}
+
+	void SnapshotRegistry::DiscardEntity(const EntityRef& entity)
+	{
+		if (entity->IsDeferringStructuralChanges()) {
+			entity->DeferStructuralChange([this, entity]() { DiscardEntity(entity); });
+			return;
+		}
+		if (!entity->m_Exists) {
+			return;
+		}
+		//children first, as destroying an entity hands its children to the layer. From a copy, as destroying removes them
+		auto children = entity->m_Children;
+		for (auto& child : children) {
+			if (child) {
+				DiscardEntity(child);
+			}
+		}
+		entity->Destroy();
+	}
+
+	void SnapshotRegistry::RegisterBuiltinTypes()
+	{
+		/*
+		 * Entities
+		 */
+		RegisterEntity<Entity>("Tara::Entity",
+			[](const Entity&, SnapshotWriter&) {},
+			[](EntityNoRef parent, LayerNoRef layer, const Transform& transform, const std::string& name, SnapshotReader&) -> EntityRef {
+				return CreateEntity<Entity>(parent, layer, transform, name);
+			}
+		);
+
+		RegisterEntity<SpriteEntity>("Tara::SpriteEntity",
+			[](const Entity& entity, SnapshotWriter& writer) {
+				const SpriteEntity& sprite = static_cast<const SpriteEntity&>(entity);
+				writer.WriteString(sprite.GetSprite() ? sprite.GetSprite()->GetAssetName() : "");
+				writer.WriteU32(sprite.GetCurrentFrame());
+				writer.WriteU32(sprite.GetCurrentSequence().Start);
+				writer.WriteU32(sprite.GetCurrentSequence().End);
+				writer.WriteF32(1.0f / sprite.GetCurrentSequence().IFrameRate); //0 when no sequence is playing
+				writer.WriteVec4(sprite.GetTint());
+				writer.WriteU8(sprite.GetFlip());
+				writer.WriteU8(sprite.GetSortLayer());
+			},
+			[](EntityNoRef parent, LayerNoRef layer, const Transform& transform, const std::string& name, SnapshotReader& reader) -> EntityRef {
+				std::string spriteName = reader.ReadString();
+				uint32_t frame = reader.ReadU32();
+				uint32_t sequenceStart = reader.ReadU32();
+				uint32_t sequenceEnd = reader.ReadU32();
+				float sequenceRate = reader.ReadF32();
+				glm::vec4 tint = reader.ReadVec4();
+				uint8_t flip = reader.ReadU8();
+				//version 2 added sort layers
+				uint8_t sortLayer = (reader.GetVersion() >= 2) ? reader.ReadU8() : 0;
+				SpriteRef asset = nullptr;
+				if (spriteName.size() > 0) {
+					asset = AssetLibrary::Get()->GetAssetIf<Sprite>(spriteName);
+					if (!asset) {
+						LOG_S(WARNING) << "SnapshotRegistry: sprite \"" << spriteName << "\" is not loaded, entity \"" << name << "\" will have no sprite";
+					}
+				}
+				auto sprite = CreateEntity<SpriteEntity>(parent, layer, transform, name, asset);
+				if (asset) {
+					if (sequenceRate > 0.0f) {
+						//a playing animation restarts from its first frame
+						sprite->SetCurrentSequence(Sprite::AnimationSequence(sequenceStart, sequenceEnd, sequenceRate));
+					}
+					else {
+						sprite->SetCurrentFrame(frame);
+					}
+				}
+				sprite->SetTint(tint);
+				sprite->SetFlip(flip);
+				sprite->SetSortLayer(sortLayer);
+				return sprite;
+			}
+		);
+
+		RegisterEntity<CameraEntity>("Tara::CameraEntity",
+			[](const Entity& entity, SnapshotWriter& writer) {
+				const CameraEntity& camera = static_cast<const CameraEntity&>(entity);
+				Camera::ProjectionType type = camera.GetProjectionType();
+				writer.WriteU8((uint8_t)type);
+				if (type == Camera::ProjectionType::Ortographic) {
+					auto extent = std::static_pointer_cast<OrthographicCamera>(camera.GetCamera())->GetExtent();
+					writer.WriteF32(extent.Left);
+					writer.WriteF32(extent.Right);
+					writer.WriteF32(extent.Bottom);
+					writer.WriteF32(extent.Top);
+					writer.WriteF32(extent.Near);
+					writer.WriteF32(extent.Far);
+				}
+				else if (type == Camera::ProjectionType::Perspective) {
+					writer.WriteF32(std::static_pointer_cast<PerspectiveCamera>(camera.GetCamera())->GetFOV());
+				}
+				writer.WriteBool(camera.GetUseWorldScale());
+				writer.WriteBool(camera.GetMimicWindowSize());
+				writer.WriteBool(camera.GetRenderEveryFrame());
+			},
+			[](EntityNoRef parent, LayerNoRef layer, const Transform& transform, const std::string& name, SnapshotReader& reader) -> EntityRef {
+				uint8_t type = reader.ReadU8();
+				if (type > (uint8_t)Camera::ProjectionType::Screen) {
+					reader.Fail("camera projection type out of range");
+					return nullptr;
+				}
+				auto camera = CreateEntity<CameraEntity>(parent, layer, (Camera::ProjectionType)type, transform, name);
+				if ((Camera::ProjectionType)type == Camera::ProjectionType::Ortographic) {
+					float left = reader.ReadF32();
+					float right = reader.ReadF32();
+					float bottom = reader.ReadF32();
+					float top = reader.ReadF32();
+					float nearPlane = reader.ReadF32();
+					float farPlane = reader.ReadF32();
+					camera->SetOrthographicExtent(OrthographicCamera::OrthoExtent(left, right, bottom, top, nearPlane, farPlane));
+				}
+				else if ((Camera::ProjectionType)type == Camera::ProjectionType::Perspective) {
+					camera->SetPerspectiveFOV(reader.ReadF32());
+				}
+				camera->SetUseWorldScale(reader.ReadBool());
+				camera->SetMimicWindowSize(reader.ReadBool());
+				camera->SetRenderEveryFrame(reader.ReadBool());
+				return camera;
+			}
+		);
+
+		RegisterEntity<TextEntity>("Tara::TextEntity",
+			[](const Entity& entity, SnapshotWriter& writer) {
+				const TextEntity& text = static_cast<const TextEntity&>(entity);
+				writer.WriteString(text.GetFont() ? text.GetFont()->GetAssetName() : "");
+				writer.WriteString(text.GetText());
+				writer.WriteVec4(text.GetColor());
+			},
+			[](EntityNoRef parent, LayerNoRef layer, const Transform& transform, const std::string& name, SnapshotReader& reader) -> EntityRef {
+				std::string fontName = reader.ReadString();
+				std::string text = reader.ReadString();
+				glm::vec4 color = reader.ReadVec4();
+				FontRef font = AssetLibrary::Get()->GetAssetIf<Font>(fontName);
+				if (!font) {
+					//a text entity must have a font
+					reader.Fail("font \"" + fontName + "\" is not loaded");
+					return nullptr;
+				}
+				auto entity = CreateEntity<TextEntity>(parent, layer, font, text, transform, name);
+				entity->SetColor(color);
+				return entity;
+			}
+		);
+
+		RegisterEntity<TilemapEntity>("Tara::TilemapEntity",
+			[](const Entity& entity, SnapshotWriter& writer) {
+				static_cast<const TilemapEntity&>(entity).WriteSnapshot(writer);
+			},
+			[](EntityNoRef parent, LayerNoRef layer, const Transform& transform, const std::string& name, SnapshotReader& reader) -> EntityRef {
+				auto tilemap = CreateEntity<TilemapEntity>(parent, layer, std::initializer_list<TilesetRef>{}, transform, name);
+				tilemap->ReadSnapshot(reader);
+				return tilemap;
+			}
+		);
+
+		/*
+		 * Components
+		 */
+		RegisterComponent<ScriptComponent>("Tara::ScriptComponent",
+			[](const Component& component, SnapshotWriter& writer) {
+				writer.WriteString(static_cast<const ScriptComponent&>(component).GetPath());
+			},
+			[](EntityNoRef parent, const std::string& name, SnapshotReader& reader) -> ComponentRef {
+				std::string path = reader.ReadString();
+				return CreateComponent<ScriptComponent>(parent, path, name);
+			}
+		);
+
+		/*
+		 * Values
+		 */
+		RegisterValue<int32_t>("int32",
+			[](const std::any& value, SnapshotWriter& writer) { writer.WriteI32(std::any_cast<int32_t>(value)); },
+			[](SnapshotReader& reader) -> std::any { return reader.ReadI32(); }
+		);
+		RegisterValue<uint32_t>("uint32",
+			[](const std::any& value, SnapshotWriter& writer) { writer.WriteU32(std::any_cast<uint32_t>(value)); },
+			[](SnapshotReader& reader) -> std::any { return reader.ReadU32(); }
+		);
+		RegisterValue<int64_t>("int64",
+			[](const std::any& value, SnapshotWriter& writer) { writer.WriteU64((uint64_t)std::any_cast<int64_t>(value)); },
+			[](SnapshotReader& reader) -> std::any { return (int64_t)reader.ReadU64(); }
+		);
+		RegisterValue<float>("float",
+			[](const std::any& value, SnapshotWriter& writer) { writer.WriteF32(std::any_cast<float>(value)); },
+			[](SnapshotReader& reader) -> std::any { return reader.ReadF32(); }
+		);
+		RegisterValue<double>("double",
+			[](const std::any& value, SnapshotWriter& writer) {
+				double d = std::any_cast<double>(value);
+				uint64_t bits;
+				memcpy(&bits, &d, 8);
+				writer.WriteU64(bits);
+			},
+			[](SnapshotReader& reader) -> std::any {
+				uint64_t bits = reader.ReadU64();
+				double d;
+				memcpy(&d, &bits, 8);
+				return d;
+			}
+		);
+		RegisterValue<bool>("bool",
+			[](const std::any& value, SnapshotWriter& writer) { writer.WriteBool(std::any_cast<bool>(value)); },
+			[](SnapshotReader& reader) -> std::any { return reader.ReadBool(); }
+		);
+		RegisterValue<std::string>("string",
+			[](const std::any& value, SnapshotWriter& writer) { writer.WriteString(std::any_cast<const std::string&>(value)); },
+			[](SnapshotReader& reader) -> std::any { return reader.ReadString(); }
+		);
+	}
+
+}
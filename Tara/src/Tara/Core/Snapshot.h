@@ -0,0 +1,416 @@
+#pragma once
+#include "tarapch.h"
+#include "Tara/Core/Entity.h"
+#include <any>
+#include <typeindex>
+
+//the first bytes of every snapshot
+#define SNAPSHOT_MAGIC "TARASNAP"
+//the format version written by this build. Readers accept this version and older
+#define SNAPSHOT_VERSION 2
+//the body is written in blocks of up to this many bytes, each compressed on its own
+#define SNAPSHOT_BLOCK_SIZE (64 * 1024)
+//header flag bits
+#define SNAPSHOT_FLAG_COMPRESSED 0x1
+
+namespace Tara {
+
+	/// <summary>
+	/// Writes a binary snapshot to a stream. Everything is little-endian, no matter the platform.
+	/// The header is written on construction. The body is buffered into blocks, which are written (and compressed, if enabled)
+	/// as they fill, so a snapshot of any size is written in one pass with a fixed amount of memory. Call Finish() when done.
+	/// </summary>
+	class SnapshotWriter {
+	public:
+		/// <summary>
+		/// Start a snapshot
+		/// </summary>
+		/// <param name="stream">the stream to write to. Should be opened in binary mode</param>
+		/// <param name="compress">true to compress the blocks. Blocks that don't shrink are stored raw anyway</param>
+		SnapshotWriter(std::ostream& stream, bool compress = true);
+
+		/// <summary>
+		/// Destructor. Finishes the snapshot, if not already finished
+		/// </summary>
+		~SnapshotWriter();
+
+		SnapshotWriter(const SnapshotWriter&) = delete;
+		SnapshotWriter& operator=(const SnapshotWriter&) = delete;
+
+		void WriteU8(uint8_t value);
+		void WriteU16(uint16_t value);
+		void WriteU32(uint32_t value);
+		void WriteU64(uint64_t value);
+		inline void WriteI32(int32_t value) { WriteU32((uint32_t)value); }
+		void WriteF32(float value);
+		inline void WriteBool(bool value) { WriteU8(value ? 1 : 0); }
+		void WriteString(const std::string& value);
+		void WriteVector(const Vector& value);
+		void WriteRotator(const Rotator& value);
+		void WriteTransform(const Transform& value);
+		void WriteVec4(const glm::vec4& value);
+
+		/// <summary>
+		/// Write an array of 32 bit values as one raw block. A straight copy on little-endian platforms.
+		/// </summary>
+		/// <param name="values">the values</param>
+		/// <param name="count">the number of values</param>
+		void WriteU32Array(const uint32_t* values, size_t count);
+
+		/// <summary>
+		/// Write a type key. Each key is written in full the first time, and as a 16 bit index after that.
+		/// </summary>
+		/// <param name="key">the key</param>
+		void WriteKey(const std::string& key);
+
+		/// <summary>
+		/// Write the last block and the end marker, and flush the stream. Nothing can be written after.
+		/// </summary>
+		/// <returns>true if everything was written successfully</returns>
+		bool Finish();
+
+		/// <summary>
+		/// Check if the stream is still good
+		/// </summary>
+		/// <returns>true if nothing has failed</returns>
+		inline bool Good() const { return m_Stream.good(); }
+
+		/// <summary>
+		/// Get the number of body bytes written so far, before compression
+		/// </summary>
+		/// <returns>the byte count</returns>
+		inline uint64_t GetRawSize() const { return m_RawSize + m_Block.size(); }
+
+		/// <summary>
+		/// Get the number of bytes written to the stream so far, header and block headers included
+		/// </summary>
+		/// <returns>the byte count</returns>
+		inline uint64_t GetStoredSize() const { return m_StoredSize; }
+
+	private:
+		/// <summary>
+		/// Append bytes to the current block, writing out full blocks
+		/// </summary>
+		void Put(const void* data, size_t size);
+
+		/// <summary>
+		/// Write out the current block, if it has anything in it
+		/// </summary>
+		void FlushBlock();
+
+	private:
+		std::ostream& m_Stream;
+		bool m_Compress;
+		bool m_Finished = false;
+		std::vector<uint8_t> m_Block;
+		std::vector<uint8_t> m_Compressed;
+		std::unordered_map<std::string, uint16_t> m_Keys;
+		uint64_t m_RawSize = 0;
+		uint64_t m_StoredSize = 0;
+	};
+
+
+	/// <summary>
+	/// Reads a binary snapshot written by SnapshotWriter, in one pass, a block at a time.
+	/// Reading past the end, or from a corrupt or truncated snapshot, marks the reader failed. After that, every read returns zero/empty,
+	/// so loaders can read a whole record and check Good() once after.
+	/// </summary>
+	class SnapshotReader {
+	public:
+		/// <summary>
+		/// Start reading a snapshot, checking the header
+		/// </summary>
+		/// <param name="stream">the stream to read from. Should be opened in binary mode</param>
+		SnapshotReader(std::istream& stream);
+
+		SnapshotReader(const SnapshotReader&) = delete;
+		SnapshotReader& operator=(const SnapshotReader&) = delete;
+
+		uint8_t ReadU8();
+		uint16_t ReadU16();
+		uint32_t ReadU32();
+		uint64_t ReadU64();
+		inline int32_t ReadI32() { return (int32_t)ReadU32(); }
+		float ReadF32();
+		inline bool ReadBool() { return ReadU8() != 0; }
+		std::string ReadString();
+		Vector ReadVector();
+		Rotator ReadRotator();
+		Transform ReadTransform();
+		glm::vec4 ReadVec4();
+
+		/// <summary>
+		/// Read an array written by WriteU32Array
+		/// </summary>
+		/// <param name="values">where to put the values</param>
+		/// <param name="count">the number of values</param>
+		void ReadU32Array(uint32_t* values, size_t count);
+
+		/// <summary>
+		/// Read a type key written by WriteKey
+		/// </summary>
+		/// <returns>the key, or the empty string if failed</returns>
+		const std::string& ReadKey();
+
+		/// <summary>
+		/// Mark the reader failed, logging why. For loaders that find something invalid.
+		/// </summary>
+		/// <param name="reason">the reason</param>
+		void Fail(const std::string& reason);
+
+		/// <summary>
+		/// Check if everything read so far was valid
+		/// </summary>
+		/// <returns>true if nothing has failed</returns>
+		inline bool Good() const { return !m_Failed; }
+
+		/// <summary>
+		/// Get the format version of the snapshot, for loaders that read older versions differently
+		/// </summary>
+		/// <returns>the version</returns>
+		inline uint32_t GetVersion() const { return m_Version; }
+
+		/// <summary>
+		/// Check if the whole body has been read
+		/// </summary>
+		/// <returns>true if the end marker was reached and the last block is used up</returns>
+		bool AtEnd();
+
+	private:
+		/// <summary>
+		/// Take bytes from the current block, reading in blocks as needed
+		/// </summary>
+		void Get(void* data, size_t size);
+
+		/// <summary>
+		/// Read in the next block
+		/// </summary>
+		/// <returns>false at the end marker, or on failure</returns>
+		bool LoadBlock();
+
+	private:
+		std::istream& m_Stream;
+		uint32_t m_Version = 0;
+		uint32_t m_Flags = 0;
+		bool m_Failed = false;
+		bool m_Ended = false;
+		std::vector<uint8_t> m_Block;
+		std::vector<uint8_t> m_Compressed;
+		size_t m_Cursor = 0;
+		std::vector<std::string> m_Keys;
+	};
+
+
+	/// <summary>
+	/// The types that can be saved to and loaded from a snapshot, and the functions that do it.
+	/// Entity and component types are looked up by their TypeRegistry id when saving. An entity type that isn't registered is saved
+	/// as the nearest registered type it derives from (with a warning), and a component type that isn't registered is skipped.
+	/// Values (the std::any cell metadata of tilemaps) are looked up by their type. Values of unregistered types are skipped.
+	/// Types are stored by key, so keys must stay the same between the save and the load. The engine's own types are registered already.
+	/// Register types before saving or loading on other threads.
+	/// </summary>
+	class SnapshotRegistry {
+	private:
+		SnapshotRegistry();
+
+	public:
+		/// <summary>
+		/// Save the type's own data (the common entity data is already saved)
+		/// </summary>
+		using EntitySaver = std::function<void(const Entity& entity, SnapshotWriter& writer)>;
+		/// <summary>
+		/// Read the type's own data, and create the entity with CreateEntity. Return nullptr (and call reader.Fail) if it can't be made.
+		/// </summary>
+		using EntityLoader = std::function<EntityRef(EntityNoRef parent, LayerNoRef layer, const Transform& transform, const std::string& name, SnapshotReader& reader)>;
+		/// <summary>
+		/// Save the type's own data
+		/// </summary>
+		using ComponentSaver = std::function<void(const Component& component, SnapshotWriter& writer)>;
+		/// <summary>
+		/// Read the type's own data, and create the component with CreateComponent. Return nullptr (and call reader.Fail) if it can't be made.
+		/// </summary>
+		using ComponentLoader = std::function<ComponentRef(EntityNoRef parent, const std::string& name, SnapshotReader& reader)>;
+		/// <summary>
+		/// Save a value, held in a std::any of the registered type
+		/// </summary>
+		using ValueSaver = std::function<void(const std::any& value, SnapshotWriter& writer)>;
+		/// <summary>
+		/// Read a value
+		/// </summary>
+		using ValueLoader = std::function<std::any(SnapshotReader& reader)>;
+
+		/// <summary>
+		/// Get the singleton SnapshotRegistry
+		/// </summary>
+		/// <returns>the registry</returns>
+		static SnapshotRegistry* Get();
+
+		SnapshotRegistry(const SnapshotRegistry&) = delete;
+		void operator=(const SnapshotRegistry&) = delete;
+
+		/// <summary>
+		/// Register an entity type. Registering a type again replaces its functions.
+		/// </summary>
+		/// <typeparam name="T">the entity type</typeparam>
+		/// <param name="key">the key the type is stored as. Should be unique, and never change once snapshots are saved</param>
+		/// <param name="saver">the function that saves the type's own data</param>
+		/// <param name="loader">the function that reads it back and creates the entity</param>
+		template<typename T>
+		void RegisterEntity(const std::string& key, EntitySaver saver, EntityLoader loader) {
+			static_assert(std::is_base_of<Entity, T>::value, "Error: Tara::SnapshotRegistry::RegisterEntity : Provided class is not a subclass of Tara::Entity");
+			RegisterEntity(TypeRegistry<Entity>::Get<T>(), key, saver, loader);
+		}
+
+		/// <summary>
+		/// Register a component type. Registering a type again replaces its functions.
+		/// </summary>
+		/// <typeparam name="T">the component type</typeparam>
+		/// <param name="key">the key the type is stored as. Should be unique, and never change once snapshots are saved</param>
+		/// <param name="saver">the function that saves the type's own data</param>
+		/// <param name="loader">the function that reads it back and creates the component</param>
+		template<typename T>
+		void RegisterComponent(const std::string& key, ComponentSaver saver, ComponentLoader loader) {
+			static_assert(std::is_base_of<Component, T>::value, "Error: Tara::SnapshotRegistry::RegisterComponent : Provided class is not a subclass of Tara::Component");
+			RegisterComponent(TypeRegistry<Component>::Get<T>(), key, saver, loader);
+		}
+
+		/// <summary>
+		/// Register a value type, for std::any metadata. Registering a type again replaces its functions.
+		/// </summary>
+		/// <typeparam name="T">the value type</typeparam>
+		/// <param name="key">the key the type is stored as</param>
+		/// <param name="saver">the function that saves a value</param>
+		/// <param name="loader">the function that reads a value</param>
+		template<typename T>
+		void RegisterValue(const std::string& key, ValueSaver saver, ValueLoader loader) {
+			m_ValueSavers[std::type_index(typeid(T))] = { key, saver };
+			m_ValueLoaders[key] = loader;
+		}
+
+		/// <summary>
+		/// Find the first entity or component in a tree whose exact type isn't registered.
+		/// Saving the tree would not keep it: the entity would be saved as its nearest registered base type, and the component left out.
+		/// </summary>
+		/// <param name="root">the root of the tree</param>
+		/// <returns>a description of the unregistered type and where it is, or an empty string if every type is registered</returns>
+		std::string FindUnregisteredType(const Entity& root) const;
+
+		/// <summary>
+		/// Save every entity of a layer (and its children and components) to a stream, in one pass
+		/// </summary>
+		/// <param name="layer">the layer</param>
+		/// <param name="stream">the stream, opened in binary mode</param>
+		/// <param name="compress">true to compress the snapshot</param>
+		/// <returns>true if successful</returns>
+		bool SaveLayer(const Layer& layer, std::ostream& stream, bool compress = true);
+
+		/// <summary>
+		/// Load the entities in a snapshot into a layer, in one pass. They are added after the layer's existing entities.
+		/// If loading fails partway, every entity it loaded is destroyed again, and the layer camera is put back.
+		/// </summary>
+		/// <param name="layer">the layer</param>
+		/// <param name="stream">the stream, opened in binary mode</param>
+		/// <returns>true if successful</returns>
+		bool LoadLayer(Layer& layer, std::istream& stream);
+
+		/// <summary>
+		/// Save one entity (and its children and components) to a stream, without its parent or layer
+		/// </summary>
+		/// <param name="root">the entity</param>
+		/// <param name="stream">the stream, opened in binary mode</param>
+		/// <param name="compress">true to compress the snapshot</param>
+		/// <returns>true if successful</returns>
+		bool SaveEntityTree(const Entity& root, std::ostream& stream, bool compress = true);
+
+		/// <summary>
+		/// Load an entity saved by SaveEntityTree. If loading fails partway, every entity it loaded is destroyed again.
+		/// Like CreateEntity, it may be called while the layer is updating; the entities are then attached once the update ends.
+		/// </summary>
+		/// <param name="parent">the parent to load it under. May be null, to load it as a root of the layer</param>
+		/// <param name="layer">the layer</param>
+		/// <param name="stream">the stream, opened in binary mode</param>
+		/// <param name="transform">if not null, replaces the saved relative transform of the root</param>
+		/// <returns>the root entity, or null if failed</returns>
+		EntityRef LoadEntityTree(EntityNoRef parent, Layer& layer, std::istream& stream, const Transform* transform = nullptr);
+
+		/// <summary>
+		/// Check if a value can be saved
+		/// </summary>
+		/// <param name="value">the value</param>
+		/// <returns>true if its type is registered</returns>
+		bool CanSaveValue(const std::any& value) const;
+
+		/// <summary>
+		/// Save a value. Must be of a registered type (see CanSaveValue)
+		/// </summary>
+		/// <param name="value">the value</param>
+		/// <param name="writer">the writer</param>
+		void SaveValue(const std::any& value, SnapshotWriter& writer) const;
+
+		/// <summary>
+		/// Read a value saved by SaveValue
+		/// </summary>
+		/// <param name="reader">the reader</param>
+		/// <returns>the value, or an empty std::any if failed</returns>
+		std::any LoadValue(SnapshotReader& reader) const;
+
+	private:
+		struct EntityEntry {
+			std::string Key;
+			EntitySaver Saver;
+			EntityLoader Loader;
+		};
+
+		struct ComponentEntry {
+			std::string Key;
+			ComponentSaver Saver;
+			ComponentLoader Loader;
+		};
+
+		struct ValueEntry {
+			std::string Key;
+			ValueSaver Saver;
+		};
+
+		void RegisterEntity(TypeId type, const std::string& key, EntitySaver saver, EntityLoader loader);
+		void RegisterComponent(TypeId type, const std::string& key, ComponentSaver saver, ComponentLoader loader);
+
+		/// <summary>
+		/// Get the entry to save an entity type with: its own, or the nearest registered base type's
+		/// </summary>
+		const EntityEntry* FindEntityEntry(TypeId type);
+
+		/// <summary>
+		/// Save an entity, its components, and its children
+		/// </summary>
+		void SaveEntity(const Entity& entity, const Entity* layerCamera, SnapshotWriter& writer);
+
+		/// <summary>
+		/// Load an entity, its components, and its children. The transform, if not null, replaces the saved one.
+		/// </summary>
+		/// <returns>the entity, or null if failed. On failure, anything it created has been destroyed again</returns>
+		EntityRef LoadEntity(EntityNoRef parent, Layer& layer, SnapshotReader& reader, const Transform* transform = nullptr);
+
+		/// <summary>
+		/// Destroy a partly loaded entity and its whole subtree. Destroy alone would hand the children to the layer.
+		/// While structural changes are deferred, this is deferred too, so it runs after the entities have been attached.
+		/// </summary>
+		void DiscardEntity(const EntityRef& entity);
+
+		/// <summary>
+		/// Register the engine's own types
+		/// </summary>
+		void RegisterBuiltinTypes();
+
+	private:
+		std::unordered_map<TypeId, EntityEntry> m_Entities;
+		std::unordered_map<std::string, TypeId> m_EntityKeys;
+		std::unordered_map<TypeId, const EntityEntry*> m_EntityFallbacks; //unregistered types, to the entry they save as
+		std::unordered_map<TypeId, ComponentEntry> m_Components;
+		std::unordered_map<std::string, TypeId> m_ComponentKeys;
+		std::unordered_set<TypeId> m_SkippedComponents; //unregistered component types already warned about
+		std::unordered_map<std::type_index, ValueEntry> m_ValueSavers;
+		std::unordered_map<std::string, ValueLoader> m_ValueLoaders;
+	};
+
+}
@@ -0,0 +1,262 @@
+#include "tarapch.h"
+#include "SpatialHashGrid.h"
+#include "Tara/Core/Entity.h"
+
+//boxes covering more cells than this are not stored cell by cell, but checked by every query
+#define SPATIAL_HASH_MAX_CELLS_PER_ITEM 1024
+
+//cell coordinates are clamped to this, so huge (or infinite) boxes don't overflow
+#define SPATIAL_HASH_MAX_CELL_COORD 1000000000.0f
+
+namespace Tara {
+
+	//the items found by the current query on this thread. Kept between queries, so it doesn't reallocate
+	static thread_local std::vector<uint32_t> s_QueryFound;
+
+	SpatialHashGrid::SpatialHashGrid(float cellSize)
+		: m_CellSize(cellSize), m_InvCellSize(1.0f / cellSize)
+	{
+		CHECK_F(cellSize > 0.0f, "SpatialHashGrid: cell size must be greater than 0!");
+	}
+
+	void SpatialHashGrid::Update(const EntityRef& entity, const BoundingBox& box)
+	{
+		//negative-size boxes never overlap anything, so don't store them at all
+		if (box.Width < 0 || box.Height < 0 || box.Depth < 0) {
+			Remove(entity);
+			return;
+		}
+		CellRange range = GetCellRange(box.Position, box.Position + box.Extent);
+		auto f = m_ItemLookup.find(entity.get());
+		if (f != m_ItemLookup.end()) {
+			//already present. Only touch the cells if it has moved into different ones
+			Item& item = m_Items[f->second];
+			if (item.Range == range) {
+				return;
+			}
+			RemoveFromCells(f->second);
+			item.Range = range;
+			AddToCells(f->second);
+			return;
+		}
+		//new entry
+		uint32_t index;
+		if (m_FreeItems.size() > 0) {
+			index = m_FreeItems.back();
+			m_FreeItems.pop_back();
+			m_Items[index] = { entity, range, false };
+		}
+		else {
+			index = (uint32_t)m_Items.size();
+			m_Items.push_back({ entity, range, false });
+		}
+		m_ItemLookup[entity.get()] = index;
+		AddToCells(index);
+	}
+
+	void SpatialHashGrid::Remove(const EntityRef& entity)
+	{
+		auto f = m_ItemLookup.find(entity.get());
+		if (f == m_ItemLookup.end()) {
+			return;
+		}
+		uint32_t index = f->second;
+		RemoveFromCells(index);
+		m_Items[index].Entity = nullptr;
+		m_FreeItems.push_back(index);
+		m_ItemLookup.erase(f);
+	}
+
+	void SpatialHashGrid::Clear()
+	{
+		m_Cells.clear();
+		m_Items.clear();
+		m_FreeItems.clear();
+		m_OversizedItems.clear();
+		m_ItemLookup.clear();
+	}
+
+	void SpatialHashGrid::QueryBox(const BoundingBox& box, std::vector<EntityRef>& results) const
+	{
+		if (box.Width < 0 || box.Height < 0 || box.Depth < 0) {
+			return;
+		}
+		auto& found = BeginQuery();
+		QueryCellRange(GetCellRange(box.Position, box.Position + box.Extent), found);
+		EndQuery(found, results);
+	}
+
+	void SpatialHashGrid::QuerySphere(const Vector& origin, float radius, std::vector<EntityRef>& results) const
+	{
+		auto& found = BeginQuery();
+		QueryCellRange(GetCellRange(origin - radius, origin + radius), found);
+		EndQuery(found, results);
+	}
+
+	void SpatialHashGrid::QueryRay(const Vector& origin, const Vector& direction, float length, std::vector<EntityRef>& results) const
+	{
+		auto& found = BeginQuery();
+		//3D DDA (Amanatides & Woo): step from cell to cell along the ray, always crossing the nearest cell boundary next
+		glm::ivec3 cell = GetCell(origin);
+		glm::ivec3 endCell = GetCell(origin + (direction * length));
+		const float start[3] = { origin.x, origin.y, origin.z };
+		const float dir[3] = { direction.x, direction.y, direction.z };
+		int32_t step[3];
+		float tMax[3];
+		float tDelta[3];
+		for (int axis = 0; axis < 3; axis++) {
+			if (dir[axis] > 0.0f) {
+				step[axis] = 1;
+				tMax[axis] = (((float)cell[axis] + 1.0f) * m_CellSize - start[axis]) / dir[axis];
+				tDelta[axis] = m_CellSize / dir[axis];
+			}
+			else if (dir[axis] < 0.0f) {
+				step[axis] = -1;
+				tMax[axis] = ((float)cell[axis] * m_CellSize - start[axis]) / dir[axis];
+				tDelta[axis] = -m_CellSize / dir[axis];
+			}
+			else {
+				step[axis] = 0;
+				tMax[axis] = std::numeric_limits<float>::infinity();
+				tDelta[axis] = std::numeric_limits<float>::infinity();
+			}
+		}
+		//the number of cells between the ends bounds the walk, even if floating point error keeps it from landing on endCell exactly
+		int64_t remaining = 1;
+		for (int axis = 0; axis < 3; axis++) {
+			remaining += std::abs((int64_t)endCell[axis] - (int64_t)cell[axis]);
+		}
+		while (remaining-- > 0) {
+			QueryCell(cell, found);
+			if (cell == endCell) {
+				break;
+			}
+			int axis = 0;
+			if (tMax[1] < tMax[axis]) { axis = 1; }
+			if (tMax[2] < tMax[axis]) { axis = 2; }
+			if (tMax[axis] > length) {
+				break;
+			}
+			cell[axis] += step[axis];
+			tMax[axis] += tDelta[axis];
+		}
+		EndQuery(found, results);
+	}
+
+	glm::ivec3 SpatialHashGrid::GetCell(const Vector& point) const
+	{
+		auto toCell = [this](float v) {
+			float c = std::floor(v * m_InvCellSize);
+			c = std::max(-SPATIAL_HASH_MAX_CELL_COORD, std::min(SPATIAL_HASH_MAX_CELL_COORD, c));
+			return (int32_t)c;
+		};
+		return { toCell(point.x), toCell(point.y), toCell(point.z) };
+	}
+
+	SpatialHashGrid::CellRange SpatialHashGrid::GetCellRange(const Vector& low, const Vector& high) const
+	{
+		return { GetCell(low), GetCell(high) };
+	}
+
+	void SpatialHashGrid::AddToCells(uint32_t index)
+	{
+		Item& item = m_Items[index];
+		const CellRange& r = item.Range;
+		int64_t cellCount = ((int64_t)r.Max.x - r.Min.x + 1) * ((int64_t)r.Max.y - r.Min.y + 1) * ((int64_t)r.Max.z - r.Min.z + 1);
+		if (cellCount > SPATIAL_HASH_MAX_CELLS_PER_ITEM) {
+			item.Oversized = true;
+			m_OversizedItems.push_back(index);
+			return;
+		}
+		item.Oversized = false;
+		for (int32_t x = r.Min.x; x <= r.Max.x; x++) {
+			for (int32_t y = r.Min.y; y <= r.Max.y; y++) {
+				for (int32_t z = r.Min.z; z <= r.Max.z; z++) {
+					m_Cells[glm::ivec3{ x, y, z }].push_back(index);
+				}
+			}
+		}
+	}
+
+	void SpatialHashGrid::RemoveFromCells(uint32_t index)
+	{
+		Item& item = m_Items[index];
+		if (item.Oversized) {
+			auto f = std::find(m_OversizedItems.begin(), m_OversizedItems.end(), index);
+			if (f != m_OversizedItems.end()) {
+				*f = m_OversizedItems.back();
+				m_OversizedItems.pop_back();
+			}
+			return;
+		}
+		const CellRange& r = item.Range;
+		for (int32_t x = r.Min.x; x <= r.Max.x; x++) {
+			for (int32_t y = r.Min.y; y <= r.Max.y; y++) {
+				for (int32_t z = r.Min.z; z <= r.Max.z; z++) {
+					auto cell = m_Cells.find(glm::ivec3{ x, y, z });
+					if (cell == m_Cells.end()) {
+						continue;
+					}
+					//order within a cell does not matter, so swap-remove
+					auto& items = cell->second;
+					auto f = std::find(items.begin(), items.end(), index);
+					if (f != items.end()) {
+						*f = items.back();
+						items.pop_back();
+					}
+					if (items.size() == 0) {
+						m_Cells.erase(cell);
+					}
+				}
+			}
+		}
+	}
+
+	void SpatialHashGrid::QueryCellRange(const CellRange& r, std::vector<uint32_t>& found) const
+	{
+		int64_t cellCount = ((int64_t)r.Max.x - r.Min.x + 1) * ((int64_t)r.Max.y - r.Min.y + 1) * ((int64_t)r.Max.z - r.Min.z + 1);
+		if (cellCount > (int64_t)m_Cells.size()) {
+			//query covers more cells than are occupied, so walk the occupied ones instead
+			for (auto& cell : m_Cells) {
+				const glm::ivec3& c = cell.first;
+				if (c.x >= r.Min.x && c.x <= r.Max.x && c.y >= r.Min.y && c.y <= r.Max.y && c.z >= r.Min.z && c.z <= r.Max.z) {
+					QueryCell(c, found);
+				}
+			}
+			return;
+		}
+		for (int32_t x = r.Min.x; x <= r.Max.x; x++) {
+			for (int32_t y = r.Min.y; y <= r.Max.y; y++) {
+				for (int32_t z = r.Min.z; z <= r.Max.z; z++) {
+					QueryCell(glm::ivec3{ x, y, z }, found);
+				}
+			}
+		}
+	}
+
+	void SpatialHashGrid::QueryCell(const glm::ivec3& c, std::vector<uint32_t>& found) const
+	{
+		auto cell = m_Cells.find(c);
+		if (cell == m_Cells.end()) {
+			return;
+		}
+		found.insert(found.end(), cell->second.begin(), cell->second.end());
+	}
+
+	std::vector<uint32_t>& SpatialHashGrid::BeginQuery() const
+	{
+		s_QueryFound.clear();
+		s_QueryFound.insert(s_QueryFound.end(), m_OversizedItems.begin(), m_OversizedItems.end());
+		return s_QueryFound;
+	}
+
+	void SpatialHashGrid::EndQuery(std::vector<uint32_t>& found, std::vector<EntityRef>& results) const
+	{
+		std::sort(found.begin(), found.end());
+		found.erase(std::unique(found.begin(), found.end()), found.end());
+		for (uint32_t index : found) {
+			results.push_back(m_Items[index].Entity);
+		}
+	}
+
+}
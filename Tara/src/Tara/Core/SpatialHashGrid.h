@@ -0,0 +1,160 @@
+#pragma once
+#include "tarapch.h"
+#include "Tara/Math/Types.h"
+#include "Tara/Math/BoundingBox.h"
+#include "Tara/Math/Extensions.h" //hashing for glm types
+
+namespace Tara {
+
+	REFTYPE(Entity);
+
+	/// <summary>
+	/// A uniform spatial hash grid over entity bounding boxes.
+	/// Space is split into cubic cells of a fixed size, and each entity is stored in every cell its box touches.
+	/// Only the cells that are actually occupied take up memory.
+	/// Queries return candidates (every entity in the touched cells, each once); exact tests are up to the caller.
+	/// Queries don't modify the grid, so any number of threads can query at once, as long as none is updating it.
+	/// </summary>
+	class SpatialHashGrid {
+	public:
+		/// <summary>
+		/// Construct a new spatial hash grid
+		/// </summary>
+		/// <param name="cellSize">the width of a cell in world units. Should be around the size of the common entity.</param>
+		SpatialHashGrid(float cellSize = 8.0f);
+
+		/// <summary>
+		/// Insert an entity, or move it if already present.
+		/// The cells are only touched if the range of cells the box covers has changed.
+		/// </summary>
+		/// <param name="entity">the entity</param>
+		/// <param name="box">the entity's bounding box</param>
+		void Update(const EntityRef& entity, const BoundingBox& box);
+
+		/// <summary>
+		/// Remove an entity, if present
+		/// </summary>
+		/// <param name="entity">the entity to remove</param>
+		void Remove(const EntityRef& entity);
+
+		/// <summary>
+		/// Remove all entities
+		/// </summary>
+		void Clear();
+
+		/// <summary>
+		/// Check if an entity is in the grid
+		/// </summary>
+		/// <param name="entity">the entity</param>
+		/// <returns>true if it is in the grid</returns>
+		inline bool Contains(const EntityRef& entity) const { return m_ItemLookup.find(entity.get()) != m_ItemLookup.end(); }
+
+		/// <summary>
+		/// Append every entity in the cells a box touches
+		/// </summary>
+		/// <param name="box">the box</param>
+		/// <param name="results">the vector to append to</param>
+		void QueryBox(const BoundingBox& box, std::vector<EntityRef>& results) const;
+
+		/// <summary>
+		/// Append every entity in the cells a sphere touches
+		/// </summary>
+		/// <param name="origin">the center of the sphere</param>
+		/// <param name="radius">the radius of the sphere</param>
+		/// <param name="results">the vector to append to</param>
+		void QuerySphere(const Vector& origin, float radius, std::vector<EntityRef>& results) const;
+
+		/// <summary>
+		/// Append every entity in the cells a ray segment passes through.
+		/// The segment runs from origin to origin + (direction * length)
+		/// </summary>
+		/// <param name="origin">the start of the ray</param>
+		/// <param name="direction">the direction of the ray</param>
+		/// <param name="length">how far along the direction the ray goes</param>
+		/// <param name="results">the vector to append to</param>
+		void QueryRay(const Vector& origin, const Vector& direction, float length, std::vector<EntityRef>& results) const;
+
+		/// <summary>
+		/// Get the width of a cell
+		/// </summary>
+		/// <returns>the cell size, in world units</returns>
+		inline float GetCellSize() const { return m_CellSize; }
+
+		/// <summary>
+		/// Get the number of entities in the grid
+		/// </summary>
+		/// <returns>the entity count</returns>
+		inline size_t GetEntityCount() const { return m_ItemLookup.size(); }
+
+	private:
+		/// <summary>
+		/// A range of cells, inclusive on both ends
+		/// </summary>
+		struct CellRange {
+			glm::ivec3 Min;
+			glm::ivec3 Max;
+			inline bool operator==(const CellRange& other) const { return Min == other.Min && Max == other.Max; }
+		};
+
+		/// <summary>
+		/// An entity stored in the grid.
+		/// Boxes too big to reasonably store cell by cell are kept "oversized", and checked by every query instead.
+		/// </summary>
+		struct Item {
+			EntityRef Entity;
+			CellRange Range;
+			bool Oversized;
+		};
+
+		/// <summary>
+		/// Get the cell a point is in
+		/// </summary>
+		glm::ivec3 GetCell(const Vector& point) const;
+
+		/// <summary>
+		/// Get the range of cells between two corners
+		/// </summary>
+		CellRange GetCellRange(const Vector& low, const Vector& high) const;
+
+		/// <summary>
+		/// Add an item to every cell in its range (or to the oversized list)
+		/// </summary>
+		void AddToCells(uint32_t item);
+
+		/// <summary>
+		/// Remove an item from every cell in its range (or from the oversized list)
+		/// </summary>
+		void RemoveFromCells(uint32_t item);
+
+		/// <summary>
+		/// Append the items of every cell in a range to the found list
+		/// </summary>
+		void QueryCellRange(const CellRange& range, std::vector<uint32_t>& found) const;
+
+		/// <summary>
+		/// Append the items of a single cell to the found list
+		/// </summary>
+		void QueryCell(const glm::ivec3& cell, std::vector<uint32_t>& found) const;
+
+		/// <summary>
+		/// Start a new query. Returns the calling thread's found list, emptied, with all the oversized items in it, as they may be anywhere.
+		/// </summary>
+		std::vector<uint32_t>& BeginQuery() const;
+
+		/// <summary>
+		/// Finish a query. Items in more than one touched cell were found more than once, so the found list
+		/// is sorted and deduplicated before its entities are appended to the results.
+		/// </summary>
+		void EndQuery(std::vector<uint32_t>& found, std::vector<EntityRef>& results) const;
+
+	private:
+		float m_CellSize;
+		float m_InvCellSize;
+		std::unordered_map<glm::ivec3, std::vector<uint32_t>> m_Cells;
+		std::vector<Item> m_Items;
+		std::vector<uint32_t> m_FreeItems;
+		std::vector<uint32_t> m_OversizedItems;
+		std::unordered_map<const Entity*, uint32_t> m_ItemLookup;
+	};
+
+}
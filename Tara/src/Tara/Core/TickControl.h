@@ -0,0 +1,36 @@
+#pragma once
+#include "tarapch.h"
+
+//the number of tick groups a layer can turn on and off. Group 0 is the default group, and is always on
+#define TICK_GROUP_COUNT 32
+
+namespace Tara {
+
+	/// <summary>
+	/// Per-object tick settings, shared by Entity and Component.
+	/// A throttled object keeps the time of the frames it skips, and gets all of it as the delta time of its next tick.
+	/// </summary>
+	struct TickControl {
+		bool Enabled = true;
+		float Interval = 0.0f; //seconds between ticks. 0 ticks every update
+		uint32_t Group = 0;
+		float Accumulated = 0.0f; //time since the last tick
+
+		/// <summary>
+		/// Add an update's time, and check if it's time to tick
+		/// </summary>
+		/// <param name="deltaTime">the update's delta time. Set to the time since the last tick, when returning true</param>
+		/// <param name="interval">the interval to tick at, which may be longer than Interval (LOD)</param>
+		/// <returns>true if the object should tick</returns>
+		inline bool Accumulate(float& deltaTime, float interval) {
+			Accumulated += deltaTime;
+			if (Accumulated < interval) {
+				return false;
+			}
+			deltaTime = Accumulated;
+			Accumulated = 0.0f;
+			return true;
+		}
+	};
+
+}
@@ -0,0 +1,244 @@
+#pragma once
+#include "tarapch.h"
+#include <mutex>
+#include <atomic>
+
+//the most types a TypeRegistry can hold. Entity and Component types are counted separately. Must be a multiple of 64
+#define TYPE_REGISTRY_MAX_TYPES 256
+
+//declares the direct base class of an Entity or Component subclass for its TypeRegistry id. Put it in the public section of the class.
+//Every class used with CreateEntity, CreateComponent or the type lookups must declare its own, subclasses do not inherit it.
+#define TYPE_REGISTRY_BASE(type, base) using TypeRegistrySelf = type; \
+	using TypeRegistryBase = base
+
+namespace Tara {
+
+	/// <summary>
+	/// A compact runtime type id, assigned by a TypeRegistry. Ids count up from 0 in the order types are first used.
+	/// </summary>
+	using TypeId = uint32_t;
+
+	/// <summary>
+	/// A set of type ids, one bit per id
+	/// </summary>
+	class TypeMask {
+	public:
+		inline void Set(TypeId id) { m_Words[id / 64] |= (uint64_t)1 << (id % 64); }
+		inline void Clear(TypeId id) { m_Words[id / 64] &= ~((uint64_t)1 << (id % 64)); }
+		inline bool Test(TypeId id) const { return (m_Words[id / 64] >> (id % 64)) & 1; }
+		inline uint64_t GetWord(size_t index) const { return m_Words[index]; }
+	private:
+		uint64_t m_Words[TYPE_REGISTRY_MAX_TYPES / 64] = {};
+	};
+
+
+	/// <summary>
+	/// Assigns compact type ids to the subclasses of a root class (Entity or Component), once per type, through templates.
+	/// Each type also records the ids of every registered type it derives from (its base class chain), so "is type A a B"
+	/// is a single bit test, with no RTTI casts. The chain comes from each class's TYPE_REGISTRY_BASE declaration.
+	/// Ids are registered the first time Get&lt;T&gt;() is called for a type, after its base. Safe to use from any thread.
+	/// </summary>
+	/// <typeparam name="Root">the root class of the family</typeparam>
+	template<typename Root>
+	class TypeRegistry {
+	public:
+		/// <summary>
+		/// Get the id of a type, registering it if this is the first time
+		/// </summary>
+		/// <typeparam name="T">the type, Root or a subclass of it</typeparam>
+		/// <returns>the id</returns>
+		template<typename T>
+		static TypeId Get() {
+			static_assert(std::is_base_of<Root, T>::value, "Error: Tara::TypeRegistry::Get : Provided class is not a subclass of the registry's root class");
+			static_assert(std::is_same<typename T::TypeRegistrySelf, T>::value, "Error: Tara::TypeRegistry::Get : Provided class does not declare its base class with TYPE_REGISTRY_BASE");
+			static const TypeId id = Register<T, typename T::TypeRegistryBase>();
+			return id;
+		}
+
+		/// <summary>
+		/// Check if one type is, or derives from, another
+		/// </summary>
+		/// <param name="type">the type to check</param>
+		/// <param name="base">the possible base type</param>
+		/// <returns>true if type is a base</returns>
+		static bool IsA(TypeId type, TypeId base) {
+			return (GetData().Derived[base].Words[type / 64].load(std::memory_order_acquire) >> (type % 64)) & 1;
+		}
+
+		/// <summary>
+		/// Check if any type in a set is, or derives from, another
+		/// </summary>
+		/// <param name="types">the set of types to check</param>
+		/// <param name="base">the possible base type</param>
+		/// <returns>true if any of them is a base</returns>
+		static bool AnyIsA(const TypeMask& types, TypeId base) {
+			const auto& derived = GetData().Derived[base];
+			for (size_t i = 0; i < TYPE_REGISTRY_MAX_TYPES / 64; i++) {
+				if (types.GetWord(i) & derived.Words[i].load(std::memory_order_acquire)) {
+					return true;
+				}
+			}
+			return false;
+		}
+
+		/// <summary>
+		/// Get the number of registered types
+		/// </summary>
+		/// <returns>the count</returns>
+		static uint32_t GetCount() {
+			auto& data = GetData();
+			std::lock_guard<std::mutex> lock(data.Mutex);
+			return (uint32_t)data.Parents.size();
+		}
+
+	private:
+		//no parent, for the root class
+		static constexpr TypeId NO_PARENT = (TypeId)-1;
+
+		/// <summary>
+		/// Bit set of the types that are, or derive from, one type. Atomic, as types may register while others are reading.
+		/// </summary>
+		struct DerivedMask {
+			std::atomic<uint64_t> Words[TYPE_REGISTRY_MAX_TYPES / 64] = {};
+		};
+
+		struct Data {
+			std::mutex Mutex;
+			std::vector<TypeId> Parents; //the id of each type's direct base, NO_PARENT for the root
+			DerivedMask Derived[TYPE_REGISTRY_MAX_TYPES];
+		};
+
+		template<typename T, typename Base>
+		static TypeId Register() {
+			if constexpr (std::is_same<T, Root>::value) {
+				return Register(NO_PARENT);
+			}
+			else {
+				static_assert(std::is_base_of<Base, T>::value && !std::is_same<Base, T>::value, "Error: Tara::TypeRegistry::Register : Declared base is not a base class of the provided class");
+				//the base is registered first, so its chain is complete
+				return Register(Get<Base>());
+			}
+		}
+
+		static TypeId Register(TypeId parent) {
+			auto& data = GetData();
+			std::lock_guard<std::mutex> lock(data.Mutex);
+			TypeId id = (TypeId)data.Parents.size();
+			CHECK_F(id < TYPE_REGISTRY_MAX_TYPES, "TypeRegistry: too many types registered! Raise TYPE_REGISTRY_MAX_TYPES");
+			data.Parents.push_back(parent);
+			//the new type is itself, and derives from every type up its chain. Types registered later derive from it the same way.
+			for (TypeId type = id; type != NO_PARENT; type = data.Parents[type]) {
+				data.Derived[type].Words[id / 64].fetch_or((uint64_t)1 << (id % 64), std::memory_order_release);
+			}
+			return id;
+		}
+
+		static Data& GetData() {
+			//intentionally leaked, so ids stay valid during static destruction
+			static Data* data = new Data();
+			return *data;
+		}
+	};
+
+
+	/// <summary>
+	/// An index of a set of objects by their type id. Holds the objects in one bucket per exact type, and a mask of which types are present.
+	/// Each bucket is kept sorted by the objects' position in their owner's list, so the first of a type is the front of its bucket.
+	/// Positions may shift, as long as the relative order of the indexed objects does not change while they are indexed.
+	/// To reorder an object, remove it, move it, and add it again.
+	/// </summary>
+	/// <typeparam name="Root">the root class of the family</typeparam>
+	/// <typeparam name="Position">a type with a static uint32_t Get(const Root&amp;) that gives an object's position</typeparam>
+	template<typename Root, typename Position>
+	class TypeIndex {
+	public:
+		/// <summary>
+		/// Add an object. Constant time when it is after every other object of its type, as new children and components are.
+		/// </summary>
+		/// <param name="type">the exact type of the object</param>
+		/// <param name="ref">the object</param>
+		void Add(TypeId type, const std::shared_ptr<Root>& ref) {
+			for (auto& bucket : m_Buckets) {
+				if (bucket.Type == type) {
+					if (bucket.Refs.empty() || Position::Get(*bucket.Refs.back()) < Position::Get(*ref)) {
+						bucket.Refs.push_back(ref);
+					}
+					else {
+						bucket.Refs.insert(Find(bucket.Refs, Position::Get(*ref)), ref);
+					}
+					return;
+				}
+			}
+			m_Buckets.push_back({ type, { ref } });
+			m_Mask.Set(type);
+		}
+
+		/// <summary>
+		/// Remove an object. Found with a binary search on its position, so it must not have moved since it was added.
+		/// </summary>
+		/// <param name="type">the exact type of the object</param>
+		/// <param name="ref">the object</param>
+		void Remove(TypeId type, const std::shared_ptr<Root>& ref) {
+			for (auto bucket = m_Buckets.begin(); bucket != m_Buckets.end(); bucket++) {
+				if (bucket->Type == type) {
+					//removing the last one is the common case (and a pop), anything else shifts the rest of the bucket down
+					if (!bucket->Refs.empty() && bucket->Refs.back() == ref) {
+						bucket->Refs.pop_back();
+					}
+					else {
+						auto found = Find(bucket->Refs, Position::Get(*ref));
+						if (found != bucket->Refs.end() && *found == ref) {
+							bucket->Refs.erase(found);
+						}
+					}
+					if (bucket->Refs.empty()) {
+						m_Buckets.erase(bucket);
+						m_Mask.Clear(type);
+					}
+					return;
+				}
+			}
+		}
+
+		/// <summary>
+		/// Check if any object is of a type, or derives from it
+		/// </summary>
+		/// <param name="base">the type</param>
+		/// <returns>true if there is one</returns>
+		inline bool Contains(TypeId base) const { return TypeRegistry<Root>::AnyIsA(m_Mask, base); }
+
+		/// <summary>
+		/// Call a function with every bucket of objects whose type is, or derives from, a type
+		/// </summary>
+		/// <typeparam name="Func">[void](const std::vector&lt;std::shared_ptr&lt;Root&gt;&gt;&amp; refs){...}</typeparam>
+		/// <param name="base">the type</param>
+		/// <param name="func">the function. Buckets are never empty, and sorted by position.</param>
+		template<typename Func>
+		void ForEachBucket(TypeId base, Func func) const {
+			if (!Contains(base)) {
+				return;
+			}
+			for (auto& bucket : m_Buckets) {
+				if (TypeRegistry<Root>::IsA(bucket.Type, base)) {
+					func(bucket.Refs);
+				}
+			}
+		}
+
+	private:
+		struct Bucket {
+			TypeId Type;
+			std::vector<std::shared_ptr<Root>> Refs;
+		};
+
+		/// <summary>
+		/// Find the first object in a bucket at or after a position
+		/// </summary>
+		static typename std::vector<std::shared_ptr<Root>>::iterator Find(std::vector<std::shared_ptr<Root>>& refs, uint32_t position) {
+			return std::lower_bound(refs.begin(), refs.end(), position, [](const std::shared_ptr<Root>& ref, uint32_t p) { return Position::Get(*ref) < p; });
+		}
+		std::vector<Bucket> m_Buckets;
+		TypeMask m_Mask;
+	};
+
+}
@@ -71,6 +71,13 @@ namespace Tara {
 		/// </summary>
 		/// <returns>the last frame time, in seconds</returns>
 		virtual float GetLastFrameTime() const = 0;
+
+		/// <summary>
+		/// Get the exact length of every frame, for windows with a synthetic clock.
+		/// Taking the difference of two absolute float times loses precision as the clock grows, so Application uses this instead when there is one.
+		/// </summary>
+		/// <returns>the frame length in seconds, or a negative number if frames don't have a fixed length</returns>
+		virtual float GetFixedFrameDelta() const { return -1.0f; }
 	};
 
 	/// <summary>
@@ -77,14 +77,7 @@ namespace Tara{
 	void CameraEntity::OnUpdate(float deltaTime)
 	{
 		if (m_RenderEveryFrame || m_RenderNextFrame){
-			if (m_UseWorldScale){
-				m_Camera->SetTransform(GetWorldTransform());
-			}
-			else {
-				Transform t = GetWorldTransform();
-				t.Scale = GetRelativeTransform().Scale;
-				m_Camera->SetTransform(t);
-			}
+			SyncCameraTransform();
 			//render with camera
 			GetOwningLayer().lock()->EnqueCamera(std::dynamic_pointer_cast<CameraEntity>(shared_from_this()));
 			
@@ -93,6 +86,15 @@ namespace Tara{
 		}
 	}
 
+	void CameraEntity::SyncCameraTransform(bool interpolated)
+	{
+		Transform t = interpolated ? GetInterpolatedWorldTransform() : GetWorldTransform();
+		if (!m_UseWorldScale) {
+			t.Scale = GetRelativeTransform().Scale;
+		}
+		m_Camera->SetTransform(t);
+	}
+
 	void CameraEntity::OnBeginPlay()
 	{
 		ListenForEvents(true);
@@ -13,6 +13,7 @@ namespace Tara {
 	/// </summary>
 	class CameraEntity : public Entity {
 	public:
+		TYPE_REGISTRY_BASE(CameraEntity, Entity);
 		/// <summary>
 		/// Constructor for a CameraEntiy
 		/// Note: you should use the Tara::CreateEntity function instead, to get full funcionality.
@@ -150,6 +151,13 @@ namespace Tara {
 		/// <param name="bits"></param>
 		inline virtual void SetRenderFilterBits(uint32_t bits) override { m_Camera->SetRenderFilterBits(bits); }
 
+		/// <summary>
+		/// Move the underlying camera to this entity's world transform.
+		/// Called on update, and again by the layer just before drawing, when the application runs a fixed timestep.
+		/// </summary>
+		/// <param name="interpolated">use the interpolated world transform instead of the current one</param>
+		void SyncCameraTransform(bool interpolated = false);
+
 	public:
 		/// <summary>
 		/// The overriden update function
@@ -6,38 +6,83 @@ namespace Tara{
     void DynamicMultiChildEntity::SelfOverlapChecks()
     {
         //so, not only do all entities need to have their own self called,
-        //they need to be added to the tree so that they can be overlapped with
+        //they need to be kept in the tree so that they can be overlapped with
         //each other efficently
         //Not that there is no need to check the children against this entity, as this eneity does
-        //not have a real size. 
+        //not have a real size.
 
-        std::list<std::pair<EntityRef, EntityRef>> overlapQueue;
+        m_PassMark++;
+        auto& children = GetChildren();
+        size_t stored = 0;
 
-        //clear previous tree
-        if (m_Tree) { delete m_Tree; m_Tree = nullptr; }
-
-
-        for (auto child : GetChildren()) {
+        for (auto& child : children) {
 
             //update child
             child->SelfOverlapChecks();
-            
-            //add child to tree
-            if (m_Tree == nullptr) {
-                m_Tree = new Node(child);
+
+            const BoundingBox& box = child->GetCachedFullBoundingBox();
+            auto f = m_Leaves.find(child.get());
+            if (box.Width < 0 || box.Height < 0 || box.Depth < 0) {
+                //negative-size boxes never overlap, so they are left out of the tree
+                //and get cleaned up with the children that left, if they were in it
+                continue;
+            }
+            int32_t leaf;
+            if (f == m_Leaves.end()) {
+                //new child, add to tree
+                leaf = AllocateNode();
+                m_Nodes[leaf].Box = box.Expanded(m_FatMargin);
+                m_Nodes[leaf].Entity = child;
+                InsertLeaf(leaf);
+                m_Leaves[child.get()] = leaf;
             }
             else {
-                std::list<EntityRef> overlaps;
-                m_Tree = m_Tree->AddChild(child->GetFullBoundingBox(), child, overlaps);
-                //for every overlap in the tree, add to queue
-                for (auto child2 : overlaps) {
-                    overlapQueue.push_back(std::make_pair(child2, child ));
+                leaf = f->second;
+                //only move it in the tree if it has left its fat box
+                if (!m_Nodes[leaf].Box.Contains(box)) {
+                    RemoveLeaf(leaf);
+                    m_Nodes[leaf].Box = box.Expanded(m_FatMargin);
+                    InsertLeaf(leaf);
                 }
             }
+            m_Nodes[leaf].PassMark = m_PassMark;
+            stored++;
+        }
+
+        //remove any leaves for entities that are no longer children
+        if (m_Leaves.size() != stored) {
+            for (auto iter = m_Leaves.begin(); iter != m_Leaves.end();) {
+                if (m_Nodes[iter->second].PassMark != m_PassMark) {
+                    RemoveLeaf(iter->second);
+                    FreeNode(iter->second);
+                    iter = m_Leaves.erase(iter);
+                }
+                else {
+                    iter++;
+                }
+            }
+        }
+
+        //find the overlapping pairs. Each pair is found from both sides, so only keep it from the lower leaf
+        std::vector<std::pair<EntityRef, EntityRef>> overlapQueue;
+        for (auto& child : children) {
+            auto f = m_Leaves.find(child.get());
+            if (f == m_Leaves.end()) { continue; }
+            int32_t self = f->second;
+            const BoundingBox& box = child->GetCachedFullBoundingBox();
+            Query(
+                [&box](const BoundingBox& nodeBox) { return nodeBox.Overlaping(box); },
+                [&](int32_t leaf) {
+                    //leaf boxes are fat, so check the real box too
+                    if (leaf > self && m_Nodes[leaf].Entity->GetCachedFullBoundingBox().Overlaping(box)) {
+                        overlapQueue.push_back(std::make_pair(child, m_Nodes[leaf].Entity));
+                    }
+                }
+            );
         }
 
         // for every overlap in the queue
-        for (auto pair : overlapQueue) {
+        for (auto& pair : overlapQueue) {
             pair.first->OtherOverlapChecks(pair.second);
         }
     }
@@ -47,29 +92,76 @@ namespace Tara{
         //When an entity is passed, it is traced against the tree. Any overlaps are then propigated down
         //Not that it is not checked agains this entity, as this entity has no size.
 
-        if (m_Tree == nullptr) { return; } //early out
+        if (m_Root == s_NullNode) { return; } //early out
 
         //fill the queue using the trace
-        std::list<EntityRef> overlapQueue;
-        m_Tree->TraceBox(other->GetFullBoundingBox(), overlapQueue);
+        std::vector<EntityRef> overlapQueue;
+        const BoundingBox& box = other->GetCachedFullBoundingBox();
+        Query(
+            [&box](const BoundingBox& nodeBox) { return nodeBox.Overlaping(box); },
+            [&](int32_t leaf) {
+                const EntityRef& child = m_Nodes[leaf].Entity;
+                if (child != other && child->GetCachedFullBoundingBox().Overlaping(box)) {
+                    overlapQueue.push_back(child);
+                }
+            }
+        );
 
         //propigate down
-        for (auto child : overlapQueue) {
+        for (auto& child : overlapQueue) {
             child->OtherOverlapChecks(other);
         }
     }
 
-    void DynamicMultiChildEntity::GetAllChildrenInBox(const BoundingBox& box, std::list<EntityRef>& list)
+    void DynamicMultiChildEntity::GetAllChildrenInBox(const BoundingBox& box, std::vector<EntityRef>& list)
     {
-        if (m_Tree) {
-            m_Tree->TraceBox(box, list);
+        std::vector<EntityRef> candidates;
+        Query(
+            [&box](const BoundingBox& nodeBox) { return nodeBox.Overlaping(box); },
+            [&](int32_t leaf) { candidates.push_back(m_Nodes[leaf].Entity); }
+        );
+        //same as the base version from here, just with fewer children to check
+        for (auto& child : candidates) {
+            if (box.Overlaping(child->GetFullBoundingBox())) {
+                if (box.Overlaping(child->GetSpecificBoundingBox())) {
+                    list.push_back(child);
+                }
+                child->GetAllChildrenInBox(box, list);
+            }
+        }
+    }
+
+    void DynamicMultiChildEntity::GetAllChildrenInRadius(Vector origin, float radius, std::vector<EntityRef>& list)
+    {
+        std::vector<EntityRef> candidates;
+        Query(
+            [&](const BoundingBox& nodeBox) { return nodeBox.OverlappingSphere(origin, radius); },
+            [&](int32_t leaf) { candidates.push_back(m_Nodes[leaf].Entity); }
+        );
+        for (auto& child : candidates) {
+            if (child->GetFullBoundingBox().OverlappingSphere(origin, radius)) {
+                if (child->GetSpecificBoundingBox().OverlappingSphere(origin, radius)) {
+                    list.push_back(child);
+                }
+                child->GetAllChildrenInRadius(origin, radius, list);
+            }
         }
     }
 
-    void DynamicMultiChildEntity::GetAllChildrenInRadius(Vector origin, float radius, std::list<EntityRef>& list)
+    void DynamicMultiChildEntity::GetAllChildrenOnRay(Vector origin, Vector direction, float length, std::vector<EntityRef>& list)
     {
-        if (m_Tree) {
-            m_Tree->TraceSphere(origin, radius, list);
+        std::vector<EntityRef> candidates;
+        Query(
+            [&](const BoundingBox& nodeBox) { return nodeBox.OverlappingRay(origin, direction, length); },
+            [&](int32_t leaf) { candidates.push_back(m_Nodes[leaf].Entity); }
+        );
+        for (auto& child : candidates) {
+            if (child->GetFullBoundingBox().OverlappingRay(origin, direction, length)) {
+                if (child->GetSpecificBoundingBox().OverlappingRay(origin, direction, length)) {
+                    list.push_back(child);
+                }
+                child->GetAllChildrenOnRay(origin, direction, length, list);
+            }
         }
     }
 
@@ -79,101 +171,250 @@ namespace Tara{
 
 
 
-    DynamicMultiChildEntity::Node* DynamicMultiChildEntity::Node::AddChild(const BoundingBox& newBox, EntityRef entity, std::list<EntityRef>& overlapping)
+    int32_t DynamicMultiChildEntity::AllocateNode()
     {
-        //BoundingBox newBox = entity->GetFullBoundingBox();
-        if (Entity) {
-            //This is a leaf node. Create sibling and new parent of both. 
-            Node* sibling = new Node(entity);
-            Node* newParent;
-            if (newBox < Box) {
-                newParent = new Node(sibling, this);
-            }
-            else {
-                newParent = new Node(this, sibling);
-            }
-            //Return that new parent to replace this in tree position
-            return newParent;
-        }
-        //this is not a leaf node (leaves return before this)
-        if (Left->Box.Overlaping(newBox)) {
-            //check if Left is a leaf, and, if it is, then add to overlapping list
-            //must be done first, because after AddChild, Left is definately not a leaf
-            if (Left->Entity) {
-                overlapping.push_back(Left->Entity);
-            }
-            //overlapping the Left side, so, we add it to that side
-            Left = Left->AddChild(newBox, entity, overlapping);
-            UpdateBox();
-            //also check if overlapping Right. If it is, trace against it to add any leaves that side to overlapping, if they are
-            if (Right->Box.Overlaping(newBox)) {
-                Right->TraceBox(newBox, overlapping);
-            }
+        int32_t index;
+        if (m_FreeNode != s_NullNode) {
+            index = m_FreeNode;
+            m_FreeNode = m_Nodes[index].Parent;
         }
         else {
-            if (Right->Box.Overlaping(newBox)) {
-                //check if Right is a leaf, and, if it is, then add to overlapping list
-                //must be done first, because after AddChild, Right is definately not a leaf
-                if (Right->Entity) {
-                    overlapping.push_back(Right->Entity);
+            index = (int32_t)m_Nodes.size();
+            m_Nodes.emplace_back();
+        }
+        Node& node = m_Nodes[index];
+        node.Parent = s_NullNode;
+        node.Left = s_NullNode;
+        node.Right = s_NullNode;
+        node.Height = 0;
+        node.PassMark = m_PassMark;
+        return index;
+    }
+
+    void DynamicMultiChildEntity::FreeNode(int32_t node)
+    {
+        m_Nodes[node].Entity = nullptr; //don't keep the entity alive
+        m_Nodes[node].Height = -1;
+        m_Nodes[node].Parent = m_FreeNode;
+        m_FreeNode = node;
+    }
+
+    void DynamicMultiChildEntity::InsertLeaf(int32_t leaf)
+    {
+        if (m_Root == s_NullNode) {
+            m_Root = leaf;
+            m_Nodes[leaf].Parent = s_NullNode;
+            return;
+        }
+
+        //find the best sibling, using the surface area heuristic.
+        //at each node, compare the cost of pairing with that node to the cheapest possible cost of going down either side
+        BoundingBox leafBox = m_Nodes[leaf].Box;
+        int32_t index = m_Root;
+        while (!m_Nodes[index].IsLeaf()) {
+            const Node& node = m_Nodes[index];
+            float area = node.Box.SurfaceArea();
+            float combinedArea = (node.Box + leafBox).SurfaceArea();
+
+            //cost of creating a new parent for this node and the new leaf
+            float cost = 2.0f * combinedArea;
+            //minimum cost of pushing the leaf further down the tree (every ancestor grows)
+            float inheritanceCost = 2.0f * (combinedArea - area);
+
+            auto descendCost = [&](int32_t childIndex) {
+                const Node& child = m_Nodes[childIndex];
+                float newArea = (child.Box + leafBox).SurfaceArea();
+                if (child.IsLeaf()) {
+                    return newArea + inheritanceCost;
                 }
-                //overlapping with the Right side, so, we add it to that side.
-                Right = Right->AddChild(newBox, entity, overlapping);
-                UpdateBox();
-                //No need to check Left, as that already failed.
+                return (newArea - child.Box.SurfaceArea()) + inheritanceCost;
+            };
+            float costLeft = descendCost(node.Left);
+            float costRight = descendCost(node.Right);
+
+            if (cost < costLeft && cost < costRight) {
+                break;
+            }
+            index = (costLeft < costRight) ? node.Left : node.Right;
+        }
+        int32_t sibling = index;
+
+        //create a new parent, in the sibling's place
+        int32_t oldParent = m_Nodes[sibling].Parent;
+        int32_t newParent = AllocateNode(); //may grow the pool, so no node references are held over this
+        m_Nodes[newParent].Parent = oldParent;
+        m_Nodes[newParent].Box = leafBox + m_Nodes[sibling].Box;
+        m_Nodes[newParent].Height = m_Nodes[sibling].Height + 1;
+        m_Nodes[newParent].Left = sibling;
+        m_Nodes[newParent].Right = leaf;
+        m_Nodes[sibling].Parent = newParent;
+        m_Nodes[leaf].Parent = newParent;
+
+        if (oldParent != s_NullNode) {
+            if (m_Nodes[oldParent].Left == sibling) {
+                m_Nodes[oldParent].Left = newParent;
             }
             else {
-                //neither are overlapping. check combined boxes to get optimal non-overlap
-                if (Left->Box.Overlaping(newBox + Right->Box)) {
-                    Left = Left->AddChild(newBox, entity, overlapping);
-                }
-                else {
-                    Right = Right->AddChild(newBox, entity, overlapping);
-                }
-                UpdateBox();
+                m_Nodes[oldParent].Right = newParent;
             }
         }
-        //return this because we don't need to replace anything
-        return this;
+        else {
+            m_Root = newParent;
+        }
+
+        //walk back up, refitting and balancing
+        index = m_Nodes[leaf].Parent;
+        while (index != s_NullNode) {
+            index = Balance(index);
+            Node& node = m_Nodes[index];
+            node.Height = 1 + std::max(m_Nodes[node.Left].Height, m_Nodes[node.Right].Height);
+            node.Box = m_Nodes[node.Left].Box + m_Nodes[node.Right].Box;
+            index = node.Parent;
+        }
     }
 
-    void DynamicMultiChildEntity::Node::TraceBox(BoundingBox box, std::list<EntityRef>& overlapping)
+    void DynamicMultiChildEntity::RemoveLeaf(int32_t leaf)
     {
-        if (Entity != nullptr) {
-            overlapping.push_back(Entity);
+        if (leaf == m_Root) {
+            m_Root = s_NullNode;
+            return;
         }
-        else {
-            if (Left->Box.Overlaping(box)) {
-                Left->TraceBox(box, overlapping);
+
+        //the leaf's parent is removed, and the sibling takes its place
+        int32_t parent = m_Nodes[leaf].Parent;
+        int32_t grandParent = m_Nodes[parent].Parent;
+        int32_t sibling = (m_Nodes[parent].Left == leaf) ? m_Nodes[parent].Right : m_Nodes[parent].Left;
+
+        if (grandParent != s_NullNode) {
+            if (m_Nodes[grandParent].Left == parent) {
+                m_Nodes[grandParent].Left = sibling;
+            }
+            else {
+                m_Nodes[grandParent].Right = sibling;
             }
-            if (Right->Box.Overlaping(box)) {
-                Right->TraceBox(box, overlapping);
+            m_Nodes[sibling].Parent = grandParent;
+            FreeNode(parent);
+
+            //walk back up, refitting and balancing
+            int32_t index = grandParent;
+            while (index != s_NullNode) {
+                index = Balance(index);
+                Node& node = m_Nodes[index];
+                node.Height = 1 + std::max(m_Nodes[node.Left].Height, m_Nodes[node.Right].Height);
+                node.Box = m_Nodes[node.Left].Box + m_Nodes[node.Right].Box;
+                index = node.Parent;
             }
         }
+        else {
+            m_Root = sibling;
+            m_Nodes[sibling].Parent = s_NullNode;
+            FreeNode(parent);
+        }
+        m_Nodes[leaf].Parent = s_NullNode;
     }
 
-    void DynamicMultiChildEntity::Node::TraceSphere(Vector center, float radius, std::list<EntityRef>& overlapping)
+    int32_t DynamicMultiChildEntity::Balance(int32_t iA)
     {
-        if (Entity != nullptr) {
-            overlapping.push_back(Entity);
+        //A has children B and C, and C has children F and G.
+        //if C is too tall, it is rotated up into A's place, and A takes one of C's children (the shorter one)
+        Node& A = m_Nodes[iA];
+        if (A.IsLeaf() || A.Height < 2) {
+            return iA;
         }
-        else {
-            if (Left->Box.OverlappingSphere(center, radius)) {
-                Left->TraceSphere(center, radius, overlapping);
+
+        int32_t iB = A.Left;
+        int32_t iC = A.Right;
+        Node& B = m_Nodes[iB];
+        Node& C = m_Nodes[iC];
+        int32_t balance = C.Height - B.Height;
+
+        //rotate C up
+        if (balance > 1) {
+            int32_t iF = C.Left;
+            int32_t iG = C.Right;
+            Node& F = m_Nodes[iF];
+            Node& G = m_Nodes[iG];
+
+            C.Left = iA;
+            C.Parent = A.Parent;
+            A.Parent = iC;
+            if (C.Parent != s_NullNode) {
+                if (m_Nodes[C.Parent].Left == iA) {
+                    m_Nodes[C.Parent].Left = iC;
+                }
+                else {
+                    m_Nodes[C.Parent].Right = iC;
+                }
             }
-            if (Right->Box.OverlappingSphere(center, radius)) {
-                Right->TraceSphere(center, radius, overlapping);
+            else {
+                m_Root = iC;
+            }
+
+            if (F.Height > G.Height) {
+                C.Right = iF;
+                A.Right = iG;
+                G.Parent = iA;
+                A.Box = B.Box + G.Box;
+                C.Box = A.Box + F.Box;
+                A.Height = 1 + std::max(B.Height, G.Height);
+                C.Height = 1 + std::max(A.Height, F.Height);
             }
+            else {
+                C.Right = iG;
+                A.Right = iF;
+                F.Parent = iA;
+                A.Box = B.Box + F.Box;
+                C.Box = A.Box + G.Box;
+                A.Height = 1 + std::max(B.Height, F.Height);
+                C.Height = 1 + std::max(A.Height, G.Height);
+            }
+            return iC;
         }
-    }
 
-    void DynamicMultiChildEntity::Node::UpdateBox()
-    {
-        if (Left && Right) {
-            Left->UpdateBox();
-            Right->UpdateBox();
-            Box = Left->Box + Right->Box;
+        //rotate B up
+        if (balance < -1) {
+            int32_t iD = B.Left;
+            int32_t iE = B.Right;
+            Node& D = m_Nodes[iD];
+            Node& E = m_Nodes[iE];
+
+            B.Left = iA;
+            B.Parent = A.Parent;
+            A.Parent = iB;
+            if (B.Parent != s_NullNode) {
+                if (m_Nodes[B.Parent].Left == iA) {
+                    m_Nodes[B.Parent].Left = iB;
+                }
+                else {
+                    m_Nodes[B.Parent].Right = iB;
+                }
+            }
+            else {
+                m_Root = iB;
+            }
+
+            if (D.Height > E.Height) {
+                B.Right = iD;
+                A.Left = iE;
+                E.Parent = iA;
+                A.Box = C.Box + E.Box;
+                B.Box = A.Box + D.Box;
+                A.Height = 1 + std::max(C.Height, E.Height);
+                B.Height = 1 + std::max(A.Height, D.Height);
+            }
+            else {
+                B.Right = iE;
+                A.Left = iD;
+                D.Parent = iA;
+                A.Box = C.Box + D.Box;
+                B.Box = A.Box + E.Box;
+                A.Height = 1 + std::max(C.Height, D.Height);
+                B.Height = 1 + std::max(A.Height, E.Height);
+            }
+            return iB;
         }
+
+        return iA;
     }
 
 }
@@ -8,11 +8,15 @@ namespace Tara {
 	NOREFTYPE(DynamicMultiChildEntity)
 
 	/// <summary>
-	/// DynamicMultiChildEntity is an entity designed to optimize collision among its children and between its children and other entities. 
+	/// DynamicMultiChildEntity is an entity designed to optimize collision among its children and between its children and other entities.
 	/// It does this by using an internal AABB tree data structure to handle the transforms.
+	/// The tree persists between frames. Each child is stored with a "fat" box, a little larger than its real one,
+	/// and is only moved in the tree when it leaves that fat box. So, the cost of keeping the tree up to date
+	/// scales with the number of children that moved far, not the number of children.
 	/// </summary>
 	class DynamicMultiChildEntity : public Entity {
 	public:
+		TYPE_REGISTRY_BASE(DynamicMultiChildEntity, Entity);
 
 		/// <summary>
 		/// Basic Constructor
@@ -22,12 +26,10 @@ namespace Tara {
 		/// <param name="transform">the transform</param>
 		/// <param name="name">the name</param>
 		DynamicMultiChildEntity(EntityNoRef parent, LayerNoRef owningLayer, Tara::Transform transform = TRANSFORM_DEFAULT, std::string name = "DynamicMultiChildEntity")
-			:Entity(parent, owningLayer, transform, name), m_Tree(nullptr)
+			:Entity(parent, owningLayer, transform, name), m_Root(s_NullNode), m_FreeNode(s_NullNode), m_FatMargin(0.25f), m_PassMark(0)
 		{}
 
-		virtual ~DynamicMultiChildEntity(){
-			if (m_Tree) { delete m_Tree; m_Tree = nullptr; }
-		}
+		virtual ~DynamicMultiChildEntity(){}
 
 	public:
 
@@ -49,96 +51,166 @@ namespace Tara {
 
 
 		/// <summary>
-		/// Apppend to a list of all the children that overlap a bounding box
+		/// Apppend to a list of all the children that overlap a bounding box.
+		/// Uses the tree, so children added since the last overlap pass are not found.
 		/// </summary>
 		/// <param name="box">the box to check with</param>
 		/// <param name="list">the list to append to</param>
-		virtual void GetAllChildrenInBox(const BoundingBox& box, std::list<EntityRef>& list) override;
+		virtual void GetAllChildrenInBox(const BoundingBox& box, std::vector<EntityRef>& list) override;
 
 
 		/// <summary>
-		/// Append to a list of all the children that overlap a circle/sphere
+		/// Append to a list of all the children that overlap a circle/sphere.
+		/// Uses the tree, so children added since the last overlap pass are not found.
 		/// </summary>
 		/// <param name="origin">the position</param>
 		/// <param name="radius">the radius</param>
 		/// <param name="list">the list to append to</param>
-		virtual void GetAllChildrenInRadius(Vector origin, float radius, std::list<EntityRef>& list) override;
+		virtual void GetAllChildrenInRadius(Vector origin, float radius, std::vector<EntityRef>& list) override;
+
+		/// <summary>
+		/// Append to a list of all the children that a ray segment hits.
+		/// Uses the tree, so children added since the last overlap pass are not found.
+		/// </summary>
+		/// <param name="origin">the start of the ray</param>
+		/// <param name="direction">the direction of the ray</param>
+		/// <param name="length">how far along the direction the ray goes</param>
+		/// <param name="list">the list to append to</param>
+		virtual void GetAllChildrenOnRay(Vector origin, Vector direction, float length, std::vector<EntityRef>& list) override;
+
+		/// <summary>
+		/// Set how much bigger than a child's real box its box in the tree is, on every side.
+		/// Larger margins mean children are moved in the tree less often, but the tree gives more false candidates.
+		/// Only applies to children as they are (re)inserted.
+		/// </summary>
+		/// <param name="margin">the margin, in world units</param>
+		inline void SetFatMargin(float margin) { m_FatMargin = margin; }
+
+		/// <summary>
+		/// Get how much bigger than a child's real box its box in the tree is, on every side.
+		/// </summary>
+		/// <returns>the margin, in world units</returns>
+		inline float GetFatMargin() const { return m_FatMargin; }
+
+		/// <summary>
+		/// Get the height of the tree. Useful for checking that it stays balanced (roughly log2 of the child count)
+		/// </summary>
+		/// <returns>the height. 0 for a single child, -1 if empty</returns>
+		inline int32_t GetTreeHeight() const { return m_Root == s_NullNode ? -1 : m_Nodes[m_Root].Height; }
 
 	private:
 
+		/// <summary>
+		/// A node in the tree. Nodes live in a pooled array, and refer to each other by index.
+		/// </summary>
 		struct Node {
-			Node* Left;
-			Node* Right;
+			/// <summary>
+			/// The box around this node. For leaves, this is the fattened box of the child
+			/// </summary>
 			BoundingBox Box;
 
 			/// <summary>
-			/// The internal entity. This ?should? be const ref because 
-			/// (a) it does not need to change and
-			/// (B) it does not need to increment the reference count
+			/// The child entity. Only set on leaves
 			/// </summary>
 			EntityRef Entity;
 
 			/// <summary>
-			/// Basic leaf constructor
+			/// The parent node, or, while the node is free, the next free node
 			/// </summary>
-			/// <param name="entity">the entity to store</param>
-			inline Node(const EntityRef& entity)
-				: Left(nullptr), Right(nullptr), Box(entity->GetFullBoundingBox()), Entity(entity)
-			{}
+			int32_t Parent;
 
-			/// <summary>
-			/// Basic non-leaf constructor
-			/// </summary>
-			/// <param name="left">the left node of this node</param>
-			/// <param name="right">the right node of this node</param>
-			inline Node(Node* left, Node* right)
-				: Left(left), Right(right), Box(left->Box + right->Box), Entity(nullptr)
-			{}
+			int32_t Left;
+			int32_t Right;
 
 			/// <summary>
-			/// basic recursive destructor
+			/// Height of the node in the tree. 0 for leaves, -1 for free nodes
 			/// </summary>
-			inline ~Node() {
-				if (Left) { delete Left; Left = nullptr; }
-				if (Right) { delete Right; Right = nullptr; }
-			}
+			int32_t Height;
 
 			/// <summary>
-			/// Add a child, and get every leaf it overlaps all in one sweep.
-			/// The overlapps are added to the list
+			/// The last overlap pass a leaf's entity was seen as a child in
 			/// </summary>
-			/// <param name="newBox"> the box around the new entity. Passed here so it only has to be calculated once per add. Passed by const ref so no copying.</param>
-			/// <param name="entity"> the new eneity to add</param>
-			/// <param name="overlapping">list to add all overlaps to</param>
-			/// <returns>the new node that may be at this position</returns>
-			Node* AddChild(const BoundingBox& newBox, EntityRef entity, std::list<EntityRef>& overlapping);
+			uint32_t PassMark;
 
-			/// <summary>
-			/// Trace a bounding box against the tree, and get every entity that overlaps it.
-			/// The list is passed as reference so that there is not a continuous concatinating of lists
-			/// </summary>
-			/// <param name="box">the box</param>
-			/// <param name="overlapping">the list to fill</param>
-			void TraceBox(BoundingBox box, std::list<EntityRef>& overlapping);
+			inline bool IsLeaf() const { return Left == s_NullNode; }
+		};
 
-			/// <summary>
-			/// Trace a sphere against the tree, and get every entity that overlaps it
-			/// The list is passed as reference so that there is not a continuous concatinating of lists
-			/// </summary>
-			/// <param name="center">center of sphere</param>
-			/// <param name="radius">radius of sphere</param>
-			/// <param name="overlapping">the list to fill</param>
-			void TraceSphere(Vector center, float radius, std::list<EntityRef>& overlapping);
+		/// <summary>
+		/// Get a node from the pool (or grow the pool)
+		/// </summary>
+		/// <returns>the index of the node</returns>
+		int32_t AllocateNode();
 
-			/// <summary>
-			/// Update bounding box
-			/// </summary>
-			void UpdateBox();
-		};
+		/// <summary>
+		/// Return a node to the pool
+		/// </summary>
+		/// <param name="node">the index of the node</param>
+		void FreeNode(int32_t node);
 
-	private:
-		Node* m_Tree;
+		/// <summary>
+		/// Insert a leaf into the tree, choosing its sibling with the surface area heuristic, then refit and rebalance up to the root
+		/// </summary>
+		/// <param name="leaf">the index of the leaf node, with its box already set</param>
+		void InsertLeaf(int32_t leaf);
+
+		/// <summary>
+		/// Remove a leaf from the tree (but not the pool), then refit and rebalance up to the root
+		/// </summary>
+		/// <param name="leaf">the index of the leaf node</param>
+		void RemoveLeaf(int32_t leaf);
 
+		/// <summary>
+		/// Rotate a node's subtree if its children's heights differ by more than one
+		/// </summary>
+		/// <param name="node">the index of the node</param>
+		/// <returns>the index of the node now at that position in the tree</returns>
+		int32_t Balance(int32_t node);
+
+		/// <summary>
+		/// Walk every leaf whose box passes a test, skipping any subtree whose box fails it
+		/// </summary>
+		/// <typeparam name="Test">function type, [bool](const BoundingBox& box){...}</typeparam>
+		/// <typeparam name="Visit">function type, [void](int32_t leaf){...}</typeparam>
+		/// <param name="test">the test to run on boxes</param>
+		/// <param name="visit">the function to call on every leaf that passes</param>
+		template<typename Test, typename Visit>
+		void Query(const Test& test, const Visit& visit) const;
+
+	private:
+		static constexpr int32_t s_NullNode = -1;
+
+		std::vector<Node> m_Nodes;
+		std::unordered_map<const Entity*, int32_t> m_Leaves; //child to leaf node
+		int32_t m_Root;
+		int32_t m_FreeNode; //head of the free node list
+		float m_FatMargin;
+		uint32_t m_PassMark;
 	};
 
-}
\ No newline at end of file
+
+	template<typename Test, typename Visit>
+	inline void DynamicMultiChildEntity::Query(const Test& test, const Visit& visit) const
+	{
+		if (m_Root == s_NullNode) { return; }
+		//explicit stack instead of recursion. A balanced tree is rarely deeper than this.
+		std::vector<int32_t> stack;
+		stack.reserve(64);
+		stack.push_back(m_Root);
+		while (stack.size() > 0) {
+			int32_t index = stack.back();
+			stack.pop_back();
+			const Node& node = m_Nodes[index];
+			if (!test(node.Box)) {
+				continue;
+			}
+			if (node.IsLeaf()) {
+				visit(index);
+			}
+			else {
+				stack.push_back(node.Right);
+				stack.push_back(node.Left);
+			}
+		}
+	}
+
+}
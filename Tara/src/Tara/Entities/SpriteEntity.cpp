@@ -9,7 +9,7 @@ namespace Tara {
 	SpriteEntity::SpriteEntity(EntityNoRef parent, LayerNoRef owningLayer, Transform transform, const std::string& name, SpriteRef sprite)
 		: Entity(parent, owningLayer, transform, name), m_Sprite(sprite), 
 		m_CurrentFrame(0), m_CurrentSequence(0,0,0.0f), m_CurrentFrameTimer(0.0f), 
-		m_Tint(1.0f,1.0f,1.0f,1.0f), m_FlipBits(0)
+		m_Tint(1.0f,1.0f,1.0f,1.0f), m_FlipBits(0), m_SortLayer(0)
 	{}
 
 	void SpriteEntity::OnUpdate(float deltaTime)
@@ -28,6 +28,13 @@ namespace Tara {
 
 	void SpriteEntity::OnDraw(float deltaTime)
 	{
+		Transform transform = GetInterpolatedWorldTransform();
+		Texture2DRef texture = m_Sprite ? m_Sprite->GetTexture() : nullptr;
+		//Y-sorted within the sort layer. Only made when it will be used
+		uint64_t sortKey = 0;
+		if (Renderer::GetQuadSortMode() == QuadSortMode::Key) {
+			sortKey = Renderer::MakeQuadSortKey(m_SortLayer, -transform.Position.y, texture);
+		}
 		if (m_Sprite){
 			auto UVs = m_Sprite->GetUVsForFrame(m_CurrentFrame);
 			if (m_FlipBits & SPRITE_FLIP_H) {
@@ -40,11 +47,11 @@ namespace Tara {
 				UVs.first.y = UVs.second.y;
 				UVs.second.y = tmp;
 			}
-			Renderer::Quad(GetWorldTransform(), m_Tint, m_Sprite->GetTexture(), UVs.first, UVs.second);
+			Renderer::Quad(transform, m_Tint, texture, UVs.first, UVs.second, sortKey);
 		}
 		else {
 			//draw color if no asset
-			Renderer::Quad(GetWorldTransform(), m_Tint);
+			Renderer::Quad(transform, m_Tint, nullptr, { 0,0 }, { 1,1 }, sortKey);
 		}
 	}
 
@@ -158,6 +165,8 @@ namespace Tara {
 		CONNECT_METHOD_OVERRIDE(SpriteEntity, SetTint); // table form
 		CONNECT_METHOD_OVERRIDE(SpriteEntity, SetFlip); // string pair form
 		CONNECT_METHOD_OVERRIDE(SpriteEntity, GetFlip); // return pair of strings
+		CONNECT_METHOD(SpriteEntity, SetSortLayer);
+		CONNECT_METHOD(SpriteEntity, GetSortLayer);
 
 	}
 
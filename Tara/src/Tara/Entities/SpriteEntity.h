@@ -15,6 +15,7 @@ namespace Tara {
 	class SpriteEntity : public Entity	{
 
 	public:
+		TYPE_REGISTRY_BASE(SpriteEntity, Entity);
 		/// <summary>
 		/// Construct a new sprite entity. Should not normally be called manually, use Tara::CreateEntity<Tara::SpriteEntity> instead
 		/// </summary>
@@ -122,6 +123,19 @@ namespace Tara {
 		/// <returns>the flit bits</returns>
 		inline const uint8_t GetFlip() const { return m_FlipBits; }
 
+		/// <summary>
+		/// Set the sort layer, used when the renderer sorts quads by key (QuadSortMode::Key).
+		/// Lower layers draw first, and within a layer sprites are Y-sorted, so sprites lower down draw over the ones above them.
+		/// </summary>
+		/// <param name="layer">the sort layer</param>
+		inline void SetSortLayer(uint8_t layer) { m_SortLayer = layer; }
+
+		/// <summary>
+		/// Get the sort layer
+		/// </summary>
+		/// <returns>the sort layer</returns>
+		inline uint8_t GetSortLayer() const { return m_SortLayer; }
+
 	public:
 		//lua stuff
 		void __SCRIPT__SetCurrentSequence(sol::object seq);
@@ -143,5 +157,6 @@ namespace Tara {
 		float m_CurrentFrameTimer;
 		glm::vec4 m_Tint;
 		uint8_t m_FlipBits;
+		uint8_t m_SortLayer;
 	};
 }
\ No newline at end of file
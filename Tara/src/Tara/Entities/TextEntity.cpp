@@ -16,7 +16,7 @@ namespace Tara{
 			m_Font->GetTextQuads(m_Text, m_CachedTrasforms, m_CachedMinUVs, m_CachedMaxUVs);
 			m_CacheDirty = false;
 		}
-		auto t = GetWorldTransform(); //cache of world transform
+		auto t = GetInterpolatedWorldTransform(); //cache of world transform
 		auto& tex = m_Font->GetTexture(); //cache of texture. audo does deduce const, but not &
 		//for each character, draw its font. Don't use m_Text.size() because there may be more transforms than in the original text. using \t is an example of this
 		for (int i = 0; i < m_CachedTrasforms.size(); i++) {
@@ -13,6 +13,7 @@ namespace Tara {
 	/// </summary>
 	class TextEntity : public Entity {
 	public:
+		TYPE_REGISTRY_BASE(TextEntity, Entity);
 
 		/// <summary>
 		/// Constructor. Use Tara::CreateEntity<Tara::TextEntity>(...) with same params
@@ -39,7 +40,7 @@ namespace Tara {
 		/// Get the current font
 		/// </summary>
 		/// <returns>the font</returns>
-		inline const FontRef& GetFont() { return m_Font; }
+		inline const FontRef& GetFont() const { return m_Font; }
 
 		/// <summary>
 		/// Set the text to be rendered
@@ -51,7 +52,7 @@ namespace Tara {
 		/// Get the current text
 		/// </summary>
 		/// <returns>the current text</returns>
-		inline const std::string& GetText() { return m_Text; }
+		inline const std::string& GetText() const { return m_Text; }
 
 		/// <summary>
 		/// Set the tint of the texture
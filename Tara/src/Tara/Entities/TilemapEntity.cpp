@@ -4,6 +4,8 @@
 #include "nlohmann/json.hpp"
 
 #include "Tara/Core/Script.h"
+#include "Tara/Core/Snapshot.h"
+#include "Tara/Asset/AssetLibrary.h"
 
 #include <fstream>
 
@@ -183,6 +185,7 @@ namespace Tara {
 					//increase Height to encompass the whole thing. Height will alwawys be one greater than last index in Y
 					m_Bounds.Height = (y - m_Bounds.y) + 1;
 				}
+				InvalidateBoundingBox();
 			}
 		}
 		else {
@@ -320,7 +323,7 @@ namespace Tara {
 	void TilemapEntity::OnDraw(float deltaTime)
 	{
 		//get the world transform Once.
-		Transform world = GetWorldTransform();
+		Transform world = GetInterpolatedWorldTransform();
 		//for every layer
 		for (auto& layer : m_Layers) {
 			//for every chunk in layer
@@ -403,6 +406,109 @@ namespace Tara {
 	}
 
 
+	void TilemapEntity::WriteSnapshot(SnapshotWriter& writer) const
+	{
+		writer.WriteU32((uint32_t)m_Tilesets.size());
+		for (auto& tileset : m_Tilesets) {
+			writer.WriteString(tileset ? tileset->GetAssetName() : "");
+		}
+		writer.WriteF32(m_Bounds.x);
+		writer.WriteF32(m_Bounds.y);
+		writer.WriteF32(m_Bounds.z);
+		writer.WriteF32(m_Bounds.Width);
+		writer.WriteF32(m_Bounds.Height);
+		writer.WriteF32(m_Bounds.Depth);
+
+		writer.WriteU32((uint32_t)m_Layers.size());
+		for (auto& layer : m_Layers) {
+			writer.WriteBool(layer.m_Colliding);
+			writer.WriteU32((uint32_t)layer.m_Chunks.size());
+			for (auto& kv : layer.m_Chunks) {
+				writer.WriteI32(kv.first.x);
+				writer.WriteI32(kv.first.y);
+				writer.WriteU32Array(kv.second->Tiles, (size_t)TileChunk::WIDTH * TileChunk::WIDTH);
+			}
+		}
+
+		//only metadata that can be saved, so count it first
+		SnapshotRegistry* registry = SnapshotRegistry::Get();
+		uint32_t metadataCount = 0;
+		for (auto& kv : m_CellMetadata) {
+			if (registry->CanSaveValue(kv.second)) {
+				metadataCount++;
+			}
+		}
+		if (metadataCount < m_CellMetadata.size()) {
+			LOG_S(WARNING) << "TilemapEntity: " << (m_CellMetadata.size() - metadataCount) << " cells of \"" << GetName() << "\" have metadata of a type not registered with SnapshotRegistry, and are not saved";
+		}
+		writer.WriteU32(metadataCount);
+		for (auto& kv : m_CellMetadata) {
+			if (registry->CanSaveValue(kv.second)) {
+				writer.WriteI32(kv.first.x);
+				writer.WriteI32(kv.first.y);
+				writer.WriteI32(kv.first.z);
+				registry->SaveValue(kv.second, writer);
+			}
+		}
+	}
+
+	void TilemapEntity::ReadSnapshot(SnapshotReader& reader)
+	{
+		uint32_t tilesetCount = reader.ReadU32();
+		m_Tilesets.clear();
+		for (uint32_t i = 0; i < tilesetCount && reader.Good(); i++) {
+			std::string tilesetName = reader.ReadString();
+			TilesetRef tileset = AssetLibrary::Get()->GetAssetIf<Tileset>(tilesetName);
+			if (!tileset) {
+				LOG_S(WARNING) << "TilemapEntity: tileset \"" << tilesetName << "\" is not loaded, the tiles of \"" << GetName() << "\" that use it will not draw";
+			}
+			m_Tilesets.push_back(tileset);
+		}
+		float x = reader.ReadF32();
+		float y = reader.ReadF32();
+		float z = reader.ReadF32();
+		float width = reader.ReadF32();
+		float height = reader.ReadF32();
+		float depth = reader.ReadF32();
+		m_Bounds = BoundingBox(x, y, z, width, height, depth);
+		InvalidateBoundingBox();
+
+		uint32_t layerCount = reader.ReadU32();
+		m_Layers.clear();
+		for (uint32_t i = 0; i < layerCount && reader.Good(); i++) {
+			PushLayer();
+			TileLayer& layer = m_Layers[m_Layers.size() - 1];
+			layer.m_Colliding = reader.ReadBool();
+			uint32_t chunkCount = reader.ReadU32();
+			for (uint32_t c = 0; c < chunkCount && reader.Good(); c++) {
+				int32_t chunkX = reader.ReadI32();
+				int32_t chunkY = reader.ReadI32();
+				TileChunk* chunk = new TileChunk();
+				reader.ReadU32Array(chunk->Tiles, (size_t)TileChunk::WIDTH * TileChunk::WIDTH);
+				TileChunk*& slot = layer.m_Chunks[glm::ivec2{ chunkX, chunkY }];
+				if (slot) {
+					//a repeated chunk replaces the earlier one
+					delete slot;
+				}
+				slot = chunk;
+			}
+		}
+
+		uint32_t metadataCount = reader.ReadU32();
+		m_CellMetadata.clear();
+		SnapshotRegistry* registry = SnapshotRegistry::Get();
+		for (uint32_t i = 0; i < metadataCount && reader.Good(); i++) {
+			int32_t cellX = reader.ReadI32();
+			int32_t cellY = reader.ReadI32();
+			int32_t cellLayer = reader.ReadI32();
+			std::any value = registry->LoadValue(reader);
+			if (reader.Good()) {
+				m_CellMetadata.insert_or_assign(glm::ivec3{ cellX, cellY, cellLayer }, value);
+			}
+		}
+	}
+
+
 	uint32_t TilemapEntity::__SCRIPT__GetTile(sol::object a, sol::object b, sol::object c)
 	{
 		if (a.valid()) {
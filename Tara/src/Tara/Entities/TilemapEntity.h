@@ -11,6 +11,9 @@ namespace Tara {
 	REFTYPE(TilemapEntity);
 	NOREFTYPE(TilemapEntity);
 
+	class SnapshotWriter;
+	class SnapshotReader;
+
 	/// <summary>
 	/// TileChunk is a 32*32 chunk of tiles (1024 tiles)
 	/// It heap-allocates its tile data
@@ -111,6 +114,7 @@ namespace Tara {
 	/// </summary>
 	class TilemapEntity : public Entity {
 	public:
+		TYPE_REGISTRY_BASE(TilemapEntity, Entity);
 		/// <summary>
 		/// When getting and setting a tileID, NO_TILE is the tileID for a blank spot
 		/// </summary>
@@ -351,6 +355,20 @@ namespace Tara {
 		static std::pair<int32_t, int32_t> ToChunkIndex(int32_t index);
 
 
+	public:
+		/// <summary>
+		/// Write the tilesets (by name), layers, and cell metadata to a snapshot. Chunks are written as raw blocks of tiles.
+		/// Cell metadata of types not registered with SnapshotRegistry is left out.
+		/// </summary>
+		/// <param name="writer">the snapshot writer</param>
+		void WriteSnapshot(SnapshotWriter& writer) const;
+
+		/// <summary>
+		/// Replace the tilesets, layers, and cell metadata with ones read from a snapshot
+		/// </summary>
+		/// <param name="reader">the snapshot reader</param>
+		void ReadSnapshot(SnapshotReader& reader);
+
 	public:
 		//Lua stuff
 		uint32_t __SCRIPT__GetTile(sol::object a, sol::object b, sol::object c);
@@ -41,9 +41,24 @@ namespace Tara {
 		/// <returns></returns>
 		inline bool GetListeningForEvents() const { return m_ListeningForEvents; }
 
+		/// <summary>
+		/// Set the event categories this listener wants. Native window events are only dispatched to it if they are in one of these,
+		/// and components only get events forwarded from their entity if they are in one of these. All categories by default.
+		/// Read when listening is enabled, so call ListenForEvents(true) again to apply a change while listening.
+		/// </summary>
+		/// <param name="categories">the EventCategory flags, or'd together</param>
+		inline void SetEventCategories(uint16_t categories) { m_EventCategories = categories; }
+
+		/// <summary>
+		/// Get the event categories this listener wants
+		/// </summary>
+		/// <returns>the EventCategory flags</returns>
+		inline uint16_t GetEventCategories() const { return m_EventCategories; }
+
 	private:
 		
-		bool m_ListeningForEvents;
+		bool m_ListeningForEvents = false;
+		uint16_t m_EventCategories = 0xFFFF;
 	};
 
 	using EventListenerNoRef = std::weak_ptr<EventListener>;
@@ -0,0 +1,147 @@
+#include "tarapch.h"
+#include "ListenerRegistry.h"
+
+namespace Tara {
+
+	void ListenerRegistry::Add(const EventListenerNoRef& ref)
+	{
+		auto listener = ref.lock();
+		if (!listener) {
+			return;
+		}
+		uint32_t handle;
+		auto found = m_Handles.find(listener.get());
+		if (found != m_Handles.end() && m_Entries[found->second].Listener.lock() == listener) {
+			//already added. The new stamp turns the old slots into tombstones
+			handle = found->second;
+			for (uint32_t bit = 0; bit < LISTENER_REGISTRY_CATEGORIES; bit++) {
+				if (m_Entries[handle].Categories & BIT(bit)) {
+					m_Categories[bit].Live--;
+				}
+			}
+		}
+		else {
+			if (found != m_Handles.end()) {
+				//a dead listener that had the same address
+				Release(found->second);
+			}
+			if (m_FreeEntries.size() > 0) {
+				handle = m_FreeEntries.back();
+				m_FreeEntries.pop_back();
+			}
+			else {
+				handle = (uint32_t)m_Entries.size();
+				m_Entries.push_back({});
+			}
+			m_Handles[listener.get()] = handle;
+		}
+		Entry& entry = m_Entries[handle];
+		entry.Listener = ref;
+		entry.Key = listener.get();
+		entry.Stamp = m_NextStamp++;
+		entry.Categories = listener->GetEventCategories();
+		for (uint32_t bit = 0; bit < LISTENER_REGISTRY_CATEGORIES; bit++) {
+			if (entry.Categories & BIT(bit)) {
+				auto& list = m_Categories[bit];
+				list.Slots.push_back({ handle, entry.Stamp });
+				list.Live++;
+				CompactIfSparse(list);
+			}
+		}
+	}
+
+	void ListenerRegistry::Remove(const EventListenerNoRef& ref)
+	{
+		auto listener = ref.lock();
+		if (!listener) {
+			//dead listeners are released when dispatch finds them
+			return;
+		}
+		auto found = m_Handles.find(listener.get());
+		if (found != m_Handles.end()) {
+			Release(found->second);
+		}
+	}
+
+	void ListenerRegistry::Dispatch(Event& e)
+	{
+		//a cursor into each category array the event is in. Walked back to front, merged by stamp,
+		//so listeners in more than one of the arrays get the event once, in the right order
+		struct Cursor {
+			const std::vector<Slot>* Slots;
+			size_t Next; //one past the next slot to look at. Sizes are taken now, so listeners added while dispatching are skipped
+		};
+		Cursor cursors[LISTENER_REGISTRY_CATEGORIES];
+		uint32_t cursorCount = 0;
+		uint16_t flags = e.GetCategoryFlags();
+		for (uint32_t bit = 0; bit < LISTENER_REGISTRY_CATEGORIES; bit++) {
+			if ((flags & BIT(bit)) && m_Categories[bit].Slots.size() > 0) {
+				cursors[cursorCount++] = { &m_Categories[bit].Slots, m_Categories[bit].Slots.size() };
+			}
+		}
+
+		m_DispatchDepth++;
+		uint64_t lastStamp = 0;
+		while (!e.Handled()) {
+			Cursor* best = nullptr;
+			uint64_t bestStamp = 0;
+			for (uint32_t i = 0; i < cursorCount; i++) {
+				if (cursors[i].Next > 0 && (*cursors[i].Slots)[cursors[i].Next - 1].Stamp > bestStamp) {
+					best = &cursors[i];
+					bestStamp = (*cursors[i].Slots)[cursors[i].Next - 1].Stamp;
+				}
+			}
+			if (!best) {
+				break;
+			}
+			Slot slot = (*best->Slots)[--best->Next];
+			if (slot.Stamp == lastStamp || m_Entries[slot.Handle].Stamp != slot.Stamp) {
+				//already sent from another category, or a tombstone
+				continue;
+			}
+			lastStamp = slot.Stamp;
+			auto listener = m_Entries[slot.Handle].Listener.lock();
+			if (!listener) {
+				Release(slot.Handle);
+				continue;
+			}
+			listener->ReceiveEvent(e);
+		}
+		m_DispatchDepth--;
+
+		if (m_DispatchDepth == 0) {
+			for (uint32_t bit = 0; bit < LISTENER_REGISTRY_CATEGORIES; bit++) {
+				if (flags & BIT(bit)) {
+					CompactIfSparse(m_Categories[bit]);
+				}
+			}
+		}
+	}
+
+	void ListenerRegistry::Release(uint32_t handle)
+	{
+		Entry& entry = m_Entries[handle];
+		for (uint32_t bit = 0; bit < LISTENER_REGISTRY_CATEGORIES; bit++) {
+			if (entry.Categories & BIT(bit)) {
+				m_Categories[bit].Live--;
+			}
+		}
+		auto found = m_Handles.find(entry.Key);
+		if (found != m_Handles.end() && found->second == handle) {
+			m_Handles.erase(found);
+		}
+		entry = {};
+		m_FreeEntries.push_back(handle);
+	}
+
+	void ListenerRegistry::CompactIfSparse(CategoryList& list)
+	{
+		//not while dispatching, as the cursors index into the arrays
+		if (m_DispatchDepth > 0 || list.Slots.size() <= 2 * (size_t)list.Live + 32) {
+			return;
+		}
+		auto cleaned = std::remove_if(list.Slots.begin(), list.Slots.end(), [this](const Slot& slot) { return m_Entries[slot.Handle].Stamp != slot.Stamp; });
+		list.Slots.erase(cleaned, list.Slots.end());
+	}
+
+}
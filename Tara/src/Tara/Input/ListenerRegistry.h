@@ -0,0 +1,86 @@
+#pragma once
+#include "tarapch.h"
+#include "Tara/Input/EventListener.h"
+
+//the number of event category bits
+#define LISTENER_REGISTRY_CATEGORIES 16
+
+namespace Tara {
+
+	/// <summary>
+	/// The event listeners of a layer, indexed by event category.
+	/// Each category keeps a contiguous array of the listeners subscribed to it, in the order they were enabled, so dispatching
+	/// an event only touches the listeners subscribed to one of its categories. The most recently enabled listener gets events first.
+	/// Removing a listener just leaves a tombstone in each array it was in. The arrays are compacted once they are mostly tombstones.
+	/// </summary>
+	class ListenerRegistry {
+	public:
+		/// <summary>
+		/// Add a listener, or move it to the front if already added. The listener's event categories are read now.
+		/// </summary>
+		/// <param name="ref">the listener</param>
+		void Add(const EventListenerNoRef& ref);
+
+		/// <summary>
+		/// Remove a listener
+		/// </summary>
+		/// <param name="ref">the listener</param>
+		void Remove(const EventListenerNoRef& ref);
+
+		/// <summary>
+		/// Send an event to every listener subscribed to any of its categories, front to back, until one handles it.
+		/// Listeners added while dispatching don't get the event. Listeners removed while dispatching don't get it either, if they haven't yet.
+		/// </summary>
+		/// <param name="e">the event</param>
+		void Dispatch(Event& e);
+
+		/// <summary>
+		/// Get the number of listeners
+		/// </summary>
+		/// <returns>the count</returns>
+		inline size_t GetListenerCount() const { return m_Handles.size(); }
+
+	private:
+		/// <summary>
+		/// A listener. Stamp is unique per Add, and 0 when the entry is free.
+		/// </summary>
+		struct Entry {
+			EventListenerNoRef Listener;
+			const EventListener* Key;
+			uint64_t Stamp;
+			uint16_t Categories;
+		};
+
+		/// <summary>
+		/// A listener in a category array. A tombstone if the stamp no longer matches the entry's.
+		/// </summary>
+		struct Slot {
+			uint32_t Handle;
+			uint64_t Stamp;
+		};
+
+		struct CategoryList {
+			std::vector<Slot> Slots; //in increasing stamp order
+			uint32_t Live = 0;
+		};
+
+		/// <summary>
+		/// Free an entry, turning its slots into tombstones
+		/// </summary>
+		void Release(uint32_t handle);
+
+		/// <summary>
+		/// Take the tombstones out of a category array, if it is mostly tombstones
+		/// </summary>
+		void CompactIfSparse(CategoryList& list);
+
+	private:
+		std::vector<Entry> m_Entries;
+		std::vector<uint32_t> m_FreeEntries;
+		std::unordered_map<const EventListener*, uint32_t> m_Handles;
+		CategoryList m_Categories[LISTENER_REGISTRY_CATEGORIES];
+		uint64_t m_NextStamp = 1;
+		uint32_t m_DispatchDepth = 0;
+	};
+
+}
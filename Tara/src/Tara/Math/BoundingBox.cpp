@@ -16,6 +16,38 @@ namespace Tara{
 			);
 	}
 
+	bool BoundingBox::OverlappingRay(const Vector& origin, const Vector& direction, float length) const
+	{
+		//negative-size don't collide
+		if (Width < 0 || Height < 0 || Depth < 0) { return false; }
+		//slab test, clipping the segment's [0, length] range against each axis in turn
+		float tMin = 0.0f;
+		float tMax = length;
+		const float start[3] = { origin.x, origin.y, origin.z };
+		const float dir[3] = { direction.x, direction.y, direction.z };
+		const float low[3] = { x, y, z };
+		const float high[3] = { x + Width, y + Height, z + Depth };
+		for (int axis = 0; axis < 3; axis++) {
+			if (dir[axis] == 0.0f) {
+				//parallel to this slab, so must start inside it
+				if (start[axis] < low[axis] || start[axis] > high[axis]) {
+					return false;
+				}
+				continue;
+			}
+			float inv = 1.0f / dir[axis];
+			float t1 = (low[axis] - start[axis]) * inv;
+			float t2 = (high[axis] - start[axis]) * inv;
+			if (t1 > t2) { std::swap(t1, t2); }
+			tMin = std::max(tMin, t1);
+			tMax = std::min(tMax, t2);
+			if (tMin > tMax) {
+				return false;
+			}
+		}
+		return true;
+	}
+
 	BoundingBox BoundingBox::operator+(const BoundingBox& other) const
 	{
 		//negative-size don't combine
@@ -82,4 +114,4 @@ namespace Tara{
 		return (x * x + y * y + z * z < other.x* other.x + other.y * other.y + other.z * other.z);
 	}
 
-}
\ No newline at end of file
+}
\ No newline at end of file
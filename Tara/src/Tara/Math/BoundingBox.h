@@ -101,6 +101,46 @@ namespace Tara {
 		/// <returns></returns>
 		bool OverlappingSphere(const Vector origin, const float radius) const;
 
+		/// <summary>
+		/// Check if a ray segment hits a BoundingBox.
+		/// The segment runs from origin to origin + (direction * length)
+		/// </summary>
+		/// <param name="origin">the start of the ray</param>
+		/// <param name="direction">the direction of the ray. If this is a unit vector, length is in world units.</param>
+		/// <param name="length">how far along the direction the ray goes</param>
+		/// <returns>true if the ray hits the box</returns>
+		bool OverlappingRay(const Vector& origin, const Vector& direction, float length) const;
+
+		/// <summary>
+		/// Check if another box is entirely inside this one (touching edges count as inside)
+		/// </summary>
+		/// <param name="other">the other box</param>
+		/// <returns>true if other is inside this box. Negative-size boxes never contain or are contained.</returns>
+		inline bool Contains(const BoundingBox& other) const {
+			if (Width < 0 || Height < 0 || Depth < 0 || other.Width < 0 || other.Height < 0 || other.Depth < 0) { return false; }
+			return
+				other.x >= x && other.x + other.Width <= x + Width &&
+				other.y >= y && other.y + other.Height <= y + Height &&
+				other.z >= z && other.z + other.Depth <= z + Depth;
+		}
+
+		/// <summary>
+		/// Get the surface area of the box. For flat (2D) boxes, this is twice the area.
+		/// </summary>
+		/// <returns>the surface area</returns>
+		inline float SurfaceArea() const {
+			return 2.0f * ((Width * Height) + (Height * Depth) + (Depth * Width));
+		}
+
+		/// <summary>
+		/// Get a copy of this box grown by a margin on every side
+		/// </summary>
+		/// <param name="margin">the distance to grow each side by</param>
+		/// <returns>the grown box</returns>
+		inline BoundingBox Expanded(float margin) const {
+			return { x - margin, y - margin, z - margin, Width + (2.0f * margin), Height + (2.0f * margin), Depth + (2.0f * margin) };
+		}
+
 		/// <summary>
 		/// Combine two bounding boxes. This returns a new box that encompases both.
 		/// </summary>
@@ -150,4 +190,4 @@ namespace Tara {
 	};
 
 
-}
\ No newline at end of file
+}
\ No newline at end of file
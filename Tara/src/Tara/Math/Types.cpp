@@ -575,6 +575,16 @@ namespace Tara{
 		return Transform(-Position, Rotation.Inverse(), -Scale);
 	}
 
+	Transform Transform::Lerp(const Transform& a, const Transform& b, float alpha)
+	{
+		//the rotator difference is clamped to [-180, 180], so this is the short way
+		return Transform(
+			a.Position + (b.Position - a.Position) * alpha,
+			a.Rotation + (b.Rotation - a.Rotation) * alpha,
+			a.Scale + (b.Scale - a.Scale) * alpha
+		);
+	}
+
 	sol::table Transform::ToScriptTable() const
 	{
 		//TODO: when lua side library for tables, complete, replace this
@@ -419,6 +419,15 @@ namespace Tara {
 		/// <returns></returns>
 		Transform operator-() const;
 
+		/// <summary>
+		/// Blend between two transforms. Rotation takes the shortest way around.
+		/// </summary>
+		/// <param name="a">the transform at alpha 0</param>
+		/// <param name="b">the transform at alpha 1</param>
+		/// <param name="alpha">how far from a to b</param>
+		/// <returns>the blended transform</returns>
+		static Transform Lerp(const Transform& a, const Transform& b, float alpha);
+
 		/// <summary>
 		/// Get a lua type from a rotator
 		/// </summary>
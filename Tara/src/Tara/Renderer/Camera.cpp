@@ -26,11 +26,9 @@ namespace Tara {
 		//make a vec4 for matrix operations
 		glm::vec4 viewPlanePos = { vx, vy, 0.0f, 1.0f }; 
 		
-		//Get the transform matrix, for use later
-		auto tMatrix = m_Transform.GetTransformMatrix(); 
-		
 		//transform the vector to be relative to the camera location in the world. 
-		Vector origin(tMatrix * glm::inverse(m_ProjectionMatrix) * viewPlanePos); 
+		//the inverse view projection is the camera's transform times the inverse projection, already multiplied
+		Vector origin(GetInverseViewProjectionMatrix() * viewPlanePos); 
 
 		//now, get the offset.
 		//just get the forward vector of the camera (since its basic orthographic)
@@ -42,6 +40,30 @@ namespace Tara {
 
 
 
+	void Camera::UpdateCachedMatrices() const
+	{
+		if (!m_MatricesDirty) {
+			return;
+		}
+		m_ViewProjectionMatrix = GetProjectionMatrix() * GetViewMatrix();
+		m_InverseViewProjectionMatrix = glm::inverse(m_ViewProjectionMatrix);
+		//everything visible is inside the clip space cube, so the world space corners of the cube bound the view.
+		//perspective projections here are set up with a negative near plane, so the cube's corners don't bound anything useful
+		m_HasViewBounds = m_Type != ProjectionType::Perspective;
+		if (m_HasViewBounds) {
+			glm::vec3 minCorner(std::numeric_limits<float>::max());
+			glm::vec3 maxCorner(std::numeric_limits<float>::lowest());
+			for (int i = 0; i < 8; i++) {
+				glm::vec4 corner = m_InverseViewProjectionMatrix * glm::vec4((i & 1) ? 1.0f : -1.0f, (i & 2) ? 1.0f : -1.0f, (i & 4) ? 1.0f : -1.0f, 1.0f);
+				glm::vec3 point(corner.x / corner.w, corner.y / corner.w, corner.z / corner.w);
+				minCorner = glm::min(minCorner, point);
+				maxCorner = glm::max(maxCorner, point);
+			}
+			m_ViewBounds = BoundingBox(minCorner.x, minCorner.y, minCorner.z, maxCorner.x - minCorner.x, maxCorner.y - minCorner.y, maxCorner.z - minCorner.z);
+		}
+		m_MatricesDirty = false;
+	}
+
 	std::pair<float, float> Camera::GetRenderTargetSize() const
 	{
 		if (m_RenderTarget) {
@@ -100,6 +122,7 @@ namespace Tara {
 				m_Extent.Bottom, m_Extent.Top,
 				m_Extent.Near, m_Extent.Far
 			);
+			InvalidateCachedMatrices();
 		}
 		if (m_RenderTarget) {
 			m_RenderTarget->SetSize(width, height);
@@ -125,6 +148,7 @@ namespace Tara {
 			m_Extent.Bottom, m_Extent.Top,
 			m_Extent.Near, m_Extent.Far
 		);
+		InvalidateCachedMatrices();
 	}
 	
 
@@ -157,12 +181,9 @@ namespace Tara {
 		//make a vec4 for matrix operations
 		glm::vec4 viewPlanePos = { vx, vy, 0.0f, 1.0f };
 
-		//Get the transform matrix, for use later
-		auto tMatrix = m_Transform.GetTransformMatrix();
-
 		//transform the vector to be relative to the camera location in the world. 
 		//TODO: make this robust enough to work for all camera types without overriding! (currently only works for orthographic types.)
-		Vector offset(tMatrix * glm::inverse(m_ProjectionMatrix) * viewPlanePos);
+		Vector offset(GetInverseViewProjectionMatrix() * viewPlanePos);
 		offset.Normalize();
 		//now, get the offset.
 		//just get the forward vector of the camera (since its basic orthographic)
@@ -183,6 +204,7 @@ namespace Tara {
 		}
 		//TODO: add methods to set near and far clipping plane
 		m_ProjectionMatrix = glm::perspective(glm::radians(m_FOV), m_AspectRatio, -1.0f, 1.0f);
+		InvalidateCachedMatrices();
 	}
 
 	ScreenCamera::ScreenCamera()
@@ -227,14 +249,9 @@ namespace Tara {
 		//make a vec4 for matrix operations
 		glm::vec4 viewPlanePos = { vx, vy, 0.0f, 1.0f };
 
-		//Get the transform matrix, for use later
-		Transform t = m_Transform; //copy
-		t.Position += Vector{ m_ScreenWidth / 2, m_ScreenHeight / 2, 0 };
-		t.Scale.y *= -1;
-		auto tMatrix = t.GetTransformMatrix();
-
 		//transform the vector to be relative to the camera location in the world. 
-		Vector origin(tMatrix * glm::inverse(m_ProjectionMatrix) * viewPlanePos);
+		//the inverse view projection includes the offset and flip of GetViewMatrix
+		Vector origin(GetInverseViewProjectionMatrix() * viewPlanePos);
 
 		//now, get the offset.
 		//just get the forward vector of the camera (since its basic orthographic)
@@ -260,6 +277,7 @@ namespace Tara {
 			extent.Bottom, extent.Top,
 			extent.Near, extent.Far
 		);
+		InvalidateCachedMatrices();
 	}
 
 
@@ -1,5 +1,6 @@
 #pragma once
 #include "Tara/Math/Types.h"
+#include "Tara/Math/BoundingBox.h"
 #include "Tara/Renderer/Texture.h"
 
 namespace Tara {
@@ -46,19 +47,19 @@ namespace Tara {
 		/// Set the world Transform of a camera
 		/// </summary>
 		/// <param name="t">the new transform</param>
-		void SetTransform(Transform t) { m_Transform = t; }
+		void SetTransform(Transform t) { m_Transform = t; m_MatricesDirty = true; }
 		
 		/// <summary>
 		/// Set the world Position of a camera
 		/// </summary>
 		/// <param name="pos">the new position</param>
-		void SetPosition(Vector pos) { m_Transform.Position = pos; }
+		void SetPosition(Vector pos) { m_Transform.Position = pos; m_MatricesDirty = true; }
 		
 		/// <summary>
 		/// Set the world rotation of a camera
 		/// </summary>
 		/// <param name="rot">the new rotation</param>
-		void SetRotation(Rotator rot) { m_Transform.Rotation = rot; }
+		void SetRotation(Rotator rot) { m_Transform.Rotation = rot; m_MatricesDirty = true; }
 		
 		/// <summary>
 		/// Get the world Transform of a camera
@@ -97,11 +98,23 @@ namespace Tara {
 		virtual glm::mat4 GetViewMatrix() const { return glm::inverse(m_Transform.GetTransformMatrix()); }
 		
 		/// <summary>
-		/// Get the projection and view matrix pre-combined
+		/// Get the projection and view matrix pre-combined. Cached, and only recomputed after the camera changes.
 		/// </summary>
 		/// <returns>projection*view matrix, column-major</returns>
+		inline const glm::mat4& GetViewProjectionMatrix() const { UpdateCachedMatrices(); return m_ViewProjectionMatrix; }
 
-		virtual glm::mat4 GetViewProjectionMatrix() const {return GetProjectionMatrix() * GetViewMatrix();}
+		/// <summary>
+		/// Get the inverse of the view projection matrix, which maps from clip space to world space. Cached like GetViewProjectionMatrix.
+		/// </summary>
+		/// <returns>inverse(projection*view) matrix, column-major</returns>
+		inline const glm::mat4& GetInverseViewProjectionMatrix() const { UpdateCachedMatrices(); return m_InverseViewProjectionMatrix; }
+
+		/// <summary>
+		/// Get the world space box around everything the camera can see. Cached like GetViewProjectionMatrix.
+		/// </summary>
+		/// <param name="bounds">set to the view bounds</param>
+		/// <returns>false if the view has no useful bounds (perspective cameras), in which case nothing should be culled against it</returns>
+		inline bool GetViewBounds(BoundingBox& bounds) const { UpdateCachedMatrices(); bounds = m_ViewBounds; return m_HasViewBounds; }
 		
 		/// <summary>
 		/// Get the render target of a camera
@@ -150,12 +163,31 @@ namespace Tara {
 	
 		std::pair<float, float> GetRenderTargetSize() const;
 
+		/// <summary>
+		/// Mark the cached matrices and view bounds as stale. Must be called after anything that changes the view or projection matrix.
+		/// </summary>
+		inline void InvalidateCachedMatrices() { m_MatricesDirty = true; }
+
+	private:
+		/// <summary>
+		/// Recompute the cached matrices and view bounds, if stale
+		/// </summary>
+		void UpdateCachedMatrices() const;
+
 	protected:
 		Transform m_Transform;
 		const ProjectionType m_Type;
 		glm::mat4 m_ProjectionMatrix;
 		RenderTargetRef m_RenderTarget;
 		uint32_t m_RenderFilterBits;
+
+	private:
+		//computed lazily from the view and projection matrices, see UpdateCachedMatrices
+		mutable glm::mat4 m_ViewProjectionMatrix;
+		mutable glm::mat4 m_InverseViewProjectionMatrix;
+		mutable BoundingBox m_ViewBounds;
+		mutable bool m_HasViewBounds = false;
+		mutable bool m_MatricesDirty = true;
 	};
 
 	/// <summary>
@@ -0,0 +1,74 @@
+#include "tarapch.h"
+#include "DrawList.h"
+#include "Tara/Renderer/Renderer.h"
+
+namespace Tara {
+
+	void DrawList::Clear()
+	{
+		m_Items.clear();
+		m_Quads.clear();
+		m_Draws.clear();
+		m_Textures.clear();
+		m_TextureIndices.clear();
+		m_InItem = false;
+	}
+
+	void DrawList::BeginItem(const BoundingBox& bounds, uint32_t renderFilterBits, bool cullable)
+	{
+		CHECK_F(!m_InItem, "DrawList::BeginItem: the last item was not ended");
+		m_InItem = true;
+		uint32_t quads = (uint32_t)m_Quads.size();
+		uint32_t draws = (uint32_t)m_Draws.size();
+		m_Items.push_back({ bounds, renderFilterBits, cullable, quads, quads, draws, draws });
+	}
+
+	void DrawList::EndItem()
+	{
+		CHECK_F(m_InItem, "DrawList::EndItem: no item was begun");
+		m_InItem = false;
+		Item& item = m_Items.back();
+		item.QuadEnd = (uint32_t)m_Quads.size();
+		item.DrawEnd = (uint32_t)m_Draws.size();
+		if (item.QuadBegin == item.QuadEnd && item.DrawBegin == item.DrawEnd) {
+			m_Items.pop_back();
+		}
+	}
+
+	void DrawList::AddQuad(const Transform& transform, const glm::vec4& color, const Texture2DRef& texture, const glm::vec2& minUV, const glm::vec2& maxUV, uint64_t sortKey)
+	{
+		uint32_t index = UINT32_MAX;
+		if (texture) {
+			auto iter = m_TextureIndices.find(texture.get());
+			if (iter != m_TextureIndices.end()) {
+				index = iter->second;
+			}
+			else {
+				index = (uint32_t)m_Textures.size();
+				m_Textures.push_back(texture);
+				m_TextureIndices.emplace(texture.get(), index);
+			}
+		}
+		m_Quads.push_back({ transform, minUV, maxUV, color, sortKey, index });
+	}
+
+	void DrawList::AddDraw(const VertexArrayRef& vertexArray, const ShaderRef& shader, const Transform& transform)
+	{
+		m_Draws.push_back({ vertexArray, shader, transform });
+	}
+
+	void DrawList::Submit(const Item& item) const
+	{
+		//vertex arrays draw right away and quads at the end of the scene, the same as when drawn directly
+		for (uint32_t i = item.DrawBegin; i < item.DrawEnd; i++) {
+			const DrawCommand& draw = m_Draws[i];
+			Renderer::Draw(draw.VertexArray, draw.Shader, draw.Transform);
+		}
+		static const Texture2DRef s_NoTexture = nullptr;
+		for (uint32_t i = item.QuadBegin; i < item.QuadEnd; i++) {
+			const QuadCommand& quad = m_Quads[i];
+			Renderer::Quad(quad.Transform, quad.Color, (quad.Texture == UINT32_MAX) ? s_NoTexture : m_Textures[quad.Texture], quad.MinUV, quad.MaxUV, quad.SortKey);
+		}
+	}
+
+}
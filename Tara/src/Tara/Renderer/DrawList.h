@@ -0,0 +1,123 @@
+#pragma once
+#include "tarapch.h"
+#include "Tara/Math/Types.h"
+#include "Tara/Math/BoundingBox.h"
+#include "Tara/Renderer/Texture.h"
+#include "Tara/Renderer/Shader.h"
+#include "Tara/Renderer/VertexArray.h"
+
+namespace Tara {
+
+	/// <summary>
+	/// A recorded list of draws, grouped into items (one per drawn entity), for drawing the same things to several cameras.
+	/// While recording (see Renderer::BeginRecording), Renderer::Quad and Renderer::Draw are stored here instead of being drawn.
+	/// Each item keeps the bounds and render filter bits of what drew it, so it can be filtered per camera without drawing it again.
+	/// </summary>
+	class DrawList {
+	public:
+		/// <summary>
+		/// One drawn thing, and the range of draws it recorded
+		/// </summary>
+		struct Item {
+			BoundingBox Bounds;
+			uint32_t RenderFilterBits;
+			bool Cullable; //false if Bounds does not cover everything the item draws
+			uint32_t QuadBegin, QuadEnd;
+			uint32_t DrawBegin, DrawEnd;
+		};
+
+	public:
+		DrawList() = default;
+
+		DrawList(DrawList const&) = delete;
+		void operator=(DrawList const&) = delete;
+
+		/// <summary>
+		/// Drop everything recorded. Storage is kept, so lists rebuilt every frame don't reallocate
+		/// </summary>
+		void Clear();
+
+		/// <summary>
+		/// Start an item. Draws recorded until EndItem belong to it.
+		/// </summary>
+		/// <param name="bounds">the world space bounds of what the item draws</param>
+		/// <param name="renderFilterBits">the render filter bits, checked against each camera's</param>
+		/// <param name="cullable">false if the bounds may not cover everything drawn, so the item is never culled</param>
+		void BeginItem(const BoundingBox& bounds, uint32_t renderFilterBits, bool cullable);
+
+		/// <summary>
+		/// End the current item. Items that recorded nothing are dropped.
+		/// </summary>
+		void EndItem();
+
+		/// <summary>
+		/// Record a quad. Same parameters as Renderer::Quad
+		/// </summary>
+		void AddQuad(const Transform& transform, const glm::vec4& color, const Texture2DRef& texture, const glm::vec2& minUV, const glm::vec2& maxUV, uint64_t sortKey);
+
+		/// <summary>
+		/// Record a vertex array draw. Same parameters as Renderer::Draw
+		/// </summary>
+		void AddDraw(const VertexArrayRef& vertexArray, const ShaderRef& shader, const Transform& transform);
+
+		/// <summary>
+		/// Draw an item's recorded draws, into the current scene
+		/// </summary>
+		/// <param name="item">the item, from GetItems</param>
+		void Submit(const Item& item) const;
+
+		/// <summary>
+		/// Check if an item should be drawn to a camera
+		/// </summary>
+		/// <param name="item">the item</param>
+		/// <param name="cameraBits">the render filter bits of the camera</param>
+		/// <param name="viewBounds">the view bounds of the camera, or null to not cull</param>
+		/// <returns>true if it should be drawn</returns>
+		inline static bool IsVisible(const Item& item, uint32_t cameraBits, const BoundingBox* viewBounds) {
+			return (item.RenderFilterBits & cameraBits) && !(viewBounds && item.Cullable && !item.Bounds.Overlaping(*viewBounds));
+		}
+
+		/// <summary>
+		/// Get the recorded items, in the order they were drawn
+		/// </summary>
+		/// <returns>the items</returns>
+		inline const std::vector<Item>& GetItems() const { return m_Items; }
+
+		/// <summary>
+		/// Get the number of recorded quads
+		/// </summary>
+		/// <returns>the count</returns>
+		inline size_t GetQuadCount() const { return m_Quads.size(); }
+
+	private:
+		/// <summary>
+		/// A recorded quad. The texture is an index into m_Textures, so recording does not touch reference counts per quad.
+		/// </summary>
+		struct QuadCommand {
+			Tara::Transform Transform;
+			glm::vec2 MinUV;
+			glm::vec2 MaxUV;
+			glm::vec4 Color;
+			uint64_t SortKey;
+			uint32_t Texture; //UINT32_MAX for none
+		};
+
+		/// <summary>
+		/// A recorded vertex array draw
+		/// </summary>
+		struct DrawCommand {
+			VertexArrayRef VertexArray;
+			ShaderRef Shader;
+			Tara::Transform Transform;
+		};
+
+	private:
+		std::vector<Item> m_Items;
+		std::vector<QuadCommand> m_Quads;
+		std::vector<DrawCommand> m_Draws;
+		std::vector<Texture2DRef> m_Textures;
+		std::unordered_map<const Texture2D*, uint32_t> m_TextureIndices;
+		bool m_InItem = false;
+	};
+
+}
@@ -7,6 +7,7 @@
 #include "GLFW/glfw3.h"
 
 #include "Platform/OpenGL/OpenGLRenderCommand.h"
+#include "Platform/Headless/HeadlessRenderCommand.h"
 namespace Tara {
 	//default::uninitialized pointer
 	std::unique_ptr<RenderCommand> RenderCommand::s_RC = std::unique_ptr<RenderCommand>();
@@ -21,7 +22,11 @@ namespace Tara {
 			s_RC = std::make_unique<OpenGLRenderCommand>();
 			break;
 		}
-		case RenderBackend::None: ABORT_F("Renderbackend::None not supported!");
+		case RenderBackend::None: {
+			//headless, commands do nothing
+			s_RC = std::make_unique<HeadlessRenderCommand>();
+			break;
+		}
 		}
 		m_DrawTypeStack.push_front({ RenderDrawType::Triangles, false });
 	}
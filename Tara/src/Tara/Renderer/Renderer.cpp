@@ -2,6 +2,7 @@
 #include "Tara/Renderer/Renderer.h"
 #include "Tara/Renderer/RenderCommand.h"
 #include "Tara/Math/BoundingBox.h"
+#include <cstring>
 //#include "Tara/Renderer/VertexArray.h"
 //#include "Tara/Renderer/Shader.h"
 //#include "Tara/Math/Types.h"
@@ -22,10 +23,32 @@ namespace Tara {
 	ShaderRef Renderer::s_QuadShader = nullptr;
 	uint32_t Renderer::s_MaxTextures = 16;
 	std::vector<Renderer::QuadGroup> Renderer::s_QuadGroups;
+	DrawList* Renderer::s_RecordingList = nullptr;
+	QuadSortMode Renderer::s_QuadSortMode = QuadSortMode::Submission;
+	std::vector<Renderer::KeyedQuad> Renderer::s_KeyedQuads;
+	std::vector<Renderer::SortEntry> Renderer::s_SortEntries;
+	std::vector<Renderer::SortEntry> Renderer::s_SortScratch;
+	uint32_t Renderer::s_LastQuadBatchCount = 0;
+	uint32_t Renderer::s_QuadGroupCount = 0;
+	uint32_t Renderer::s_FirstOpenQuadGroup = 0;
+	std::vector<Renderer::TextureSlot> Renderer::s_TextureSlots;
+	uint32_t Renderer::s_TextureSlotCount = 0;
+	uint32_t Renderer::s_TextureSlotStamp = 1;
+	bool Renderer::s_HeadlessBatching = false;
+
+	void Renderer::SetRenderBackend(RenderBackend backend)
+	{
+		CHECK_F(!s_InitializedQuadDraw, "Renderer::SetRenderBackend: the backend can't be changed after rendering has started");
+		s_RenderBackend = backend;
+	}
 
 	void Renderer::BeginScene(const CameraRef camera)
 	{
+		//nothing to draw to
+		if (s_RenderBackend == RenderBackend::None && !s_HeadlessBatching) { return; }
+		CHECK_F(!s_RecordingList, "Renderer::BeginScene: can't begin a scene while recording a draw list");
 		s_SceneData.camera = camera;
+		if (s_RenderBackend == RenderBackend::None) { return; }
 		auto rt = camera->GetRenderTarget();
 		if (rt) {
 			rt->RenderTo(true);
@@ -63,14 +86,25 @@ namespace Tara {
 
 	void Renderer::EndScene()
 	{
+		if (s_RenderBackend == RenderBackend::None && !s_HeadlessBatching) { return; }
+		if (s_KeyedQuads.size() > 0) {
+			BatchKeyedQuads();
+		}
+		if (s_RenderBackend == RenderBackend::None) {
+			//batched, but with nothing to draw to
+			ResetQuadGroups();
+			s_SceneData.camera = nullptr;
+			return;
+		}
 		//execute batch rendering
 		s_QuadShader->Bind();
 		s_QuadShader->Send("u_MatrixViewProjection", s_SceneData.camera->GetViewProjectionMatrix());
 		s_QuadArray->Bind();
-		for (const auto& group : s_QuadGroups) {
+		for (uint32_t i = 0; i < s_QuadGroupCount; i++) {
+			const QuadGroup& group = s_QuadGroups[i];
 			s_QuadArray->GetVertexBuffers()[0]->SetData((float*)group.Quads.data(), (uint32_t)group.Quads.size() * 18); //the 18 is not a "magic number", it is the number of floats in a QuadData struct.
 			uint32_t index = 0;
-			for (auto texture : group.TextureNames) {
+			for (const auto& texture : group.TextureNames) {
 				if (texture) {
 					texture->Bind(index);
 					s_QuadShader->Send("u_Texture" + std::to_string(index), (int)index);
@@ -82,7 +116,7 @@ namespace Tara {
 			RenderCommand::PopDrawType();
 			//glDrawArrays(GL_POINTS, 0, m_Quads.size());
 		}
-		s_QuadGroups.clear();
+		ResetQuadGroups();
 		
 		//unset render target
 		auto rt = s_SceneData.camera->GetRenderTarget();
@@ -96,6 +130,11 @@ namespace Tara {
 
 	void Renderer::Draw(VertexArrayRef vertexArray, ShaderRef shader, Transform transform)
 	{
+		if (s_RenderBackend == RenderBackend::None) { return; }
+		if (s_RecordingList) {
+			s_RecordingList->AddDraw(vertexArray, shader, transform);
+			return;
+		}
 		vertexArray->Bind();
 		shader->Bind();
 		shader->Send("u_MatrixViewProjection", s_SceneData.camera->GetViewProjectionMatrix());
@@ -103,8 +142,13 @@ namespace Tara {
 		RenderCommand::Draw(vertexArray);
 	}
 
-	void Renderer::Quad(const Transform& transform, glm::vec4 color, const Texture2DRef& texture, glm::vec2 minUV, glm::vec2 maxUV)
+	void Renderer::Quad(const Transform& transform, glm::vec4 color, const Texture2DRef& texture, glm::vec2 minUV, glm::vec2 maxUV, uint64_t sortKey)
 	{
+		if (s_RenderBackend == RenderBackend::None && !s_HeadlessBatching) { return; }
+		if (s_RecordingList) {
+			s_RecordingList->AddQuad(transform, color, texture, minUV, maxUV, sortKey);
+			return;
+		}
 		//Create the QuadData struct
 		QuadData data = {
 			transform,
@@ -114,57 +158,246 @@ namespace Tara {
 			-1 //temp
 		};
 
-		//find the slot to enter it into
-		bool entered = false;
-		for (auto& group : s_QuadGroups) {
-			auto iter = std::find(group.TextureNames.begin(), group.TextureNames.end(), texture);
-			if (iter == group.TextureNames.end()) {
-				if (!texture || group.TextureNames.size() < s_MaxTextures) {
-					//this group is not full, and does not contain this texture, (or, the texture is null)
-					//so add this texture to the group, and then add this quad to the list
-					//after setting its texture index correctly
-					if (texture){
-						data.TextureIndex = (float)group.TextureNames.size(); //the index about to be filled
-						group.TextureNames.push_back(texture); //filled it!
-					}
-					group.Quads.push_back(data);
-					entered = true;
-					break;//no need to continue loop
-				}
-				else {
-					//this group is full and does not contain this texture
-					continue;
-				}
+		//keyed quads are batched at the end of the scene, once sorted
+		if (s_QuadSortMode == QuadSortMode::Key) {
+			s_SortEntries.push_back({ sortKey, (uint32_t)s_KeyedQuads.size() });
+			s_KeyedQuads.push_back({ data, texture });
+			return;
+		}
+
+		if (!texture) {
+			//untextured quads use no slot, so they always fit in the first batch
+			uint32_t group = (s_QuadGroupCount > 0) ? 0 : NextQuadGroup();
+			s_QuadGroups[group].Quads.push_back(data);
+			return;
+		}
+
+		//each texture is in at most one batch per scene, so one lookup finds its batch and slot
+		TextureSlot& slot = FindTextureSlot(texture.get());
+		if (slot.Group == UINT32_MAX) {
+			//first use this scene: it goes in the first batch with a free slot. Batches only fill up, so that never moves back
+			while (s_FirstOpenQuadGroup < s_QuadGroupCount && s_QuadGroups[s_FirstOpenQuadGroup].TextureNames.size() >= s_MaxTextures) {
+				s_FirstOpenQuadGroup++;
 			}
-			else {
-				//found that texture. Now, add this quad to the list.
-				//also modify the quad texture index
-				if (texture) {
-					float index = (float)(iter - group.TextureNames.begin());
-					data.TextureIndex = index; //the index about to be filled
+			if (s_FirstOpenQuadGroup == s_QuadGroupCount) {
+				NextQuadGroup();
+			}
+			QuadGroup& group = s_QuadGroups[s_FirstOpenQuadGroup];
+			slot.Group = s_FirstOpenQuadGroup;
+			slot.Slot = (uint32_t)group.TextureNames.size();
+			group.TextureNames.push_back(texture);
+		}
+		data.TextureIndex = (float)slot.Slot;
+		s_QuadGroups[slot.Group].Quads.push_back(data);
+	}
+
+	uint32_t Renderer::NextQuadGroup()
+	{
+		//groups past the count were cleared at the end of the last scene, and keep their storage
+		if (s_QuadGroupCount == s_QuadGroups.size()) {
+			s_QuadGroups.emplace_back();
+		}
+		return s_QuadGroupCount++;
+	}
+
+	Renderer::TextureSlot& Renderer::FindTextureSlot(const Texture2D* texture)
+	{
+		//keep the table at most half full, so probes stay short
+		if ((s_TextureSlotCount + 1) * 2 > s_TextureSlots.size()) {
+			std::vector<TextureSlot> old;
+			old.swap(s_TextureSlots);
+			s_TextureSlots.resize(std::max<size_t>(old.size() * 2, 64));
+			s_TextureSlotCount = 0;
+			for (const TextureSlot& entry : old) {
+				if (entry.Stamp == s_TextureSlotStamp) {
+					TextureSlot& moved = FindTextureSlot(entry.Texture);
+					moved.Group = entry.Group;
+					moved.Slot = entry.Slot;
 				}
-				group.Quads.push_back(data);
-				entered = true;
-				break; //no need to continue loop
 			}
 		}
-		if (!entered) {
-			//no group can take it, or there are none.
-			//so, create a new group, add the stuff to it, and push it into the list.
-			QuadGroup group;
-			if (texture) {
-				data.TextureIndex = (float)group.TextureNames.size(); //the index about to be filled
-				group.TextureNames.push_back(texture); //filled it!
+		size_t mask = s_TextureSlots.size() - 1;
+		uint64_t hash = (uint64_t)(uintptr_t)texture;
+		hash ^= hash >> 17;
+		hash *= 0x9E3779B97F4A7C15ull;
+		size_t index = (size_t)(hash >> 32) & mask;
+		while (true) {
+			TextureSlot& entry = s_TextureSlots[index];
+			if (entry.Stamp != s_TextureSlotStamp) {
+				//empty this scene, so the texture is not in the table
+				entry = { texture, s_TextureSlotStamp, UINT32_MAX, 0 };
+				s_TextureSlotCount++;
+				return entry;
+			}
+			if (entry.Texture == texture) {
+				return entry;
+			}
+			index = (index + 1) & mask;
+		}
+	}
+
+	void Renderer::ResetQuadGroups()
+	{
+		for (uint32_t i = 0; i < s_QuadGroupCount; i++) {
+			s_QuadGroups[i].Quads.clear();
+			s_QuadGroups[i].TextureNames.clear();
+		}
+		s_LastQuadBatchCount = s_QuadGroupCount;
+		s_QuadGroupCount = 0;
+		s_FirstOpenQuadGroup = 0;
+		//a new stamp empties every texture slot at once
+		s_TextureSlotCount = 0;
+		s_TextureSlotStamp++;
+		if (s_TextureSlotStamp == 0) {
+			//wrapped, so old stamps could match again
+			for (TextureSlot& entry : s_TextureSlots) {
+				entry.Stamp = 0;
 			}
-			group.Quads.push_back(data);
-			s_QuadGroups.push_back(group);
+			s_TextureSlotStamp = 1;
 		}
+	}
+
+
+	void Renderer::SetHeadlessBatching(bool batch)
+	{
+		CHECK_F(!s_SceneData.camera, "Renderer::SetHeadlessBatching: can't change headless batching inside a scene");
+		s_HeadlessBatching = batch;
+	}
 
+	void Renderer::SetQuadSortMode(QuadSortMode mode)
+	{
+		CHECK_F(!s_SceneData.camera, "Renderer::SetQuadSortMode: can't change the sort mode inside a scene");
+		s_QuadSortMode = mode;
+	}
+
+	uint64_t Renderer::MakeQuadSortKey(uint8_t layer, float depth, const Texture2DRef& texture)
+	{
+		//flip the float's bits so they order as unsigned integers: negatives flip every bit, positives just the sign bit
+		uint32_t depthBits;
+		std::memcpy(&depthBits, &depth, sizeof(float));
+		depthBits = (depthBits & 0x80000000u) ? ~depthBits : (depthBits | 0x80000000u);
+		//the texture only needs to be the same for the same texture, so a hash of its address will do
+		uint64_t textureBits = 0;
+		if (texture) {
+			uint64_t address = (uint64_t)(uintptr_t)texture.get();
+			address ^= address >> 17;
+			address *= 0x9E3779B97F4A7C15ull;
+			textureBits = address >> 40;
+		}
+		//[8 bits layer][32 bits depth][24 bits texture]
+		uint64_t key = ((uint64_t)layer << 56) | ((uint64_t)depthBits << 24) | textureBits;
+		//0 is no key. Only a negative NaN depth on layer 0 with no texture gets here
+		return std::max<uint64_t>(key, 1);
+	}
+
+	/// <summary>
+	/// LSD radix sort on the keys, a byte at a time. Stable, so equal keys keep their order.
+	/// Bytes that are the same in every key are skipped, so keys that only use a few bytes only take that many passes.
+	/// </summary>
+	/// <param name="entries">the entries to sort. Sorted in place</param>
+	/// <param name="count">the number of entries</param>
+	/// <param name="scratch">a second buffer, for the passes to move between</param>
+	template<typename T>
+	static void RadixSortByKey(T* entries, uint32_t count, std::vector<T>& scratch)
+	{
+		if (count < 2) {
+			return;
+		}
+		if (scratch.size() < count) {
+			scratch.resize(count);
+		}
+		//count every byte of every key in one read
+		uint32_t histograms[8][256] = {};
+		for (uint32_t i = 0; i < count; i++) {
+			for (uint32_t b = 0; b < 8; b++) {
+				histograms[b][(entries[i].Key >> (b * 8)) & 0xFF]++;
+			}
+		}
+		T* from = entries;
+		T* to = scratch.data();
+		for (uint32_t b = 0; b < 8; b++) {
+			uint32_t* histogram = histograms[b];
+			uint32_t shift = b * 8;
+			if (histogram[(from[0].Key >> shift) & 0xFF] == count) {
+				//every key has the same byte here, so this pass would move nothing
+				continue;
+			}
+			//turn counts into the first index of each byte value
+			uint32_t offset = 0;
+			for (uint32_t i = 0; i < 256; i++) {
+				uint32_t c = histogram[i];
+				histogram[i] = offset;
+				offset += c;
+			}
+			for (uint32_t i = 0; i < count; i++) {
+				to[histogram[(from[i].Key >> shift) & 0xFF]++] = from[i];
+			}
+			std::swap(from, to);
+		}
+		//an odd number of passes leaves the result in the scratch buffer
+		if (from != entries) {
+			std::copy(from, from + count, entries);
+		}
+	}
+
+	void Renderer::BatchKeyedQuads()
+	{
+		//unkeyed quads stay where they were submitted, so only the runs of keyed quads between them are sorted
+		uint32_t count = (uint32_t)s_SortEntries.size();
+		uint32_t runStart = 0;
+		for (uint32_t i = 0; i <= count; i++) {
+			if (i == count || s_SortEntries[i].Key == 0) {
+				RadixSortByKey(s_SortEntries.data() + runStart, i - runStart, s_SortScratch);
+				runStart = i + 1;
+			}
+		}
+		//batches are filled in order, never going back to an earlier one, so they draw in key order.
+		//a texture can be in several batches here, so its slot only counts if it is in the current one
+		uint32_t current = UINT32_MAX;
+		for (const SortEntry& entry : s_SortEntries) {
+			KeyedQuad& quad = s_KeyedQuads[entry.Index];
+			if (quad.Texture) {
+				TextureSlot& slot = FindTextureSlot(quad.Texture.get());
+				if (current == UINT32_MAX || slot.Group != current) {
+					if (current == UINT32_MAX || s_QuadGroups[current].TextureNames.size() >= s_MaxTextures) {
+						//no batch yet, or the batch is out of texture slots
+						current = NextQuadGroup();
+					}
+					slot.Group = current;
+					slot.Slot = (uint32_t)s_QuadGroups[current].TextureNames.size();
+					s_QuadGroups[current].TextureNames.push_back(quad.Texture);
+				}
+				quad.Data.TextureIndex = (float)slot.Slot;
+			}
+			else if (current == UINT32_MAX) {
+				current = NextQuadGroup();
+			}
+			s_QuadGroups[current].Quads.push_back(quad.Data);
+		}
+		//storage is kept for the next scene
+		s_KeyedQuads.clear();
+		s_SortEntries.clear();
+	}
+
+	void Renderer::BeginRecording(DrawList& list, const CameraRef& camera)
+	{
+		CHECK_F(!s_SceneData.camera, "Renderer::BeginRecording: can't record a draw list inside a scene");
+		CHECK_F(!s_RecordingList, "Renderer::BeginRecording: already recording a draw list");
+		s_RecordingList = &list;
+		//Text and Patch check the camera's projection type
+		s_SceneData.camera = camera;
+	}
+
+	void Renderer::EndRecording()
+	{
+		s_RecordingList = nullptr;
+		s_SceneData.camera = nullptr;
 	}
 
 
-	void Tara::Renderer::Text(const Transform& transform, const std::string& text, FontRef font, glm::vec4 color)
+	void Tara::Renderer::Text(const Transform& transform, const std::string& text, FontRef font, glm::vec4 color, uint64_t sortKey)
 	{
+		if (s_RenderBackend == RenderBackend::None) { return; }
 		Transform t(transform);
 		if (s_SceneData.camera->GetProjectionType() != Camera::ProjectionType::Screen) {
 			t.Scale.y *= -1;
@@ -174,12 +407,13 @@ namespace Tara {
 		std::vector<glm::vec2> uvMax;
 		font->GetTextQuads(text, transforms, uvMin, uvMax);
 		for (int i = 0; i < text.size(); i++) {
-			Quad(t + transforms[i], color, font->GetTexture(), uvMin[i], uvMax[i]);
+			Quad(t + transforms[i], color, font->GetTexture(), uvMin[i], uvMax[i], sortKey);
 		}
 	}
 	
-	void Renderer::Patch(const Transform& transform, const PatchRef& patch, glm::vec4 color)
+	void Renderer::Patch(const Transform& transform, const PatchRef& patch, glm::vec4 color, uint64_t sortKey)
 	{
+		if (s_RenderBackend == RenderBackend::None) { return; }
 		Transform offset{ transform.Position, transform.Rotation, {1.0f, 1.0f, transform.Scale.z} };
 		auto muv = patch->GetMiddleUVs();
 		auto mp = patch->GetMiddleOffsets(glm::vec2(transform.Scale.x, transform.Scale.y));
@@ -209,7 +443,8 @@ namespace Tara {
 						xPos[x + 1] - xPos[x], yPos[y + 1] - yPos[y]),
 					color, t,
 					{ xUV[x],yUV[y] },
-					{ xUV[x + 1],yUV[y + 1] }
+					{ xUV[x + 1],yUV[y + 1] },
+					sortKey
 				);
 			}
 		}
@@ -7,6 +7,7 @@
 #include "Tara/Renderer/Texture.h"
 #include "Tara/Asset/Font.h"
 #include "Tara/Asset/Patch.h"
+#include "Tara/Renderer/DrawList.h"
 
 namespace Tara {
 
@@ -18,6 +19,16 @@ namespace Tara {
 		OpenGl
 	};
 
+	/// <summary>
+	/// How Renderer::EndScene orders the quads of a scene before batching them
+	/// </summary>
+	enum class QuadSortMode {
+		Submission = 0, //batched as submitted, each quad joining the first batch with room for its texture. Sort keys are ignored
+		Key				//stable sorted by sort key, then batched in that order. Quads with equal keys keep the order they were submitted in.
+						//Quads with key 0 (no key) are not moved: they keep their submission order relative to every other quad, and keyed
+						//quads are only sorted among the keyed quads submitted between the same two unkeyed ones.
+	};
+
 	
 
 	/// <summary>
@@ -34,6 +45,13 @@ namespace Tara {
 		/// <returns>the rendering backend</returns>
 		static RenderBackend GetRenderBackend() { return s_RenderBackend; }
 
+		/// <summary>
+		/// Set the rendering backend. Must be done before anything is created or drawn, as resources are made for the current backend.
+		/// With RenderBackend::None, textures and fonts keep CPU-side data only, and drawing does nothing.
+		/// </summary>
+		/// <param name="backend">the new rendering backend</param>
+		static void SetRenderBackend(RenderBackend backend);
+
 		/// <summary>
 		/// Begin a scene to render with a given camera
 		/// </summary>
@@ -45,6 +63,46 @@ namespace Tara {
 		/// </summary>
 		static void EndScene();
 
+		/// <summary>
+		/// Set how quads are ordered. Must not be called inside a scene.
+		/// </summary>
+		/// <param name="mode">the sort mode</param>
+		static void SetQuadSortMode(QuadSortMode mode);
+
+		/// <summary>
+		/// Get how quads are ordered
+		/// </summary>
+		/// <returns>the sort mode</returns>
+		inline static QuadSortMode GetQuadSortMode() { return s_QuadSortMode; }
+
+		/// <summary>
+		/// Make a quad sort key. Keys order by layer, then by depth, then group equal textures, so quads at the same depth batch together.
+		/// </summary>
+		/// <param name="layer">the sort layer. Lower layers draw first</param>
+		/// <param name="depth">the depth within the layer. Lower depths draw first. For Y-sorting, use the negated Y position</param>
+		/// <param name="texture">the texture the quad draws with</param>
+		/// <returns>the sort key. Never 0, which is no key</returns>
+		static uint64_t MakeQuadSortKey(uint8_t layer, float depth, const Texture2DRef& texture);
+
+		/// <summary>
+		/// Get the number of quad batches the last scene drew, to see how often textures broke a batch
+		/// </summary>
+		/// <returns>the batch count</returns>
+		inline static uint32_t GetLastQuadBatchCount() { return s_LastQuadBatchCount; }
+
+		/// <summary>
+		/// With RenderBackend::None, still batch quads in BeginScene, Quad, and EndScene, dropping the batches instead of drawing them.
+		/// For measuring the cost of batching without a GPU. Must not be called inside a scene.
+		/// </summary>
+		/// <param name="batch">true to batch</param>
+		static void SetHeadlessBatching(bool batch);
+
+		/// <summary>
+		/// Check if quads are batched with RenderBackend::None
+		/// </summary>
+		/// <returns>true if batched</returns>
+		inline static bool GetHeadlessBatching() { return s_HeadlessBatching; }
+
 		/// <summary>
 		/// draw a arbitrary vertex array
 		/// </summary>
@@ -58,7 +116,8 @@ namespace Tara {
 		/// </summary>
 		/// <param name="texture">the texture to draw</param>
 		/// <param name="transform">the transform of the quad</param>
-		static void Quad(const Transform& transform, glm::vec4 color = { 1.0f,1.0f,1.0f,1.0f }, const Texture2DRef& texture = nullptr, glm::vec2 minUV = { 0,0 }, glm::vec2 maxUV = {1,1});
+		/// <param name="sortKey">the sort key, used when the sort mode is QuadSortMode::Key. See MakeQuadSortKey. 0 keeps the quad in submission order</param>
+		static void Quad(const Transform& transform, glm::vec4 color = { 1.0f,1.0f,1.0f,1.0f }, const Texture2DRef& texture = nullptr, glm::vec2 minUV = { 0,0 }, glm::vec2 maxUV = {1,1}, uint64_t sortKey = 0);
 
 		/// <summary>
 		/// Render text. If this is being done every frame with unchanging text, it may be more efficent to instead get the rect data from the font directly, and cache it.
@@ -68,7 +127,8 @@ namespace Tara {
 		/// <param name="text">the text to draw</param>
 		/// <param name="font">the font to draw with</param>
 		/// <param name="color">the color of the text. defaults to white</param>
-		static void Text(const Transform& transform, const std::string& text, FontRef font, glm::vec4 color = { 1.0f, 1.0f, 1.0f, 1.0f });
+		/// <param name="sortKey">the sort key of every quad of the text</param>
+		static void Text(const Transform& transform, const std::string& text, FontRef font, glm::vec4 color = { 1.0f, 1.0f, 1.0f, 1.0f }, uint64_t sortKey = 0);
 		
 		/// <summary>
 		/// Render a 9-patch. If this is being done every frame with an unchanging patch, 
@@ -77,11 +137,47 @@ namespace Tara {
 		/// <param name="transform">The transform to render at</param>
 		/// <param name="patch">the patch to render</param>
 		/// <param name="color">the tint color</param>
-		static void Patch(const Transform& transform, const PatchRef& patch, glm::vec4 color = { 1.0f, 1.0f, 1.0f, 1.0f });
+		/// <param name="sortKey">the sort key of every quad of the patch</param>
+		static void Patch(const Transform& transform, const PatchRef& patch, glm::vec4 color = { 1.0f, 1.0f, 1.0f, 1.0f }, uint64_t sortKey = 0);
+
+		/// <summary>
+		/// Start recording into a draw list. Until EndRecording, Quad, Draw, Text, and Patch are stored in the list instead of drawn.
+		/// Must not be called inside a scene.
+		/// </summary>
+		/// <param name="list">the list to record into</param>
+		/// <param name="camera">the camera the draws are made for. Text and Patch lay out differently for screen cameras, so the list should only be submitted to cameras of the same kind</param>
+		static void BeginRecording(DrawList& list, const CameraRef& camera);
+
+		/// <summary>
+		/// Stop recording into a draw list
+		/// </summary>
+		static void EndRecording();
+
+		/// <summary>
+		/// Check if a draw list is being recorded into
+		/// </summary>
+		/// <returns>true if recording</returns>
+		inline static bool IsRecording() { return s_RecordingList != nullptr; }
 
 	private:
 		static void LoadQuadShader();
 
+		/// <summary>
+		/// Sort each run of keyed quads of the scene between unkeyed ones, and batch them all in order after any existing batches
+		/// </summary>
+		static void BatchKeyedQuads();
+
+		/// <summary>
+		/// Start a new batch, reusing the storage of an old one when there is one
+		/// </summary>
+		/// <returns>the index of the batch in s_QuadGroups</returns>
+		static uint32_t NextQuadGroup();
+
+		/// <summary>
+		/// Clear the batches (keeping their storage) and the texture slots, for the next scene
+		/// </summary>
+		static void ResetQuadGroups();
+
 
 	private:
 
@@ -104,6 +200,40 @@ namespace Tara {
 			std::vector<Texture2DRef> TextureNames;
 		};
 
+		/// <summary>
+		/// Where a texture is in the batches of the current scene. An entry of the open addressing table s_TextureSlots,
+		/// empty unless its stamp matches s_TextureSlotStamp, so the table empties at the end of a scene without being touched.
+		/// </summary>
+		struct TextureSlot {
+			const Texture2D* Texture;
+			uint32_t Stamp;
+			uint32_t Group; //UINT32_MAX until the texture is given a slot
+			uint32_t Slot;
+		};
+
+		/// <summary>
+		/// Find the slot entry of a texture, adding an unassigned one if it has none this scene
+		/// </summary>
+		/// <param name="texture">the texture</param>
+		/// <returns>the entry. Only valid until the next call</returns>
+		static TextureSlot& FindTextureSlot(const Texture2D* texture);
+
+		/// <summary>
+		/// A quad waiting to be sorted, in QuadSortMode::Key
+		/// </summary>
+		struct KeyedQuad {
+			QuadData Data;
+			Texture2DRef Texture;
+		};
+
+		/// <summary>
+		/// A sort key, and the index of its quad in s_KeyedQuads. Sorted instead of the quads, so each radix pass moves 16 bytes a quad.
+		/// </summary>
+		struct SortEntry {
+			uint64_t Key;
+			uint32_t Index;
+		};
+
 		/// <summary>
 		/// Structure that holds data about the current scene.
 		/// </summary>
@@ -128,7 +258,21 @@ namespace Tara {
 		static VertexArrayRef s_QuadArray;
 		static ShaderRef s_QuadShader;
 
-		static std::vector<QuadGroup> s_QuadGroups;
+		static std::vector<QuadGroup> s_QuadGroups; //only the first s_QuadGroupCount are in use. The rest are empty, kept for their storage
+		static uint32_t s_QuadGroupCount;
+		static uint32_t s_FirstOpenQuadGroup; //no batch before this one has a free texture slot
+		static std::vector<TextureSlot> s_TextureSlots; //a power of two in size
+		static uint32_t s_TextureSlotCount;
+		static uint32_t s_TextureSlotStamp;
+		static bool s_HeadlessBatching;
+
+		static QuadSortMode s_QuadSortMode;
+		static std::vector<KeyedQuad> s_KeyedQuads;
+		static std::vector<SortEntry> s_SortEntries;
+		static std::vector<SortEntry> s_SortScratch;
+		static uint32_t s_LastQuadBatchCount;
+
+		static DrawList* s_RecordingList;
 	};
 
 }
\ No newline at end of file
@@ -6,6 +6,7 @@
 //platform-dependant
 #include "Platform/OpenGL/OpenGLTexture2D.h"
 #include "Platform/OpenGL/OpenGlRenderTarget.h"
+#include "Platform/Headless/HeadlessTexture2D.h"
 
 namespace Tara{
     Texture::Filtering Texture::s_DefaultTextureFiltering = Texture::Filtering::Nearest;
@@ -22,7 +23,7 @@ namespace Tara{
                 switch (Renderer::GetRenderBackend()) { //GetAssetNameFromPath(path)
                 case RenderBackend::OpenGl: ref = std::make_shared<OpenGLTexture2D>(path, lName); break;
 
-                case RenderBackend::None: ABORT_F("Renderbackend::None not supported!");
+                case RenderBackend::None: ref = std::make_shared<HeadlessTexture2D>(path, lName); break;
                 }
                 AssetLibrary::Get()->RegisterAsset(ref);
             }
@@ -43,7 +44,7 @@ namespace Tara{
             switch (Renderer::GetRenderBackend()) { //GetAssetNameFromPath(path)
             case RenderBackend::OpenGl: ref = std::make_shared<OpenGLTexture2D>(bytes, width, height, bytesPerPixel, name); break;
 
-            case RenderBackend::None: ABORT_F("Renderbackend::None not supported!");
+            case RenderBackend::None: ref = std::make_shared<HeadlessTexture2D>(bytes, width, height, bytesPerPixel, name); break;
             }
             AssetLibrary::Get()->RegisterAsset(ref);
         }
@@ -59,7 +60,7 @@ namespace Tara{
             switch (Renderer::GetRenderBackend()) { //GetAssetNameFromPath(path)
             case RenderBackend::OpenGl: ref = std::make_shared<OpenGLRenderTarget>(width, height, name); break;
 
-            case RenderBackend::None: ABORT_F("Renderbackend::None not supported!");
+            case RenderBackend::None: ref = std::make_shared<HeadlessRenderTarget>(width, height, name); break;
             }
             AssetLibrary::Get()->RegisterAsset(ref);
         }
@@ -35,7 +35,7 @@ namespace Tara{
 		auto& children = GetChildren();
 		glm::vec2 size{ 0,0 };
 		for (auto& child : children) {
-			auto asUI = std::dynamic_pointer_cast<Tara::UIBaseEntity>(child);
+			auto asUI = child->IsOfType<Tara::UIBaseEntity>() ? std::static_pointer_cast<Tara::UIBaseEntity>(child) : nullptr;
 			if (asUI) {
 				auto childDesiredSize = asUI->GetDesiredSize();
 				size.x = std::max(size.x, childDesiredSize.x);
@@ -53,12 +53,9 @@ namespace Tara{
 	void UIBaseEntity::SetDesiredSize(glm::vec2 size)
 	{
 		m_Transform = UIBox::CompressBoxAndSize(UIBox::DecompressBoxAndSize(m_Transform).first, size);
-		auto parent = GetParent().lock();
-		if (parent) {
-			auto pparent = std::dynamic_pointer_cast<Tara::UIBaseEntity>(parent);
-			if (pparent) {
-				pparent->m_DesiredSizeDirty = true;
-			}
+		Entity* parent = GetParentPtr();
+		if (parent && parent->IsOfType<Tara::UIBaseEntity>()) {
+			static_cast<Tara::UIBaseEntity*>(parent)->m_DesiredSizeDirty = true;
 		}
 	}
 	
@@ -67,6 +64,7 @@ namespace Tara{
 		auto prev = UIBox::DecompressBoxAndSize(m_Transform);
 		m_Transform = UIBox::CompressBoxAndSize(area, prev.second);
 		m_RenderAreaCacheDirty = true;
+		InvalidateBoundingBox();
 	}
 	
 	UIBox UIBaseEntity::GetAllowedArea() const
@@ -190,7 +188,7 @@ namespace Tara{
 
 		auto& children = GetChildren();
 		for (auto& child : children) {
-			auto asUI = std::dynamic_pointer_cast<Tara::UIBaseEntity>(child);
+			auto asUI = child->IsOfType<Tara::UIBaseEntity>() ? std::static_pointer_cast<Tara::UIBaseEntity>(child) : nullptr;
 			if (asUI) {
 				//normally, this would be needed, but we are ignoring it.
 				//Other sublcasses of UIBaseEntity will probably override OnUpdate
@@ -213,7 +211,7 @@ namespace Tara{
 
 		EventFilter filter(e);
 		filter.Call<WindowResizeEvent>([this](WindowResizeEvent& ee) {
-			if (!(this->GetParent().lock())) {
+			if (!(this->GetParentPtr())) {
 				//no parent, resize to window size
 				this->SetAllowedArea(UIBox(0.0f, 0.0f, (float)ee.GetWidth(), (float)ee.GetHeight()));
 			}
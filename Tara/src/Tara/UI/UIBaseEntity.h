@@ -21,6 +21,7 @@ namespace Tara {
 	/// </summary>
 	class UIBaseEntity : public Entity {
 	public:
+		TYPE_REGISTRY_BASE(UIBaseEntity, Entity);
 		UIBaseEntity(EntityNoRef parent, LayerNoRef owningLayer, const std::string& name = "UIBaseEntity");
 
 		virtual ~UIBaseEntity() = default;
@@ -11,6 +11,7 @@ namespace Tara {
 
 	class UIButtonEntity : public UIVisualEntity {
 	public:
+		TYPE_REGISTRY_BASE(UIButtonEntity, UIVisualEntity);
 		enum class ButtonState : uint8_t {
 			NORMAL, HOVERED, CLICKED, DISABLED
 		};
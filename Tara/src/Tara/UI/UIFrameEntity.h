@@ -12,6 +12,7 @@ namespace Tara {
 
 	class UIFrameEntity : public UIVisualEntity {
 	public:
+		TYPE_REGISTRY_BASE(UIFrameEntity, UIVisualEntity);
 		/// <summary>
 		/// 
 		/// </summary>
@@ -15,7 +15,7 @@ namespace Tara{
 		glm::vec2 size{ 0,0 };
 		auto spacing = GetSpacing();
 		for (auto& child : children) {
-			auto asUI = std::dynamic_pointer_cast<Tara::UIBaseEntity>(child);
+			auto asUI = child->IsOfType<Tara::UIBaseEntity>() ? std::static_pointer_cast<Tara::UIBaseEntity>(child) : nullptr;
 			if (asUI) {
 				auto childDesiredSize = asUI->GetDesiredSize();
 				//adjust sizes to also get the offsets
@@ -73,7 +73,7 @@ namespace Tara{
 		heightParts.reserve(children.size());
 
 		for (auto& child : children) {
-			auto asUI = std::dynamic_pointer_cast<Tara::UIBaseEntity>(child);
+			auto asUI = child->IsOfType<Tara::UIBaseEntity>() ? std::static_pointer_cast<Tara::UIBaseEntity>(child) : nullptr;
 			if (asUI) {
 				auto childDesiredSize = asUI->GetDesiredSize();
 				//adjust sizes to also get the offsets
@@ -102,7 +102,7 @@ namespace Tara{
 		int i = 0;
 		UIBox unique{ allowed.x1, allowed.y1, allowed.x2, allowed.y2 };
 		for (auto& child : children) {
-			auto asUI = std::dynamic_pointer_cast<Tara::UIBaseEntity>(child);
+			auto asUI = child->IsOfType<Tara::UIBaseEntity>() ? std::static_pointer_cast<Tara::UIBaseEntity>(child) : nullptr;
 			if (asUI) {
 				//move unique to next slot
 				//take the base (y1), and the total height scaled by the percentage that is wanted.
@@ -164,7 +164,7 @@ namespace Tara{
 			heightParts.reserve(children.size());
 
 			for (auto& child : children) {
-				auto asUI = std::dynamic_pointer_cast<Tara::UIBaseEntity>(child);
+				auto asUI = child->IsOfType<Tara::UIBaseEntity>() ? std::static_pointer_cast<Tara::UIBaseEntity>(child) : nullptr;
 				if (asUI) {
 					auto childDesiredSize = asUI->GetDesiredSize();
 					//adjust sizes to also get the offsets
@@ -186,7 +186,7 @@ namespace Tara{
 			int i = 0;
 			UIBox unique{ allowed.x1, allowed.y1, allowed.x2, allowed.y2 };
 			for (auto& child : children) {
-				auto asUI = std::dynamic_pointer_cast<Tara::UIBaseEntity>(child);
+				auto asUI = child->IsOfType<Tara::UIBaseEntity>() ? std::static_pointer_cast<Tara::UIBaseEntity>(child) : nullptr;
 				if (asUI) {
 					//move unique to next slot
 					//take the base (y1), and the total height scaled by the percentage that is wanted.
@@ -11,6 +11,7 @@ namespace Tara {
 	/// </summary>
 	class UIListEntity : public UIBaseEntity {
 	public:
+		TYPE_REGISTRY_BASE(UIListEntity, UIBaseEntity);
 		/// <summary>
 		/// direction of the list
 		/// </summary>
@@ -12,6 +12,7 @@ namespace Tara {
 	/// </summary>
 	class UISpacerEntity : public UIBaseEntity {
 	public:
+		TYPE_REGISTRY_BASE(UISpacerEntity, UIBaseEntity);
 		/// <summary>
 		/// Constructor
 		/// </summary>
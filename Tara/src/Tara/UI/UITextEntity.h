@@ -8,6 +8,7 @@ namespace Tara {
 
 	class UITextEntity : public UIBaseEntity {
 	public:
+		TYPE_REGISTRY_BASE(UITextEntity, UIBaseEntity);
 		UITextEntity(EntityNoRef parent, LayerNoRef owningLayer, FontRef font, const std::string& name = "UITextEntity");
 
 		virtual ~UITextEntity() = default;
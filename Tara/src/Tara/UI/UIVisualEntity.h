@@ -11,6 +11,7 @@ namespace Tara {
 	/// </summary>
 	class UIVisualEntity : public UIBaseEntity {
 	public:
+		TYPE_REGISTRY_BASE(UIVisualEntity, UIBaseEntity);
 		/// <summary>
 		/// Constructor
 		/// </summary>
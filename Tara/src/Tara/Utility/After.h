@@ -1,35 +1,35 @@
 #pragma once
 
-#include <cstdarg>
-#include <future>
 #include "Tara/Core/Application.h"
+#include "Tara/Utility/TimerScheduler.h"
 
 namespace Tara {
 
-	
-
-	struct AfterCallable {
-		float secondsRemaining;
-		std::future<void> callable;
-		AfterCallable(float s, std::future<void>&& callable)
-			:secondsRemaining(s), callable(std::move(callable))
-		{}
-	};
-
-
-	template <typename Callable, typename... Ts> void After(Callable&& callable, float seconds, Ts&&... args) {
-		//va_list args;
-		//va_start(args, seconds);
-		//LOG_S(INFO) << "After being called!";
-		std::future<void> future = std::async(std::launch::deferred, std::move(callable), std::forward<Ts>(args)...);
-		AfterCallable*  c = new AfterCallable( seconds, std::move(future) );
-		Application::Get()->After(c);
-		//va_end(args);
+	/// <summary>
+	/// Call a function after a delay, on the Application's timer scheduler.
+	/// Extra arguments are copied now and passed to the callable when it runs.
+	/// </summary>
+	/// <param name="callable">the function to call</param>
+	/// <param name="seconds">the delay, in seconds</param>
+	/// <param name="...args">arguments for the callable</param>
+	/// <returns>a handle to the timer, to cancel, pause, or rescale it</returns>
+	template <typename Callable, typename... Ts> TimerHandle After(Callable&& callable, float seconds, Ts&&... args) {
+		if constexpr (sizeof...(Ts) == 0) {
+			return Application::Get()->GetTimers().Schedule(std::forward<Callable>(callable), seconds);
+		}
+		else {
+			return Application::Get()->GetTimers().Schedule(
+				[callable = std::forward<Callable>(callable), args = std::make_tuple(std::forward<Ts>(args)...)]() mutable {
+					std::apply(callable, args);
+				},
+				seconds
+			);
+		}
 	}
 
-	inline void __SCRIPT__After(sol::protected_function func, float seconds) {
+	inline TimerHandle __SCRIPT__After(sol::protected_function func, float seconds) {
 		//LOG_S(INFO) << "Script After called!";
-		After([func]() {
+		return After([func]() {
 			auto result = func();
 			if (!result.valid()) {
 				sol::error err = result;
@@ -38,4 +38,4 @@ namespace Tara {
 			}
 		}, seconds);
 	}
-}
\ No newline at end of file
+}
@@ -1,10 +1,12 @@
 #include "tarapch.h"
 #include "Profiler.h"
+#include <mutex>
 
 namespace Tara {
 	namespace Profiler {
 
 		static std::unordered_map<std::string, std::vector<float>> ProfileData;
+		static std::mutex ProfileDataMutex; //scopes may be profiled on worker threads
 
 		void Log(const char* file, const char* name, float time)
 		{
@@ -12,6 +14,7 @@ namespace Tara {
 			fullName = fullName.substr(fullName.find_last_of("/\\") + 1);
 			fullName += ":";
 			fullName += name;
+			std::lock_guard<std::mutex> lock(ProfileDataMutex);
 			auto i = ProfileData.find(fullName);
 			if (i == ProfileData.end()) {
 				ProfileData[fullName] = std::vector<float>({time});
@@ -23,6 +26,7 @@ namespace Tara {
 
 		void Dump(int32_t logLevel)
 		{
+			std::lock_guard<std::mutex> lock(ProfileDataMutex);
 			std::stringstream ss;
 			ss << "Profiling:" << std::endl << std::string(50,'=') << std::endl;
 			ss << "Name\tCounts\tAverage\tMin\tMax\tStandard Deviation" << std::endl;
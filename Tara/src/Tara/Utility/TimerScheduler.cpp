@@ -0,0 +1,309 @@
+#include "tarapch.h"
+#include "TimerScheduler.h"
+#include "Tara/Core/Application.h"
+#include "Tara/Core/Script.h"
+
+#define TIMER_WHEEL_SLOTS (1u << TIMER_WHEEL_SLOT_BITS)
+#define TIMER_WHEEL_SLOT_MASK (TIMER_WHEEL_SLOTS - 1)
+#define TIMER_NODE_NONE 0xFFFFFFFFu
+
+namespace Tara {
+
+	/*****************************************************************
+	 *                          TimerHandle                          *
+	 *****************************************************************/
+
+	void TimerHandle::Cancel() const { Application::Get()->GetTimers().Cancel(*this); }
+	void TimerHandle::Pause() const { Application::Get()->GetTimers().Pause(*this); }
+	void TimerHandle::Resume() const { Application::Get()->GetTimers().Resume(*this); }
+	void TimerHandle::SetTimeScale(float scale) const { Application::Get()->GetTimers().SetTimeScale(*this, scale); }
+	float TimerHandle::GetTimeScale() const { return Application::Get()->GetTimers().GetTimeScale(*this); }
+	bool TimerHandle::IsActive() const { return Application::Get()->GetTimers().IsActive(*this); }
+	bool TimerHandle::IsPaused() const { return Application::Get()->GetTimers().IsPaused(*this); }
+	float TimerHandle::GetRemaining() const { return Application::Get()->GetTimers().GetRemaining(*this); }
+
+	void TimerHandle::RegisterLuaType(sol::state& lua)
+	{
+		sol::usertype<TimerHandle> type = lua.new_usertype<TimerHandle>("Timer");
+		CONNECT_METHOD(TimerHandle, Cancel);
+		CONNECT_METHOD(TimerHandle, Pause);
+		CONNECT_METHOD(TimerHandle, Resume);
+		CONNECT_METHOD(TimerHandle, SetTimeScale);
+		CONNECT_METHOD(TimerHandle, GetTimeScale);
+		CONNECT_METHOD(TimerHandle, IsActive);
+		CONNECT_METHOD(TimerHandle, IsPaused);
+		CONNECT_METHOD(TimerHandle, GetRemaining);
+	}
+
+
+	/*****************************************************************
+	 *                        TimerScheduler                         *
+	 *****************************************************************/
+
+	TimerScheduler::TimerScheduler()
+		: m_CurrentTick(0), m_Time(0.0), m_LinkedCount(0), m_ActiveCount(0)
+	{
+		for (uint32_t i = 0; i < (TIMER_WHEEL_LEVELS << TIMER_WHEEL_SLOT_BITS); i++) {
+			m_SlotHeads[i] = TIMER_NODE_NONE;
+			m_SlotTails[i] = TIMER_NODE_NONE;
+		}
+	}
+
+	TimerScheduler::~TimerScheduler()
+	{
+		CancelAll();
+	}
+
+	TimerHandle TimerScheduler::Schedule(TimerCallback&& callback, float seconds, float timeScale)
+	{
+		uint32_t index;
+		if (m_FreeNodes.size() > 0) {
+			index = m_FreeNodes.back();
+			m_FreeNodes.pop_back();
+		}
+		else {
+			index = (uint32_t)m_Nodes.size();
+			m_Nodes.emplace_back();
+		}
+		Node& node = m_Nodes[index];
+		node.Callback = std::move(callback);
+		node.Remaining = std::max(seconds, 0.0f);
+		node.TimeScale = std::max(timeScale, 0.0f);
+		node.Active = true;
+		node.Paused = false;
+		node.Linked = false;
+		m_ActiveCount++;
+		Release(index);
+		return { index, node.Generation };
+	}
+
+	void TimerScheduler::Advance(float deltaTime)
+	{
+		m_Time += deltaTime;
+		uint64_t target = (uint64_t)(m_Time * TIMER_WHEEL_TICKS_PER_SECOND);
+		while (m_CurrentTick < target) {
+			if (m_LinkedCount == 0) {
+				//nothing is counting down, so there is nothing to cascade or fire on the way
+				m_CurrentTick = target;
+				break;
+			}
+			m_CurrentTick++;
+
+			//when a level's lower bits roll over, its next slot moves down. Highest level first, so nothing lands in a slot already passed
+			uint32_t cascades = 0;
+			while (cascades + 1 < TIMER_WHEEL_LEVELS && (m_CurrentTick & (((uint64_t)1 << (TIMER_WHEEL_SLOT_BITS * (cascades + 1))) - 1)) == 0) {
+				cascades++;
+			}
+			for (uint32_t level = cascades; level > 0; level--) {
+				Cascade(level, (uint32_t)(m_CurrentTick >> (TIMER_WHEEL_SLOT_BITS * level)) & TIMER_WHEEL_SLOT_MASK);
+			}
+
+			//fire everything due this tick. Callbacks may schedule or cancel freely: the node is freed first, and new timers are always at least a tick out
+			uint32_t slot = (uint32_t)m_CurrentTick & TIMER_WHEEL_SLOT_MASK;
+			while (m_SlotHeads[slot] != TIMER_NODE_NONE) {
+				uint32_t index = m_SlotHeads[slot];
+				Unlink(index);
+				TimerCallback callback = std::move(m_Nodes[index].Callback);
+				Free(index);
+				callback();
+			}
+		}
+	}
+
+	void TimerScheduler::Cancel(TimerHandle handle)
+	{
+		Node* node = Lookup(handle);
+		if (!node) {
+			return;
+		}
+		if (node->Linked) {
+			Unlink(handle.Index);
+		}
+		node->Callback.Reset();
+		Free(handle.Index);
+	}
+
+	void TimerScheduler::CancelAll()
+	{
+		for (uint32_t i = 0; i < (uint32_t)m_Nodes.size(); i++) {
+			if (m_Nodes[i].Active) {
+				Cancel({ i, m_Nodes[i].Generation });
+			}
+		}
+	}
+
+	void TimerScheduler::Pause(TimerHandle handle)
+	{
+		Node* node = Lookup(handle);
+		if (node && !node->Paused) {
+			Hold(handle.Index);
+			node->Paused = true;
+		}
+	}
+
+	void TimerScheduler::Resume(TimerHandle handle)
+	{
+		Node* node = Lookup(handle);
+		if (node && node->Paused) {
+			node->Paused = false;
+			Release(handle.Index);
+		}
+	}
+
+	void TimerScheduler::SetTimeScale(TimerHandle handle, float scale)
+	{
+		Node* node = Lookup(handle);
+		if (node) {
+			Hold(handle.Index);
+			node->TimeScale = std::max(scale, 0.0f);
+			Release(handle.Index);
+		}
+	}
+
+	float TimerScheduler::GetTimeScale(TimerHandle handle) const
+	{
+		const Node* node = Lookup(handle);
+		return node ? node->TimeScale : 0.0f;
+	}
+
+	bool TimerScheduler::IsActive(TimerHandle handle) const
+	{
+		return Lookup(handle) != nullptr;
+	}
+
+	bool TimerScheduler::IsPaused(TimerHandle handle) const
+	{
+		const Node* node = Lookup(handle);
+		return node && node->Paused;
+	}
+
+	float TimerScheduler::GetRemaining(TimerHandle handle) const
+	{
+		const Node* node = Lookup(handle);
+		if (!node) {
+			return 0.0f;
+		}
+		return node->Linked ? RemainingOf(*node) : node->Remaining;
+	}
+
+	TimerScheduler::Node* TimerScheduler::Lookup(TimerHandle handle)
+	{
+		if (handle.Index < m_Nodes.size() && m_Nodes[handle.Index].Active && m_Nodes[handle.Index].Generation == handle.Generation) {
+			return &m_Nodes[handle.Index];
+		}
+		return nullptr;
+	}
+
+	const TimerScheduler::Node* TimerScheduler::Lookup(TimerHandle handle) const
+	{
+		if (handle.Index < m_Nodes.size() && m_Nodes[handle.Index].Active && m_Nodes[handle.Index].Generation == handle.Generation) {
+			return &m_Nodes[handle.Index];
+		}
+		return nullptr;
+	}
+
+	void TimerScheduler::Link(uint32_t index)
+	{
+		Node& node = m_Nodes[index];
+		//the lowest level whose span covers the wait. Its slot comes around before the deadline, and no earlier
+		uint64_t delta = node.Deadline - m_CurrentTick;
+		uint32_t level = 0;
+		while (level + 1 < TIMER_WHEEL_LEVELS && delta >= ((uint64_t)1 << (TIMER_WHEEL_SLOT_BITS * (level + 1)))) {
+			level++;
+		}
+		uint32_t slot = (level << TIMER_WHEEL_SLOT_BITS) | ((uint32_t)(node.Deadline >> (TIMER_WHEEL_SLOT_BITS * level)) & TIMER_WHEEL_SLOT_MASK);
+
+		//append, so timers due on the same tick fire in the order they were scheduled
+		node.Slot = slot;
+		node.Prev = m_SlotTails[slot];
+		node.Next = TIMER_NODE_NONE;
+		if (m_SlotTails[slot] != TIMER_NODE_NONE) {
+			m_Nodes[m_SlotTails[slot]].Next = index;
+		}
+		else {
+			m_SlotHeads[slot] = index;
+		}
+		m_SlotTails[slot] = index;
+	}
+
+	void TimerScheduler::Unlink(uint32_t index)
+	{
+		Node& node = m_Nodes[index];
+		if (node.Prev != TIMER_NODE_NONE) {
+			m_Nodes[node.Prev].Next = node.Next;
+		}
+		else {
+			m_SlotHeads[node.Slot] = node.Next;
+		}
+		if (node.Next != TIMER_NODE_NONE) {
+			m_Nodes[node.Next].Prev = node.Prev;
+		}
+		else {
+			m_SlotTails[node.Slot] = node.Prev;
+		}
+		node.Linked = false;
+		m_LinkedCount--;
+	}
+
+	void TimerScheduler::Hold(uint32_t index)
+	{
+		Node& node = m_Nodes[index];
+		if (node.Linked) {
+			node.Remaining = RemainingOf(node);
+			Unlink(index);
+		}
+	}
+
+	void TimerScheduler::Release(uint32_t index)
+	{
+		Node& node = m_Nodes[index];
+		if (node.Linked || node.Paused || node.TimeScale <= 0.0f) {
+			return;
+		}
+		//convert own seconds to scheduler ticks, rounding up so a timer never fires early
+		double ticks = std::ceil((double)node.Remaining / node.TimeScale * TIMER_WHEEL_TICKS_PER_SECOND);
+		double maxTicks = (double)(((uint64_t)1 << (TIMER_WHEEL_SLOT_BITS * TIMER_WHEEL_LEVELS)) - 1);
+		if (ticks > maxTicks) {
+			LOG_S(WARNING) << "TimerScheduler: timer delay is longer than the wheel can hold, it will fire early!";
+			ticks = maxTicks;
+		}
+		node.Deadline = m_CurrentTick + std::max((uint64_t)ticks, (uint64_t)1);
+		node.Linked = true;
+		m_LinkedCount++;
+		Link(index);
+	}
+
+	float TimerScheduler::RemainingOf(const Node& node) const
+	{
+		double seconds = (double)node.Deadline / TIMER_WHEEL_TICKS_PER_SECOND - m_Time;
+		return std::max((float)(seconds * node.TimeScale), 0.0f);
+	}
+
+	void TimerScheduler::Free(uint32_t index)
+	{
+		Node& node = m_Nodes[index];
+		node.Active = false;
+		node.Paused = false;
+		node.Generation++;
+		if (node.Generation == 0) {
+			//0 is reserved for invalid handles
+			node.Generation = 1;
+		}
+		m_FreeNodes.push_back(index);
+		m_ActiveCount--;
+	}
+
+	void TimerScheduler::Cascade(uint32_t level, uint32_t slot)
+	{
+		uint32_t id = (level << TIMER_WHEEL_SLOT_BITS) | slot;
+		uint32_t index = m_SlotHeads[id];
+		m_SlotHeads[id] = TIMER_NODE_NONE;
+		m_SlotTails[id] = TIMER_NODE_NONE;
+		while (index != TIMER_NODE_NONE) {
+			uint32_t next = m_Nodes[index].Next;
+			Link(index);
+			index = next;
+		}
+	}
+
+}
@@ -0,0 +1,338 @@
+#pragma once
+#include "tarapch.h"
+
+//bytes of capture a timer callback can hold without allocating. Larger callables go on the heap
+#define TIMER_CALLBACK_INLINE_SIZE 48
+//resolution of the timer wheel. Timers fire on the first update at or after their tick
+#define TIMER_WHEEL_TICKS_PER_SECOND 1000
+//the wheel has TIMER_WHEEL_LEVELS levels of 2^TIMER_WHEEL_SLOT_BITS slots each, so it spans 2^32 ticks (about 49 days)
+#define TIMER_WHEEL_SLOT_BITS 8
+#define TIMER_WHEEL_LEVELS 4
+
+namespace Tara {
+
+	/// <summary>
+	/// A type-erased void() callable, stored inline when it is small enough, so scheduling a lambda with a few captures doesn't allocate.
+	/// Move only.
+	/// </summary>
+	class TimerCallback {
+	public:
+		TimerCallback() : m_Ops(nullptr) {}
+
+		template<typename F, typename = std::enable_if_t<!std::is_same<std::decay_t<F>, TimerCallback>::value>>
+		TimerCallback(F&& func)
+			: m_Ops(nullptr)
+		{
+			using Fn = std::decay_t<F>;
+			if constexpr (IsInline<Fn>()) {
+				new (m_Storage) Fn(std::forward<F>(func));
+			}
+			else {
+				*(Fn**)m_Storage = new Fn(std::forward<F>(func));
+			}
+			m_Ops = &OpsFor<Fn>::Table;
+		}
+
+		TimerCallback(TimerCallback&& other) noexcept
+			: m_Ops(other.m_Ops)
+		{
+			if (m_Ops) {
+				m_Ops->Move(m_Storage, other.m_Storage);
+				other.m_Ops = nullptr;
+			}
+		}
+
+		TimerCallback& operator=(TimerCallback&& other) noexcept {
+			if (this != &other) {
+				Reset();
+				m_Ops = other.m_Ops;
+				if (m_Ops) {
+					m_Ops->Move(m_Storage, other.m_Storage);
+					other.m_Ops = nullptr;
+				}
+			}
+			return *this;
+		}
+
+		TimerCallback(const TimerCallback&) = delete;
+		TimerCallback& operator=(const TimerCallback&) = delete;
+
+		~TimerCallback() { Reset(); }
+
+		/// <summary>
+		/// Call the callable, if there is one
+		/// </summary>
+		inline void operator()() { if (m_Ops) { m_Ops->Invoke(m_Storage); } }
+
+		inline explicit operator bool() const { return m_Ops != nullptr; }
+
+		/// <summary>
+		/// Destroy the held callable
+		/// </summary>
+		inline void Reset() {
+			if (m_Ops) {
+				m_Ops->Destroy(m_Storage);
+				m_Ops = nullptr;
+			}
+		}
+
+	private:
+		struct Ops {
+			void(*Invoke)(void*);
+			void(*Move)(void* dst, void* src); //move src into uninitialized dst, and destroy src
+			void(*Destroy)(void*);
+		};
+
+		template<typename Fn>
+		static constexpr bool IsInline() {
+			return sizeof(Fn) <= TIMER_CALLBACK_INLINE_SIZE && alignof(Fn) <= alignof(std::max_align_t) && std::is_nothrow_move_constructible<Fn>::value;
+		}
+
+		template<typename Fn, bool Inline = IsInline<Fn>()>
+		struct OpsFor {
+			static void Invoke(void* p) { (*(Fn*)p)(); }
+			static void Move(void* dst, void* src) { new (dst) Fn(std::move(*(Fn*)src)); ((Fn*)src)->~Fn(); }
+			static void Destroy(void* p) { ((Fn*)p)->~Fn(); }
+			static constexpr Ops Table = { &Invoke, &Move, &Destroy };
+		};
+
+		template<typename Fn>
+		struct OpsFor<Fn, false> {
+			static void Invoke(void* p) { (**(Fn**)p)(); }
+			static void Move(void* dst, void* src) { *(Fn**)dst = *(Fn**)src; }
+			static void Destroy(void* p) { delete *(Fn**)p; }
+			static constexpr Ops Table = { &Invoke, &Move, &Destroy };
+		};
+
+	private:
+		alignas(std::max_align_t) unsigned char m_Storage[TIMER_CALLBACK_INLINE_SIZE];
+		const Ops* m_Ops;
+	};
+
+
+	/// <summary>
+	/// A handle to a scheduled timer, for cancelling, pausing, or changing its time scale.
+	/// Handles are small and safe to copy. Once the timer fires or is cancelled, its handles are stale, and every operation on them does nothing.
+	/// The operations act on the Application's scheduler, for convenience (and for Lua). Use the TimerScheduler functions directly for other schedulers.
+	/// </summary>
+	struct TimerHandle {
+		uint32_t Index = 0;
+		uint32_t Generation = 0; //0 is never a live timer
+
+		/// <summary>
+		/// Cancel the timer. It will not fire.
+		/// </summary>
+		void Cancel() const;
+
+		/// <summary>
+		/// Pause the timer. Its remaining time stops counting down until resumed.
+		/// </summary>
+		void Pause() const;
+
+		/// <summary>
+		/// Resume a paused timer
+		/// </summary>
+		void Resume() const;
+
+		/// <summary>
+		/// Set how fast the timer counts down, relative to the scheduler. 2 runs twice as fast, 0.5 half as fast, 0 is the same as paused.
+		/// </summary>
+		/// <param name="scale">the time scale</param>
+		void SetTimeScale(float scale) const;
+
+		/// <summary>
+		/// Get the timer's time scale
+		/// </summary>
+		/// <returns>the time scale, or 0 if the timer is not active</returns>
+		float GetTimeScale() const;
+
+		/// <summary>
+		/// Check if the timer is still waiting to fire (paused timers count)
+		/// </summary>
+		/// <returns>true if active</returns>
+		bool IsActive() const;
+
+		/// <summary>
+		/// Check if the timer is paused
+		/// </summary>
+		/// <returns>true if paused</returns>
+		bool IsPaused() const;
+
+		/// <summary>
+		/// Get the time left before the timer fires, in the timer's own (scaled) time
+		/// </summary>
+		/// <returns>the seconds remaining, or 0 if the timer is not active</returns>
+		float GetRemaining() const;
+
+		inline bool operator==(const TimerHandle& other) const { return Index == other.Index && Generation == other.Generation; }
+		inline bool operator!=(const TimerHandle& other) const { return !(*this == other); }
+
+		//lua stuff
+		static void RegisterLuaType(sol::state& lua);
+	};
+
+
+	/// <summary>
+	/// Schedules callbacks to run after a delay, using a hierarchical timer wheel.
+	/// Scheduling and cancelling are O(1), and advancing costs one slot per elapsed tick plus the timers that fire or move down a level,
+	/// no matter how many timers are waiting. Timer nodes are pooled and reused, and small callbacks are stored inline, so
+	/// steady scheduling doesn't allocate.
+	/// Each timer has its own time scale, and can be paused and resumed. Not thread safe; use from the main thread.
+	/// </summary>
+	class TimerScheduler {
+	public:
+		TimerScheduler();
+		~TimerScheduler();
+
+		TimerScheduler(const TimerScheduler&) = delete;
+		TimerScheduler& operator=(const TimerScheduler&) = delete;
+
+		/// <summary>
+		/// Schedule a callback
+		/// </summary>
+		/// <param name="callback">the callback</param>
+		/// <param name="seconds">the delay, in seconds. The callback runs on the first update at least this long from now (at least one tick)</param>
+		/// <param name="timeScale">how fast the timer counts down, relative to the scheduler</param>
+		/// <returns>a handle to the timer</returns>
+		TimerHandle Schedule(TimerCallback&& callback, float seconds, float timeScale = 1.0f);
+
+		/// <summary>
+		/// Advance time, running every timer that comes due, in the order they come due
+		/// </summary>
+		/// <param name="deltaTime">the time passed, in seconds</param>
+		void Advance(float deltaTime);
+
+		/// <summary>
+		/// Cancel a timer. Does nothing if the timer already fired or was cancelled.
+		/// </summary>
+		/// <param name="handle">the timer</param>
+		void Cancel(TimerHandle handle);
+
+		/// <summary>
+		/// Cancel every timer
+		/// </summary>
+		void CancelAll();
+
+		/// <summary>
+		/// Pause a timer
+		/// </summary>
+		/// <param name="handle">the timer</param>
+		void Pause(TimerHandle handle);
+
+		/// <summary>
+		/// Resume a paused timer
+		/// </summary>
+		/// <param name="handle">the timer</param>
+		void Resume(TimerHandle handle);
+
+		/// <summary>
+		/// Set a timer's time scale. A scale of 0 holds the timer like a pause, until given a positive scale again.
+		/// </summary>
+		/// <param name="handle">the timer</param>
+		/// <param name="scale">the time scale</param>
+		void SetTimeScale(TimerHandle handle, float scale);
+
+		/// <summary>
+		/// Get a timer's time scale
+		/// </summary>
+		/// <param name="handle">the timer</param>
+		/// <returns>the time scale, or 0 if the timer is not active</returns>
+		float GetTimeScale(TimerHandle handle) const;
+
+		/// <summary>
+		/// Check if a timer is still waiting to fire (paused timers count)
+		/// </summary>
+		/// <param name="handle">the timer</param>
+		/// <returns>true if active</returns>
+		bool IsActive(TimerHandle handle) const;
+
+		/// <summary>
+		/// Check if a timer is paused
+		/// </summary>
+		/// <param name="handle">the timer</param>
+		/// <returns>true if paused</returns>
+		bool IsPaused(TimerHandle handle) const;
+
+		/// <summary>
+		/// Get the time left before a timer fires, in the timer's own (scaled) time
+		/// </summary>
+		/// <param name="handle">the timer</param>
+		/// <returns>the seconds remaining, or 0 if the timer is not active</returns>
+		float GetRemaining(TimerHandle handle) const;
+
+		/// <summary>
+		/// Get the number of active timers (paused timers count)
+		/// </summary>
+		/// <returns>the count</returns>
+		inline uint32_t GetActiveCount() const { return m_ActiveCount; }
+
+	private:
+		/// <summary>
+		/// A pooled timer. A timer counts down (is linked into a wheel slot) unless it is paused or has a time scale of 0.
+		/// </summary>
+		struct Node {
+			TimerCallback Callback;
+			uint64_t Deadline = 0;	//tick to fire on, when linked
+			float Remaining = 0.0f;	//own seconds left, when not linked
+			float TimeScale = 1.0f;
+			uint32_t Generation = 1;
+			uint32_t Prev = 0, Next = 0;	//links in the slot list
+			uint32_t Slot = 0;				//the slot list this is in
+			bool Active = false;
+			bool Paused = false;
+			bool Linked = false;
+		};
+
+		/// <summary>
+		/// Get the node of a handle, or nullptr if the handle is stale
+		/// </summary>
+		Node* Lookup(TimerHandle handle);
+		const Node* Lookup(TimerHandle handle) const;
+
+		/// <summary>
+		/// Put a scheduled node into the slot for its deadline
+		/// </summary>
+		void Link(uint32_t index);
+
+		/// <summary>
+		/// Take a scheduled node out of its slot
+		/// </summary>
+		void Unlink(uint32_t index);
+
+		/// <summary>
+		/// Stop a node counting down, keeping its remaining time
+		/// </summary>
+		void Hold(uint32_t index);
+
+		/// <summary>
+		/// Start a node counting down its remaining time, unless it is paused or has a time scale of 0
+		/// </summary>
+		void Release(uint32_t index);
+
+		/// <summary>
+		/// Get the own seconds left on a scheduled node
+		/// </summary>
+		float RemainingOf(const Node& node) const;
+
+		/// <summary>
+		/// Return a node to the pool, invalidating its handles
+		/// </summary>
+		void Free(uint32_t index);
+
+		/// <summary>
+		/// Move every node in a slot down into the levels below, by its deadline
+		/// </summary>
+		void Cascade(uint32_t level, uint32_t slot);
+
+	private:
+		std::vector<Node> m_Nodes;
+		std::vector<uint32_t> m_FreeNodes;
+		uint32_t m_SlotHeads[TIMER_WHEEL_LEVELS << TIMER_WHEEL_SLOT_BITS];
+		uint32_t m_SlotTails[TIMER_WHEEL_LEVELS << TIMER_WHEEL_SLOT_BITS];
+		uint64_t m_CurrentTick;
+		double m_Time;	//seconds advanced, for converting to ticks without drift
+		uint32_t m_LinkedCount;
+		uint32_t m_ActiveCount;
+	};
+
+}